@@ -0,0 +1,72 @@
+/*! ****************************************************************************
+\file ASTBuildOptionAnnotation.hpp
+\authors Ian J. Bertolacci
+
+\brief
+Annotate loops of a Subspace with the option ISL uses to build their AST.
+
+\copyright
+Copyright 2017 Universiy of Arizona
+*******************************************************************************/
+
+#ifndef AST_BUILD_OPTION_ANNOTATION_HPP
+#define AST_BUILD_OPTION_ANNOTATION_HPP
+
+#include <LoopChainIR/Transformation.hpp>
+#include <LoopChainIR/Schedule.hpp>
+#include <LoopChainIR/Subspace.hpp>
+
+#include <string>
+#include <vector>
+
+namespace LoopChainIR {
+
+  /*!
+  Sets the separate, atomic, or unroll option on loops of a Subspace.
+  Trades generated code size against the number of guards in the loops.
+
+  \note
+  Like ParallelAnnotation, this does not produce any ISCC code; the option is
+  recorded in the Schedule and used during code generation.
+  */
+  class ASTBuildOptionAnnotation : public Transformation {
+    public:
+      const ASTBuildOption option;
+      const std::vector<Subspace::size_type> dimensions;
+
+      /*!
+      \brief
+      Annotate all the loops of the subspace with option.
+      */
+      ASTBuildOptionAnnotation( ASTBuildOption option );
+
+      /*!
+      \brief
+      Annotate the listed loops of the subspace with option.
+
+      \param[in] option The option ISL will use to build the loops.
+      \param[in] dimensions Indices of the variable iterators (within the subspace)
+                 of the loops being annotated.
+      */
+      ASTBuildOptionAnnotation( ASTBuildOption option, std::vector<Subspace::size_type> dimensions );
+
+      /*!
+      \brief
+      Annotate loops of the first non-loops subspace.
+
+      \returns
+      Empty list, since annotations do not create ISCC code.
+      */
+      std::vector<std::string> apply( Schedule& schedule );
+
+      /*!
+      \brief
+      Annotate loops of the given subspace.
+
+      \returns
+      Empty list, since annotations do not create ISCC code.
+      */
+      std::vector<std::string> apply( Schedule& schedule, Subspace* subspace );
+  };
+}
+#endif
@@ -18,21 +18,59 @@ Copyright 2017 Universiy of Arizona
 #include <vector>
 #include <set>
 #include <initializer_list>
+#include <iterator>
+#include <cstddef>
 
+// Forward declarations because C++ was a mistake.
 namespace LoopChainIR {
+  class Tuple;
+  class TupleCollection;
+  class AffineAccess;
+  class Dataspace;
 
+  std::ostream& operator<<( std::ostream& os, const Tuple& tuple);
+  std::ostream& operator<<( std::ostream& os, const TupleCollection& collection);
+  std::ostream& operator<<( std::ostream& os, const AffineAccess& access);
+  std::ostream& operator<<( std::ostream& os, const Dataspace& dataspace);
+}
+
+namespace LoopChainIR {
+
+  /*!
+  A point (or offset) of fixed dimensionality.
+  Tuples of up to inline_capacity dimensions are stored inline, without any
+  heap allocation; larger tuples fall back to a vector.
+  */
   class Tuple {
+    public:
+      typedef std::vector<int>::size_type size_type;
+      typedef int* iterator;
+      typedef const int* const_iterator;
+
+      static const size_type inline_capacity = 8;
+
     private:
-      typedef std::vector<int> container_type;
-      container_type tuple;
+      size_type dimensions_var;
+      int inline_values[inline_capacity];
+      std::vector<int> overflow_values;
+
+      // Zero tuple of the given dimensionality.
+      explicit Tuple( size_type dimensions );
+
+      int* data();
+      const int* data() const;
+
+      friend class TupleCollection;
+
     public:
-      typedef container_type::size_type size_type;
-      typedef container_type::iterator iterator;
       Tuple( std::vector<int> values );
       Tuple( std::initializer_list<int> values );
       Tuple( std::vector<std::string> values );
       Tuple( std::initializer_list<std::string> values );
       Tuple( const Tuple& other );
+      Tuple( Tuple&& other );
+      Tuple& operator=( const Tuple& other );
+      Tuple& operator=( Tuple&& other );
 
       static Tuple createMagicEmptyTuple();
 
@@ -41,6 +79,8 @@ namespace LoopChainIR {
       bool isZeroTuple() const;
       iterator begin();
       iterator end();
+      const_iterator begin() const;
+      const_iterator end() const;
 
       int operator[]( size_type index ) const;
       Tuple operator+( const Tuple& that ) const;
@@ -56,47 +96,237 @@ namespace LoopChainIR {
       friend std::ostream& LoopChainIR::operator<<( std::ostream& os, const Tuple& tuple);
   };
 
+  /*!
+  A sorted set of tuples of the same dimensionality.
+  Tuples are stored as a structure of arrays: one contiguous column per
+  dimension, with the tuples in lexicographic order, so that dimension-wise
+  reductions and shifts are straight loops over a column.
+  Iteration yields the tuples (by value) in lexicographic order.
+  */
   class TupleCollection {
-    private:
-      typedef std::set<Tuple> container_type;
+    public:
+      typedef std::vector<int>::size_type size_type;
+
+      class const_iterator {
+        private:
+          const TupleCollection* collection;
+          size_type position;
+
+        public:
+          typedef std::input_iterator_tag iterator_category;
+          typedef Tuple value_type;
+          typedef std::ptrdiff_t difference_type;
+          typedef const Tuple* pointer;
+          typedef Tuple reference;
 
-      container_type tuples;
+          const_iterator( const TupleCollection* collection, size_type position );
+
+          Tuple operator*() const;
+          const_iterator& operator++();
+          const_iterator operator++( int );
+          bool operator==( const const_iterator& that ) const;
+          bool operator!=( const const_iterator& that ) const;
+      };
+
+      typedef const_iterator iterator;
+
+    private:
       const Tuple::size_type dimensions_var;
+      size_type count;
+      // Element d of the k-th tuple is values[ d*count + k ]
+      std::vector<int> values;
 
-    public:
-      typedef container_type::iterator iterator;
+      const int* column( Tuple::size_type dimension ) const;
+      int* column( Tuple::size_type dimension );
+
+      // Lexicographically compare the k-th tuple of left and the l-th tuple of right.
+      static int compare( const TupleCollection& left, size_type k, const TupleCollection& right, size_type l );
 
+    public:
       TupleCollection( Tuple::size_type dimensions );
       TupleCollection( std::set<Tuple> tuples, signed int dimensions = -1 );
       TupleCollection( const TupleCollection& that );
+      TupleCollection( TupleCollection&& that );
       TupleCollection( const TupleCollection& left, const TupleCollection& right );
       Tuple::size_type dimensions() const;
-      iterator begin();
-      iterator end();
+
+      /*! \returns the number of tuples in the collection. */
+      size_type size() const;
+
+      const_iterator begin() const;
+      const_iterator end() const;
       Tuple maxOnDims() const;
       Tuple minOnDims() const;
-      void shiftAll( Tuple& extent );
+      void shiftAll( const Tuple& extent );
 
       std::string str() const;
       friend std::ostream& LoopChainIR::operator<<( std::ostream& os, const TupleCollection& collection);
   };
 
+  /*!
+  An access whose index is an affine function of the iterators: A[ M*i + c ].
+  Rows of the coefficient matrix M correspond to dimensions of the dataspace,
+  columns to dimensions of the iteration space.
+  For example, with iterators (i,j), the transpose A[j][i] is {{0,1},{1,0}} + (0,0),
+  the restriction A[2i] is {{2,0}} + (0), and the broadcast A[i][0] is {{1,0},{0,0}} + (0,0).
+  */
+  class AffineAccess {
+    public:
+      typedef Tuple::size_type size_type;
+      typedef std::vector< std::vector<int> > matrix_type;
+
+    private:
+      matrix_type coefficients;
+      Tuple offset_tuple;
+
+    public:
+      AffineAccess( matrix_type coefficients, Tuple offset );
+
+      /*!
+      \brief Create the translation access A[ i + offset ].
+      */
+      explicit AffineAccess( const Tuple& offset );
+
+      /*! \returns dimensionality of the dataspace (rows of M). */
+      size_type dimensions() const;
+
+      /*! \returns dimensionality of the iteration space (columns of M). */
+      size_type iteratorDimensions() const;
+
+      int coefficient( size_type row, size_type column ) const;
+      Tuple offset() const;
+
+      /*! \returns true if M is the identity (the access is A[ i + c ]) */
+      bool isTranslation() const;
+
+      /*!
+      \returns true if each row and each column of M has at most one non-zero
+      coefficient. A zero row is a constant index (a broadcast dimension), and
+      a zero column an iterator the access does not depend on (e.g. s[0]).
+      */
+      bool isSeparable() const;
+
+      bool hasSameLinearPart( const AffineAccess& that ) const;
+
+      /*!
+      \brief
+      Returns the access after the iteration space is shifted by extent,
+      following the same convention as TupleCollection::shiftAll ( c + M*extent ).
+      */
+      AffineAccess shifted( const Tuple& extent ) const;
+
+      /*! \brief Returns the access with the same coefficients and the given offset. */
+      AffineAccess withOffset( const Tuple& offset ) const;
+
+      /*! \brief Index of the dataspace accessed at iteration. */
+      Tuple evaluate( const Tuple& iteration ) const;
+
+      /*!
+      \brief
+      Compute the distance j - i between an iteration i of this access and the
+      iteration j of earlier that touch the same element
+      ( M*i + c_this = M*j + c_earlier ).
+      Throws an assert_exception if the distance is not a constant: the linear
+      parts differ, or M is not separable, or an iterator does not appear in M.
+
+      \param[in] earlier the access being compared against.
+      \param[out] distance the constant distance, if it exists.
+
+      \returns false if the accesses never touch the same element.
+      */
+      bool dependenceDistance( const AffineAccess& earlier, Tuple& distance ) const;
+
+      /*!
+      \brief
+      As above, but the iterators that do not appear in M may be at any
+      distance: constant[d] is false for those, and distance[d] is 0.
+      Throws an assert_exception if the linear parts differ or M is not
+      separable.
+      */
+      bool dependenceDistance( const AffineAccess& earlier, Tuple& distance, std::vector<bool>& constant ) const;
+
+      /*! \returns true if dependenceDistance can compare this access with that one. */
+      bool isComparable( const AffineAccess& that ) const;
+
+      bool operator<( const AffineAccess& that ) const;
+      bool operator==( const AffineAccess& that ) const;
+      bool operator!=( const AffineAccess& that ) const;
+
+      std::string str() const;
+      friend std::ostream& LoopChainIR::operator<<( std::ostream& os, const AffineAccess& access);
+  };
+
+  /*!
+  Associative and commutative operators a nest may reduce into a dataspace with.
+  */
+  enum ReductionOperator {
+    ReduceAdd, ReduceMultiply, ReduceMin, ReduceMax,
+    ReduceBitAnd, ReduceBitOr, ReduceBitXor, ReduceLogicalAnd, ReduceLogicalOr
+  };
+
+  /*! \returns the OpenMP reduction-identifier of op ( "+", "min", ... ). */
+  std::string reductionIdentifier( ReductionOperator op );
+
   class Dataspace {
     public:
       const std::string name;
     private:
-      const TupleCollection read_collection;
-      const TupleCollection write_collection;
+      TupleCollection read_collection;
+      TupleCollection write_collection;
+      std::set<AffineAccess> affine_read_set;
+      std::set<AffineAccess> affine_write_set;
+      std::set<AffineAccess> reduction_target_set;
+      ReductionOperator reduction_operator;
       Tuple::size_type dimensions_var;
     public:
       Dataspace( std::string name, std::set<Tuple> reads, std::set<Tuple> writes );
       Dataspace( std::string name, const TupleCollection& reads, const TupleCollection& writes );
 
-      TupleCollection reads() const;
-      TupleCollection writes() const;
+      /*!
+      \brief
+      Dataspace with accesses that are not simple offsets of the iterators.
+      Translation accesses in affine_reads and affine_writes are stored as tuples.
+      */
+      Dataspace( std::string name, std::set<Tuple> reads, std::set<Tuple> writes, std::set<AffineAccess> affine_reads, std::set<AffineAccess> affine_writes );
+      Dataspace( std::string name, const TupleCollection& reads, const TupleCollection& writes, std::set<AffineAccess> affine_reads, std::set<AffineAccess> affine_writes );
+
+      /*!
+      \brief
+      Dataspace only accumulated into by the nest: every iteration combines a
+      value into the elements at targets with op (e.g. s[0] += ..., or
+      r[i] = max( r[i], ... ) with the broadcast access {{1,0}} + (0)).
+      Because the updates commute, the dependences they carry between
+      iterations (and between nests reducing with the same operator) do not
+      constrain the schedule.
+      */
+      Dataspace( std::string name, ReductionOperator op, std::set<AffineAccess> targets );
+
+      const TupleCollection& reads() const;
+      const TupleCollection& writes() const;
       TupleCollection allAccesses() const;
       Tuple::size_type dimensions() const;
 
+      /*! \returns the non-translation reads. */
+      const std::set<AffineAccess>& affineReads() const;
+      /*! \returns the non-translation writes. */
+      const std::set<AffineAccess>& affineWrites() const;
+      /*! \returns true if there are any non-translation accesses. */
+      bool hasAffineAccesses() const;
+
+      /*! \returns true if the dataspace is only reduced into. */
+      bool isReduction() const;
+      /*! \returns the elements reduced into (empty if not a reduction). */
+      const std::set<AffineAccess>& reductionTargets() const;
+      /*! \returns the operator of the reduction (throws if not a reduction). */
+      ReductionOperator reductionOperator() const;
+
+      /*!
+      \brief
+      Returns the dataspace with all accesses shifted by extent
+      (see TupleCollection::shiftAll and AffineAccess::shifted).
+      */
+      Dataspace shifted( const Tuple& extent ) const;
+
       std::string str() const;
       friend std::ostream& LoopChainIR::operator<<( std::ostream& os, const Dataspace& dataspace);
   };
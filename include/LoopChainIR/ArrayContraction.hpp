@@ -0,0 +1,98 @@
+/*! ****************************************************************************
+\file ArrayContraction.hpp
+\authors Ian J. Bertolacci
+
+\brief
+Live window analysis for array contraction of temporaries in a fused chain.
+
+A dataspace that is written and then read only inside a group of fused
+nests does not need to be stored in full: an element is only live from the
+fused iteration that writes it to the last fused iteration that reads it.
+Given the shifts applied before fusion (e.g. from
+AutomaticShiftTransformation::computeShiftTuplesForFusion), the analysis
+computes, for each such dataspace, the number of elements along each
+dimension that are live at once. Codegen can then fold the dataspace's index
+modulo that window (a scalar when every window is 1, a rolling buffer
+otherwise).
+
+Only translation accesses (tuples) are considered. A dataspace is only
+contracted if every element read in the fused loop is written earlier in it;
+reads past the edges of the writing nest's domain make it live in.
+
+\copyright
+Copyright 2017 Universiy of Arizona
+*******************************************************************************/
+
+#ifndef ARRAY_CONTRACTION_HPP
+#define ARRAY_CONTRACTION_HPP
+
+#include <LoopChainIR/LoopChain.hpp>
+#include <LoopChainIR/Accesses.hpp>
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+
+namespace LoopChainIR {
+
+  class ArrayContraction {
+    public:
+      /*! \brief Window of a dimension that must be stored in full. */
+      static const int FullDimension = -1;
+
+    private:
+      std::map< std::string, std::vector<int> > windows;
+      std::map< std::string, std::string > reasons;
+
+      void analyze( const LoopChain& chain, const std::vector<LoopChain::size_type>& fused_nests,
+                    const std::map<LoopChain::size_type, Tuple>& shifts, const std::set<std::string>& live_out );
+
+    public:
+      /*!
+      \param[in] chain Loop chain being fused.
+      \param[in] fused_nests Ids of the nests that are fused, in execution order.
+      \param[in] shifts Shift applied to each nest before fusion (missing nests are not shifted).
+      \param[in] live_out Dataspaces that are used after the chain, and cannot be contracted.
+      */
+      ArrayContraction( const LoopChain& chain, const std::vector<LoopChain::size_type>& fused_nests,
+                        const std::map<LoopChain::size_type, Tuple>& shifts, const std::set<std::string>& live_out );
+
+      /*!
+      \brief Analysis where every nest of the chain is fused.
+      */
+      ArrayContraction( const LoopChain& chain, const std::map<LoopChain::size_type, Tuple>& shifts, const std::set<std::string>& live_out );
+
+      /*! \returns the names of all dataspaces that can be contracted. */
+      std::set<std::string> contractibleDataspaces() const;
+
+      bool isContractible( const std::string& dataspace ) const;
+
+      /*! \returns true if the dataspace can be replaced by a scalar. */
+      bool isScalar( const std::string& dataspace ) const;
+
+      /*!
+      \returns the live window along each dimension of a contractible
+      dataspace, or FullDimension where the dimension must be kept in full.
+      */
+      const std::vector<int>& getWindow( const std::string& dataspace ) const;
+
+      /*! \returns why the dataspace cannot be contracted. */
+      std::string getReason( const std::string& dataspace ) const;
+
+      /*!
+      \brief
+      Subscript of the contracted storage for an access of a contractible
+      dataspace. Dimensions with a window of 1 are dropped, windowed
+      dimensions are folded modulo their window, and full dimensions are kept.
+      For example with windows {3, FullDimension}, the indices {"i", "j"}
+      give "[((i)%3+3)%3][j]". Scalars give "".
+
+      \param[in] dataspace Name of a contractible dataspace.
+      \param[in] indices Index expression of each dimension.
+      */
+      std::string contractedSubscript( const std::string& dataspace, const std::vector<std::string>& indices ) const;
+  };
+
+}
+
+#endif
@@ -58,8 +58,8 @@ namespace LoopChainIR {
     std::vector<std::string> apply( Schedule& schedule );
 
     public:
-      static std::vector<ShiftTransformation*> computeShiftForFusion( Subspace::size_type dimensions, LoopChain chain, bool include_zero_tuple = false );
-      static std::map<LoopChain::size_type, Tuple> computeShiftTuplesForFusion( Subspace::size_type dimensions, LoopChain chain, bool include_zero_tuple = false  );
+      static std::vector<ShiftTransformation*> computeShiftForFusion( Subspace::size_type dimensions, const LoopChain& chain, bool include_zero_tuple = false );
+      static std::map<LoopChain::size_type, Tuple> computeShiftTuplesForFusion( Subspace::size_type dimensions, const LoopChain& chain, bool include_zero_tuple = false  );
 
   };
 
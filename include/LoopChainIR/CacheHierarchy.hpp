@@ -0,0 +1,95 @@
+/*! ****************************************************************************
+\file CacheHierarchy.hpp
+\authors Ian J. Bertolacci
+
+\brief
+Data cache hierarchy of the host, read from sysfs or from an override file.
+
+\copyright
+Copyright 2017 Universiy of Arizona
+*******************************************************************************/
+
+#ifndef CACHE_HIERARCHY_HPP
+#define CACHE_HIERARCHY_HPP
+
+#include <string>
+#include <vector>
+
+namespace LoopChainIR {
+
+  /*!
+  One data (or unified) cache level.
+  */
+  struct CacheLevel {
+    typedef std::vector<int>::size_type size_type;
+
+    int level;
+    size_type size;
+    size_type line_size;
+    // Number of cores sharing one instance of the cache.
+    size_type shared_cores;
+
+    CacheLevel( int level, size_type size, size_type line_size = 64, size_type shared_cores = 1 );
+
+    /*! \returns the share of the cache available to each core. */
+    size_type sizePerCore() const;
+  };
+
+  class CacheHierarchy {
+    public:
+      typedef std::vector<CacheLevel>::size_type size_type;
+      typedef std::vector<CacheLevel>::const_iterator const_iterator;
+
+      /*!
+      \brief
+      Environment variable naming an override file used by host() in place
+      of sysfs.
+      */
+      static const char* const OverrideVariable;
+
+    private:
+      // Ordered from the innermost (L1) level out
+      std::vector<CacheLevel> levels;
+
+    public:
+      CacheHierarchy( std::vector<CacheLevel> levels );
+
+      /*!
+      \brief
+      Read the data and unified caches of the first cpu in
+      <root>/cpu0/cache/index* (level, type, size, coherency_line_size,
+      shared_cpu_list).
+      */
+      static CacheHierarchy fromSysfs( const std::string& root = "/sys/devices/system/cpu" );
+
+      /*!
+      \brief
+      Read an override file with one cache per line:
+        <level> <size> [<line size> [<shared cores>]]
+      where sizes may have a K, M or G suffix (e.g. "2 1M 64 1"). Empty lines
+      and lines starting with # are ignored.
+      */
+      static CacheHierarchy fromFile( const std::string& path );
+
+      /*!
+      \brief
+      The host's hierarchy: from the file named by OverrideVariable if it is
+      set, otherwise from sysfs.
+      */
+      static CacheHierarchy host();
+
+      /*!
+      \brief
+      Parse a size such as "32K", "1M" or "32768" into bytes.
+      */
+      static CacheLevel::size_type parseSize( const std::string& size );
+
+      size_type size() const;
+      const CacheLevel& operator[]( size_type index ) const;
+      const_iterator begin() const;
+      const_iterator end() const;
+  };
+
+}
+
+#endif
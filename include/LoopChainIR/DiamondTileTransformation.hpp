@@ -0,0 +1,72 @@
+/*! ****************************************************************************
+\file DiamondTileTransformation.hpp
+\authors Ian J. Bertolacci
+
+\brief
+Diamond tiling of a stencil chain with a time domain over time and its outermost dimension.
+
+\copyright
+Copyright 2017 Universiy of Arizona
+*******************************************************************************/
+
+#ifndef DIAMOND_TILE_TRANSFORMATION_HPP
+#define DIAMOND_TILE_TRANSFORMATION_HPP
+
+#include <LoopChainIR/Transformation.hpp>
+#include <LoopChainIR/Schedule.hpp>
+#include <LoopChainIR/Subspace.hpp>
+#include <LoopChainIR/LoopChain.hpp>
+
+#include <string>
+#include <vector>
+
+namespace LoopChainIR {
+
+  class DiamondTileTransformation : public Transformation {
+    private:
+      int tile_size;
+      std::vector<Transformation*> over_tiles;
+
+    public:
+      /*!
+      \param[in] tile_size Width of the tiles along both diamond coordinates.
+      \param[in] over_tiles Transformations applied to the tile subspace ([row, column]).
+
+      The tiles of a row are independent, so ParallelAnnotation( 1 ) runs them in parallel.
+      Must be the first transformation applied to the schedule.
+      */
+      DiamondTileTransformation( int tile_size, std::vector<Transformation*> over_tiles = std::vector<Transformation*>() );
+
+      int getTileSize() const;
+
+      /*!
+      \brief
+      Smallest positive slope of the diamonds' sides that contains every
+      dependence of chain (which must have a time domain).
+      */
+      static int slope( const LoopChain& chain );
+
+      /*!
+      \brief
+      Generate ISCC code for a transformation, and append it to the transformation
+      list of schedule (modifies schedule).
+
+      \returns
+      The ISCC code as a string
+      */
+      std::vector<std::string> apply( Schedule& schedule );
+
+      /*!
+      \brief
+      Generate ISCC code for a transformation, and append it to the transformation
+      list of schedule (modifies schedule) given the nest subspace.
+
+      \returns
+      The ISCC code as a string
+      */
+      std::vector<std::string> apply( Schedule& schedule, Subspace* subspace );
+  };
+
+}
+
+#endif
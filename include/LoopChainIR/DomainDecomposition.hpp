@@ -0,0 +1,93 @@
+/*! ****************************************************************************
+\file DomainDecomposition.hpp
+\authors Ian J. Bertolacci
+
+\brief
+Partition a loop chain across a grid of ranks, with halo exchanges between its nests.
+
+\copyright
+Copyright 2017 Universiy of Arizona
+*******************************************************************************/
+
+#ifndef DOMAIN_DECOMPOSITION_HPP
+#define DOMAIN_DECOMPOSITION_HPP
+
+#include <LoopChainIR/LoopChain.hpp>
+#include <LoopChainIR/HaloExchange.hpp>
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace LoopChainIR {
+
+  class DomainDecomposition {
+    public:
+      typedef RectangularDomain::size_type size_type;
+      typedef HaloExchange::HaloWidth HaloWidth;
+
+      enum Region { Owned, Interior, Boundary };
+
+    private:
+      LoopChain chain;
+      std::vector<int> grid;
+
+      // Widths of the halos nest reads of each dataspace
+      std::map<std::string, std::vector<HaloWidth> > readWidths( LoopChain::size_type nest ) const;
+      static bool hasHalo( const std::vector<HaloWidth>& widths );
+
+    public:
+      /*!
+      \param[in] chain The chain to decompose.
+      \param[in] grid Number of ranks along each decomposed (outermost) dimension.
+      Nests only write the elements they own.
+      */
+      DomainDecomposition( const LoopChain& chain, std::vector<int> grid );
+
+      const std::vector<int>& getGrid() const;
+
+      /*! \returns the number of ranks. */
+      int ranks() const;
+
+      /*! \returns the symbols of the first and last iteration owned along dimension. */
+      static std::string lowerSymbol( size_type dimension );
+      static std::string upperSymbol( size_type dimension );
+
+      /*!
+      \returns
+      The width of the halo below and above the owned elements of dataspace
+      name along each decomposed dimension: the farthest any nest reads beyond
+      the elements it owns.
+      */
+      std::vector<HaloWidth> haloWidths( const std::string& name ) const;
+
+      /*!
+      \returns
+      The dataspaces exchanged before each nest, given the halos are stale
+      before the first nest.
+      */
+      std::vector< std::set<std::string> > exchanges() const;
+
+      /*!
+      \returns
+      The chain with the domain of nest restricted to the region of a rank's
+      iterations, and the other nests' domains empty.
+      For Interior and Boundary, the halos are those of the dataspaces
+      exchanged before nest.
+      */
+      LoopChain localChain( LoopChain::size_type nest, Region region ) const;
+
+      /*!
+      \returns
+      The code of a rank. A nest reading a stale halo runs its interior while
+      the halo is exchanged, and its boundary after.
+      \param[in] transport Name of the HaloTransport.
+      \param[in] halo_prefix Prefix of the names of the HaloExchanges.
+      */
+      std::string codegen( std::string transport = "transport", std::string halo_prefix = "halo_" ) const;
+  };
+
+}
+
+#endif
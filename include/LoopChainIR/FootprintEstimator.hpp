@@ -0,0 +1,113 @@
+/*! ****************************************************************************
+\file FootprintEstimator.hpp
+\authors Ian J. Bertolacci
+
+\brief
+Estimates, before any code is generated, the data touched by a tile of one or
+more (fused) loop nests.
+
+For every dataspace it reports the distinct bytes touched by one tile, by one
+(fused) iteration, and the bytes of a tile that were already touched by the
+previous tile (the neighbouring tile along the innermost dimension, which is
+the tile executed just before it).
+
+Each access is taken as the bounding box of the elements it touches over the
+tile, which is exact for translations (the Dataspace tuples) and for
+permutations of the iterators; the union and intersection of those boxes are
+counted exactly.
+
+\copyright
+Copyright 2017 Universiy of Arizona
+*******************************************************************************/
+
+#ifndef FOOTPRINT_ESTIMATOR_HPP
+#define FOOTPRINT_ESTIMATOR_HPP
+
+#include <LoopChainIR/LoopChain.hpp>
+#include <LoopChainIR/Schedule.hpp>
+#include <LoopChainIR/TileTransformation.hpp>
+#include <LoopChainIR/Accesses.hpp>
+#include <string>
+#include <vector>
+#include <map>
+
+namespace LoopChainIR {
+
+  class FootprintEstimator {
+    public:
+      typedef RectangularDomain::size_type size_type;
+      typedef std::vector<size_type> TileSizes;
+
+      struct Footprint {
+        // Distinct bytes touched by one tile
+        size_type tile_bytes;
+        // Bytes of the tile already touched by the previous tile
+        size_type reused_bytes;
+        // Distinct bytes touched by one (fused) iteration
+        size_type iteration_bytes;
+      };
+
+      typedef std::map<std::string, Footprint> FootprintMap;
+
+    private:
+      // For each nest, all accesses of each dataspace
+      std::vector< std::map< std::string, std::vector<AffineAccess> > > nest_accesses;
+      std::vector<size_type> nest_dimensions;
+      std::map<std::string, size_type> element_sizes;
+      size_type default_element_size;
+
+      // Accesses of each dataspace made by loops
+      std::map< std::string, std::vector<AffineAccess> > accessesOf( const std::vector<LoopChain::size_type>& loops ) const;
+
+    public:
+      /*!
+      \param[in] chain Loop chain being estimated.
+      \param[in] element_sizes Size, in bytes, of the elements of dataspaces.
+      \param[in] default_element_size Size of the elements of dataspaces not in element_sizes.
+      */
+      FootprintEstimator( const LoopChain& chain,
+                          std::map<std::string, size_type> element_sizes = std::map<std::string, size_type>(),
+                          size_type default_element_size = sizeof(double) );
+
+      /*!
+      \brief
+      Estimate the chain of a schedule, including the shifts of its accesses
+      applied by ShiftTransformations.
+      Tiling rewrites the accesses of the schedule's chain, so this should be
+      done before the TileTransformations are applied.
+      */
+      FootprintEstimator( const Schedule& schedule,
+                          std::map<std::string, size_type> element_sizes = std::map<std::string, size_type>(),
+                          size_type default_element_size = sizeof(double) );
+
+      /*! \returns the size of the elements of dataspace. */
+      size_type elementSize( const std::string& dataspace ) const;
+
+      /*!
+      \brief
+      Footprint of each dataspace accessed by the loops, fused and executing
+      the same tile.
+
+      \param[in] loops Ids of the nests executed in each tile (of equal dimensionality).
+      \param[in] tile Constant size of the tile in every dimension.
+      */
+      FootprintMap estimate( const std::vector<LoopChain::size_type>& loops, const TileSizes& tile ) const;
+      FootprintMap estimate( const std::vector<LoopChain::size_type>& loops, const TileTransformation::TileMap& tile ) const;
+      FootprintMap estimate( LoopChain::size_type loop, const TileTransformation::TileMap& tile ) const;
+
+      /*! \returns the distinct bytes of all dataspaces touched by one tile. */
+      size_type tileBytes( const std::vector<LoopChain::size_type>& loops, const TileSizes& tile ) const;
+
+      /*! \returns the sum of each footprint of footprints. */
+      static Footprint total( const FootprintMap& footprints );
+
+      /*!
+      \returns the sizes of a TileMap giving constant sizes for all of the
+      dimensions dimensions.
+      */
+      static TileSizes tileSizes( const TileTransformation::TileMap& tile, size_type dimensions );
+  };
+
+}
+
+#endif
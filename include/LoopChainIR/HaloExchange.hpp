@@ -0,0 +1,172 @@
+/*! ****************************************************************************
+\file HaloExchange.hpp
+\authors Ian J. Bertolacci
+
+\brief
+Runtime for the halo exchanges of domain decomposed loop chains.
+
+\copyright
+Copyright 2017 Universiy of Arizona
+*******************************************************************************/
+
+#ifndef HALO_EXCHANGE_HPP
+#define HALO_EXCHANGE_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace LoopChainIR {
+
+  /*!
+  Point-to-point, tagged, non-blocking messages between ranks.
+  */
+  class HaloTransport {
+    public:
+      typedef std::size_t size_type;
+
+      virtual ~HaloTransport();
+
+      virtual int rank() const = 0;
+      virtual int ranks() const = 0;
+
+      /*!
+      \brief
+      Start sending bytes bytes of data to rank to. data must not change until
+      wait() returns.
+      */
+      virtual void send( int to, int tag, const void* data, size_type bytes ) = 0;
+
+      /*!
+      \brief
+      Start receiving a message of bytes bytes with tag from rank from into
+      data.
+      */
+      virtual void receive( int from, int tag, void* data, size_type bytes ) = 0;
+
+      /*! \brief Complete every started send and receive. */
+      virtual void wait() = 0;
+  };
+
+  /*!
+  Mailboxes of the LocalTransports of ranks in one process, for testing.
+  */
+  class LocalNetwork {
+    private:
+      int rank_count;
+      std::mutex mutex;
+      std::condition_variable delivered;
+      // (from, to, tag) -> messages, oldest first
+      std::map< std::tuple<int, int, int>, std::deque< std::vector<char> > > mailboxes;
+
+      friend class LocalTransport;
+
+    public:
+      explicit LocalNetwork( int ranks );
+
+      LocalNetwork( const LocalNetwork& ) = delete;
+      LocalNetwork& operator=( const LocalNetwork& ) = delete;
+
+      int ranks() const;
+  };
+
+  /*!
+  Endpoint of one rank of a LocalNetwork. Sends copy the message into the
+  receiver's mailbox immediately; wait() blocks until every started receive
+  has a message.
+  */
+  class LocalTransport : public HaloTransport {
+    private:
+      struct Receive {
+        int from;
+        int tag;
+        void* data;
+        size_type bytes;
+      };
+
+      LocalNetwork& network;
+      int rank_id;
+      std::vector<Receive> receives;
+
+    public:
+      LocalTransport( LocalNetwork& network, int rank );
+
+      int rank() const;
+      int ranks() const;
+      void send( int to, int tag, const void* data, size_type bytes );
+      void receive( int from, int tag, void* data, size_type bytes );
+      void wait();
+  };
+
+  /*!
+  \brief
+  The part [first, last] of [lower, upper] owned by part part of parts, where
+  the parts differ in size by at most one.
+  */
+  std::pair<long, long> partitionRange( long lower, long upper, int parts, int part );
+
+  /*!
+  Exchanges the halos of one rank's block of an array, stored in row-major
+  order with its halos. Corner and edge neighbours are exchanged with directly.
+  */
+  class HaloExchange {
+    public:
+      typedef std::size_t size_type;
+      // Width of the halo below and above the owned elements of a dimension
+      typedef std::pair<size_type, size_type> HaloWidth;
+
+    private:
+      struct Region {
+        int neighbour;
+        int tag;
+        // First element (owned coordinates, which may be negative) and extent
+        std::vector<long> first;
+        std::vector<size_type> extent;
+        std::vector<char> buffer;
+      };
+
+      char* data;
+      size_type element_bytes;
+      std::vector<size_type> owned;
+      std::vector<HaloWidth> halo;
+      std::vector<Region> sends;
+      std::vector<Region> receives;
+
+      size_type offset( const std::vector<long>& coordinate ) const;
+      // Copy between the region of the array and the region's buffer
+      void copy( Region& region, bool to_buffer );
+
+    public:
+      /*!
+      \param[in] data First element of the array, halos included.
+      \param[in] element_bytes Size of an element.
+      \param[in] owned Owned elements in each dimension.
+      \param[in] halo Halo widths in each dimension; the array is
+                 halo[d].first + owned[d] + halo[d].second elements wide.
+      \param[in] grid Ranks in each dimension, numbered in row-major order.
+      \param[in] rank This rank.
+      \param[in] tag Tag distinguishing this array's messages from other arrays'.
+      */
+      HaloExchange( void* data, size_type element_bytes, std::vector<size_type> owned, std::vector<HaloWidth> halo, std::vector<int> grid, int rank, int tag = 0 );
+
+      /*! \returns the number of neighbours this rank exchanges with. */
+      size_type neighbours() const;
+
+      /*! \brief Copy the owned elements the neighbours need into send buffers. */
+      void pack();
+
+      /*! \brief Start sending the packed elements and receiving the halos. */
+      void exchange( HaloTransport& transport );
+
+      /*! \brief Copy the received elements into the halos, after transport.wait(). */
+      void unpack();
+  };
+
+}
+
+#endif
@@ -0,0 +1,103 @@
+/*! ****************************************************************************
+\file HierarchicalTileTransformation.hpp
+\authors Ian J. Bertolacci
+
+\brief
+Multi-level tiling of a loop nest, with one level of tiles per cache of the
+host.
+
+The tiles of each level are sized (by TileSizeSelector) for the share of one
+cache available to a core, and nest: the tiles of the outermost (last level
+cache) tiling are executed in parallel across cores, each of them is tiled for
+the next cache in, and so on down to L1.
+
+\copyright
+Copyright 2017 Universiy of Arizona
+*******************************************************************************/
+
+#ifndef HIERARCHICAL_TILE_TRANSFORMATION_HPP
+#define HIERARCHICAL_TILE_TRANSFORMATION_HPP
+
+#include <LoopChainIR/LoopChain.hpp>
+#include <LoopChainIR/Transformation.hpp>
+#include <LoopChainIR/TileTransformation.hpp>
+#include <LoopChainIR/TileSizeSelector.hpp>
+#include <LoopChainIR/CacheHierarchy.hpp>
+
+#include <string>
+#include <vector>
+
+namespace LoopChainIR {
+
+  class HierarchicalTileTransformation : public Transformation {
+    public:
+      typedef std::vector<TileSizeSelector::TileSizes>::size_type size_type;
+
+    private:
+      LoopChain::size_type loop;
+      // Tile sizes of each level, from the innermost (L1) level out
+      std::vector<TileSizeSelector::TileSizes> levels;
+      bool parallel;
+
+    public:
+      /*!
+      \brief
+      Tile loop for every level of caches. Each level's tile sizes are rounded
+      down to a multiple of the level inside it.
+
+      \param[in] chain Loop chain containing the loop (used to estimate working sets).
+      \param[in] loop Id of loop to transform.
+      \param[in] caches Cache hierarchy to tile for (e.g. CacheHierarchy::host()).
+      \param[in] element_size Size, in bytes, of the elements of the dataspaces.
+      \param[in] simd_width Number of elements in a SIMD vector.
+      \param[in] parallel Annotate the outermost tile loop for parallel execution.
+      */
+      HierarchicalTileTransformation( const LoopChain& chain, LoopChain::size_type loop, const CacheHierarchy& caches,
+                                      TileSizeSelector::size_type element_size = sizeof(double), TileSizeSelector::size_type simd_width = 4,
+                                      bool parallel = true );
+
+      /*!
+      \brief
+      Tile loop with explicit tile sizes for each level, from the innermost
+      level out. Each level must be a multiple of the level before it.
+      */
+      HierarchicalTileTransformation( LoopChain::size_type loop, std::vector<TileSizeSelector::TileSizes> levels, bool parallel = true );
+
+      LoopChain::size_type getLoopId() const;
+
+      /*! \returns the number of tiling levels. */
+      size_type depth() const;
+
+      /*! \returns the tile sizes of each level, from the innermost level out. */
+      const std::vector<TileSizeSelector::TileSizes>& getLevels() const;
+
+      bool isParallel() const;
+
+      /*!
+      \brief
+      Generate ISCC code for the nested tilings, and append it to the
+      transformation list of schedule (modifies schedule).
+
+      \param[inout] schedule Schedule this transformation is being applied to.
+
+      \returns
+      The ISCC code as a string
+      */
+      std::vector<std::string> apply( Schedule& schedule, Subspace* subspace );
+
+      /*!
+      \brief
+      Generate ISCC code for the nested tilings, and append it to the
+      transformation list of schedule (modifies schedule).
+
+      \param[inout] schedule Schedule this transformation is being applied to.
+
+      \returns
+      The ISCC code as a string
+      */
+      std::vector<std::string> apply( Schedule& schedule );
+  };
+
+}
+
+#endif
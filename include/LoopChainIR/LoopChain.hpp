@@ -23,6 +23,8 @@ Copyright 2017 Universiy of Arizona
   class LoopChain {
   private:
     std::vector<LoopNest> chain;
+    // Empty, or the one dimensional domain of the time loop around the chain
+    std::vector<RectangularDomain> time;
 
   public:
     typedef std::vector<LoopNest>::size_type size_type;
@@ -32,6 +34,8 @@ Copyright 2017 Universiy of Arizona
     LoopChain();
 
     LoopChain( const LoopChain& chain );
+    LoopChain( LoopChain&& chain );
+    LoopChain& operator=( LoopChain&& chain );
 
     /*!
     Appends the LoopNest onto the list.
@@ -43,6 +47,7 @@ Copyright 2017 Universiy of Arizona
     \returns reference to the LoopNest object at index.
     */
     LoopNest& getNest( size_type index );
+    const LoopNest& getNest( size_type index ) const;
 
     /*!
     \returns number of LoopNest objects in chain.
@@ -52,7 +57,25 @@ Copyright 2017 Universiy of Arizona
     /*
     \returns the maximum dimensionality of all the loop-nests in the chain.
     */
-    RectangularDomain::size_type maxDimension();
+    RectangularDomain::size_type maxDimension() const;
+
+    /*!
+    Declare a time loop around the chain: each iteration of the (one
+    dimensional) time domain executes every nest of the chain, in order.
+    The time iterator becomes the first argument of every statement.
+    \param[in] domain Domain of the time loop.
+    */
+    void setTimeDomain( RectangularDomain domain );
+
+    /*!
+    \returns true if a time loop was declared around the chain.
+    */
+    bool hasTimeDomain() const;
+
+    /*!
+    \returns the domain of the time loop.
+    */
+    const RectangularDomain& getTimeDomain() const;
 
     iterator begin();
     const_iterator begin() const;
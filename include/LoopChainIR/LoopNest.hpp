@@ -15,7 +15,10 @@ Copyright 2017 Universiy of Arizona
 #define LOOPNEST_HPP
 
 #include <list>
+#include <string>
+#include <vector>
 #include <LoopChainIR/RectangularDomain.hpp>
+#include <LoopChainIR/PolyhedralDomain.hpp>
 #include <LoopChainIR/Accesses.hpp>
 
 namespace LoopChainIR{
@@ -26,6 +29,8 @@ namespace LoopChainIR{
   class LoopNest{
   private:
     RectangularDomain bounds;
+    PolyhedralDomain polyhedral_bounds;
+    bool rectangular;
     std::list<Dataspace> dataspaces;
 
   public:
@@ -36,16 +41,40 @@ namespace LoopChainIR{
     LoopNest( RectangularDomain loop_bounds );
     LoopNest( RectangularDomain loop_bounds, std::list<Dataspace> dataspaces );
 
+    /*!
+    \param[in] loop_bounds Non-rectangular domain of the loop nest
+    */
+    LoopNest( PolyhedralDomain loop_bounds );
+    LoopNest( PolyhedralDomain loop_bounds, std::list<Dataspace> dataspaces );
+
+    /*!
+    \returns true if the nest's domain is a RectangularDomain.
+    */
+    bool isRectangular() const;
+
+    /*!
+    \returns the dimensionality of the nest's domain.
+    */
+    RectangularDomain::size_type dimensions() const;
 
     /*!
     \returns reference to this LoopNest's RectangularDomain.
+    Throws an assert_exception if the nest is not rectangular.
     */
     RectangularDomain& getDomain();
+    const RectangularDomain& getDomain() const;
 
     /*!
-    \returns a copy of the LoopNest's Dataspaces.
+    \returns reference to this LoopNest's domain as a PolyhedralDomain.
+    For rectangular nests, this is the polyhedral equivalent of the RectangularDomain.
     */
-    std::list<Dataspace> getDataspaces() const;
+    PolyhedralDomain& getPolyhedralDomain();
+    const PolyhedralDomain& getPolyhedralDomain() const;
+
+    /*!
+    \returns reference to the LoopNest's Dataspaces.
+    */
+    const std::list<Dataspace>& getDataspaces() const;
 
     /*!
     \brief Replaces the original dataspaces with the given ones.
@@ -55,9 +84,32 @@ namespace LoopChainIR{
     /*!
     \brief Shifts all the accesses by some extent.
     */
-    void shiftDataspaces( Tuple extent );
+    void shiftDataspaces( const Tuple& extent );
   };
 
+  /*!
+  A dependence of iteration i + distance of a later nest on iteration i of an
+  earlier one: both access the same element of dataspace, and at least one of
+  them writes it.
+  */
+  struct DependenceDistance {
+    enum Kind { Flow, Output, Anti };
+
+    std::string dataspace;
+    Kind kind;
+    Tuple distance;
+  };
+
+  /*!
+  \brief
+  Distances of the flow (earlier writes, later reads), output (both write) and
+  anti (earlier reads, later writes) dependences of later on earlier, one per
+  pair of accesses to a dataspace. earlier and later may be the same nest.
+  Throws an assert_exception if a dataspace of either nest has affine accesses
+  or is a reduction, whose distances are not constant.
+  */
+  std::vector<DependenceDistance> dependenceDistances( const LoopNest& earlier, const LoopNest& later );
+
 }
 
 #endif
@@ -0,0 +1,98 @@
+/*! ****************************************************************************
+\file OverlappedTileTransformation.hpp
+\authors Ian J. Bertolacci
+
+\brief
+Tile consecutive producer/consumer nests with overlapping tiles that recompute their halos.
+
+\copyright
+Copyright 2017 Universiy of Arizona
+*******************************************************************************/
+
+#ifndef OVERLAPPED_TILE_TRANSFORMATION_HPP
+#define OVERLAPPED_TILE_TRANSFORMATION_HPP
+
+#include <LoopChainIR/Transformation.hpp>
+#include <LoopChainIR/Schedule.hpp>
+#include <LoopChainIR/Subspace.hpp>
+#include <LoopChainIR/LoopChain.hpp>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace LoopChainIR {
+
+  class OverlappedTileTransformation : public Transformation {
+    public:
+      typedef RectangularDomain::size_type size_type;
+      // Iterations of a nest's region below and above the tile in a dimension
+      typedef std::pair<int, int> Halo;
+
+    private:
+      std::vector<LoopChain::size_type> nests;
+      std::vector<int> tile_sizes;
+      std::vector<Transformation*> over_tiles;
+
+    public:
+      /*!
+      \param[in] nests Ids of the consecutive loops tiled together, in order.
+      \param[in] tile_sizes Iterations per tile of each of the loops' outermost dimensions.
+      \param[in] over_tiles Transformations applied to the tile subspace.
+
+      Each dataspace written by the nests must be written by only one of them,
+      at one offset, and not read by it or an earlier nest, since producer iterations in the
+      halos run more than once. The tiles of a phase can run in parallel.
+      */
+      OverlappedTileTransformation( std::vector<LoopChain::size_type> nests, std::vector<int> tile_sizes, std::vector<Transformation*> over_tiles = std::vector<Transformation*>() );
+
+      const std::vector<LoopChain::size_type>& getNests() const;
+      const std::vector<int>& getTileSizes() const;
+
+      /*!
+      \brief
+      Halo of each nest in each of the first dimensions, covering what the later nests read from it.
+      */
+      static std::vector< std::vector<Halo> > halos( const LoopChain& chain, const std::vector<LoopChain::size_type>& nests, size_type dimensions );
+
+      /*!
+      \brief
+      Iterations of nests executed by an interior tile of tile_sizes, over the
+      iterations of nests in the tile. An estimate that ignores the edges of the
+      domains, where regions are clipped.
+      */
+      static double redundancyRatio( const LoopChain& chain, const std::vector<LoopChain::size_type>& nests, const std::vector<int>& tile_sizes );
+
+      /*! \returns the redundancy ratio of this transformation on chain. */
+      double redundancyRatio( const LoopChain& chain ) const;
+
+      /*!
+      \brief
+      Smallest distance, in tiles, between tiles whose regions do not overlap.
+      */
+      static std::vector<int> phaseStrides( const std::vector< std::vector<Halo> >& halos, const std::vector<int>& tile_sizes );
+
+      /*!
+      \brief
+      Generate ISCC code for a transformation, and append it to the transformation
+      list of schedule (modifies schedule).
+
+      \returns
+      The ISCC code as a string
+      */
+      std::vector<std::string> apply( Schedule& schedule );
+
+      /*!
+      \brief
+      Generate ISCC code for a transformation, and append it to the transformation
+      list of schedule (modifies schedule) given the nest subspace.
+
+      \returns
+      The ISCC code as a string
+      */
+      std::vector<std::string> apply( Schedule& schedule, Subspace* subspace );
+  };
+
+}
+
+#endif
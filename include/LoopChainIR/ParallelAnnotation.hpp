@@ -4,14 +4,81 @@
 #include <LoopChainIR/Transformation.hpp>
 #include <LoopChainIR/Schedule.hpp>
 #include <LoopChainIR/Subspace.hpp>
+#include <LoopChainIR/Accesses.hpp>
+
+#include <string>
+#include <map>
 
 namespace LoopChainIR {
+
+  /*!
+  Clauses of the "omp parallel for" pragma emitted for an annotated loop.
+  Empty (or default) clauses are left out of the pragma, leaving the choice to
+  the OpenMP runtime.
+  */
+  class OpenMPClauses {
+    public:
+      enum ScheduleKind { DefaultSchedule, Static, Dynamic, Guided, Auto, Runtime };
+      enum ProcBind { DefaultProcBind, Master, Close, Spread };
+
+    private:
+      ScheduleKind schedule_kind;
+      std::string chunk_size;
+      unsigned int collapse_depth;
+      std::string thread_count;
+      ProcBind proc_bind;
+      std::map<std::string, ReductionOperator> reductions;
+
+    public:
+      OpenMPClauses();
+
+      /*!
+      \param[in] kind schedule(kind) clause.
+      \param[in] chunk Chunk size (constant or expression) of a static, dynamic or guided schedule.
+      */
+      OpenMPClauses& schedule( ScheduleKind kind, std::string chunk = "" );
+
+      /*!
+      \brief Collapse the annotated loop and the depth-1 loops inside it.
+      The loops must be perfectly nested and rectangular; apply and codegen throw otherwise.
+      */
+      OpenMPClauses& collapse( unsigned int depth );
+
+      /*! \brief num_threads clause (constant or expression). */
+      OpenMPClauses& numThreads( std::string threads );
+
+      OpenMPClauses& procBind( ProcBind bind );
+
+      /*!
+      \brief
+      reduction(op:variable) clause. A variable can only be reduced with one
+      operator.
+      */
+      OpenMPClauses& reduction( ReductionOperator op, std::string variable );
+
+      ScheduleKind getSchedule() const;
+      const std::string& getChunk() const;
+      unsigned int getCollapse() const;
+      const std::string& getNumThreads() const;
+      ProcBind getProcBind() const;
+      const std::map<std::string, ReductionOperator>& getReductions() const;
+
+      /*!
+      \returns the pragma text (without "#pragma"), e.g.
+      "omp parallel for schedule(dynamic,4) collapse(2) proc_bind(spread) reduction(+:sum)"
+      */
+      std::string pragma() const;
+  };
+
   class ParallelAnnotation : public Transformation {
     public:
       const Subspace::size_type additional_depth;
+      const OpenMPClauses clauses;
 
       ParallelAnnotation( );
       ParallelAnnotation( Subspace::size_type additional_depth );
+      ParallelAnnotation( OpenMPClauses clauses );
+      ParallelAnnotation( Subspace::size_type additional_depth, OpenMPClauses clauses );
       /*!
       \brief
       Generate ISCC code for a transformation, and append it to the transformation
@@ -26,6 +93,10 @@ namespace LoopChainIR {
       \brief
       Generate ISCC code for a transformation, and append it to the transformation
       list of schedule (modifies schedule) given a particular subspace.
+      The annotated loops also reduce into the reduction dataspaces of the
+      nests they execute, so each thread reduces into a private copy: a scalar
+      accumulator s[0] by name, any other target as the array section its
+      nest reduces into (e.g. reduction(max:r[1:N-1+1])).
 
       \returns
       The ISCC code as a string
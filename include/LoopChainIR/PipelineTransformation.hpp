@@ -0,0 +1,73 @@
+/*! ****************************************************************************
+\file PipelineTransformation.hpp
+\authors Ian J. Bertolacci
+
+\brief
+Pipeline consecutive loop nests over blocks of their outermost dimension.
+
+\copyright
+Copyright 2017 Universiy of Arizona
+*******************************************************************************/
+
+#ifndef PIPELINE_TRANSFORMATION_HPP
+#define PIPELINE_TRANSFORMATION_HPP
+
+#include <LoopChainIR/Transformation.hpp>
+#include <LoopChainIR/Schedule.hpp>
+#include <LoopChainIR/Subspace.hpp>
+#include <LoopChainIR/LoopChain.hpp>
+
+#include <string>
+#include <vector>
+
+namespace LoopChainIR {
+
+  class PipelineTransformation : public Transformation {
+    private:
+      std::vector<LoopChain::size_type> stages;
+      int block_size;
+      std::string clauses;
+
+    public:
+      /*!
+      \param[in] stages Ids of the consecutive loops forming the pipeline, in order.
+      \param[in] block_size Iterations of the outermost dimension per block.
+      \param[in] clauses Clauses of the doacross loop over blocks (other than ordered).
+
+      The blocks of the last stage must be independent of one another.
+      */
+      PipelineTransformation( std::vector<LoopChain::size_type> stages, int block_size, std::string clauses = "schedule(static, 1)" );
+
+      const std::vector<LoopChain::size_type>& getStages() const;
+      int getBlockSize() const;
+
+      /*!
+      \brief
+      Stage s runs block k - offset[s] in iteration k of the loop over blocks.
+      */
+      static std::vector<int> blockOffsets( const LoopChain& chain, const std::vector<LoopChain::size_type>& stages, int block_size );
+
+      /*!
+      \brief
+      Generate ISCC code for a transformation, and append it to the transformation
+      list of schedule (modifies schedule).
+
+      \returns
+      The ISCC code as a string
+      */
+      std::vector<std::string> apply( Schedule& schedule );
+
+      /*!
+      \brief
+      Generate ISCC code for a transformation, and append it to the transformation
+      list of schedule (modifies schedule) given the nest subspace.
+
+      \returns
+      The ISCC code as a string
+      */
+      std::vector<std::string> apply( Schedule& schedule, Subspace* subspace );
+  };
+
+}
+
+#endif
@@ -0,0 +1,92 @@
+/*! ****************************************************************************
+\file PolyhedralDomain.hpp
+\authors Ian J. Bertolacci
+
+\brief
+Contains the bounds on a (possibly non-rectangular) loop nest.
+The domain is a set of affine constraints over the nest's iterators and
+symbolic constants. For example the triangle 0 <= j <= i <= N would be the
+iterators {"i","j"}, the constraints {"0 <= j <= i <= N"}, and symbols {"N"}.
+
+\copyright
+Copyright 2017 Universiy of Arizona
+*******************************************************************************/
+
+#ifndef POLYHEDRAL_DOMAIN_HPP
+#define POLYHEDRAL_DOMAIN_HPP
+
+#include <LoopChainIR/RectangularDomain.hpp>
+
+#include <string>
+#include <vector>
+#include <set>
+
+namespace LoopChainIR{
+
+  /*
+  Encapsulates the bounds of a polyhedral domain.
+  */
+  class PolyhedralDomain
+  {
+  private:
+    std::vector<std::string> iterators;
+    std::vector<std::string> constraints;
+    std::set<std::string> symbols;
+
+  public:
+    typedef std::vector<std::string>::size_type size_type;
+
+    /*!
+    \param[in] iterators ordered list of iterator names used in the constraints.
+    \param[in] constraints affine (ISL) constraints on the iterators and symbols.
+    \param[in] symbols the set of symbols found in the constraints
+    */
+    PolyhedralDomain( std::vector<std::string> iterators, std::vector<std::string> constraints, std::set<std::string> symbols );
+
+    /*!
+    \param[in] set_string ISL set string (e.g. "[N] -> { [i,j] : 0 <= j <= i <= N }")
+    Unnamed set dimensions are given the names i_0, i_1, ...
+    */
+    PolyhedralDomain( std::string set_string );
+
+    /*!
+    \brief
+    Create the polyhedral equivalent of a rectangular domain.
+    \param[in] domain Rectangular domain being converted.
+    */
+    PolyhedralDomain( const RectangularDomain& domain );
+
+    /*!
+    \returns the dimensionality of the domain
+    */
+    size_type dimensions() const;
+
+    /*!
+    \returns the number of symbolics
+    */
+    size_type symbolics() const;
+
+    /*!
+    \returns the names of the iterators.
+    */
+    const std::vector<std::string>& getIterators() const;
+
+    /*!
+    \returns the constraints of the domain.
+    */
+    const std::vector<std::string>& getConstraints() const;
+
+    /*!
+    \returns the set of symbols.
+    */
+    const std::set<std::string>& getSymbols() const;
+
+    /*!
+    \returns the domain as an ISL set string.
+    */
+    std::string getSet() const;
+
+  };
+
+}
+#endif
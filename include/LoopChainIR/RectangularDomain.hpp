@@ -7,6 +7,8 @@ Contains the bounds on a loop nest.
 Currently, bounds are represented simply as a string, containing only the
 expression that gives that bound. For example the bounds 0 <= x <= N+M would be
 "0" for the lower bound, and "N+M" for the upper bound.
+Each dimension may also have a (constant) stride, so that only
+lower, lower + stride, lower + 2*stride, ... are in the domain.
 
 \copyright
 Copyright 2015-2016 Colorado State University
@@ -31,6 +33,7 @@ namespace LoopChainIR{
   private:
     std::vector<std::string> upper_bounds;
     std::vector<std::string> lower_bounds;
+    std::vector<std::string> strides;
     std::set<std::string> symbols;
 
   public:
@@ -88,36 +91,49 @@ namespace LoopChainIR{
     */
     RectangularDomain( std::vector< std::pair<std::string,std::string> > bounds, std::set<std::string> symbols );
 
+    /*!
+    \param[in] lower_bounds ordered vector of lower bounds
+    \param[in] upper_bounds ordered vector of upper bounds
+    \param[in] strides ordered vector of strides (positive integer constants)
+    \param[in] symbols the set of symbols found in the bounds
+    */
+    RectangularDomain( std::vector<std::string> lower_bounds, std::vector<std::string> upper_bounds, std::vector<std::string> strides, std::set<std::string> symbols );
+
 
     /*!
     \param[in] RectangularDomain to append
     */
-    void append(RectangularDomain d);
+    void append( const RectangularDomain& d );
 
     /*!
     \returns the dimensionality of the domain
     */
-    size_type dimensions();
+    size_type dimensions() const;
 
     /*!
     \returns the number of symbolics
     */
-    size_type symbolics();
+    size_type symbolics() const;
 
     /*!
     \returns the upper bound of the dimension.
     */
-    std::string getUpperBound( size_type dimension );
+    const std::string& getUpperBound( size_type dimension ) const;
 
     /*!
     \returns the lower bound of the dimension.
     */
-    std::string getLowerBound( size_type dimension );
+    const std::string& getLowerBound( size_type dimension ) const;
+
+    /*!
+    \returns the stride of the dimension ("1" unless specified).
+    */
+    const std::string& getStride( size_type dimension ) const;
 
     /*!
     \returns the set of symbols.
     */
-    std::set<std::string> getSymbols( );
+    const std::set<std::string>& getSymbols( ) const;
 
   };
 
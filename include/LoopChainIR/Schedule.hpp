@@ -21,6 +21,10 @@ Copyright 2017 Universiy of Arizona
 #include <LoopChainIR/util.hpp>
 #include <string>
 #include <vector>
+#include <set>
+#include <map>
+#include <list>
+#include <memory>
 #include <iostream>
 #include <sstream>
 
@@ -35,6 +39,53 @@ namespace LoopChainIR {
   print Schedule object to ostream.
   */
   std::ostream& operator<<( std::ostream& os, const Schedule& schedule);
+
+  /*!
+  \brief
+  Options controlling how ISL builds the AST of a particular loop.
+  Separate splits the loop into pieces with simpler bounds (more code, fewer guards),
+  Atomic generates each statement instance in a single loop (less code, more guards),
+  Unroll completely unrolls the loop (requires a constant trip count).
+  */
+  enum class ASTBuildOption { Separate, Atomic, Unroll };
+
+  /*!
+  \brief
+  An OpenMP doacross loop: pragma (which has an ordered(1) clause) is emitted
+  before the loop, each iteration waits for the previous iteration's
+  depend(source) before it starts, and signals its own depend(source) before
+  the trailing statements belonging to the overlapped nests.
+  Only loops executing nothing but statements of nests are doacross loops.
+  */
+  struct DoacrossLoop {
+    std::string pragma;
+    std::set<LoopChain::size_type> nests;
+    std::set<LoopChain::size_type> overlapped;
+    // Set during code generation
+    std::string statement_symbol;
+  };
+
+  /*!
+  \brief
+  Tile loops whose tiles are executed by a TileRuntime (the variable runtime
+  of the generated code). The tile loops are emitted twice: first registering
+  each tile in a TileGraph, with an edge to it from the tile at tile - offset
+  for every offset, then in the tile body passed to runtime.run, which only
+  executes the tile it is called with.
+  */
+  struct RuntimeTiles {
+    std::string runtime;
+    Subspace::size_type dimensions;
+    std::set< std::vector<int> > offsets;
+  };
+
+  /*!
+  \brief
+  Reduction clauses (e.g. "reduction(+:sum)") of each nest, by the dataspace
+  they reduce into. A parallel loop's pragma gets the clauses of the nests
+  executed under it.
+  */
+  typedef std::map< LoopChain::size_type, std::map<std::string, std::string> > NestReductions;
 }
 
 namespace LoopChainIR {
@@ -51,15 +102,29 @@ namespace LoopChainIR {
 
   private:
     LoopChain chain;
+    // Accesses of each nest as given, kept when a transformation first rewrites them
+    std::map<LoopChain::size_type, std::list<Dataspace> > original_dataspaces;
+    // getChain() with the original accesses restored, built on request
+    mutable std::unique_ptr<LoopChain> original_chain;
     RectangularDomain::size_type iterators_length;
     std::vector<std::string> transformations;
     std::vector<std::string> domains;
-    std::map<Subspace*, Subspace::size_type> parallel_subspaces;
+    // OpenMP pragma of each annotated depth of each parallel subspace
+    std::map<Subspace*, std::map<Subspace::size_type, std::string> > parallel_subspaces;
+    std::map<Subspace*, std::map<Subspace::size_type, NestReductions> > reduction_subspaces;
+    std::map<Subspace*, std::map<Subspace::size_type, DoacrossLoop> > doacross_subspaces;
+    std::map<Subspace*, RuntimeTiles> runtime_subspaces;
+    std::map<Subspace*, std::map<Subspace::size_type, ASTBuildOption> > ast_build_options;
+    std::set<std::string> symbols;
+    std::vector<std::string> context_constraints;
     std::string statement_prefix;
     std::string root_statement_symbol;
     std::string iterator_prefix;
     SubspaceManager manager;
+    // Subspace of the chain's time loop, if it has one
+    Subspace* time_subspace;
     int depth;
+    bool persistent_region;
 
     /*!
     \brief
@@ -70,8 +135,29 @@ namespace LoopChainIR {
     */
     size_type append( std::string text );
 
+    /*!
+    \brief
+    Print the nodes of tree (the root block's children) inside a single
+    parallel region, with barriers only between dependent nests.
+    */
+    __isl_give isl_printer* printPersistentRegion( __isl_keep isl_ast_node* tree, __isl_take isl_printer* p, __isl_take isl_ast_print_options* options ) const;
+
+    /*!
+    \brief
+    Print the statements of node (flattening blocks) inside the persistent
+    region. Sequential loops and conditions around shared loops run on every
+    thread; other statements without a shared loop run on a single thread.
+    unsynchronized holds the nests executed since the last barrier.
+    */
+    __isl_give isl_printer* printPersistentNodes( __isl_keep isl_ast_node* node, __isl_take isl_printer* p, __isl_keep isl_ast_print_options* options, std::set<LoopChain::size_type>& unsynchronized ) const;
+
   public:
     Schedule( LoopChain& chain, std::string statement_prefix = std::string(""), std::string iterator_prefix = "c" );
+
+    /*!
+    \brief Schedule that takes ownership of the chain instead of copying it.
+    */
+    Schedule( LoopChain&& chain, std::string statement_prefix = std::string(""), std::string iterator_prefix = "c" );
     /*!
     \returns The length (in symbols) of the loop chain's iterator.
     */
@@ -81,6 +167,29 @@ namespace LoopChainIR {
     \brief returns the original loop chain
     */
     LoopChain& getChain();
+    const LoopChain& getChain() const;
+
+    /*!
+    \brief
+    Keep the accesses of the nest as they are before a transformation
+    rewrites them in getChain(). Only the first call for a nest has an effect.
+    */
+    void preserveDataspaces( LoopChain::size_type nest );
+
+    /*!
+    \brief
+    returns the accesses of the nest as given to the schedule, which is what
+    the schedule map applies to.
+    */
+    const std::list<Dataspace>& getOriginalDataspaces( LoopChain::size_type nest ) const;
+
+    /*!
+    \brief
+    returns the loop chain with the accesses as given to the schedule.
+    This is getChain() itself until a transformation rewrites accesses, and is
+    invalidated by the next such transformation.
+    */
+    const LoopChain& getOriginalChain() const;
 
     /*!
     \brief returns the original loop chain
@@ -167,7 +276,7 @@ namespace LoopChainIR {
     \returns
     std::string copy of the statement prefix.
     */
-    std::string getStatementPrefix();
+    std::string getStatementPrefix() const;
 
     /*!
     \brief
@@ -176,9 +285,9 @@ namespace LoopChainIR {
     \returns
     std::string copy of the root statement symbol.
     */
-    std::string getRootStatementSymbol();
+    std::string getRootStatementSymbol() const;
 
-    std::string getIteratorPrefix();
+    std::string getIteratorPrefix() const;
 
     /*!
     \brief
@@ -205,9 +314,33 @@ namespace LoopChainIR {
     /*! \brief Generates ISCC code that can be used by the ISCC interpreter to generate code equivalent to the output of ISL */
     std::string codegenToISCC( ) const;
 
+    /*!
+    \brief
+    Apply the transformations appended so far to the domains of the chain.
+
+    \returns
+    The current iteration space (in the input space of the next transformation)
+    as an ISL union set string.
+    */
+    std::string getIterationSpace() const;
+
+    /*!
+    \brief
+    Compose the transformations appended so far, restricted to the domains of
+    the chain.
+
+    \returns
+    The map from each statement instance to its point in the current iteration
+    space, as an ISL union map string.
+    */
+    std::string getScheduleMap() const;
+
     /*! \brief Get a reference to the manager. */
     SubspaceManager& getSubspaceManager();
 
+    /*! \brief Get the subspace of the chain's time loop (NULL if the chain has no time domain). */
+    Subspace* getTimeSubspace();
+
     /*! \brief Get the current depth of nested transformations. */
     int getDepth();
 
@@ -217,13 +350,125 @@ namespace LoopChainIR {
     /*! \brief Decrease depth of nested transformations. */
     int decrementDepth();
 
-    void addParallelSubspace( Subspace* subspace, Subspace::size_type additional_depth );
+    /*!
+    \brief
+    Execute the loop additional_depth loops into subspace in parallel.
+
+    \param[in] pragma Pragma text emitted before the loop (see OpenMPClauses::pragma).
+    Each line of the text is emitted as its own pragma, and $n is replaced by
+    the iterator of the loop n loops out from the annotated one ($0 being the
+    annotated loop's own iterator). $min(n) is replaced by the least value
+    that loop takes over the whole schedule.
+    */
+    void addParallelSubspace( Subspace* subspace, Subspace::size_type additional_depth, std::string pragma = "omp parallel for" );
+
+    /*!
+    \brief
+    Add the reduction clauses of the nests executed under the parallel loops
+    additional_depth loops into subspace to their pragma.
+    Two nests under the same loop must reduce into a dataspace the same way.
+    */
+    void addParallelReductions( Subspace* subspace, Subspace::size_type additional_depth, NestReductions reductions );
+
+    /*!
+    \brief
+    Execute the loops additional_depth loops into subspace that execute only
+    statements of nests as OpenMP doacross loops ("omp parallel for <clauses> ordered(1)").
+    The iterations run in order up to their depend(source), which is emitted
+    before the trailing statements of the loop body that belong only to the
+    overlapped nests; those statements run concurrently with later iterations.
+    The loop's iterator is expected to step by one.
+    */
+    void addDoacrossSubspace( Subspace* subspace, Subspace::size_type additional_depth, std::set<LoopChain::size_type> nests, std::set<LoopChain::size_type> overlapped, std::string clauses = "schedule(static, 1)" );
+
+    /*!
+    \brief
+    Execute the tiles of the first tiles.dimensions loops of subspace with a
+    TileRuntime (see RuntimeTiles). Every statement under those loops must be
+    under all of them.
+    */
+    void addRuntimeSubspace( Subspace* subspace, RuntimeTiles tiles );
+
+    /*!
+    \brief
+    Generate the whole chain in one "omp parallel" region, instead of a region
+    per parallel loop.
+    A nest (top-level loop) whose outermost loop is annotated "omp parallel for"
+    becomes an "omp for ... nowait" loop; any other nest is executed by a single
+    thread ("omp single nowait"), with the parallel loops within it opening
+    nested regions.
+    An "omp barrier" is only emitted before a nest that accesses a dataspace
+    written (or reduced into) by, or writes a dataspace accessed by, a nest
+    executed since the previous barrier.
+    */
+    void setPersistentParallelRegion( bool persistent );
+    bool getPersistentParallelRegion() const;
+
+    /*!
+    \brief
+    Set the AST build option ISL uses for a loop.
+
+    \param[in] subspace The Subspace the loop belongs to.
+    \param[in] dimension The index of the loop's iterator within the subspace.
+    \param[in] option The option used when generating the loop.
+    */
+    void addASTBuildOption( Subspace* subspace, Subspace::size_type dimension, ASTBuildOption option );
+
+    /*!
+    \brief
+    Returns the ISL AST build options (as an ISL union map string) used during code generation.
+    By default, the loops are separated on the nest subspace.
+    */
+    std::string getASTBuildOptions() const;
+
+    /*!
+    \brief
+    Assume a constraint on the symbolic constants of the chain during code generation
+    (e.g. "N >= 1024 and N % 32 = 0").
+    ISL does not generate guards and remainder loops for cases that violate
+    the constraint, so the generated code is only correct for values satisfying it.
+
+    \param[in] constraint ISL constraint expression over the symbols of the chain's domains.
+    */
+    void addContextConstraint( std::string constraint );
+
+    /*!
+    \brief
+    Returns the context (as an ISL parameter set string) assumed during code generation.
+    */
+    std::string getContext() const;
 
   public:
     friend std::ostream& LoopChainIR::operator<<( std::ostream& os, const Schedule& schedule);
 
   };
 
+  // Frees the pragma text carried by a parallel annotation id
+  void free_parallel_annotation( void* pragma );
+
+  // Returns the pragma text (e.g. "omp parallel for schedule(dynamic)") of a parallel annotation id
+  std::string parallel_annotation_pragma( __isl_keep isl_id* annotation );
+
+  // Returns the lines of the pragma text of a parallel annotation id
+  std::vector<std::string> parallel_annotation_pragma_lines( __isl_keep isl_id* annotation );
+
+  // Frees the DoacrossLoop carried by a doacross annotation id
+  void free_doacross_annotation( void* loop );
+
+  // Frees the RuntimeTiles carried by a runtime annotation id
+  void free_runtime_annotation( void* tiles );
+
+  // Pragmas of the loops at each depth, passed to custom_for_builder_callback
+  struct ParallelDepths {
+    std::map<Subspace::size_type, std::string> pragmas;
+    std::map<Subspace::size_type, NestReductions> reductions;
+    std::map<Subspace::size_type, DoacrossLoop> doacross;
+    std::map<Subspace::size_type, RuntimeTiles> runtime;
+    // Least value of each loop over the schedule, by iterator, for $min(n) in pragmas
+    std::map<std::string, std::string> least_values;
+    std::string statement_symbol;
+  };
+
   // Callback function called during isl_ast_build_set_after_each_for to annotate parallel loops
   __isl_give isl_ast_node* custom_for_builder_callback( __isl_take isl_ast_node *node, __isl_keep isl_ast_build* build, void* user );
 
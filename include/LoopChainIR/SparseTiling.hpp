@@ -0,0 +1,177 @@
+/*! ****************************************************************************
+\file SparseTiling.hpp
+\authors Ian J. Bertolacci
+
+\brief
+Inspector-executor runtime for full sparse tiling of loop chains whose
+accesses go through index arrays (e.g. unstructured meshes).
+
+The inspector examines the index arrays at run time, partitions a seed loop
+into tiles, and grows the tiles backward and forward through the rest of the
+chain so that every dependence between loops goes from a tile to the same or
+a later tile. The resulting SparseTileSchedule can be executed directly, or
+handed to generated executor code, and reused for as long as the index
+arrays do not change (e.g. across time steps).
+
+As with the polyhedral transformations, the iterations of each individual
+loop are assumed to be independent of each other.
+
+\copyright
+Copyright 2017 Universiy of Arizona
+*******************************************************************************/
+
+#ifndef SPARSE_TILING_HPP
+#define SPARSE_TILING_HPP
+
+#include <string>
+#include <vector>
+#include <map>
+#include <functional>
+
+namespace LoopChainIR {
+
+  /*!
+  Accesses of one loop into one dataspace, as a compressed sparse row relation
+  from iterations to data items: iteration i touches
+  items[ offsets[i] ] ... items[ offsets[i+1] - 1 ].
+  */
+  class SparseAccess {
+    public:
+      typedef std::vector<int>::size_type size_type;
+
+      const std::string dataspace;
+      const bool is_write;
+
+    private:
+      std::vector<int> offsets;
+      std::vector<int> items;
+
+    public:
+      SparseAccess( std::string dataspace, bool is_write, std::vector<int> offsets, std::vector<int> items );
+
+      /*!
+      \brief
+      Create accesses from an index array where every iteration touches the
+      same number of items: iteration i touches index[i*arity] ... index[i*arity + arity - 1].
+      */
+      static SparseAccess fromIndexArray( std::string dataspace, bool is_write, const std::vector<int>& index, size_type arity );
+
+      /*!
+      \brief
+      Create the direct access: iteration i touches item i.
+      */
+      static SparseAccess direct( std::string dataspace, bool is_write, size_type iterations );
+
+      /*! \returns number of iterations the relation is defined over. */
+      size_type iterations() const;
+
+      /*! \returns one past the largest item accessed. */
+      int itemBound() const;
+
+      const int* beginItems( size_type iteration ) const;
+      const int* endItems( size_type iteration ) const;
+  };
+
+  /*!
+  The result of inspection: for every loop of the chain, the iterations of that
+  loop in each tile. Executing tiles in order, and in each tile every loop in
+  order, respects all dependences of the chain.
+  */
+  class SparseTileSchedule {
+    public:
+      typedef std::vector<int>::size_type size_type;
+
+    private:
+      int num_tiles;
+      // Tile of each iteration of each loop
+      std::vector< std::vector<int> > tile_of;
+      // CSR from tile to iterations, per loop
+      std::vector< std::vector<int> > tile_pointers;
+      std::vector< std::vector<int> > tile_iterations;
+
+    public:
+      SparseTileSchedule( int num_tiles, std::vector< std::vector<int> > tile_of );
+
+      int numTiles() const;
+      size_type numLoops() const;
+
+      /*! \returns the tile the iteration of loop is scheduled in. */
+      int tileOf( size_type loop, size_type iteration ) const;
+
+      /*! \returns tile t of loop is tileIterations(loop)[ tilePointers(loop)[t] .. tilePointers(loop)[t+1] ) */
+      const std::vector<int>& tilePointers( size_type loop ) const;
+      const std::vector<int>& tileIterations( size_type loop ) const;
+
+      /*!
+      \brief
+      Execute the schedule, calling kernel( loop, iteration ) for every iteration of the chain.
+      */
+      void execute( std::function<void(size_type, int)> kernel ) const;
+
+      /*!
+      \brief
+      Generate C executor code for the schedule.
+      The generated code expects, for each loop k, the arrays
+      <prefix>tile_ptr_k and <prefix>tile_iter_k (filled from tilePointers(k)
+      and tileIterations(k)) and the statement macro <statement_prefix>statement_k(i).
+
+      \param[in] prefix Prefix of the schedule arrays and tile iterator.
+      \param[in] statement_prefix Prefix of the statement macros (as in Schedule).
+      */
+      std::string executorCode( std::string prefix = "", std::string statement_prefix = "" ) const;
+  };
+
+  /*!
+  Collects the loops of a chain and their run-time accesses, and computes
+  full sparse tiled schedules from them.
+  */
+  class SparseTileInspector {
+    public:
+      typedef std::vector<int>::size_type size_type;
+
+    private:
+      std::vector<size_type> loop_iterations;
+      std::vector< std::vector<SparseAccess> > loop_accesses;
+
+    public:
+      SparseTileInspector();
+
+      /*!
+      \brief
+      Append a loop to the chain.
+
+      \param[in] iterations Number of iterations of the loop.
+      \param[in] accesses Accesses of the loop (each defined over all the iterations).
+
+      \returns the id of the loop.
+      */
+      size_type addLoop( size_type iterations, std::vector<SparseAccess> accesses );
+
+      size_type numLoops() const;
+
+      /*!
+      \brief
+      Partition the seed loop into num_tiles contiguous blocks, and grow the tiles
+      through the chain.
+      */
+      SparseTileSchedule inspect( size_type seed_loop, int num_tiles ) const;
+
+      /*!
+      \brief
+      Grow the given partition of the seed loop (tile of each seed iteration,
+      in [0, number of tiles) ) through the chain.
+      Iterations of other loops with no dependences are placed in the tile
+      proportional to their position in their loop.
+      */
+      SparseTileSchedule inspect( size_type seed_loop, std::vector<int> seed_partition ) const;
+
+      /*!
+      \returns true if every dependence between loops in the chain goes from
+      a tile to the same or a later tile of schedule.
+      */
+      bool isLegal( const SparseTileSchedule& schedule ) const;
+  };
+
+}
+
+#endif
@@ -0,0 +1,106 @@
+/*! ****************************************************************************
+\file StorageMapping.hpp
+\authors Ian J. Bertolacci
+
+\brief
+Modulo storage mapping (circular buffers) of a dataspace.
+
+One dimension of the dataspace (typically time) is folded modulo the reuse
+distance of its accesses, so that only that many planes are stored: the
+Jacobi-style update A[t][i] = f( A[t-1][i-1], A[t-1][i], A[t-1][i+1] ) only
+needs A[t%2][i]. The folding can be verified against a Schedule: it is legal
+if every read still gets its value from the same write once the storage is
+folded.
+
+Values of the dataspace that are used after the chain only exist for the
+last modulus planes.
+
+\copyright
+Copyright 2017 Universiy of Arizona
+*******************************************************************************/
+
+#ifndef STORAGE_MAPPING_HPP
+#define STORAGE_MAPPING_HPP
+
+#include <LoopChainIR/LoopChain.hpp>
+#include <LoopChainIR/Schedule.hpp>
+#include <LoopChainIR/Accesses.hpp>
+#include <string>
+#include <vector>
+
+namespace LoopChainIR {
+
+  class StorageMapping {
+    private:
+      std::string dataspace;
+      Tuple::size_type dataspace_dimensions;
+      Tuple::size_type fold_dimension;
+      int modulus;
+
+    public:
+      /*!
+      \brief
+      Fold dimension of dataspace modulo the reuse distance of its accesses in
+      chain (see reuseDistance).
+      */
+      StorageMapping( const LoopChain& chain, std::string dataspace, Tuple::size_type dimension );
+
+      /*!
+      \brief
+      Fold dimension of dataspace modulo the reuse distance of its accesses in
+      the chain of schedule, as given before any transformation.
+      */
+      StorageMapping( const Schedule& schedule, std::string dataspace, Tuple::size_type dimension );
+
+      /*!
+      \brief
+      Fold dimension of dataspace modulo an explicit modulus (e.g. to request
+      a larger ring of planes).
+      */
+      StorageMapping( const LoopChain& chain, std::string dataspace, Tuple::size_type dimension, int modulus );
+
+      /*!
+      \brief
+      Largest distance, along dimension, from a write of an element to a read
+      of it, over the (translation) accesses of dataspace in chain.
+      Throws an assert_exception if dataspace has non-translation accesses.
+
+      \returns the distance plus one: the number of planes that are live at once.
+      */
+      static int reuseDistance( const LoopChain& chain, const std::string& dataspace, Tuple::size_type dimension );
+
+      /*! \returns the reuse distance in the chain of schedule, as given before any transformation. */
+      static int reuseDistance( const Schedule& schedule, const std::string& dataspace, Tuple::size_type dimension );
+
+      const std::string& getDataspace() const;
+      Tuple::size_type getDimension() const;
+      int getModulus() const;
+
+      /*!
+      \returns the folding as an ISL map string,
+      e.g. "{ A[a_0,a_1] -> A[a_0 mod 2,a_1] }"
+      */
+      std::string getMap() const;
+
+      /*!
+      \brief
+      Subscript of the folded storage for the given index expressions,
+      e.g. {"t", "i"} gives "[((t)%2+2)%2][i]".
+      */
+      std::string indexExpression( const std::vector<std::string>& indices ) const;
+
+      /*!
+      \brief
+      Check the folding against the order of schedule: every read of the
+      dataspace must be reached by the same write with and without folding.
+      The accesses are those of the chain given to schedule, since
+      transformations rewrite the accesses of its chain.
+
+      \returns true if the folding is legal under schedule.
+      */
+      bool verify( const Schedule& schedule ) const;
+  };
+
+}
+
+#endif
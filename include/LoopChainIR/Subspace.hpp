@@ -45,6 +45,7 @@ namespace LoopChainIR {
   /* \brief Encapsulates contiguous string of iterators used to form an iteration space.*/
   class Subspace {
     public:
+        /*! \brief Iterator names, built once when the Subspace is constructed. */
         typedef std::vector<std::string> Container;
         typedef SubspaceIterator iterator;
         typedef ConstSubspaceIterator const_iterator;
@@ -59,12 +60,16 @@ namespace LoopChainIR {
         const size_type const_index;
 
     protected:
-      Container variable_iterators;
-      std::string constant_iterator;
+      // Variable iterators followed by the constant iterator.
       Container all_iterators;
+      // Aliased version of each of all_iterators.
+      Container alias_iterators;
       timestamp_t stage;
       bool is_currently_aliased;
 
+      friend class SubspaceIterator;
+      friend class ConstSubspaceIterator;
+
     public:
       Subspace( std::string var_iter_prefix, count_type var_iter_count );
       Subspace( std::string prefix, count_type count, Subspace& that );
@@ -100,23 +105,26 @@ namespace LoopChainIR {
       /*! \brief Returns a string of the iterators at or before the specified stage, with option to use aliases. */
       std::string get_iterators( timestamp_t stage, bool use_aliases ) const;
 
+      /*! \brief Appends the iterators at or before the specified stage to iterators, comma separated, with option to use aliases. */
+      void append_iterators( timestamp_t stage, bool use_aliases, std::string& iterators ) const;
+
       /*! \brief Returns the index'th iterator, with option to use aliases. */
-      std::string get( size_type index, bool use_aliases ) const;
+      const std::string& get( size_type index, bool use_aliases ) const;
 
       /*! \brief Returns the index'th iterator, respecting alias state. */
-      std::string operator[]( size_type index ) const;
+      const std::string& operator[]( size_type index ) const;
       /*! \brief Returns true if the subspaces have the same iterators. Aliasing and stage not considered. */
-      bool operator==( const Subspace that ) const;
+      bool operator==( const Subspace& that ) const;
       /*! \brief Returns true if the subspaces do not have the same iterators. Aliasing and stage not considered. */
-      bool operator!=( const Subspace that ) const;
+      bool operator!=( const Subspace& that ) const;
 
       /*! \brief Assign the Subsapce a stage. */
       void set_stage( timestamp_t stage );
   };
 
-  class SubspaceIterator : std::iterator<std::forward_iterator_tag, Subspace::Container::value_type> {
+  class SubspaceIterator : std::iterator<std::forward_iterator_tag, std::string> {
     public:
-      typedef Subspace::Container::value_type value_type;
+      typedef std::string value_type;
       typedef Subspace::Container::iterator base_iterator;
 
     private:
@@ -126,17 +134,17 @@ namespace LoopChainIR {
 
     public:
       SubspaceIterator( const Subspace* subspace, base_iterator iter, bool use_aliases );
-      bool operator==( const SubspaceIterator that ) const;
-      bool operator!=( const SubspaceIterator that ) const;
-      value_type operator*();
+      bool operator==( const SubspaceIterator& that ) const;
+      bool operator!=( const SubspaceIterator& that ) const;
+      const value_type& operator*();
       SubspaceIterator& operator++();
       SubspaceIterator& operator++( int );
       base_iterator get_iterator();
   };
 
-  class ConstSubspaceIterator : std::iterator<std::forward_iterator_tag, Subspace::Container::value_type> {
+  class ConstSubspaceIterator : std::iterator<std::forward_iterator_tag, std::string> {
     public:
-      typedef Subspace::Container::value_type value_type;
+      typedef std::string value_type;
       typedef Subspace::Container::const_iterator base_iterator;
 
     private:
@@ -146,9 +154,9 @@ namespace LoopChainIR {
 
     public:
       ConstSubspaceIterator( const Subspace* subspace, base_iterator iter, bool use_aliases );
-      bool operator==( const ConstSubspaceIterator that ) const;
-      bool operator!=( const ConstSubspaceIterator that ) const;
-      value_type operator*();
+      bool operator==( const ConstSubspaceIterator& that ) const;
+      bool operator!=( const ConstSubspaceIterator& that ) const;
+      const value_type& operator*();
       ConstSubspaceIterator& operator++();
       ConstSubspaceIterator& operator++( int );
       base_iterator get_iterator();
@@ -0,0 +1,104 @@
+/*! ****************************************************************************
+\file TaskAnnotation.hpp
+\authors Ian J. Bertolacci
+
+\brief
+Execute each tile of a tiling as an OpenMP task, ordered by depend clauses
+instead of the barriers of a wavefront.
+
+Applied over the tiles of a TileTransformation, the outermost tile loop is run
+by a single thread of a parallel region, and the point loops of each tile are
+made into a task. Each task has a depend(out) on its own tile's element of a
+dependence array, and a depend(in) on the elements of the tiles it depends on,
+so a tile starts as soon as its predecessors have finished.
+
+The generated code expects the dependence array (by default tile_deps) to be
+declared with (number of tiles + 2) elements in each tiled dimension, counting
+the tiles from the least value of the tile loop over the schedule; tile t uses
+element t - least + 1, which keeps the neighbouring tiles of boundary tiles in
+bounds.
+
+\copyright
+Copyright 2017 Universiy of Arizona
+*******************************************************************************/
+
+#ifndef TASK_ANNOTATION_HPP
+#define TASK_ANNOTATION_HPP
+
+#include <LoopChainIR/Transformation.hpp>
+#include <LoopChainIR/Schedule.hpp>
+#include <LoopChainIR/Subspace.hpp>
+#include <LoopChainIR/LoopChain.hpp>
+
+#include <string>
+#include <vector>
+#include <set>
+
+namespace LoopChainIR {
+
+  class TaskAnnotation : public Transformation {
+    public:
+      typedef std::vector<int> TileOffset;
+
+    private:
+      std::vector<LoopChain::size_type> loops;
+      std::string dependence_array;
+
+    public:
+      /*!
+      \param[in] loop Id of the tiled loop.
+      \param[in] dependence_array Name of the array used in the depend clauses.
+      */
+      TaskAnnotation( LoopChain::size_type loop, std::string dependence_array = "tile_deps" );
+
+      /*!
+      \param[in] loops Ids of the (fused) loops executed in each tile.
+      \param[in] dependence_array Name of the array used in the depend clauses.
+      */
+      TaskAnnotation( std::vector<LoopChain::size_type> loops, std::string dependence_array = "tile_deps" );
+
+      const std::string& getDependenceArray() const;
+
+      /*!
+      \brief
+      Offsets to the tiles each tile depends on, from the flow, anti and output
+      dependences between the accesses of loops over the first tile_dimensions
+      dimensions. Tile t depends on tile t - offset.
+      Affine accesses must be at constant distances in the tiled dimensions
+      (see AffineAccess::dependenceDistance); otherwise an assert_exception is
+      thrown, as the tiles an access reaches are unknown.
+      Assumes tiles are at least as large as the dependence distances, and that
+      the tiling is legal (every offset is lexicographically positive).
+      */
+      static std::set<TileOffset> tileDependences( const LoopChain& chain, const std::vector<LoopChain::size_type>& loops, Subspace::size_type tile_dimensions );
+
+      /*!
+      \returns the pragma text of the task of a tile with the given offsets,
+      with $n standing for the n-th tile iterator out from the point loop.
+      */
+      std::string taskPragma( const std::set<TileOffset>& offsets, Subspace::size_type tile_dimensions ) const;
+
+      /*!
+      \brief
+      Generate ISCC code for a transformation, and append it to the transformation
+      list of schedule (modifies schedule).
+
+      \returns
+      The ISCC code as a string
+      */
+      std::vector<std::string> apply( Schedule& schedule );
+
+      /*!
+      \brief
+      Generate ISCC code for a transformation, and append it to the transformation
+      list of schedule (modifies schedule) given the tile subspace.
+
+      \returns
+      The ISCC code as a string
+      */
+      std::vector<std::string> apply( Schedule& schedule, Subspace* subspace );
+  };
+
+}
+
+#endif
@@ -0,0 +1,181 @@
+/*! ****************************************************************************
+\file TileRuntime.hpp
+\authors Ian J. Bertolacci
+
+\brief
+A small dependence-driven runtime for executing the tiles of tiled (and fused)
+loop chains without the OpenMP runtime.
+
+Generated (see TileRuntimeAnnotation) or hand written code registers each tile
+and its successor edges in a TileGraph, and hands the graph and the tile body
+to a TileRuntime. Each
+tile has a counter of its unfinished predecessors; the worker finishing the
+last predecessor of a tile pushes that tile onto its own work-stealing deque,
+so a tile usually runs on the core that just produced its inputs. Idle workers
+steal the oldest tile of another worker's deque, trying the nearest workers
+first.
+
+\copyright
+Copyright 2017 Universiy of Arizona
+*******************************************************************************/
+
+#ifndef TILE_RUNTIME_HPP
+#define TILE_RUNTIME_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace LoopChainIR {
+
+  /*!
+  Chase-Lev work-stealing deque of tile ids.
+  The owning worker pushes and pops at the bottom; any other worker steals
+  from the top. The capacity is fixed, as each tile is pushed at most once
+  per run.
+  */
+  class WorkStealingDeque {
+    public:
+      typedef std::size_t size_type;
+
+    private:
+      std::vector< std::atomic<size_type> > buffer;
+      size_type mask;
+      std::atomic<long> top;
+      std::atomic<long> bottom;
+
+    public:
+      /*! \param[in] capacity Most tiles held at once (rounded up to a power of two). */
+      explicit WorkStealingDeque( size_type capacity );
+
+      WorkStealingDeque( const WorkStealingDeque& ) = delete;
+      WorkStealingDeque& operator=( const WorkStealingDeque& ) = delete;
+
+      size_type capacity() const;
+
+      /*! \brief Empty the deque. Only safe while no other worker is using it. */
+      void clear();
+
+      /*! \brief Push tile onto the bottom. Owner only. */
+      void push( size_type tile );
+
+      /*! \brief Pop the newest tile into tile. Owner only. \returns false if empty. */
+      bool pop( size_type& tile );
+
+      /*!
+      \brief Steal the oldest tile into tile. Any worker.
+      \returns false if empty, or if another worker took the tile first.
+      */
+      bool steal( size_type& tile );
+  };
+
+  /*!
+  Tiles and the edges from each tile to the tiles that depend on it.
+  */
+  class TileGraph {
+    public:
+      typedef std::size_t size_type;
+      // Same as TaskAnnotation::TileOffset
+      typedef std::vector<int> TileOffset;
+
+    private:
+      std::vector< std::vector<size_type> > successor_lists;
+      std::vector<size_type> predecessor_counts;
+      // Number of tiles in each dimension, for graphs made by grid()
+      std::vector<size_type> extents;
+
+    public:
+      TileGraph();
+      explicit TileGraph( size_type tiles );
+
+      /*! \returns the id of a new tile. */
+      size_type addTile();
+
+      /*! \brief Tile to may not start before tile from has finished. */
+      void addEdge( size_type from, size_type to );
+
+      size_type size() const;
+      const std::vector<size_type>& successors( size_type tile ) const;
+      size_type predecessors( size_type tile ) const;
+
+      /*! \returns true if no tile (transitively) depends on itself. */
+      bool acyclic() const;
+
+      /*!
+      \brief
+      Graph of a rectangular grid of tiles, numbered in lexicographic
+      (row-major) order, where tile t depends on tile t - offset for every
+      offset (e.g. from TaskAnnotation::tileDependences) that stays in the grid.
+
+      \param[in] tiles Number of tiles in each dimension.
+      */
+      static TileGraph grid( const std::vector<size_type>& tiles, const std::set<TileOffset>& offsets );
+
+      /*! \returns the grid coordinate of tile, for graphs made by grid(). */
+      std::vector<size_type> coordinate( size_type tile ) const;
+  };
+
+  /*!
+  Pool of workers executing TileGraphs.
+  */
+  class TileRuntime {
+    public:
+      typedef TileGraph::size_type size_type;
+      typedef std::function<void( size_type )> TileBody;
+
+    private:
+      std::vector< std::unique_ptr<WorkStealingDeque> > deques;
+      std::vector<std::thread> threads;
+
+      // Start and end of runs
+      std::mutex mutex;
+      std::condition_variable start_condition;
+      std::condition_variable done_condition;
+      size_type generation;
+      size_type finished_workers;
+      bool stopping;
+
+      // State of the current run
+      const TileGraph* graph;
+      const TileBody* body;
+      std::unique_ptr< std::atomic<size_type>[] > pending_predecessors;
+      std::atomic<size_type> remaining;
+      std::atomic<bool> aborted;
+      std::exception_ptr failure;
+      std::atomic<size_type> steal_count;
+
+      void serve( size_type worker );
+      void work( size_type worker );
+
+    public:
+      /*! \param[in] workers Number of workers, including the thread calling run(). */
+      explicit TileRuntime( size_type workers = std::thread::hardware_concurrency() );
+      ~TileRuntime();
+
+      TileRuntime( const TileRuntime& ) = delete;
+      TileRuntime& operator=( const TileRuntime& ) = delete;
+
+      size_type workers() const;
+
+      /*!
+      \brief
+      Call body on every tile of graph, each after all of its predecessors
+      have returned. Returns once all tiles have run. If body throws, the
+      remaining tiles are abandoned and the first exception is rethrown.
+      */
+      void run( const TileGraph& graph, const TileBody& body );
+
+      /*! \returns the number of tiles stolen during the last run. */
+      size_type steals() const;
+  };
+
+}
+
+#endif
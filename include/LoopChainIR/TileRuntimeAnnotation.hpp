@@ -0,0 +1,80 @@
+/*! ****************************************************************************
+\file TileRuntimeAnnotation.hpp
+\authors Ian J. Bertolacci
+
+\brief
+Execute the tiles of a tiling with a TileRuntime instead of OpenMP.
+
+Applied over the tiles of a TileTransformation, the generated code first runs
+the tile loops to register each tile in a LoopChainIR::TileGraph, adds an edge
+to every tile from each tile it depends on (TaskAnnotation::tileDependences),
+and then calls run on the runtime with the graph and a tile body. The body
+runs the point loops of the tile it is called with. Tilings whose edges
+tileDependences cannot derive (affine accesses at distances that are not
+constant) are rejected rather than run with missing edges.
+
+The generated code is C++: it expects LoopChainIR/TileRuntime.hpp, <map> and
+<vector> to be included, and a TileRuntime (by default tile_runtime) to be in
+scope.
+
+\copyright
+Copyright 2017 Universiy of Arizona
+*******************************************************************************/
+
+#ifndef TILE_RUNTIME_ANNOTATION_HPP
+#define TILE_RUNTIME_ANNOTATION_HPP
+
+#include <LoopChainIR/Transformation.hpp>
+#include <LoopChainIR/Schedule.hpp>
+#include <LoopChainIR/Subspace.hpp>
+#include <LoopChainIR/LoopChain.hpp>
+
+#include <string>
+#include <vector>
+
+namespace LoopChainIR {
+
+  class TileRuntimeAnnotation : public Transformation {
+    private:
+      std::vector<LoopChain::size_type> loops;
+      std::string runtime;
+
+    public:
+      /*!
+      \param[in] loop Id of the tiled loop.
+      \param[in] runtime Name of the TileRuntime in the generated code.
+      */
+      TileRuntimeAnnotation( LoopChain::size_type loop, std::string runtime = "tile_runtime" );
+
+      /*!
+      \param[in] loops Ids of the (fused) loops executed in each tile.
+      \param[in] runtime Name of the TileRuntime in the generated code.
+      */
+      TileRuntimeAnnotation( std::vector<LoopChain::size_type> loops, std::string runtime = "tile_runtime" );
+
+      const std::string& getRuntime() const;
+
+      /*!
+      \brief
+      Generate ISCC code for a transformation, and append it to the transformation
+      list of schedule (modifies schedule).
+
+      \returns
+      The ISCC code as a string
+      */
+      std::vector<std::string> apply( Schedule& schedule );
+
+      /*!
+      \brief
+      Generate ISCC code for a transformation, and append it to the transformation
+      list of schedule (modifies schedule) given the tile subspace.
+
+      \returns
+      The ISCC code as a string
+      */
+      std::vector<std::string> apply( Schedule& schedule, Subspace* subspace );
+  };
+
+}
+
+#endif
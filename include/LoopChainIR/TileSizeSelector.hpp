@@ -0,0 +1,85 @@
+/*! ****************************************************************************
+\file TileSizeSelector.hpp
+\authors Ian J. Bertolacci
+
+\brief
+Analytical cache model for picking the tile sizes of a loop nest.
+
+The working set of a tile is estimated by a FootprintEstimator from the
+reads and writes of the nest's dataspaces. The selector grows the tile, keeping
+it roughly square and the innermost dimension a multiple of the SIMD width,
+for as long as the working set fits the target cache.
+
+\copyright
+Copyright 2017 Universiy of Arizona
+*******************************************************************************/
+
+#ifndef TILE_SIZE_SELECTOR_HPP
+#define TILE_SIZE_SELECTOR_HPP
+
+#include <LoopChainIR/LoopChain.hpp>
+#include <LoopChainIR/TileTransformation.hpp>
+#include <LoopChainIR/FootprintEstimator.hpp>
+#include <string>
+#include <vector>
+
+namespace LoopChainIR {
+
+  class TileSizeSelector {
+    public:
+      typedef RectangularDomain::size_type size_type;
+      typedef FootprintEstimator::TileSizes TileSizes;
+
+    private:
+      FootprintEstimator estimator;
+      LoopChain::size_type loop;
+      size_type dimensions;
+      size_type simd_width;
+      // Trip count of each dimension, or 0 where it is not a constant.
+      std::vector<size_type> extents;
+
+      /*!
+      Double the smallest dimension of tile that still fits, while the
+      footprint stays within cache_bytes.
+      */
+      TileSizes grow( TileSizes tile, size_type cache_bytes ) const;
+
+    public:
+      /*!
+      \param[in] chain Loop chain containing the nest.
+      \param[in] loop Id of the nest being tiled.
+      \param[in] element_size Size, in bytes, of the elements of every dataspace.
+      \param[in] simd_width Number of elements in a SIMD vector; the innermost
+                            tile size is always a multiple of it.
+      */
+      TileSizeSelector( const LoopChain& chain, LoopChain::size_type loop, size_type element_size = sizeof(double), size_type simd_width = 4 );
+
+      /*!
+      \returns the number of bytes of all dataspaces touched by one tile of
+      the given sizes.
+      */
+      size_type footprint( const TileSizes& tile ) const;
+
+      /*!
+      \brief
+      Select the largest tile whose footprint fits in cache_bytes.
+      If even a single SIMD vector of iterations does not fit, that minimal
+      tile is returned.
+      */
+      TileSizes select( size_type cache_bytes ) const;
+
+      /*!
+      \brief
+      Select one tile per cache level (e.g. { L1, L2 } sizes in bytes, from
+      the innermost level out). The tile for each level is a multiple of the
+      tile of the level before it (or covers the whole loop), so the levels nest.
+      */
+      std::vector<TileSizes> select( const std::vector<size_type>& cache_bytes ) const;
+
+      /*! \returns tile as sizes of a TileTransformation for the nest. */
+      static TileTransformation::TileMap tileMap( const TileSizes& tile );
+  };
+
+}
+
+#endif
@@ -42,6 +42,7 @@ namespace LoopChainIR {
     mapped_type uniform_size;
     std::vector<Transformation*> over_tiles;
     std::vector<Transformation*> within_tiles;
+    bool separate_full_tiles;
     static int num_prefixes_used;
 
   public:
@@ -61,8 +62,9 @@ namespace LoopChainIR {
 
     \param[in] loop Id of loop to transform;
     \param[in] tile_size Size of tiles for loop, for all dimensions of tile.
+    \param[in] separate_full_tiles Generate full tiles (constant trip counts) separately from partial tiles.
     */
-    TileTransformation( LoopChain::size_type loop, TileMap tile_sizes );
+    TileTransformation( LoopChain::size_type loop, TileMap tile_sizes, bool separate_full_tiles = false );
 
     /*!
     \brief
@@ -70,12 +72,15 @@ namespace LoopChainIR {
 
     \param[in] loop Id of loop to transform;
     \param[in] tile_size Size of tiles for loop, for all dimensions of tile.
+    \param[in] over_tiles Transformation applied to the tile subspace.
+    \param[in] within_tiles Transformation applied to the tiled subspace.
+    \param[in] separate_full_tiles Generate full tiles (constant trip counts) separately from partial tiles.
     */
-    TileTransformation( LoopChain::size_type loop, TileMap tile_sizes, Transformation* over_tiles, Transformation* within_tiles );
+    TileTransformation( LoopChain::size_type loop, TileMap tile_sizes, Transformation* over_tiles, Transformation* within_tiles, bool separate_full_tiles = false );
 
-    TileTransformation( LoopChain::size_type loop, TileMap tile_sizes, std::vector<Transformation*> over_tiles, std::vector<Transformation*> within_tiles );
+    TileTransformation( LoopChain::size_type loop, TileMap tile_sizes, std::vector<Transformation*> over_tiles, std::vector<Transformation*> within_tiles, bool separate_full_tiles = false );
 
-    TileTransformation( LoopChain::size_type loop, TileMap tile_sizes, std::initializer_list<Transformation*> over_tiles, std::initializer_list<Transformation*> within_tiles );
+    TileTransformation( LoopChain::size_type loop, TileMap tile_sizes, std::initializer_list<Transformation*> over_tiles, std::initializer_list<Transformation*> within_tiles, bool separate_full_tiles = false );
 
 
 
@@ -101,6 +106,15 @@ namespace LoopChainIR {
 
     LoopChain::size_type getLoopId();
 
+    /*!
+    \brief
+    Return true if full tiles are generated separately from partial (boundary) tiles.
+    Full tiles are scheduled with the tile subspace's constant iterator set to 0,
+    partial tiles with it set to 1, so the full tile's point loops have constant
+    trip counts equal to the tile size and no min/max bounds.
+    */
+    bool separatesFullTiles();
+
     /*!
     \brief
     Generate ISCC code for the shift transformation, and append it to the
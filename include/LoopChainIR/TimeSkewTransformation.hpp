@@ -0,0 +1,83 @@
+/*! ****************************************************************************
+\file TimeSkewTransformation.hpp
+\authors Ian J. Bertolacci
+
+\brief
+Temporal blocking of a loop chain with a time domain by skewing and tiling.
+
+\copyright
+Copyright 2017 Universiy of Arizona
+*******************************************************************************/
+
+#ifndef TIME_SKEW_TRANSFORMATION_HPP
+#define TIME_SKEW_TRANSFORMATION_HPP
+
+#include <LoopChainIR/Transformation.hpp>
+#include <LoopChainIR/Schedule.hpp>
+#include <LoopChainIR/Subspace.hpp>
+#include <LoopChainIR/LoopChain.hpp>
+
+#include <string>
+#include <vector>
+
+namespace LoopChainIR {
+
+  class TimeSkewTransformation : public Transformation {
+    public:
+      typedef RectangularDomain::size_type size_type;
+
+    private:
+      int time_tile;
+      std::vector<int> space_tiles;
+      bool fuse;
+
+    public:
+      /*!
+      \param[in] time_tile Time steps per tile.
+      \param[in] space_tiles Iterations per tile of each of the nests' outermost dimensions.
+      \param[in] fuse Fuse the nests within each time step.
+
+      Must be the first transformation applied to the schedule.
+      */
+      TimeSkewTransformation( int time_tile, std::vector<int> space_tiles, bool fuse = false );
+
+      int getTimeTile() const;
+      const std::vector<int>& getSpaceTiles() const;
+      bool fusesNests() const;
+
+      /*!
+      \brief
+      Shift of each nest along its first dimensions so that dependences within a time step point forward.
+      */
+      static std::vector< std::vector<int> > nestShifts( const LoopChain& chain, size_type dimensions );
+
+      /*!
+      \brief
+      Smallest skew of each dimension that makes dependences from one time step to the next point forward.
+      */
+      static std::vector<int> skewFactors( const LoopChain& chain, const std::vector< std::vector<int> >& shifts );
+
+      /*!
+      \brief
+      Generate ISCC code for a transformation, and append it to the transformation
+      list of schedule (modifies schedule).
+
+      \returns
+      The ISCC code as a string
+      */
+      std::vector<std::string> apply( Schedule& schedule );
+
+      /*!
+      \brief
+      Generate ISCC code for a transformation, and append it to the transformation
+      list of schedule (modifies schedule) given the nest subspace.
+
+      \returns
+      The ISCC code as a string
+      */
+      std::vector<std::string> apply( Schedule& schedule, Subspace* subspace );
+  };
+
+}
+
+#endif
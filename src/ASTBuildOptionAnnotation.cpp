@@ -0,0 +1,48 @@
+/*! ****************************************************************************
+\file ASTBuildOptionAnnotation.cpp
+\authors Ian J. Bertolacci
+
+\brief
+Annotate loops of a Subspace with the option ISL uses to build their AST.
+
+\copyright
+Copyright 2017 Universiy of Arizona
+*******************************************************************************/
+
+#include <LoopChainIR/ASTBuildOptionAnnotation.hpp>
+#include <LoopChainIR/util.hpp>
+
+using namespace LoopChainIR;
+using namespace std;
+
+ASTBuildOptionAnnotation::ASTBuildOptionAnnotation( ASTBuildOption option )
+: ASTBuildOptionAnnotation( option, std::vector<Subspace::size_type>() )
+{ }
+
+ASTBuildOptionAnnotation::ASTBuildOptionAnnotation( ASTBuildOption option, std::vector<Subspace::size_type> dimensions )
+: option( option ), dimensions( dimensions )
+{ }
+
+std::vector<std::string> ASTBuildOptionAnnotation::apply( Schedule& schedule ){
+  return this->apply( schedule, *(std::next(schedule.getSubspaceManager().get_iterator_to_loops())) );
+}
+
+std::vector<std::string> ASTBuildOptionAnnotation::apply( Schedule& schedule, Subspace* subspace ){
+  // No listed dimensions means every loop of the subspace
+  if( this->dimensions.empty() ){
+    for( Subspace::size_type dimension = 0; dimension < subspace->size(); dimension += 1 ){
+      schedule.addASTBuildOption( subspace, dimension, this->option );
+    }
+  } else {
+    for( Subspace::size_type dimension : this->dimensions ){
+      assertWithException( dimension < subspace->size(),
+                           SSTR( "Cannot annotate dimension " << dimension
+                              << " of a subspace with " << subspace->size()
+                              << " dimensions." )
+                         );
+      schedule.addASTBuildOption( subspace, dimension, this->option );
+    }
+  }
+
+  return std::vector<std::string>();
+}
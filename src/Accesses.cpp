@@ -11,6 +11,8 @@ Copyright 2017 Universiy of Arizona
 *******************************************************************************/
 
 #include <limits>
+#include <algorithm>
+#include <utility>
 #include <sstream>
 
 #include <LoopChainIR/Accesses.hpp>
@@ -19,36 +21,91 @@ Copyright 2017 Universiy of Arizona
 using namespace std;
 using namespace LoopChainIR;
 
+const Tuple::size_type Tuple::inline_capacity;
+
+Tuple::Tuple( Tuple::size_type dimensions )
+: dimensions_var( dimensions ), overflow_values()
+{
+  if( dimensions > inline_capacity ){
+    this->overflow_values.assign( dimensions, 0 );
+  } else {
+    fill( this->inline_values, this->inline_values + dimensions, 0 );
+  }
+}
+
 Tuple::Tuple( vector<int> values )
-: tuple( values.begin(), values.end() )
-{ }
+: Tuple( values.size() )
+{
+  copy( values.begin(), values.end(), this->data() );
+}
 
 Tuple::Tuple( vector<string> values )
-: tuple()
+: Tuple( values.size() )
 {
+  int* element = this->data();
   for( string value : values ){
-    this->tuple.push_back( stoi( value ) );
+    *element++ = stoi( value );
   }
 }
 
 Tuple::Tuple( std::initializer_list<int> values )
-: Tuple( vector<int>( values ) )
-{ }
+: Tuple( values.size() )
+{
+  copy( values.begin(), values.end(), this->data() );
+}
 
 Tuple::Tuple( std::initializer_list<std::string> values )
 : Tuple( vector<string>( values ) )
 { }
 
 Tuple::Tuple( const Tuple& that )
-: Tuple( that.tuple )
-{ }
+: dimensions_var( that.dimensions_var ), overflow_values( that.overflow_values )
+{
+  if( that.dimensions_var <= inline_capacity ){
+    copy( that.inline_values, that.inline_values + that.dimensions_var, this->inline_values );
+  }
+}
+
+Tuple::Tuple( Tuple&& that )
+: dimensions_var( that.dimensions_var ), overflow_values( std::move( that.overflow_values ) )
+{
+  if( that.dimensions_var <= inline_capacity ){
+    copy( that.inline_values, that.inline_values + that.dimensions_var, this->inline_values );
+  }
+}
+
+Tuple& Tuple::operator=( const Tuple& that ){
+  this->dimensions_var = that.dimensions_var;
+  this->overflow_values = that.overflow_values;
+  if( that.dimensions_var <= inline_capacity ){
+    copy( that.inline_values, that.inline_values + that.dimensions_var, this->inline_values );
+  }
+  return *this;
+}
+
+Tuple& Tuple::operator=( Tuple&& that ){
+  this->dimensions_var = that.dimensions_var;
+  this->overflow_values = std::move( that.overflow_values );
+  if( that.dimensions_var <= inline_capacity ){
+    copy( that.inline_values, that.inline_values + that.dimensions_var, this->inline_values );
+  }
+  return *this;
+}
 
 Tuple Tuple::createMagicEmptyTuple( ){
-  return Tuple( vector<int>() );
+  return Tuple( (size_type) 0 );
+}
+
+int* Tuple::data(){
+  return (this->dimensions_var > inline_capacity)? this->overflow_values.data() : this->inline_values;
+}
+
+const int* Tuple::data() const {
+  return (this->dimensions_var > inline_capacity)? this->overflow_values.data() : this->inline_values;
 }
 
 Tuple::size_type Tuple::dimensions() const {
-  return this->tuple.size();
+  return this->dimensions_var;
 }
 
 bool Tuple::isEmptyTuple() const {
@@ -56,7 +113,7 @@ bool Tuple::isEmptyTuple() const {
 }
 
 bool Tuple::isZeroTuple() const {
-  for( int element : this->tuple ){
+  for( int element : *this ){
     if( element != 0 ){
       return false;
     }
@@ -66,15 +123,23 @@ bool Tuple::isZeroTuple() const {
 }
 
 Tuple::iterator Tuple::begin(){
-  return this->tuple.begin();
+  return this->data();
 }
 
 Tuple::iterator Tuple::end(){
-  return this->tuple.end();
+  return this->data() + this->dimensions_var;
+}
+
+Tuple::const_iterator Tuple::begin() const {
+  return this->data();
+}
+
+Tuple::const_iterator Tuple::end() const {
+  return this->data() + this->dimensions_var;
 }
 
 int Tuple::operator[]( Tuple::size_type index ) const {
-  return this->tuple[index];
+  return this->data()[index];
 }
 
 Tuple Tuple::operator+( const Tuple& that ) const {
@@ -83,12 +148,15 @@ Tuple Tuple::operator+( const Tuple& that ) const {
                              << this->dimensions() << " "
                              << that.dimensions() ) );
 
-  vector<int> result( this->dimensions(), 0 );
+  Tuple result( this->dimensions() );
+  int* result_values = result.data();
+  const int* left = this->data();
+  const int* right = that.data();
   for( size_type i = 0; i < this->dimensions(); ++i ){
-    result[i] = (*this)[i] + that[i];
+    result_values[i] = left[i] + right[i];
   }
 
-  return  Tuple(result);
+  return result;
 }
 
 Tuple Tuple::operator-( const Tuple& that ) const {
@@ -97,22 +165,27 @@ Tuple Tuple::operator-( const Tuple& that ) const {
                              << this->dimensions() << " "
                              << that.dimensions() ) );
 
-  vector<int> result( this->dimensions(), 0 );
+  Tuple result( this->dimensions() );
+  int* result_values = result.data();
+  const int* left = this->data();
+  const int* right = that.data();
   for( size_type i = 0; i < this->dimensions(); ++i ){
-    result[i] = (*this)[i] - that[i];
+    result_values[i] = left[i] - right[i];
   }
 
-  return Tuple(result);
+  return result;
 }
 
 Tuple Tuple::operator-( ) const {
-  vector<int> result( this->dimensions(), 0 );
+  Tuple result( this->dimensions() );
+  int* result_values = result.data();
+  const int* values = this->data();
 
   for( size_type i = 0; i < this->dimensions(); ++i ){
-    result[i] = - (*this)[i];
+    result_values[i] = - values[i];
   }
 
-  return Tuple(result);
+  return result;
 }
 
 bool Tuple::operator<( const Tuple& that ) const {
@@ -122,17 +195,7 @@ bool Tuple::operator<( const Tuple& that ) const {
     return false;
   }
 
-  for( size_type i = 0; i < this->dimensions(); ++i ){
-    if( (*this)[i] == that[i] ){
-      continue;
-    } else if( (*this)[i] < that[i] ){
-      return true;
-    } else {
-      return false;
-    }
-  }
-
-  return false;
+  return lexicographical_compare( this->begin(), this->end(), that.begin(), that.end() );
 }
 
 bool Tuple::operator>( const Tuple& that ) const {
@@ -144,13 +207,7 @@ bool Tuple::operator==( const Tuple& that ) const {
     return false;
   }
 
-  for( size_type i = 0; i < this->dimensions(); ++i ){
-    if( (*this)[i] != that[i] ){
-      return false;
-    }
-  }
-
-  return true;
+  return equal( this->begin(), this->end(), that.begin() );
 }
 
 bool Tuple::operator!=( const Tuple& that ) const {
@@ -161,7 +218,7 @@ std::string Tuple::str() const {
   ostringstream stream;
   stream << "(";
   bool first = true;
-  for( int element : this->tuple ){
+  for( int element : *this ){
     if( !first ){
       stream << ", ";
     } else {
@@ -177,97 +234,215 @@ std::ostream& LoopChainIR::operator<<( std::ostream& os, const Tuple& tuple){
   return (os << tuple.str() );
 }
 
+TupleCollection::const_iterator::const_iterator( const TupleCollection* collection, TupleCollection::size_type position )
+: collection( collection ), position( position )
+{ }
+
+Tuple TupleCollection::const_iterator::operator*() const {
+  Tuple tuple( this->collection->dimensions() );
+  int* values = tuple.data();
+  for( Tuple::size_type d = 0; d < tuple.dimensions(); d += 1 ){
+    values[d] = this->collection->column( d )[ this->position ];
+  }
+  return tuple;
+}
+
+TupleCollection::const_iterator& TupleCollection::const_iterator::operator++(){
+  this->position += 1;
+  return *this;
+}
+
+TupleCollection::const_iterator TupleCollection::const_iterator::operator++( int ){
+  const_iterator previous( *this );
+  this->position += 1;
+  return previous;
+}
+
+bool TupleCollection::const_iterator::operator==( const TupleCollection::const_iterator& that ) const {
+  return this->collection == that.collection && this->position == that.position;
+}
+
+bool TupleCollection::const_iterator::operator!=( const TupleCollection::const_iterator& that ) const {
+  return !( *this == that );
+}
+
 TupleCollection::TupleCollection( Tuple::size_type dimensions )
-: tuples( ), dimensions_var( dimensions )
+: dimensions_var( dimensions ), count( 0 ), values( )
 { }
 
 TupleCollection::TupleCollection( std::set<Tuple> tuples, signed int dimensions )
-: tuples( (tuples.erase( Tuple::createMagicEmptyTuple() ), tuples) ), dimensions_var( (tuples.size() > 0)? tuples.begin()->dimensions() : (Tuple::size_type) dimensions )
+: dimensions_var( (tuples.erase( Tuple::createMagicEmptyTuple() ), tuples.size() > 0)? tuples.begin()->dimensions() : (Tuple::size_type) dimensions ),
+  count( tuples.size() ),
+  values( )
 {
   // assert that if there given an empty collection, a dimensionality was given
-  assertWithException( this->tuples.size() > 0 || (this->tuples.size() == 0 && this->dimensions() > 0),
+  assertWithException( this->count > 0 || (this->count == 0 && this->dimensions() > 0),
                        "Dimensionality must be specified for collection with no initial set." );
 
-  for( Tuple tuple : this->tuples ){
+  // The set is already in lexicographic order.
+  this->values.resize( this->dimensions() * this->count );
+  size_type k = 0;
+  for( const Tuple& tuple : tuples ){
     assertWithException( this->dimensions() == tuple.dimensions(), "Not all tuples are of the same dimensionality" );
+    for( Tuple::size_type d = 0; d < tuple.dimensions(); d += 1 ){
+      this->column( d )[k] = tuple[d];
+    }
+    k += 1;
   }
 }
 
 TupleCollection::TupleCollection( const TupleCollection& that )
-: TupleCollection( that.tuples, that.dimensions_var )
+: dimensions_var( that.dimensions_var ), count( that.count ), values( that.values )
 { }
 
+TupleCollection::TupleCollection( TupleCollection&& that )
+: dimensions_var( that.dimensions_var ), count( that.count ), values( std::move( that.values ) )
+{
+  that.count = 0;
+}
+
 TupleCollection::TupleCollection( const TupleCollection& left, const TupleCollection& right )
-: TupleCollection( []( std::set<Tuple> s_left, std::set<Tuple> s_right ){
-                      std::set<Tuple> tmp( s_left );
-                      tmp.insert( s_right.begin(), s_right.end() );
-                      return tmp;
-                    }( left.tuples, right.tuples ),
-                    left.dimensions() | right.dimensions()
-                  )
-{ }
+: dimensions_var( (left.count > 0 || right.count == 0)? left.dimensions() : right.dimensions() ),
+  count( 0 ),
+  values( )
+{
+  assertWithException( left.count == 0 || right.count == 0 || left.dimensions() == right.dimensions(),
+                       "Not all tuples are of the same dimensionality" );
+
+  // Merge the two sorted collections, dropping duplicates.
+  vector<size_type> from_left;
+  vector<size_type> from_right;
+  // Position in the merged collection of each element taken from left/right
+  vector<size_type> left_positions;
+  vector<size_type> right_positions;
+
+  size_type k = 0, l = 0;
+  while( k < left.count || l < right.count ){
+    int order = (k == left.count)? 1 : (l == right.count)? -1 : compare( left, k, right, l );
+    if( order <= 0 ){
+      from_left.push_back( k );
+      left_positions.push_back( this->count );
+      k += 1;
+      if( order == 0 ){
+        l += 1;
+      }
+    } else {
+      from_right.push_back( l );
+      right_positions.push_back( this->count );
+      l += 1;
+    }
+    this->count += 1;
+  }
+
+  this->values.resize( this->dimensions() * this->count );
+  for( Tuple::size_type d = 0; d < this->dimensions(); d += 1 ){
+    int* destination = this->column( d );
+    if( !from_left.empty() ){
+      const int* source = left.column( d );
+      for( size_type i = 0; i < from_left.size(); i += 1 ){
+        destination[ left_positions[i] ] = source[ from_left[i] ];
+      }
+    }
+    if( !from_right.empty() ){
+      const int* source = right.column( d );
+      for( size_type i = 0; i < from_right.size(); i += 1 ){
+        destination[ right_positions[i] ] = source[ from_right[i] ];
+      }
+    }
+  }
+}
+
+const int* TupleCollection::column( Tuple::size_type dimension ) const {
+  return this->values.data() + dimension * this->count;
+}
+
+int* TupleCollection::column( Tuple::size_type dimension ){
+  return this->values.data() + dimension * this->count;
+}
 
+int TupleCollection::compare( const TupleCollection& left, TupleCollection::size_type k, const TupleCollection& right, TupleCollection::size_type l ){
+  for( Tuple::size_type d = 0; d < left.dimensions(); d += 1 ){
+    int a = left.column( d )[k];
+    int b = right.column( d )[l];
+    if( a != b ){
+      return (a < b)? -1 : 1;
+    }
+  }
+  return 0;
+}
 
 Tuple::size_type TupleCollection::dimensions() const {
   return this->dimensions_var;
 }
 
-TupleCollection::iterator TupleCollection::begin(){
-  return this->tuples.begin();
+TupleCollection::size_type TupleCollection::size() const {
+  return this->count;
+}
+
+TupleCollection::const_iterator TupleCollection::begin() const {
+  return const_iterator( this, 0 );
 }
 
-TupleCollection::iterator TupleCollection::end(){
-  return this->tuples.end();
+TupleCollection::const_iterator TupleCollection::end() const {
+  return const_iterator( this, this->count );
 }
 
 Tuple TupleCollection::maxOnDims() const {
-  if( this->tuples.size() < 1 ){
+  if( this->count < 1 ){
     return Tuple::createMagicEmptyTuple();
   }
 
-  vector<int> max_values( this->dimensions(), numeric_limits<int>::min() );
-
-  for( Tuple tuple : this->tuples ){
-    for( Tuple::size_type d = 0; d < tuple.dimensions(); d += 1 ){
-      max_values[d] = max( max_values[d], tuple[d] );
+  Tuple max_values( this->dimensions() );
+  for( Tuple::size_type d = 0; d < this->dimensions(); d += 1 ){
+    const int* values = this->column( d );
+    int value = numeric_limits<int>::min();
+    for( size_type k = 0; k < this->count; k += 1 ){
+      value = max( value, values[k] );
     }
+    max_values.data()[d] = value;
   }
 
-  return Tuple(max_values);
+  return max_values;
 }
 
 Tuple TupleCollection::minOnDims() const {
-  if( this->tuples.size() < 1 ){
+  if( this->count < 1 ){
     return Tuple::createMagicEmptyTuple();
   }
 
-  vector<int> min_values( this->dimensions(), numeric_limits<int>::max() );
-
-  for( Tuple tuple : this->tuples ){
-    for( Tuple::size_type d = 0; d < tuple.dimensions(); d += 1 ){
-      min_values[d] = min( min_values[d], tuple[d] );
+  Tuple min_values( this->dimensions() );
+  for( Tuple::size_type d = 0; d < this->dimensions(); d += 1 ){
+    const int* values = this->column( d );
+    int value = numeric_limits<int>::max();
+    for( size_type k = 0; k < this->count; k += 1 ){
+      value = min( value, values[k] );
     }
+    min_values.data()[d] = value;
   }
 
-  return Tuple(min_values);
+  return min_values;
 }
 
-void TupleCollection::shiftAll( Tuple& extent ){
+void TupleCollection::shiftAll( const Tuple& extent ){
   assertWithException( extent.dimensions() == this->dimensions(),
                        SSTR( "Shift extent dimensionality (" << extent.dimensions()
                              << ") than collection (" << this->dimensions() << ")" ) );
-  set<Tuple> new_set;
-  for( Tuple tuple : this->tuples ){
-    new_set.insert( tuple + extent );
+  // Adding the same value to every element of a column preserves the
+  // lexicographic order, so the collection stays sorted.
+  for( Tuple::size_type d = 0; d < this->dimensions(); d += 1 ){
+    int* values = this->column( d );
+    const int shift = extent[d];
+    for( size_type k = 0; k < this->count; k += 1 ){
+      values[k] += shift;
+    }
   }
-  this->tuples = new_set;
 }
 
 std::string TupleCollection::str( ) const {
   ostringstream stream;
   stream << "{ ";
   bool first = true;
-  for( Tuple tuple : this->tuples ){
+  for( Tuple tuple : *this ){
     if( !first ){
       stream << ", ";
     } else {
@@ -283,8 +458,286 @@ std::ostream& LoopChainIR::operator<<( std::ostream& os, const TupleCollection&
   return (os << collection.str() );
 }
 
+AffineAccess::AffineAccess( AffineAccess::matrix_type coefficients, Tuple offset )
+: coefficients( coefficients ), offset_tuple( offset )
+{
+  assertWithException( this->coefficients.size() == this->offset_tuple.dimensions(),
+                       SSTR( "Coefficient matrix has " << this->coefficients.size()
+                             << " rows but offset has " << this->offset_tuple.dimensions() << " dimensions" ) );
+  for( vector<int> row : this->coefficients ){
+    assertWithException( row.size() == this->iteratorDimensions(), "Not all rows of the coefficient matrix are the same length" );
+  }
+}
+
+AffineAccess::AffineAccess( const Tuple& offset )
+: coefficients( offset.dimensions(), vector<int>( offset.dimensions(), 0 ) ), offset_tuple( offset )
+{
+  for( size_type d = 0; d < offset.dimensions(); d += 1 ){
+    this->coefficients[d][d] = 1;
+  }
+}
+
+AffineAccess::size_type AffineAccess::dimensions() const {
+  return this->coefficients.size();
+}
+
+AffineAccess::size_type AffineAccess::iteratorDimensions() const {
+  return (this->coefficients.size() > 0)? this->coefficients[0].size() : 0;
+}
+
+int AffineAccess::coefficient( AffineAccess::size_type row, AffineAccess::size_type column ) const {
+  return this->coefficients[row][column];
+}
+
+Tuple AffineAccess::offset() const {
+  return this->offset_tuple;
+}
+
+bool AffineAccess::isTranslation() const {
+  if( this->dimensions() != this->iteratorDimensions() ){
+    return false;
+  }
+
+  for( size_type row = 0; row < this->dimensions(); row += 1 ){
+    for( size_type column = 0; column < this->iteratorDimensions(); column += 1 ){
+      if( this->coefficients[row][column] != ((row == column)? 1 : 0) ){
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+bool AffineAccess::isSeparable() const {
+  vector<int> column_counts( this->iteratorDimensions(), 0 );
+
+  for( size_type row = 0; row < this->dimensions(); row += 1 ){
+    int row_count = 0;
+    for( size_type column = 0; column < this->iteratorDimensions(); column += 1 ){
+      if( this->coefficients[row][column] != 0 ){
+        row_count += 1;
+        column_counts[column] += 1;
+      }
+    }
+    if( row_count > 1 ){
+      return false;
+    }
+  }
+
+  for( int count : column_counts ){
+    if( count > 1 ){
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool AffineAccess::hasSameLinearPart( const AffineAccess& that ) const {
+  return this->coefficients == that.coefficients;
+}
+
+AffineAccess AffineAccess::shifted( const Tuple& extent ) const {
+  assertWithException( extent.dimensions() == this->iteratorDimensions(),
+                       SSTR( "Shift extent dimensionality (" << extent.dimensions()
+                             << ") differs from access iterator dimensionality (" << this->iteratorDimensions() << ")" ) );
+
+  // c + M*extent
+  return this->withOffset( this->evaluate( extent ) );
+}
+
+AffineAccess AffineAccess::withOffset( const Tuple& offset ) const {
+  return AffineAccess( this->coefficients, offset );
+}
+
+Tuple AffineAccess::evaluate( const Tuple& iteration ) const {
+  assertWithException( iteration.dimensions() == this->iteratorDimensions(),
+                       SSTR( "Iteration dimensionality (" << iteration.dimensions()
+                             << ") differs from access iterator dimensionality (" << this->iteratorDimensions() << ")" ) );
+
+  vector<int> index( this->dimensions(), 0 );
+  for( size_type row = 0; row < this->dimensions(); row += 1 ){
+    index[row] = this->offset_tuple[row];
+    for( size_type column = 0; column < this->iteratorDimensions(); column += 1 ){
+      index[row] += this->coefficients[row][column] * iteration[column];
+    }
+  }
+
+  return Tuple( index );
+}
+
+bool AffineAccess::dependenceDistance( const AffineAccess& earlier, Tuple& distance ) const {
+  vector<bool> constant;
+  Tuple values = Tuple::createMagicEmptyTuple();
+  bool dependent = this->dependenceDistance( earlier, values, constant );
+  assertWithException( !dependent || std::find( constant.begin(), constant.end(), false ) == constant.end(),
+                       SSTR( "Cannot compute a constant dependence distance for " << this->str() << ", which does not depend on every iterator" ) );
+  if( dependent ){
+    distance = values;
+  }
+  return dependent;
+}
+
+bool AffineAccess::dependenceDistance( const AffineAccess& earlier, Tuple& distance, std::vector<bool>& constant ) const {
+  assertWithException( this->hasSameLinearPart( earlier ),
+                       SSTR( "Cannot compute a constant dependence distance between " << this->str() << " and " << earlier.str() ) );
+  assertWithException( this->isSeparable(),
+                       SSTR( "Cannot compute a constant dependence distance for non-separable access " << this->str() ) );
+
+  vector<int> values( this->iteratorDimensions(), 0 );
+  constant.assign( this->iteratorDimensions(), false );
+
+  for( size_type row = 0; row < this->dimensions(); row += 1 ){
+    int difference = this->offset_tuple[row] - earlier.offset_tuple[row];
+
+    size_type column = 0;
+    while( column < this->iteratorDimensions() && this->coefficients[row][column] == 0 ){
+      column += 1;
+    }
+
+    // Broadcast dimension: only the same constant index conflicts.
+    if( column == this->iteratorDimensions() ){
+      if( difference != 0 ){
+        return false;
+      }
+      continue;
+    }
+
+    int coefficient = this->coefficients[row][column];
+    // No integer iteration touches the same element.
+    if( difference % coefficient != 0 ){
+      return false;
+    }
+
+    values[column] = difference / coefficient;
+    constant[column] = true;
+  }
+
+  distance = Tuple( values );
+  return true;
+}
+
+bool AffineAccess::isComparable( const AffineAccess& that ) const {
+  return this->hasSameLinearPart( that ) && this->isSeparable();
+}
+
+bool AffineAccess::operator<( const AffineAccess& that ) const {
+  if( this->coefficients != that.coefficients ){
+    return this->coefficients < that.coefficients;
+  }
+  return this->offset_tuple < that.offset_tuple;
+}
+
+bool AffineAccess::operator==( const AffineAccess& that ) const {
+  return this->coefficients == that.coefficients && this->offset_tuple == that.offset_tuple;
+}
+
+bool AffineAccess::operator!=( const AffineAccess& that ) const {
+  return !( this->operator==( that ) );
+}
+
+std::string AffineAccess::str() const {
+  ostringstream stream;
+  stream << "[";
+  for( size_type row = 0; row < this->dimensions(); row += 1 ){
+    if( row > 0 ){
+      stream << ", ";
+    }
+
+    bool empty = true;
+    for( size_type column = 0; column < this->iteratorDimensions(); column += 1 ){
+      int coefficient = this->coefficients[row][column];
+      if( coefficient == 0 ){
+        continue;
+      }
+      stream << ((!empty && coefficient > 0)? "+" : "");
+      if( coefficient == -1 ){
+        stream << "-";
+      } else if( coefficient != 1 ){
+        stream << coefficient << "*";
+      }
+      stream << "i_" << column;
+      empty = false;
+    }
+
+    int offset = this->offset_tuple[row];
+    if( empty ){
+      stream << offset;
+    } else if( offset != 0 ){
+      stream << ((offset > 0)? "+" : "") << offset;
+    }
+  }
+  stream << "]";
+  return stream.str();
+}
+
+std::ostream& LoopChainIR::operator<<( std::ostream& os, const AffineAccess& access ){
+  return (os << access.str() );
+}
+
+namespace {
+  // Translation accesses are stored in the tuple collections.
+  set<Tuple> translationOffsets( set<Tuple> tuples, const set<AffineAccess>& accesses ){
+    for( AffineAccess access : accesses ){
+      if( access.isTranslation() ){
+        tuples.insert( access.offset() );
+      }
+    }
+    return tuples;
+  }
+
+  set<AffineAccess> nonTranslations( const set<AffineAccess>& accesses ){
+    set<AffineAccess> result;
+    for( AffineAccess access : accesses ){
+      if( !access.isTranslation() ){
+        result.insert( access );
+      }
+    }
+    return result;
+  }
+
+  // Dimensionality of the dataspace, from any access.
+  signed int accessDimensions( const set<Tuple>& reads, const set<Tuple>& writes, const set<AffineAccess>& affine_reads, const set<AffineAccess>& affine_writes ){
+    for( const set<Tuple>* tuples : { &reads, &writes } ){
+      for( Tuple tuple : *tuples ){
+        if( !tuple.isEmptyTuple() ){
+          return (signed int) tuple.dimensions();
+        }
+      }
+    }
+    for( const set<AffineAccess>* accesses : { &affine_reads, &affine_writes } ){
+      if( !accesses->empty() ){
+        return (signed int) accesses->begin()->dimensions();
+      }
+    }
+    return -1;
+  }
+
+  set<Tuple> asTuples( TupleCollection collection ){
+    return set<Tuple>( collection.begin(), collection.end() );
+  }
+}
+
+std::string LoopChainIR::reductionIdentifier( ReductionOperator op ){
+  switch( op ){
+    case ReduceAdd: return "+";
+    case ReduceMultiply: return "*";
+    case ReduceMin: return "min";
+    case ReduceMax: return "max";
+    case ReduceBitAnd: return "&";
+    case ReduceBitOr: return "|";
+    case ReduceBitXor: return "^";
+    case ReduceLogicalAnd: return "&&";
+    case ReduceLogicalOr: return "||";
+  }
+  assertWithException( false, SSTR( "Unknown reduction operator " << (int) op ) );
+  return "";
+}
+
 Dataspace::Dataspace( std::string name, std::set<Tuple> reads, std::set<Tuple> writes )
-: name( name ), read_collection( reads ), write_collection( writes )
+: name( name ), read_collection( reads ), write_collection( writes ), affine_read_set(), affine_write_set(),
+  reduction_target_set(), reduction_operator( ReduceAdd )
 {
   assertWithException(  read_collection.dimensions() == write_collection.dimensions(),
                         SSTR( "Read/Write sets are of different dimensionality: "
@@ -294,7 +747,8 @@ Dataspace::Dataspace( std::string name, std::set<Tuple> reads, std::set<Tuple> w
 }
 
 Dataspace::Dataspace( std::string name, const TupleCollection& reads, const TupleCollection& writes )
-: name( name ), read_collection( reads ), write_collection( writes ), dimensions_var( reads.dimensions() )
+: name( name ), read_collection( reads ), write_collection( writes ), affine_read_set(), affine_write_set(),
+  reduction_target_set(), reduction_operator( ReduceAdd ), dimensions_var( reads.dimensions() )
 {
   assertWithException(  read_collection.dimensions() == write_collection.dimensions(),
                         SSTR( "Read/Write sets are of different dimensionality: "
@@ -302,27 +756,146 @@ Dataspace::Dataspace( std::string name, const TupleCollection& reads, const Tupl
                       );
 }
 
-TupleCollection Dataspace::reads() const {
-  return TupleCollection( this->read_collection );
+Dataspace::Dataspace( std::string name, std::set<Tuple> reads, std::set<Tuple> writes, std::set<AffineAccess> affine_reads, std::set<AffineAccess> affine_writes )
+: Dataspace( name,
+             TupleCollection( reads, accessDimensions( reads, writes, affine_reads, affine_writes ) ),
+             TupleCollection( writes, accessDimensions( reads, writes, affine_reads, affine_writes ) ),
+             affine_reads, affine_writes )
+{ }
+
+Dataspace::Dataspace( std::string name, const TupleCollection& reads, const TupleCollection& writes, std::set<AffineAccess> affine_reads, std::set<AffineAccess> affine_writes )
+: name( name ),
+  read_collection( translationOffsets( asTuples( reads ), affine_reads ), reads.dimensions() ),
+  write_collection( translationOffsets( asTuples( writes ), affine_writes ), writes.dimensions() ),
+  affine_read_set( nonTranslations( affine_reads ) ),
+  affine_write_set( nonTranslations( affine_writes ) ),
+  reduction_target_set(),
+  reduction_operator( ReduceAdd ),
+  dimensions_var( reads.dimensions() )
+{
+  assertWithException(  read_collection.dimensions() == write_collection.dimensions(),
+                        SSTR( "Read/Write sets are of different dimensionality: "
+                              << read_collection.dimensions() << ", " << write_collection.dimensions() )
+                      );
+
+  for( const set<AffineAccess>* accesses : { &this->affine_read_set, &this->affine_write_set } ){
+    for( AffineAccess access : *accesses ){
+      assertWithException( access.dimensions() == this->dimensions(),
+                           SSTR( "Access " << access << " is of different dimensionality than dataspace " << name ) );
+    }
+  }
+}
+
+Dataspace::Dataspace( std::string name, ReductionOperator op, std::set<AffineAccess> targets )
+: name( name ),
+  read_collection( targets.empty()? 0 : targets.begin()->dimensions() ),
+  write_collection( targets.empty()? 0 : targets.begin()->dimensions() ),
+  affine_read_set(),
+  affine_write_set(),
+  reduction_target_set( targets ),
+  reduction_operator( op ),
+  dimensions_var( targets.empty()? 0 : targets.begin()->dimensions() )
+{
+  assertWithException( !targets.empty(), SSTR( "Reduction into " << name << " has no targets" ) );
+  for( const AffineAccess& target : targets ){
+    assertWithException( target.dimensions() == this->dimensions(),
+                         SSTR( "Reduction target " << target << " is of different dimensionality than dataspace " << name ) );
+  }
+}
+
+const TupleCollection& Dataspace::reads() const {
+  return this->read_collection;
 }
 
-TupleCollection Dataspace::writes() const {
-  return TupleCollection( this->write_collection );
+const TupleCollection& Dataspace::writes() const {
+  return this->write_collection;
 }
 
 TupleCollection Dataspace::allAccesses() const {
-  return TupleCollection( this->reads(), this->writes() );
+  return TupleCollection( this->read_collection, this->write_collection );
 }
 
 Tuple::size_type Dataspace::dimensions() const {
   return this->dimensions_var;
 }
 
+const std::set<AffineAccess>& Dataspace::affineReads() const {
+  return this->affine_read_set;
+}
+
+const std::set<AffineAccess>& Dataspace::affineWrites() const {
+  return this->affine_write_set;
+}
+
+bool Dataspace::hasAffineAccesses() const {
+  return !( this->affine_read_set.empty() && this->affine_write_set.empty() );
+}
+
+bool Dataspace::isReduction() const {
+  return !this->reduction_target_set.empty();
+}
+
+const std::set<AffineAccess>& Dataspace::reductionTargets() const {
+  return this->reduction_target_set;
+}
+
+ReductionOperator Dataspace::reductionOperator() const {
+  assertWithException( this->isReduction(), SSTR( "Dataspace " << this->name << " is not a reduction" ) );
+  return this->reduction_operator;
+}
+
+Dataspace Dataspace::shifted( const Tuple& extent ) const {
+  Dataspace result( *this );
+  // A reduction has no reads or writes, and its targets may have fewer
+  // dimensions than the iterators
+  if( !this->isReduction() ){
+    result.read_collection.shiftAll( extent );
+    result.write_collection.shiftAll( extent );
+  }
+
+  result.affine_read_set.clear();
+  for( const AffineAccess& access : this->affine_read_set ){
+    result.affine_read_set.insert( access.shifted( extent ) );
+  }
+  result.affine_write_set.clear();
+  for( const AffineAccess& access : this->affine_write_set ){
+    result.affine_write_set.insert( access.shifted( extent ) );
+  }
+  result.reduction_target_set.clear();
+  for( const AffineAccess& access : this->reduction_target_set ){
+    result.reduction_target_set.insert( access.shifted( extent ) );
+  }
+
+  return result;
+}
+
 std::string Dataspace::str() const {
   ostringstream stream;
   stream << this->name << ": "
          << "\n\tReads: " << this->read_collection
          << "\n\tWrites: " << this->write_collection;
+
+  if( this->hasAffineAccesses() ){
+    for( pair<string, const set<AffineAccess>*> accesses : { make_pair( string("Affine Reads"), &this->affine_read_set ),
+                                                             make_pair( string("Affine Writes"), &this->affine_write_set ) } ){
+      stream << "\n\t" << accesses.first << ": { ";
+      bool first = true;
+      for( AffineAccess access : *accesses.second ){
+        stream << (first?"":", ") << access;
+        first = false;
+      }
+      stream << " }";
+    }
+  }
+  if( this->isReduction() ){
+    stream << "\n\tReductions (" << reductionIdentifier( this->reduction_operator ) << "): { ";
+    bool first = true;
+    for( AffineAccess access : this->reduction_target_set ){
+      stream << (first?"":", ") << access;
+      first = false;
+    }
+    stream << " }";
+  }
   return stream.str();
 }
 
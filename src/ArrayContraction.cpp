@@ -0,0 +1,350 @@
+/*! ****************************************************************************
+\file ArrayContraction.cpp
+\authors Ian J. Bertolacci
+
+\brief
+Live window analysis for array contraction of temporaries in a fused chain.
+
+\copyright
+Copyright 2017 Universiy of Arizona
+*******************************************************************************/
+
+#include <LoopChainIR/ArrayContraction.hpp>
+#include <LoopChainIR/all_isl.hpp>
+#include <LoopChainIR/util.hpp>
+#include <algorithm>
+#include <sstream>
+
+using namespace std;
+using namespace LoopChainIR;
+
+const int ArrayContraction::FullDimension;
+
+namespace {
+
+  struct NestAccess {
+    // Position of the nest in the fused body.
+    vector<LoopChain::size_type>::size_type position;
+    LoopChain::size_type nest;
+    Tuple offset;
+  };
+
+  // Position in the fused iteration space at which an access touches element e:
+  // nest iteration i = e - offset runs at fused iteration i + shift.
+  // Returned as the constant part ( shift - offset ).
+  Tuple accessTime( const NestAccess& access, const map<LoopChain::size_type, Tuple>& shifts ){
+    map<LoopChain::size_type, Tuple>::const_iterator shift = shifts.find( access.nest );
+    vector<int> time;
+    for( Tuple::size_type d = 0; d < access.offset.dimensions(); d += 1 ){
+      int shift_d = (shift != shifts.end() && d < shift->second.dimensions())? shift->second[d] : 0;
+      time.push_back( shift_d - access.offset[d] );
+    }
+    return Tuple( time );
+  }
+
+  // Index of the first non-zero element, or dimensions() if zero.
+  Tuple::size_type firstNonZero( const Tuple& tuple ){
+    Tuple::size_type d = 0;
+    while( d < tuple.dimensions() && tuple[d] == 0 ){
+      d += 1;
+    }
+    return d;
+  }
+
+  bool lexicographicallyPositive( const Tuple& tuple ){
+    Tuple::size_type d = firstNonZero( tuple );
+    return d < tuple.dimensions() && tuple[d] > 0;
+  }
+
+  // "[N] -> { S_1[i_0] -> range : 1 <= i_0 <= N }" for the nest at position in the fused body.
+  // range may use the iterators of the nest's domain.
+  string nestMap( const LoopNest& nest, vector<LoopChain::size_type>::size_type position, const string& range ){
+    const PolyhedralDomain& domain = nest.getPolyhedralDomain();
+    ostringstream map;
+    map << "[";
+    bool not_first = false;
+    for( const string& symbol : domain.getSymbols() ){
+      map << (not_first?",":"") << symbol;
+      not_first = true;
+    }
+    map << "] -> { S_" << position << "[";
+    for( vector<string>::size_type d = 0; d < domain.getIterators().size(); d += 1 ){
+      map << ((d > 0)?",":"") << domain.getIterators()[d];
+    }
+    map << "] -> " << range;
+    for( vector<string>::size_type c = 0; c < domain.getConstraints().size(); c += 1 ){
+      map << ((c > 0)?" and ":" : ") << domain.getConstraints()[c];
+    }
+    map << " }";
+    return map.str();
+  }
+
+  // "B[i_0 + -1]"
+  string accessRange( const LoopNest& nest, const string& name, const Tuple& offset ){
+    const vector<string>& iterators = nest.getPolyhedralDomain().getIterators();
+    ostringstream range;
+    range << name << "[";
+    for( Tuple::size_type d = 0; d < offset.dimensions(); d += 1 ){
+      range << ((d > 0)?",":"") << iterators[d] << " + " << offset[d];
+    }
+    range << "]";
+    return range.str();
+  }
+
+  // True if some element read in the fused loop is not written by an
+  // earlier iteration of it, i.e. the dataspace is live into the fused loop.
+  // Exact dataflow under the fused schedule [i + shift, position].
+  bool readsLiveIn( const LoopChain& chain, const vector<LoopChain::size_type>& fused_nests, const map<LoopChain::size_type, Tuple>& shifts,
+                    const string& name, const vector<NestAccess>& reads, const vector<NestAccess>& writes ){
+    RectangularDomain::size_type depth = 0;
+    for( LoopChain::size_type nest : fused_nests ){
+      depth = max( depth, chain.getNest( nest ).getPolyhedralDomain().dimensions() );
+    }
+
+    isl_ctx* ctx = isl_ctx_alloc();
+
+    isl_union_map* schedule = isl_union_map_empty( isl_space_params_alloc( ctx, 0 ) );
+    for( vector<LoopChain::size_type>::size_type position = 0; position < fused_nests.size(); position += 1 ){
+      const LoopNest& nest = chain.getNest( fused_nests[position] );
+      const vector<string>& iterators = nest.getPolyhedralDomain().getIterators();
+      map<LoopChain::size_type, Tuple>::const_iterator shift = shifts.find( fused_nests[position] );
+      ostringstream range;
+      range << "[";
+      for( RectangularDomain::size_type d = 0; d < depth; d += 1 ){
+        if( d < iterators.size() ){
+          int shift_d = (shift != shifts.end() && d < shift->second.dimensions())? shift->second[d] : 0;
+          range << iterators[d] << " + " << shift_d << ",";
+        } else {
+          range << "0,";
+        }
+      }
+      range << position << "]";
+      schedule = isl_union_map_union( schedule, isl_union_map_read_from_str( ctx, nestMap( nest, position, range.str() ).c_str() ) );
+    }
+
+    isl_union_map* sinks = isl_union_map_empty( isl_space_params_alloc( ctx, 0 ) );
+    for( const NestAccess& read : reads ){
+      const LoopNest& nest = chain.getNest( read.nest );
+      sinks = isl_union_map_union( sinks, isl_union_map_read_from_str( ctx, nestMap( nest, read.position, accessRange( nest, name, read.offset ) ).c_str() ) );
+    }
+
+    isl_union_map* sources = isl_union_map_empty( isl_space_params_alloc( ctx, 0 ) );
+    for( const NestAccess& write : writes ){
+      const LoopNest& nest = chain.getNest( write.nest );
+      sources = isl_union_map_union( sources, isl_union_map_read_from_str( ctx, nestMap( nest, write.position, accessRange( nest, name, write.offset ) ).c_str() ) );
+    }
+
+    isl_union_access_info* info = isl_union_access_info_from_sink( sinks );
+    info = isl_union_access_info_set_must_source( info, sources );
+    info = isl_union_access_info_set_schedule_map( info, schedule );
+    isl_union_flow* flow = isl_union_access_info_compute_flow( info );
+    isl_union_map* no_source = isl_union_flow_get_must_no_source( flow );
+    isl_bool empty = isl_union_map_is_empty( no_source );
+    isl_union_map_free( no_source );
+    isl_union_flow_free( flow );
+    isl_ctx_free( ctx );
+
+    assertWithException( empty != isl_bool_error, SSTR( "Could not compute the dataflow of " << name ) );
+    return empty == isl_bool_false;
+  }
+
+}
+
+ArrayContraction::ArrayContraction( const LoopChain& chain, const std::vector<LoopChain::size_type>& fused_nests,
+                                    const std::map<LoopChain::size_type, Tuple>& shifts, const std::set<std::string>& live_out )
+: windows(), reasons()
+{
+  this->analyze( chain, fused_nests, shifts, live_out );
+}
+
+ArrayContraction::ArrayContraction( const LoopChain& chain, const std::map<LoopChain::size_type, Tuple>& shifts, const std::set<std::string>& live_out )
+: windows(), reasons()
+{
+  vector<LoopChain::size_type> fused_nests;
+  for( LoopChain::size_type nest = 0; nest < chain.length(); nest += 1 ){
+    fused_nests.push_back( nest );
+  }
+  this->analyze( chain, fused_nests, shifts, live_out );
+}
+
+void ArrayContraction::analyze( const LoopChain& chain, const std::vector<LoopChain::size_type>& fused_nests,
+                                const std::map<LoopChain::size_type, Tuple>& shifts, const std::set<std::string>& live_out ){
+  map< string, vector<NestAccess> > reads;
+  map< string, vector<NestAccess> > writes;
+  map< string, Tuple::size_type > dimensions;
+  set< string > names;
+
+  // Collect the accesses of the fused nests
+  for( vector<LoopChain::size_type>::size_type position = 0; position < fused_nests.size(); position += 1 ){
+    LoopChain::size_type nest = fused_nests[position];
+    assertWithException( nest < chain.length(), SSTR( "Fused nest " << nest << " is not in the chain" ) );
+
+    for( const Dataspace& dataspace : chain.getNest( nest ).getDataspaces() ){
+      names.insert( dataspace.name );
+      dimensions[dataspace.name] = dataspace.dimensions();
+
+      if( dataspace.hasAffineAccesses() ){
+        this->reasons[dataspace.name] = SSTR( "Nest " << nest << " has non-translation accesses" );
+      }
+      if( dataspace.isReduction() ){
+        this->reasons[dataspace.name] = SSTR( "Nest " << nest << " reduces into it" );
+      }
+      for( Tuple offset : dataspace.reads() ){
+        reads[dataspace.name].push_back( NestAccess{ position, nest, offset } );
+      }
+      for( Tuple offset : dataspace.writes() ){
+        writes[dataspace.name].push_back( NestAccess{ position, nest, offset } );
+      }
+    }
+  }
+
+  // Dataspaces also used outside the fused nests are live across them
+  for( LoopChain::size_type nest = 0; nest < chain.length(); nest += 1 ){
+    if( find( fused_nests.begin(), fused_nests.end(), nest ) != fused_nests.end() ){
+      continue;
+    }
+    for( const Dataspace& dataspace : chain.getNest( nest ).getDataspaces() ){
+      if( names.count( dataspace.name ) > 0 && this->reasons.count( dataspace.name ) == 0 ){
+        this->reasons[dataspace.name] = SSTR( "Accessed by nest " << nest << " which is not fused" );
+      }
+    }
+  }
+
+  for( const string& name : names ){
+    if( this->reasons.count( name ) > 0 ){
+      continue;
+    }
+    if( live_out.count( name ) > 0 ){
+      this->reasons[name] = "Live out of the chain";
+      continue;
+    }
+    if( writes[name].empty() ){
+      this->reasons[name] = "Never written";
+      continue;
+    }
+
+    // Distances from a write of an element to the reads of it
+    vector<Tuple> read_distances;
+    bool reads_covered = true;
+    for( const NestAccess& read : reads[name] ){
+      bool covered = false;
+      for( const NestAccess& write : writes[name] ){
+        Tuple distance = accessTime( read, shifts ) - accessTime( write, shifts );
+        // The read sees the write if it happens at a later fused iteration,
+        // or in the same iteration in a later nest.
+        if( lexicographicallyPositive( distance ) || ( distance.isZeroTuple() && write.position < read.position ) ){
+          read_distances.push_back( distance );
+          covered = true;
+        }
+      }
+      if( !covered ){
+        this->reasons[name] = SSTR( "Read " << read.offset << " in nest " << read.nest << " is not preceded by a write in the fused loop" );
+        reads_covered = false;
+        break;
+      }
+    }
+    if( !reads_covered ){
+      continue;
+    }
+
+    // A write at a positive distance does not cover the edges of the domain,
+    // where the read element may never be written in the fused loop.
+    if( readsLiveIn( chain, fused_nests, shifts, name, reads[name], writes[name] ) ){
+      this->reasons[name] = "Reads elements that are not written earlier in the fused loop";
+      continue;
+    }
+
+    // Distances between different writes, so that a folded write never
+    // clobbers an element that is still live.
+    vector<Tuple> write_spreads;
+    for( const NestAccess& first : writes[name] ){
+      for( const NestAccess& second : writes[name] ){
+        Tuple spread = accessTime( second, shifts ) - accessTime( first, shifts );
+        if( lexicographicallyPositive( spread ) ){
+          write_spreads.push_back( spread );
+        }
+      }
+    }
+
+    // The outermost dimension carrying any distance. Dimensions outside it
+    // are never live for more than one iteration, dimensions inside it must
+    // be kept in full.
+    Tuple::size_type dims = dimensions[name];
+    Tuple::size_type carrying = dims;
+    for( const vector<Tuple>* distances : { &read_distances, &write_spreads } ){
+      for( const Tuple& distance : *distances ){
+        carrying = min( carrying, firstNonZero( distance ) );
+      }
+    }
+
+    vector<int> window( dims, 1 );
+    if( carrying < dims ){
+      int max_read = 0;
+      for( const Tuple& distance : read_distances ){
+        max_read = max( max_read, distance[carrying] );
+      }
+      int max_spread = 0;
+      for( const Tuple& spread : write_spreads ){
+        max_spread = max( max_spread, spread[carrying] );
+      }
+
+      window[carrying] = max_read + max_spread + 1;
+      for( Tuple::size_type d = carrying + 1; d < dims; d += 1 ){
+        window[d] = FullDimension;
+      }
+    }
+
+    this->windows[name] = window;
+  }
+}
+
+std::set<std::string> ArrayContraction::contractibleDataspaces() const {
+  set<string> names;
+  for( const pair< const string, vector<int> >& window : this->windows ){
+    names.insert( window.first );
+  }
+  return names;
+}
+
+bool ArrayContraction::isContractible( const std::string& dataspace ) const {
+  return this->windows.count( dataspace ) > 0;
+}
+
+bool ArrayContraction::isScalar( const std::string& dataspace ) const {
+  const vector<int>& window = this->getWindow( dataspace );
+  return all_of( window.begin(), window.end(), []( int size ){ return size == 1; } );
+}
+
+const std::vector<int>& ArrayContraction::getWindow( const std::string& dataspace ) const {
+  map< string, vector<int> >::const_iterator window = this->windows.find( dataspace );
+  assertWithException( window != this->windows.end(), SSTR( "Dataspace " << dataspace << " cannot be contracted: " << this->getReason( dataspace ) ) );
+  return window->second;
+}
+
+std::string ArrayContraction::getReason( const std::string& dataspace ) const {
+  map< string, string >::const_iterator reason = this->reasons.find( dataspace );
+  if( reason != this->reasons.end() ){
+    return reason->second;
+  } else if( this->windows.count( dataspace ) > 0 ){
+    return "";
+  } else {
+    return "Not accessed in the fused nests";
+  }
+}
+
+std::string ArrayContraction::contractedSubscript( const std::string& dataspace, const std::vector<std::string>& indices ) const {
+  const vector<int>& window = this->getWindow( dataspace );
+  assertWithException( indices.size() == window.size(),
+                       SSTR( "Dataspace " << dataspace << " has " << window.size() << " dimensions, but " << indices.size() << " indices were given" ) );
+
+  ostringstream subscript;
+  for( vector<int>::size_type d = 0; d < window.size(); d += 1 ){
+    if( window[d] == FullDimension ){
+      subscript << "[" << indices[d] << "]";
+    } else if( window[d] > 1 ){
+      // Non-negative modulo, since indices may be negative
+      subscript << "[((" << indices[d] << ")%" << window[d] << "+" << window[d] << ")%" << window[d] << "]";
+    }
+  }
+  return subscript.str();
+}
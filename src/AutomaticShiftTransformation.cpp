@@ -31,7 +31,7 @@ vector<string> AutomaticShiftTransformation::apply( Schedule& schedule, Subspace
 }
 
 
-map<LoopChain::size_type, Tuple> AutomaticShiftTransformation::computeShiftTuplesForFusion( Subspace::size_type dimensions, LoopChain chain, bool include_zero_tuple ) {
+map<LoopChain::size_type, Tuple> AutomaticShiftTransformation::computeShiftTuplesForFusion( Subspace::size_type dimensions, const LoopChain& chain, bool include_zero_tuple ) {
   #if defined USE_SCIP
     MPSolver::OptimizationProblemType optimizationProblemType = MPSolver::SCIP_MIXED_INTEGER_PROGRAMMING;
   #elif defined USE_GLPK
@@ -76,11 +76,11 @@ map<LoopChain::size_type, Tuple> AutomaticShiftTransformation::computeShiftTuple
       objective->SetCoefficient( variable, 1 );
     }
 
-    list<Dataspace> nest_unnamed_dataspaces = chain.getNest(nest_idx).getDataspaces();
+    const list<Dataspace>& nest_unnamed_dataspaces = chain.getNest(nest_idx).getDataspaces();
     map< string, Dataspace > nest_dataspaces;
     set<string> nest_dataspace_names;
 
-    for( Dataspace dataspace : nest_unnamed_dataspaces ){
+    for( const Dataspace& dataspace : nest_unnamed_dataspaces ){
       nest_dataspace_names.insert( dataspace.name );
       nest_dataspaces.emplace( dataspace.name, dataspace );
     }
@@ -93,10 +93,10 @@ map<LoopChain::size_type, Tuple> AutomaticShiftTransformation::computeShiftTuple
       vector<MPVariable*>* previous_shifts = shift_variables[previous_idx];
 
       // Setup constraints: c_ywd - C_xwd <= S_yd - S_xd
-      map<string, Dataspace> previous_dataspaces = dataspaces[previous_idx];
+      const map<string, Dataspace>& previous_dataspaces = dataspaces[previous_idx];
 
       set<string> previous_dataspace_names;
-      for( map<string, Dataspace>::iterator iter = previous_dataspaces.begin(); iter != previous_dataspaces.end(); ++iter ){
+      for( map<string, Dataspace>::const_iterator iter = previous_dataspaces.begin(); iter != previous_dataspaces.end(); ++iter ){
         previous_dataspace_names.insert( iter->first );
       }
 
@@ -116,12 +116,40 @@ map<LoopChain::size_type, Tuple> AutomaticShiftTransformation::computeShiftTuple
         continue;
       }
 
-      auto calc_func = [&](TupleCollection nest_collection, TupleCollection prev_collection) {
-        for( Tuple nest_access_tuple : nest_collection ){
-          for( Tuple previous_access_tuple : prev_collection ){
+      // Translation accesses (tuples) and affine accesses are compared alike
+      auto as_affine = []( const TupleCollection& collection, const set<AffineAccess>& affine_accesses ){
+        vector<AffineAccess> accesses;
+        for( Tuple tuple : collection ){
+          accesses.push_back( AffineAccess( tuple ) );
+        }
+        accesses.insert( accesses.end(), affine_accesses.begin(), affine_accesses.end() );
+        return accesses;
+      };
+
+      auto calc_func = [&](const vector<AffineAccess>& nest_accesses, const vector<AffineAccess>& prev_accesses) {
+        for( const AffineAccess& nest_access : nest_accesses ){
+          for( const AffineAccess& previous_access : prev_accesses ){
+            // Accesses without a constant distance (e.g. A[i] and A[2i], or A[j][i] and A[i][j])
+            // cannot be ordered by a shift, so they leave the shifts unconstrained
+            if( !nest_access.isComparable( previous_access ) ){
+              continue;
+            }
+
+            // Distance between the iterations touching the same element.
+            Tuple distance = Tuple::createMagicEmptyTuple();
+            vector<bool> constant;
+            if( !nest_access.dependenceDistance( previous_access, distance, constant ) ){
+              // Accesses never touch the same element
+              continue;
+            }
+
             for( Subspace::size_type d = 0; d < dimensions; ++d ){
+              // Every iteration of a scalar or broadcast dimension touches the element
+              if( !constant[d] ){
+                continue;
+              }
               // Calculate constant lower bound
-              int difference = nest_access_tuple[d] - previous_access_tuple[d];
+              int difference = distance[d];
               // Construct constraint constant <= nest_shift_d - prev_shift
 
               auto map_index = make_pair( previous_shifts->at(d), nest_shifts->at(d) );
@@ -132,24 +160,41 @@ map<LoopChain::size_type, Tuple> AutomaticShiftTransformation::computeShiftTuple
               }
 
             } // for d
-          } // for previous_access_tuple
-        } // for nest_access_tuple
+          } // for previous_access
+        } // for nest_access
 
       }; // lambda function calc_func
 
-      for( string name : common ){
+      for( const string& name : common ){
+
+        const Dataspace& nest_dataspace = nest_dataspaces.find(name)->second;
+        const Dataspace& previous_dataspace = previous_dataspaces.find(name)->second;
+
+        // Reductions with the same operator commute, so carry no dependence
+        if( nest_dataspace.isReduction() && previous_dataspace.isReduction()
+            && nest_dataspace.reductionOperator() == previous_dataspace.reductionOperator() ){
+          continue;
+        }
+
+        vector<AffineAccess> nest_reads = as_affine( nest_dataspace.reads(), nest_dataspace.affineReads() );
+        vector<AffineAccess> nest_writes = as_affine( nest_dataspace.writes(), nest_dataspace.affineWrites() );
+        vector<AffineAccess> previous_reads = as_affine( previous_dataspace.reads(), previous_dataspace.affineReads() );
+        vector<AffineAccess> previous_writes = as_affine( previous_dataspace.writes(), previous_dataspace.affineWrites() );
 
-        Dataspace nest_dataspace = nest_dataspaces.find(name)->second;
-        Dataspace previous_dataspace = previous_dataspaces.find(name)->second;
+        // Otherwise a reduction both reads and writes its targets
+        nest_reads.insert( nest_reads.end(), nest_dataspace.reductionTargets().begin(), nest_dataspace.reductionTargets().end() );
+        nest_writes.insert( nest_writes.end(), nest_dataspace.reductionTargets().begin(), nest_dataspace.reductionTargets().end() );
+        previous_reads.insert( previous_reads.end(), previous_dataspace.reductionTargets().begin(), previous_dataspace.reductionTargets().end() );
+        previous_writes.insert( previous_writes.end(), previous_dataspace.reductionTargets().begin(), previous_dataspace.reductionTargets().end() );
 
         // Writes - writes
-        calc_func( nest_dataspace.writes(), previous_dataspace.writes() );
+        calc_func( nest_writes, previous_writes );
 
         // Writes - Reads
-        calc_func( nest_dataspace.writes(), previous_dataspace.reads() );
+        calc_func( nest_writes, previous_reads );
 
         // Reads - Writes
-        calc_func( nest_dataspace.reads(), previous_dataspace.writes() );
+        calc_func( nest_reads, previous_writes );
 
       } // for( name : common )
     } // for( previous_idx )
@@ -221,7 +266,7 @@ map<LoopChain::size_type, Tuple> AutomaticShiftTransformation::computeShiftTuple
   return shift_tuples;
 }
 
-vector<ShiftTransformation*> AutomaticShiftTransformation::computeShiftForFusion( Subspace::size_type dimensions, LoopChain chain, bool include_zero_tuple ){
+vector<ShiftTransformation*> AutomaticShiftTransformation::computeShiftForFusion( Subspace::size_type dimensions, const LoopChain& chain, bool include_zero_tuple ){
   map<LoopChain::size_type, Tuple> shift_tuples = computeShiftTuplesForFusion( dimensions, chain, include_zero_tuple );
   vector<ShiftTransformation*> transformations;
 
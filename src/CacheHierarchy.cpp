@@ -0,0 +1,170 @@
+/*! ****************************************************************************
+\file CacheHierarchy.cpp
+\authors Ian J. Bertolacci
+
+\brief
+Data cache hierarchy of the host, read from sysfs or from an override file.
+
+\copyright
+Copyright 2017 Universiy of Arizona
+*******************************************************************************/
+
+#include <LoopChainIR/CacheHierarchy.hpp>
+#include <LoopChainIR/util.hpp>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+
+using namespace std;
+using namespace LoopChainIR;
+
+namespace {
+
+  // Read the first line of a sysfs attribute, returning false if it does not exist.
+  bool readAttribute( const string& path, string& value ){
+    ifstream file( path.c_str() );
+    if( !file.good() ){
+      return false;
+    }
+    getline( file, value );
+    return true;
+  }
+
+  // Count the cpus in a list such as "0-3,8-11"
+  CacheLevel::size_type countCpus( const string& list ){
+    CacheLevel::size_type count = 0;
+    istringstream ranges( list );
+    string range;
+    while( getline( ranges, range, ',' ) ){
+      string::size_type dash = range.find( '-' );
+      if( dash == string::npos ){
+        count += 1;
+      } else {
+        count += atoi( range.substr( dash + 1 ).c_str() ) - atoi( range.substr( 0, dash ).c_str() ) + 1;
+      }
+    }
+    return max( count, (CacheLevel::size_type) 1 );
+  }
+
+}
+
+CacheLevel::CacheLevel( int level, size_type size, size_type line_size, size_type shared_cores )
+: level( level ), size( size ), line_size( line_size ), shared_cores( shared_cores )
+{
+  assertWithException( size >= 1, SSTR( "L" << level << " cache must have a size" ) );
+  assertWithException( shared_cores >= 1, SSTR( "L" << level << " cache must be used by at least one core" ) );
+}
+
+CacheLevel::size_type CacheLevel::sizePerCore() const {
+  return this->size / this->shared_cores;
+}
+
+const char* const CacheHierarchy::OverrideVariable = "LOOPCHAINIR_CACHE_HIERARCHY";
+
+CacheHierarchy::CacheHierarchy( std::vector<CacheLevel> levels )
+: levels( std::move( levels ) )
+{
+  assertWithException( !this->levels.empty(), "Cache hierarchy has no levels" );
+  stable_sort( this->levels.begin(), this->levels.end(),
+               []( const CacheLevel& left, const CacheLevel& right ){ return left.level < right.level; } );
+}
+
+CacheLevel::size_type CacheHierarchy::parseSize( const std::string& size ){
+  char* end = NULL;
+  long value = strtol( size.c_str(), &end, 10 );
+  assertWithException( end != size.c_str() && value > 0, SSTR( "Invalid cache size \"" << size << "\"" ) );
+
+  string suffix( end );
+  CacheLevel::size_type multiplier = 1;
+  if( suffix == "K" || suffix == "k" ){
+    multiplier = 1024;
+  } else if( suffix == "M" || suffix == "m" ){
+    multiplier = 1024*1024;
+  } else if( suffix == "G" || suffix == "g" ){
+    multiplier = 1024*1024*1024;
+  } else {
+    assertWithException( suffix.empty(), SSTR( "Invalid cache size \"" << size << "\"" ) );
+  }
+
+  return (CacheLevel::size_type) value * multiplier;
+}
+
+CacheHierarchy CacheHierarchy::fromSysfs( const std::string& root ){
+  vector<CacheLevel> levels;
+
+  string level;
+  for( int index = 0; readAttribute( SSTR( root << "/cpu0/cache/index" << index << "/level" ), level ); index += 1 ){
+    string directory = SSTR( root << "/cpu0/cache/index" << index << "/" );
+
+    string type;
+    string size;
+    readAttribute( directory + "type", type );
+    if( type == "Instruction" || !readAttribute( directory + "size", size ) ){
+      continue;
+    }
+
+    string line_size = "64";
+    string shared = "0";
+    readAttribute( directory + "coherency_line_size", line_size );
+    readAttribute( directory + "shared_cpu_list", shared );
+
+    levels.push_back( CacheLevel( atoi( level.c_str() ), parseSize( size ), parseSize( line_size ), countCpus( shared ) ) );
+  }
+
+  assertWithException( !levels.empty(), SSTR( "No data caches found in " << root ) );
+  return CacheHierarchy( levels );
+}
+
+CacheHierarchy CacheHierarchy::fromFile( const std::string& path ){
+  ifstream file( path.c_str() );
+  assertWithException( file.good(), SSTR( "Cannot open cache hierarchy file " << path ) );
+
+  vector<CacheLevel> levels;
+  string line;
+  while( getline( file, line ) ){
+    istringstream fields( line );
+    int level = 0;
+    string size;
+    if( !(fields >> level) ){
+      // Blank line or comment
+      assertWithException( line.find_first_not_of( " \t" ) == string::npos || line[ line.find_first_not_of( " \t" ) ] == '#',
+                           SSTR( "Invalid line in cache hierarchy file " << path << ": " << line ) );
+      continue;
+    }
+    assertWithException( (bool)(fields >> size), SSTR( "Missing cache size in " << path << ": " << line ) );
+
+    string line_size = "64";
+    CacheLevel::size_type shared = 1;
+    fields >> line_size >> shared;
+
+    levels.push_back( CacheLevel( level, parseSize( size ), parseSize( line_size ), shared ) );
+  }
+
+  return CacheHierarchy( levels );
+}
+
+CacheHierarchy CacheHierarchy::host(){
+  const char* override_file = getenv( OverrideVariable );
+  if( override_file != NULL && override_file[0] != '\0' ){
+    return fromFile( override_file );
+  }
+  return fromSysfs();
+}
+
+CacheHierarchy::size_type CacheHierarchy::size() const {
+  return this->levels.size();
+}
+
+const CacheLevel& CacheHierarchy::operator[]( size_type index ) const {
+  assertWithException( index < this->levels.size(), SSTR( "Cache level index " << index << " out of range" ) );
+  return this->levels[index];
+}
+
+CacheHierarchy::const_iterator CacheHierarchy::begin() const {
+  return this->levels.begin();
+}
+
+CacheHierarchy::const_iterator CacheHierarchy::end() const {
+  return this->levels.end();
+}
@@ -0,0 +1,132 @@
+/*! ****************************************************************************
+\file DiamondTileTransformation.cpp
+\authors Ian J. Bertolacci
+
+\brief
+Diamond tiling of a stencil chain with a time domain over time and the nests'
+outermost dimension.
+
+\copyright
+Copyright 2017 Universiy of Arizona
+*******************************************************************************/
+
+#include <LoopChainIR/DiamondTileTransformation.hpp>
+#include <LoopChainIR/util.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+
+using namespace std;
+using namespace LoopChainIR;
+
+namespace {
+
+  /*
+  Largest absolute outermost distance of the dependences of later on earlier.
+  Returns false if the nests do not depend on each other.
+  */
+  bool largestDistance( const LoopNest& earlier, const LoopNest& later, int& distance ){
+    bool dependent = false;
+    distance = 0;
+    for( const DependenceDistance& dependence : dependenceDistances( earlier, later ) ){
+      distance = max( distance, abs( dependence.distance[0] ) );
+      dependent = true;
+    }
+    return dependent;
+  }
+
+}
+
+DiamondTileTransformation::DiamondTileTransformation( int tile_size, std::vector<Transformation*> over_tiles )
+: tile_size( tile_size ), over_tiles( std::move( over_tiles ) )
+{
+  assertWithException( this->tile_size > 0, SSTR( "Tile size must be positive, not " << this->tile_size ) );
+}
+
+int DiamondTileTransformation::getTileSize() const {
+  return this->tile_size;
+}
+
+int DiamondTileTransformation::slope( const LoopChain& chain ){
+  assertWithException( chain.hasTimeDomain(), "Diamond tiling requires a chain with a time domain" );
+
+  for( LoopChain::size_type loop = 0; loop < chain.length(); loop += 1 ){
+    const LoopNest& nest = chain.getNest( loop );
+    assertWithException( nest.dimensions() > 0, SSTR( "Loop " << loop << " has no dimension to tile" ) );
+
+    // Iterations of the same virtual time may not depend on each other
+    for( const DependenceDistance& dependence : dependenceDistances( nest, nest ) ){
+      assertWithException( dependence.distance[0] == 0,
+                           SSTR( "Iterations of loop " << loop << " depend on each other through " << dependence.dataspace ) );
+    }
+  }
+
+  // Nest later of the same time step is later - earlier virtual steps ahead, and L + later - earlier in the next time step
+  int slope = 1;
+  int length = (int) chain.length();
+  for( int earlier = 0; earlier < length; earlier += 1 ){
+    for( int later = 0; later < length; later += 1 ){
+      int distance = 0;
+      if( !largestDistance( chain.getNest( earlier ), chain.getNest( later ), distance ) ){
+        continue;
+      }
+      if( earlier < later ){
+        slope = max( slope, (distance + (later - earlier) - 1) / (later - earlier) );
+      }
+      slope = max( slope, (distance + (length + later - earlier) - 1) / (length + later - earlier) );
+    }
+  }
+
+  return slope;
+}
+
+std::vector<std::string> DiamondTileTransformation::apply( Schedule& schedule ){
+  return this->apply( schedule, schedule.getSubspaceManager().get_nest() );
+}
+
+std::vector<std::string> DiamondTileTransformation::apply( Schedule& schedule, Subspace* subspace ){
+  SubspaceManager& manager = schedule.getSubspaceManager();
+  Subspace* time = schedule.getTimeSubspace();
+  Subspace* loops = manager.get_loops();
+  const LoopChain& chain = schedule.getChain();
+  assertWithException( time != NULL, "Diamond tiling requires a chain with a time domain" );
+  assertWithException( subspace == manager.get_nest(), "Can only diamond tile the nest subspace" );
+
+  int slope = DiamondTileTransformation::slope( chain );
+
+  // Subspace of the tiles ([row, column]), outside the time loop
+  Subspace* tiles = new Subspace( manager.get_safe_prefix( "d" ), 2 );
+  manager.insert_left( tiles, manager.get_iterator_to_subspace( time ) );
+  tiles->set_aliased();
+
+  std::string header = SSTR( "[" << manager.get_input_iterators() << "] -> [" << manager.get_output_iterators() << "] : " );
+
+  std::ostringstream transformation;
+  transformation << "{";
+  for( LoopChain::size_type loop = 0; loop < chain.length(); loop += 1 ){
+    std::string virtual_time = SSTR( slope * chain.length() << "*" << time->get( 0, false ) << " + " << slope * loop );
+    std::string rising = SSTR( "floor((" << virtual_time << " + " << subspace->get( 0, false ) << ")/" << this->tile_size << ")" );
+    std::string falling = SSTR( "floor((" << virtual_time << " - " << subspace->get( 0, false ) << ")/" << this->tile_size << ")" );
+
+    transformation << "\n\t" << header << "\n\t\t"
+                   << loops->get( loops->const_index, false ) << " = " << loop << " and "
+                   << tiles->get( 0, true ) << " = " << rising << " + " << falling << " and "
+                   << tiles->get( 1, true ) << " = " << rising << " and "
+                   << tiles->get( tiles->const_index, true ) << " = 0;";
+  }
+  transformation << "\n};";
+
+  std::vector<std::string> transformations;
+  transformations.push_back( transformation.str() );
+
+  manager.next_stage();
+  schedule.incrementDepth();
+  // Apply over tile transformations on the tile subspace, appending (in order) any new transformations created
+  for( Transformation* over_tile : this->over_tiles ){
+    std::vector<std::string> additional_transformations = over_tile->apply( schedule, tiles );
+    transformations.insert( transformations.end(), additional_transformations.begin(), additional_transformations.end() );
+  }
+  schedule.decrementDepth();
+
+  return transformations;
+}
@@ -0,0 +1,243 @@
+/*! ****************************************************************************
+\file DomainDecomposition.cpp
+\authors Ian J. Bertolacci
+
+\brief
+Partition the iteration space of a loop chain across a grid of ranks, and
+generate each rank's code with the halo exchanges it needs.
+
+\copyright
+Copyright 2017 Universiy of Arizona
+*******************************************************************************/
+
+#include <LoopChainIR/DomainDecomposition.hpp>
+#include <LoopChainIR/Schedule.hpp>
+#include <LoopChainIR/util.hpp>
+#include <algorithm>
+#include <sstream>
+
+using namespace std;
+using namespace LoopChainIR;
+
+DomainDecomposition::DomainDecomposition( const LoopChain& chain, std::vector<int> grid )
+: chain( chain ), grid( std::move( grid ) )
+{
+  assertWithException( !this->grid.empty(), "Must decompose at least one dimension" );
+  for( int ranks : this->grid ){
+    assertWithException( ranks > 0, SSTR( "Cannot decompose a dimension across " << ranks << " ranks" ) );
+  }
+
+  for( LoopChain::size_type nest = 0; nest < this->chain.length(); nest += 1 ){
+    const LoopNest& loop_nest = this->chain.getNest( nest );
+    assertWithException( loop_nest.dimensions() >= this->grid.size(),
+                         SSTR( "Loop " << nest << " has fewer than the " << this->grid.size() << " decomposed dimensions" ) );
+
+    map<string, vector<HaloWidth> > reads = this->readWidths( nest );
+    for( const Dataspace& dataspace : loop_nest.getDataspaces() ){
+      assertWithException( !dataspace.hasAffineAccesses() && !dataspace.isReduction(),
+                           SSTR( "Elements of " << dataspace.name << " accessed by loop " << nest << " are unknown" ) );
+      for( const Tuple& write : dataspace.writes() ){
+        for( size_type d = 0; d < this->grid.size(); d += 1 ){
+          assertWithException( write[d] == 0,
+                               SSTR( "Loop " << nest << " writes elements of " << dataspace.name << " it does not own" ) );
+        }
+      }
+      assertWithException( dataspace.writes().size() == 0 || !DomainDecomposition::hasHalo( reads[dataspace.name] ),
+                           SSTR( "Loop " << nest << " reads the halo of " << dataspace.name << ", which it writes" ) );
+    }
+  }
+}
+
+const std::vector<int>& DomainDecomposition::getGrid() const {
+  return this->grid;
+}
+
+int DomainDecomposition::ranks() const {
+  int ranks = 1;
+  for( int extent : this->grid ){
+    ranks *= extent;
+  }
+  return ranks;
+}
+
+std::string DomainDecomposition::lowerSymbol( size_type dimension ){
+  return SSTR( "owned_lower_" << dimension );
+}
+
+std::string DomainDecomposition::upperSymbol( size_type dimension ){
+  return SSTR( "owned_upper_" << dimension );
+}
+
+bool DomainDecomposition::hasHalo( const std::vector<HaloWidth>& widths ){
+  for( const HaloWidth& width : widths ){
+    if( width.first > 0 || width.second > 0 ){
+      return true;
+    }
+  }
+  return false;
+}
+
+std::map<std::string, std::vector<DomainDecomposition::HaloWidth> > DomainDecomposition::readWidths( LoopChain::size_type nest ) const {
+  map<string, vector<HaloWidth> > widths;
+  for( const Dataspace& dataspace : this->chain.getNest( nest ).getDataspaces() ){
+    vector<HaloWidth>& width = widths[dataspace.name];
+    width.resize( this->grid.size(), HaloWidth( 0, 0 ) );
+    for( const Tuple& read : dataspace.reads() ){
+      for( size_type d = 0; d < this->grid.size(); d += 1 ){
+        width[d].first = max<HaloExchange::size_type>( width[d].first, (read[d] < 0)? -read[d] : 0 );
+        width[d].second = max<HaloExchange::size_type>( width[d].second, (read[d] > 0)? read[d] : 0 );
+      }
+    }
+  }
+  return widths;
+}
+
+std::vector<DomainDecomposition::HaloWidth> DomainDecomposition::haloWidths( const std::string& name ) const {
+  vector<HaloWidth> widths( this->grid.size(), HaloWidth( 0, 0 ) );
+  for( LoopChain::size_type nest = 0; nest < this->chain.length(); nest += 1 ){
+    map<string, vector<HaloWidth> > reads = this->readWidths( nest );
+    if( reads.count( name ) == 0 ){
+      continue;
+    }
+    for( size_type d = 0; d < this->grid.size(); d += 1 ){
+      widths[d].first = max( widths[d].first, reads[name][d].first );
+      widths[d].second = max( widths[d].second, reads[name][d].second );
+    }
+  }
+  return widths;
+}
+
+std::vector< std::set<std::string> > DomainDecomposition::exchanges() const {
+  vector< set<string> > exchanges( this->chain.length() );
+  // Dataspaces whose halos are up to date
+  set<string> current;
+
+  for( LoopChain::size_type nest = 0; nest < this->chain.length(); nest += 1 ){
+    for( const auto& read : this->readWidths( nest ) ){
+      if( DomainDecomposition::hasHalo( read.second ) && current.count( read.first ) == 0 ){
+        exchanges[nest].insert( read.first );
+        current.insert( read.first );
+      }
+    }
+    for( const Dataspace& dataspace : this->chain.getNest( nest ).getDataspaces() ){
+      if( dataspace.writes().size() > 0 ){
+        current.erase( dataspace.name );
+      }
+    }
+  }
+
+  return exchanges;
+}
+
+LoopChain DomainDecomposition::localChain( LoopChain::size_type nest, Region region ) const {
+  assertWithException( nest < this->chain.length(), SSTR( "Loop " << nest << " is not in the chain" ) );
+
+  // Halos of the dataspaces exchanged before the nest
+  vector<HaloWidth> widths( this->grid.size(), HaloWidth( 0, 0 ) );
+  if( region != Owned ){
+    set<string> exchanged = this->exchanges()[nest];
+    for( const auto& read : this->readWidths( nest ) ){
+      if( exchanged.count( read.first ) == 0 ){
+        continue;
+      }
+      for( size_type d = 0; d < this->grid.size(); d += 1 ){
+        widths[d].first = max( widths[d].first, read.second[d].first );
+        widths[d].second = max( widths[d].second, read.second[d].second );
+      }
+    }
+  }
+
+  LoopChain local;
+  for( LoopChain::size_type other = 0; other < this->chain.length(); other += 1 ){
+    const LoopNest& loop_nest = this->chain.getNest( other );
+    const PolyhedralDomain& domain = loop_nest.getPolyhedralDomain();
+    list<Dataspace> dataspaces = loop_nest.getDataspaces();
+
+    if( other != nest ){
+      local.append( LoopNest( PolyhedralDomain( domain.getIterators(), { "1 = 0" }, set<string>() ), dataspaces ) );
+      continue;
+    }
+
+    vector<string> constraints = domain.getConstraints();
+    set<string> symbols = domain.getSymbols();
+    ostringstream boundary;
+    for( size_type d = 0; d < this->grid.size(); d += 1 ){
+      const string& iterator = domain.getIterators()[d];
+      string lower = DomainDecomposition::lowerSymbol( d );
+      string upper = DomainDecomposition::upperSymbol( d );
+      symbols.insert( lower );
+      symbols.insert( upper );
+
+      if( region == Interior ){
+        constraints.push_back( SSTR( lower << " + " << widths[d].first << " <= " << iterator << " <= " << upper << " - " << widths[d].second ) );
+      } else {
+        constraints.push_back( SSTR( lower << " <= " << iterator << " <= " << upper ) );
+      }
+
+      // Iterations within the halo width of the owned elements' edges
+      if( widths[d].first > 0 ){
+        boundary << (boundary.str().empty()? "" : " or ") << iterator << " < " << lower << " + " << widths[d].first;
+      }
+      if( widths[d].second > 0 ){
+        boundary << (boundary.str().empty()? "" : " or ") << iterator << " > " << upper << " - " << widths[d].second;
+      }
+    }
+
+    if( region == Boundary ){
+      constraints.push_back( boundary.str().empty()? string( "1 = 0" ) : SSTR( "(" << boundary.str() << ")" ) );
+    }
+
+    local.append( LoopNest( PolyhedralDomain( domain.getIterators(), constraints, symbols ), dataspaces ) );
+  }
+
+  return local;
+}
+
+std::string DomainDecomposition::codegen( std::string transport, std::string halo_prefix ) const {
+  vector< set<string> > exchanges = this->exchanges();
+  ostringstream code;
+
+  // Every rank owns at least as many elements as the halos are wide (as HaloExchange requires)
+  vector<HaloExchange::size_type> widest( this->grid.size(), 1 );
+  for( LoopChain::size_type nest = 0; nest < this->chain.length(); nest += 1 ){
+    for( const auto& read : this->readWidths( nest ) ){
+      for( size_type d = 0; d < this->grid.size(); d += 1 ){
+        widest[d] = max( widest[d], max( read.second[d].first, read.second[d].second ) );
+      }
+    }
+  }
+  vector<string> context;
+  for( size_type d = 0; d < this->grid.size(); d += 1 ){
+    context.push_back( SSTR( DomainDecomposition::upperSymbol( d ) << " - " << DomainDecomposition::lowerSymbol( d ) << " + 1 >= " << widest[d] ) );
+  }
+  auto generate = [&]( LoopChain::size_type nest, Region region ){
+    Schedule schedule( this->localChain( nest, region ) );
+    for( const string& constraint : context ){
+      schedule.addContextConstraint( constraint );
+    }
+    return schedule.codegen();
+  };
+
+  for( LoopChain::size_type nest = 0; nest < this->chain.length(); nest += 1 ){
+    if( exchanges[nest].empty() ){
+      code << generate( nest, Owned );
+      continue;
+    }
+
+    // Overlap the exchange with the iterations that do not read the halos
+    for( const string& name : exchanges[nest] ){
+      code << halo_prefix << name << ".pack();\n";
+    }
+    for( const string& name : exchanges[nest] ){
+      code << halo_prefix << name << ".exchange( " << transport << " );\n";
+    }
+    code << generate( nest, Interior );
+    code << transport << ".wait();\n";
+    for( const string& name : exchanges[nest] ){
+      code << halo_prefix << name << ".unpack();\n";
+    }
+    code << generate( nest, Boundary );
+  }
+
+  return code.str();
+}
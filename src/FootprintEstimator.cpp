@@ -0,0 +1,256 @@
+/*! ****************************************************************************
+\file FootprintEstimator.cpp
+\authors Ian J. Bertolacci
+
+\brief
+Estimates the data touched by a tile of one or more (fused) loop nests.
+
+\copyright
+Copyright 2017 Universiy of Arizona
+*******************************************************************************/
+
+#include <LoopChainIR/FootprintEstimator.hpp>
+#include <LoopChainIR/util.hpp>
+#include <algorithm>
+#include <utility>
+
+using namespace std;
+using namespace LoopChainIR;
+
+namespace {
+
+  // Inclusive [lower, upper] extent of each dimension
+  typedef vector< pair<long long, long long> > Box;
+
+  // Bounding box of the elements access touches over the tile starting at origin.
+  Box touched( const AffineAccess& access, const FootprintEstimator::TileSizes& tile, const vector<long long>& origin ){
+    Box box;
+    for( AffineAccess::size_type row = 0; row < access.dimensions(); row += 1 ){
+      long long lower = access.offset()[row];
+      long long upper = access.offset()[row];
+      for( AffineAccess::size_type column = 0; column < access.iteratorDimensions(); column += 1 ){
+        long long coefficient = access.coefficient( row, column );
+        long long first = coefficient * origin[column];
+        long long last = coefficient * (origin[column] + (long long) tile[column] - 1);
+        lower += min( first, last );
+        upper += max( first, last );
+      }
+      box.push_back( make_pair( lower, upper ) );
+    }
+    return box;
+  }
+
+  // Number of elements in the union of boxes, counted over the grid formed by
+  // the boundaries of all the boxes.
+  long long unionVolume( vector<Box> boxes ){
+    sort( boxes.begin(), boxes.end() );
+    boxes.erase( unique( boxes.begin(), boxes.end() ), boxes.end() );
+    if( boxes.empty() ){
+      return 0;
+    }
+
+    Box::size_type dimensions = boxes.front().size();
+    vector< vector<long long> > boundaries( dimensions );
+    for( const Box& box : boxes ){
+      for( Box::size_type d = 0; d < dimensions; d += 1 ){
+        boundaries[d].push_back( box[d].first );
+        boundaries[d].push_back( box[d].second + 1 );
+      }
+    }
+    for( vector<long long>& boundary : boundaries ){
+      sort( boundary.begin(), boundary.end() );
+      boundary.erase( unique( boundary.begin(), boundary.end() ), boundary.end() );
+    }
+
+    long long volume = 0;
+    vector<Box::size_type> cell( dimensions, 0 );
+    while( true ){
+      // The cell is covered if any box contains its lower corner
+      bool covered = false;
+      for( Box::size_type b = 0; b < boxes.size() && !covered; b += 1 ){
+        covered = true;
+        for( Box::size_type d = 0; d < dimensions && covered; d += 1 ){
+          long long corner = boundaries[d][ cell[d] ];
+          covered = boxes[b][d].first <= corner && corner <= boxes[b][d].second;
+        }
+      }
+      if( covered ){
+        long long cell_volume = 1;
+        for( Box::size_type d = 0; d < dimensions; d += 1 ){
+          cell_volume *= boundaries[d][ cell[d] + 1 ] - boundaries[d][ cell[d] ];
+        }
+        volume += cell_volume;
+      }
+
+      // Next cell
+      Box::size_type d = 0;
+      while( d < dimensions && (cell[d] += 1) == boundaries[d].size() - 1 ){
+        cell[d] = 0;
+        d += 1;
+      }
+      if( d == dimensions ){
+        break;
+      }
+    }
+
+    return volume;
+  }
+
+}
+
+FootprintEstimator::FootprintEstimator( const LoopChain& chain, std::map<std::string, size_type> element_sizes, size_type default_element_size )
+: nest_accesses(), nest_dimensions(), element_sizes( std::move( element_sizes ) ), default_element_size( default_element_size )
+{
+  assertWithException( default_element_size >= 1, "Element size must be at least one byte" );
+  for( const auto& element_size : this->element_sizes ){
+    assertWithException( element_size.second >= 1, SSTR( "Element size of " << element_size.first << " must be at least one byte" ) );
+  }
+
+  for( LoopChain::size_type loop = 0; loop < chain.length(); loop += 1 ){
+    const LoopNest& nest = chain.getNest( loop );
+    map< string, vector<AffineAccess> > accesses;
+
+    for( const Dataspace& dataspace : nest.getDataspaces() ){
+      vector<AffineAccess>& dataspace_accesses = accesses[dataspace.name];
+      for( Tuple tuple : dataspace.reads() ){
+        dataspace_accesses.push_back( AffineAccess( tuple ) );
+      }
+      for( Tuple tuple : dataspace.writes() ){
+        dataspace_accesses.push_back( AffineAccess( tuple ) );
+      }
+      dataspace_accesses.insert( dataspace_accesses.end(), dataspace.affineReads().begin(), dataspace.affineReads().end() );
+      dataspace_accesses.insert( dataspace_accesses.end(), dataspace.affineWrites().begin(), dataspace.affineWrites().end() );
+      dataspace_accesses.insert( dataspace_accesses.end(), dataspace.reductionTargets().begin(), dataspace.reductionTargets().end() );
+
+      for( const AffineAccess& access : dataspace_accesses ){
+        assertWithException( access.iteratorDimensions() == nest.dimensions(),
+                             SSTR( "Access " << access << " of " << dataspace.name << " does not match the " << nest.dimensions() << " dimensions of loop " << loop ) );
+      }
+      if( dataspace_accesses.empty() ){
+        accesses.erase( dataspace.name );
+      }
+    }
+
+    this->nest_accesses.push_back( accesses );
+    this->nest_dimensions.push_back( nest.dimensions() );
+  }
+}
+
+FootprintEstimator::FootprintEstimator( const Schedule& schedule, std::map<std::string, size_type> element_sizes, size_type default_element_size )
+: FootprintEstimator( schedule.getChain(), std::move( element_sizes ), default_element_size )
+{ }
+
+FootprintEstimator::size_type FootprintEstimator::elementSize( const std::string& dataspace ) const {
+  map<string, size_type>::const_iterator element_size = this->element_sizes.find( dataspace );
+  return (element_size != this->element_sizes.end())? element_size->second : this->default_element_size;
+}
+
+std::map< std::string, std::vector<AffineAccess> > FootprintEstimator::accessesOf( const std::vector<LoopChain::size_type>& loops ) const {
+  assertWithException( !loops.empty(), "No loops to estimate" );
+
+  map< string, vector<AffineAccess> > accesses;
+  for( LoopChain::size_type loop : loops ){
+    assertWithException( loop < this->nest_accesses.size(), SSTR( "Loop " << loop << " is not in the chain" ) );
+    assertWithException( this->nest_dimensions[loop] == this->nest_dimensions[ loops.front() ],
+                         SSTR( "Loop " << loop << " does not have the dimensionality of loop " << loops.front() ) );
+
+    for( const auto& dataspace : this->nest_accesses[loop] ){
+      vector<AffineAccess>& dataspace_accesses = accesses[dataspace.first];
+      assertWithException( dataspace_accesses.empty() || dataspace_accesses.front().dimensions() == dataspace.second.front().dimensions(),
+                           SSTR( "Dataspace " << dataspace.first << " is accessed with different dimensionalities" ) );
+      dataspace_accesses.insert( dataspace_accesses.end(), dataspace.second.begin(), dataspace.second.end() );
+    }
+  }
+
+  return accesses;
+}
+
+FootprintEstimator::FootprintMap FootprintEstimator::estimate( const std::vector<LoopChain::size_type>& loops, const TileSizes& tile ) const {
+  map< string, vector<AffineAccess> > accesses = this->accessesOf( loops );
+  size_type dimensions = this->nest_dimensions[ loops.front() ];
+
+  assertWithException( tile.size() == dimensions,
+                       SSTR( "Tile has " << tile.size() << " dimensions, but the loops have " << dimensions ) );
+  for( size_type d = 0; d < dimensions; d += 1 ){
+    assertWithException( tile[d] >= 1, SSTR( "Tile size of dimension " << d << " must be positive" ) );
+  }
+
+  vector<long long> origin( dimensions, 0 );
+  // The tile before, along the innermost dimension
+  vector<long long> previous_origin( dimensions, 0 );
+  previous_origin.back() = -(long long) tile.back();
+  TileSizes point( dimensions, 1 );
+
+  FootprintMap footprints;
+  for( const auto& dataspace : accesses ){
+    vector<Box> current;
+    vector<Box> previous;
+    vector<Box> iteration;
+    for( const AffineAccess& access : dataspace.second ){
+      current.push_back( touched( access, tile, origin ) );
+      previous.push_back( touched( access, tile, previous_origin ) );
+      iteration.push_back( touched( access, point, origin ) );
+    }
+
+    // Intersections of each pair of boxes from the two tiles
+    vector<Box> shared;
+    for( const Box& mine : current ){
+      for( const Box& theirs : previous ){
+        Box both;
+        bool empty = false;
+        for( Box::size_type d = 0; d < mine.size(); d += 1 ){
+          both.push_back( make_pair( max( mine[d].first, theirs[d].first ), min( mine[d].second, theirs[d].second ) ) );
+          empty = empty || both.back().first > both.back().second;
+        }
+        if( !empty ){
+          shared.push_back( both );
+        }
+      }
+    }
+
+    size_type element_size = this->elementSize( dataspace.first );
+    Footprint footprint;
+    footprint.tile_bytes = (size_type) unionVolume( current ) * element_size;
+    footprint.reused_bytes = (size_type) unionVolume( shared ) * element_size;
+    footprint.iteration_bytes = (size_type) unionVolume( iteration ) * element_size;
+    footprints[dataspace.first] = footprint;
+  }
+
+  return footprints;
+}
+
+FootprintEstimator::FootprintMap FootprintEstimator::estimate( const std::vector<LoopChain::size_type>& loops, const TileTransformation::TileMap& tile ) const {
+  assertWithException( !loops.empty() && loops.front() < this->nest_dimensions.size(), "No loops to estimate" );
+  return this->estimate( loops, tileSizes( tile, this->nest_dimensions[ loops.front() ] ) );
+}
+
+FootprintEstimator::FootprintMap FootprintEstimator::estimate( LoopChain::size_type loop, const TileTransformation::TileMap& tile ) const {
+  return this->estimate( vector<LoopChain::size_type>( { loop } ), tile );
+}
+
+FootprintEstimator::size_type FootprintEstimator::tileBytes( const std::vector<LoopChain::size_type>& loops, const TileSizes& tile ) const {
+  return total( this->estimate( loops, tile ) ).tile_bytes;
+}
+
+FootprintEstimator::Footprint FootprintEstimator::total( const FootprintMap& footprints ){
+  Footprint sum = { 0, 0, 0 };
+  for( const auto& footprint : footprints ){
+    sum.tile_bytes += footprint.second.tile_bytes;
+    sum.reused_bytes += footprint.second.reused_bytes;
+    sum.iteration_bytes += footprint.second.iteration_bytes;
+  }
+  return sum;
+}
+
+FootprintEstimator::TileSizes FootprintEstimator::tileSizes( const TileTransformation::TileMap& tile, size_type dimensions ){
+  TileSizes sizes;
+  for( size_type d = 0; d < dimensions; d += 1 ){
+    TileTransformation::TileMap::const_iterator size = tile.find( d );
+    assertWithException( size != tile.end(), SSTR( "No tile size given for dimension " << d ) );
+    assertWithException( !size->second.empty() && size->second.find_first_not_of( "0123456789" ) == string::npos,
+                         SSTR( "Footprints require constant tile sizes, but dimension " << d << " has size " << size->second ) );
+    sizes.push_back( (size_type) stoul( size->second ) );
+  }
+  assertWithException( tile.size() == dimensions, SSTR( "Tile sizes given for more than " << dimensions << " dimensions" ) );
+  return sizes;
+}
@@ -0,0 +1,251 @@
+/*! ****************************************************************************
+\file HaloExchange.cpp
+\authors Ian J. Bertolacci
+
+\brief
+Runtime for the halo exchanges of domain decomposed loop chains.
+
+\copyright
+Copyright 2017 Universiy of Arizona
+*******************************************************************************/
+
+#include <LoopChainIR/HaloExchange.hpp>
+#include <LoopChainIR/util.hpp>
+#include <cstring>
+#include <set>
+
+using namespace std;
+using namespace LoopChainIR;
+
+HaloTransport::~HaloTransport(){ }
+
+LocalNetwork::LocalNetwork( int ranks )
+: rank_count( ranks ), mutex(), delivered(), mailboxes()
+{
+  assertWithException( ranks > 0, SSTR( "A network needs at least one rank, not " << ranks ) );
+}
+
+int LocalNetwork::ranks() const {
+  return this->rank_count;
+}
+
+LocalTransport::LocalTransport( LocalNetwork& network, int rank )
+: network( network ), rank_id( rank ), receives()
+{
+  assertWithException( 0 <= rank && rank < network.ranks(), SSTR( "Rank " << rank << " is not in a network of " << network.ranks() ) );
+}
+
+int LocalTransport::rank() const {
+  return this->rank_id;
+}
+
+int LocalTransport::ranks() const {
+  return this->network.ranks();
+}
+
+void LocalTransport::send( int to, int tag, const void* data, size_type bytes ){
+  assertWithException( 0 <= to && to < this->ranks(), SSTR( "Rank " << to << " is not in the network" ) );
+  const char* begin = static_cast<const char*>( data );
+  {
+    lock_guard<std::mutex> lock( this->network.mutex );
+    this->network.mailboxes[ make_tuple( this->rank_id, to, tag ) ].push_back( vector<char>( begin, begin + bytes ) );
+  }
+  this->network.delivered.notify_all();
+}
+
+void LocalTransport::receive( int from, int tag, void* data, size_type bytes ){
+  assertWithException( 0 <= from && from < this->ranks(), SSTR( "Rank " << from << " is not in the network" ) );
+  this->receives.push_back( Receive{ from, tag, data, bytes } );
+}
+
+void LocalTransport::wait(){
+  unique_lock<std::mutex> lock( this->network.mutex );
+  for( const Receive& receive : this->receives ){
+    deque< vector<char> >& mailbox = this->network.mailboxes[ make_tuple( receive.from, this->rank_id, receive.tag ) ];
+    this->network.delivered.wait( lock, [&](){ return !mailbox.empty(); } );
+
+    vector<char> message = std::move( mailbox.front() );
+    mailbox.pop_front();
+    assertWithException( message.size() == receive.bytes,
+                         SSTR( "Rank " << this->rank_id << " expected " << receive.bytes << " bytes from rank " << receive.from
+                               << " (tag " << receive.tag << "), but received " << message.size() ) );
+    memcpy( receive.data, message.data(), message.size() );
+  }
+  this->receives.clear();
+}
+
+std::pair<long, long> LoopChainIR::partitionRange( long lower, long upper, int parts, int part ){
+  assertWithException( 0 <= part && part < parts, SSTR( "Part " << part << " is not one of " << parts ) );
+  long size = upper - lower + 1;
+  return make_pair( lower + (size * part) / parts, lower + (size * (part + 1)) / parts - 1 );
+}
+
+HaloExchange::HaloExchange( void* data, size_type element_bytes, std::vector<size_type> owned, std::vector<HaloWidth> halo, std::vector<int> grid, int rank, int tag )
+: data( static_cast<char*>( data ) ), element_bytes( element_bytes ), owned( std::move( owned ) ), halo( std::move( halo ) ), sends(), receives()
+{
+  size_type dimensions = this->owned.size();
+  assertWithException( this->halo.size() == dimensions && grid.size() == dimensions,
+                       "Owned extents, halo widths and rank grid must have the same dimensionality" );
+
+  // Coordinate of this rank in the grid
+  int ranks = 1;
+  for( int extent : grid ){
+    ranks *= extent;
+  }
+  assertWithException( 0 <= rank && rank < ranks, SSTR( "Rank " << rank << " is not in a grid of " << ranks << " ranks" ) );
+  vector<int> coordinate( dimensions );
+  for( size_type d = dimensions, remaining = rank; d > 0; d -= 1 ){
+    coordinate[d-1] = remaining % grid[d-1];
+    remaining /= grid[d-1];
+  }
+
+  for( size_type d = 0; d < dimensions; d += 1 ){
+    assertWithException( grid[d] == 1 || (this->halo[d].first <= this->owned[d] && this->halo[d].second <= this->owned[d]),
+                         SSTR( "Halo of dimension " << d << " is wider than the " << this->owned[d] << " owned elements" ) );
+  }
+
+  int directions = 1;
+  for( size_type d = 0; d < dimensions; d += 1 ){
+    directions *= 3;
+  }
+
+  // Every neighbour, across faces, edges and corners
+  for( int direction = 0; direction < directions; direction += 1 ){
+    vector<int> step( dimensions );
+    int opposite = 0;
+    int neighbour = 0;
+    bool inside = true;
+    bool self = true;
+    for( size_type d = dimensions, remaining = direction; d > 0; d -= 1 ){
+      step[d-1] = (int)( remaining % 3 ) - 1;
+      remaining /= 3;
+    }
+    for( size_type d = 0; d < dimensions; d += 1 ){
+      int position = coordinate[d] + step[d];
+      inside = inside && 0 <= position && position < grid[d];
+      neighbour = neighbour * grid[d] + position;
+      opposite = opposite * 3 + (1 - step[d]);
+      self = self && step[d] == 0;
+    }
+    if( self || !inside ){
+      continue;
+    }
+
+    // The neighbour's halo facing this rank, and this rank's halo facing the neighbour
+    Region send{ neighbour, tag * directions + direction, vector<long>( dimensions ), vector<size_type>( dimensions ), vector<char>() };
+    Region receive{ neighbour, tag * directions + opposite, vector<long>( dimensions ), vector<size_type>( dimensions ), vector<char>() };
+    size_type send_elements = 1;
+    size_type receive_elements = 1;
+    for( size_type d = 0; d < dimensions; d += 1 ){
+      if( step[d] > 0 ){
+        send.first[d] = (long)( this->owned[d] - this->halo[d].first );
+        send.extent[d] = this->halo[d].first;
+        receive.first[d] = (long) this->owned[d];
+        receive.extent[d] = this->halo[d].second;
+      } else if( step[d] < 0 ){
+        send.first[d] = 0;
+        send.extent[d] = this->halo[d].second;
+        receive.first[d] = -(long) this->halo[d].first;
+        receive.extent[d] = this->halo[d].first;
+      } else if( grid[d] == 1 ){
+        // Not decomposed: the halos of this dimension are the neighbour's too
+        send.first[d] = -(long) this->halo[d].first;
+        send.extent[d] = this->halo[d].first + this->owned[d] + this->halo[d].second;
+        receive.first[d] = send.first[d];
+        receive.extent[d] = send.extent[d];
+      } else {
+        send.first[d] = 0;
+        send.extent[d] = this->owned[d];
+        receive.first[d] = 0;
+        receive.extent[d] = this->owned[d];
+      }
+      send_elements *= send.extent[d];
+      receive_elements *= receive.extent[d];
+    }
+
+    if( send_elements > 0 ){
+      send.buffer.resize( send_elements * element_bytes );
+      this->sends.push_back( std::move( send ) );
+    }
+    if( receive_elements > 0 ){
+      receive.buffer.resize( receive_elements * element_bytes );
+      this->receives.push_back( std::move( receive ) );
+    }
+  }
+}
+
+HaloExchange::size_type HaloExchange::neighbours() const {
+  set<int> neighbours;
+  for( const Region& region : this->sends ){
+    neighbours.insert( region.neighbour );
+  }
+  for( const Region& region : this->receives ){
+    neighbours.insert( region.neighbour );
+  }
+  return neighbours.size();
+}
+
+HaloExchange::size_type HaloExchange::offset( const std::vector<long>& coordinate ) const {
+  size_type offset = 0;
+  for( size_type d = 0; d < this->owned.size(); d += 1 ){
+    size_type extent = this->halo[d].first + this->owned[d] + this->halo[d].second;
+    offset = offset * extent + (size_type)( coordinate[d] + (long) this->halo[d].first );
+  }
+  return offset;
+}
+
+void HaloExchange::copy( Region& region, bool to_buffer ){
+  size_type dimensions = this->owned.size();
+  if( dimensions == 0 ){
+    return;
+  }
+
+  // Rows of the innermost dimension are contiguous
+  size_type row_bytes = region.extent.back() * this->element_bytes;
+  vector<long> coordinate( region.first );
+  char* buffer = region.buffer.data();
+  while( true ){
+    char* element = this->data + this->offset( coordinate ) * this->element_bytes;
+    if( to_buffer ){
+      memcpy( buffer, element, row_bytes );
+    } else {
+      memcpy( element, buffer, row_bytes );
+    }
+    buffer += row_bytes;
+
+    // Next row
+    size_type d = dimensions - 1;
+    while( d > 0 ){
+      coordinate[d-1] += 1;
+      if( coordinate[d-1] < region.first[d-1] + (long) region.extent[d-1] ){
+        break;
+      }
+      coordinate[d-1] = region.first[d-1];
+      d -= 1;
+    }
+    if( d == 0 ){
+      break;
+    }
+  }
+}
+
+void HaloExchange::pack(){
+  for( Region& region : this->sends ){
+    this->copy( region, true );
+  }
+}
+
+void HaloExchange::exchange( HaloTransport& transport ){
+  for( Region& region : this->receives ){
+    transport.receive( region.neighbour, region.tag, region.buffer.data(), region.buffer.size() );
+  }
+  for( Region& region : this->sends ){
+    transport.send( region.neighbour, region.tag, region.buffer.data(), region.buffer.size() );
+  }
+}
+
+void HaloExchange::unpack(){
+  for( Region& region : this->receives ){
+    this->copy( region, false );
+  }
+}
@@ -0,0 +1,108 @@
+/*! ****************************************************************************
+\file HierarchicalTileTransformation.cpp
+\authors Ian J. Bertolacci
+
+\brief
+Multi-level tiling of a loop nest, with one level of tiles per cache of the
+host.
+
+\copyright
+Copyright 2017 Universiy of Arizona
+*******************************************************************************/
+
+#include <LoopChainIR/HierarchicalTileTransformation.hpp>
+#include <LoopChainIR/ParallelAnnotation.hpp>
+#include <LoopChainIR/util.hpp>
+#include <algorithm>
+#include <memory>
+
+using namespace std;
+using namespace LoopChainIR;
+
+HierarchicalTileTransformation::HierarchicalTileTransformation( const LoopChain& chain, LoopChain::size_type loop, const CacheHierarchy& caches,
+                                                                TileSizeSelector::size_type element_size, TileSizeSelector::size_type simd_width,
+                                                                bool parallel )
+: loop( loop ), levels(), parallel( parallel )
+{
+  // A shared cache is split between the cores working on tiles in parallel,
+  // but is never less than the private cache inside it.
+  vector<TileSizeSelector::size_type> cache_bytes;
+  for( const CacheLevel& cache : caches ){
+    cache_bytes.push_back( max( cache.sizePerCore(), cache_bytes.empty()? 0 : cache_bytes.back() ) );
+  }
+
+  TileSizeSelector selector( chain, loop, element_size, simd_width );
+  for( TileSizeSelector::TileSizes tile : selector.select( cache_bytes ) ){
+    // Each tile is made of whole tiles of the level inside it
+    if( !this->levels.empty() ){
+      const TileSizeSelector::TileSizes& inner = this->levels.back();
+      for( TileSizeSelector::size_type d = 0; d < tile.size(); d += 1 ){
+        tile[d] = max( inner[d], tile[d] - tile[d] % inner[d] );
+      }
+    }
+    // A cache that does not allow a larger tile adds nothing but loop overhead
+    if( this->levels.empty() || this->levels.back() != tile ){
+      this->levels.push_back( tile );
+    }
+  }
+}
+
+HierarchicalTileTransformation::HierarchicalTileTransformation( LoopChain::size_type loop, std::vector<TileSizeSelector::TileSizes> levels, bool parallel )
+: loop( loop ), levels( std::move( levels ) ), parallel( parallel )
+{
+  assertWithException( !this->levels.empty(), "Hierarchical tiling requires at least one level" );
+  for( size_type level = 1; level < this->levels.size(); level += 1 ){
+    const TileSizeSelector::TileSizes& inner = this->levels[level - 1];
+    const TileSizeSelector::TileSizes& outer = this->levels[level];
+    assertWithException( inner.size() == outer.size(),
+                         SSTR( "Tiling level " << level << " has " << outer.size() << " dimensions, but level " << (level - 1) << " has " << inner.size() ) );
+    for( TileSizeSelector::size_type d = 0; d < outer.size(); d += 1 ){
+      assertWithException( inner[d] >= 1 && outer[d] % inner[d] == 0,
+                           SSTR( "Tile size " << outer[d] << " of level " << level << " is not a multiple of " << inner[d] << " in dimension " << d ) );
+    }
+  }
+}
+
+LoopChain::size_type HierarchicalTileTransformation::getLoopId() const {
+  return this->loop;
+}
+
+HierarchicalTileTransformation::size_type HierarchicalTileTransformation::depth() const {
+  return this->levels.size();
+}
+
+const std::vector<TileSizeSelector::TileSizes>& HierarchicalTileTransformation::getLevels() const {
+  return this->levels;
+}
+
+bool HierarchicalTileTransformation::isParallel() const {
+  return this->parallel;
+}
+
+std::vector<std::string> HierarchicalTileTransformation::apply( Schedule& schedule ){
+  return this->apply( schedule, schedule.getSubspaceManager().get_nest() );
+}
+
+std::vector<std::string> HierarchicalTileTransformation::apply( Schedule& schedule, Subspace* subspace ){
+  // Build the tilings from the innermost level out, each tiling within the tiles of the next.
+  unique_ptr<ParallelAnnotation> annotation;
+  vector< unique_ptr<TileTransformation> > owned;
+  TileTransformation* tiling = NULL;
+  for( size_type level = 0; level < this->levels.size(); level += 1 ){
+    vector<Transformation*> over_tiles;
+    vector<Transformation*> within_tiles;
+
+    if( level == this->levels.size() - 1 && this->parallel ){
+      annotation.reset( new ParallelAnnotation() );
+      over_tiles.push_back( annotation.get() );
+    }
+    if( tiling != NULL ){
+      within_tiles.push_back( tiling );
+    }
+
+    owned.emplace_back( new TileTransformation( this->loop, TileSizeSelector::tileMap( this->levels[level] ), over_tiles, within_tiles ) );
+    tiling = owned.back().get();
+  }
+
+  return tiling->apply( schedule, subspace );
+}
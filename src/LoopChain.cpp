@@ -12,39 +12,70 @@ Copyright 2015-2016 Colorado State University
 #include <LoopChainIR/LoopChain.hpp>
 #include <LoopChainIR/util.hpp>
 #include <algorithm>
+#include <utility>
 
 using namespace LoopChainIR;
 
 LoopChain::LoopChain()
-  : chain()
+  : chain(), time()
   { }
 
 LoopChain::LoopChain( const LoopChain& chain )
-  : chain(chain.chain)
+  : chain(chain.chain), time(chain.time)
   { }
 
+LoopChain::LoopChain( LoopChain&& chain )
+  : chain( std::move( chain.chain ) ), time( std::move( chain.time ) )
+  { }
+
+LoopChain& LoopChain::operator=( LoopChain&& chain ){
+  this->chain = std::move( chain.chain );
+  this->time = std::move( chain.time );
+  return *this;
+}
+
 void LoopChain::append( LoopNest nest ){
-  this->chain.push_back( nest );
+  this->chain.push_back( std::move( nest ) );
 }
 
 LoopNest& LoopChain::getNest( LoopChain::size_type index ){
   return this->chain[index];
 }
 
+const LoopNest& LoopChain::getNest( LoopChain::size_type index ) const {
+  return this->chain[index];
+}
+
 LoopChain::size_type LoopChain::length() const {
   return this->chain.size();
 }
 
-RectangularDomain::size_type LoopChain::maxDimension(){
+RectangularDomain::size_type LoopChain::maxDimension() const {
   RectangularDomain::size_type maximum = 0;
 
-  for( std::vector<LoopNest>::iterator iter = this->chain.begin(); iter != this->chain.end(); iter++ ){
-    maximum = std::max( (*iter).getDomain().dimensions(), maximum );
+  for( std::vector<LoopNest>::const_iterator iter = this->chain.begin(); iter != this->chain.end(); iter++ ){
+    maximum = std::max( (*iter).dimensions(), maximum );
   }
 
   return maximum;
 }
 
+void LoopChain::setTimeDomain( RectangularDomain domain ){
+  assertWithException( domain.dimensions() == 1,
+                       SSTR( "Time domain must have one dimension, not " << domain.dimensions() ) );
+  this->time.clear();
+  this->time.push_back( std::move( domain ) );
+}
+
+bool LoopChain::hasTimeDomain() const {
+  return !this->time.empty();
+}
+
+const RectangularDomain& LoopChain::getTimeDomain() const {
+  assertWithException( this->hasTimeDomain(), "Chain has no time domain" );
+  return this->time.front();
+}
+
 LoopChain::iterator LoopChain::begin(){
   return this->chain.begin();
 }
@@ -12,40 +12,103 @@ Copyright 2015-2016 Colorado State University
 
 #include <LoopChainIR/LoopNest.hpp>
 #include <LoopChainIR/util.hpp>
+#include <utility>
 
 using namespace LoopChainIR;
 
 LoopNest::LoopNest( RectangularDomain loop_bounds )
-: bounds( loop_bounds ), dataspaces( )
+: LoopNest( std::move( loop_bounds ), std::list<Dataspace>() )
 { }
 
 LoopNest::LoopNest( RectangularDomain loop_bounds, std::list<Dataspace> dataspaces )
-: bounds( loop_bounds ), dataspaces( dataspaces )
+: bounds( std::move( loop_bounds ) ), polyhedral_bounds( this->bounds ), rectangular( true ), dataspaces( std::move( dataspaces ) )
 { }
 
+LoopNest::LoopNest( PolyhedralDomain loop_bounds )
+: LoopNest( std::move( loop_bounds ), std::list<Dataspace>() )
+{ }
+
+LoopNest::LoopNest( PolyhedralDomain loop_bounds, std::list<Dataspace> dataspaces )
+: bounds( std::vector<std::string>(), std::vector<std::string>(), loop_bounds.getSymbols() ),
+  polyhedral_bounds( std::move( loop_bounds ) ), rectangular( false ), dataspaces( std::move( dataspaces ) )
+{ }
+
+bool LoopNest::isRectangular() const {
+  return this->rectangular;
+}
+
+RectangularDomain::size_type LoopNest::dimensions() const {
+  return this->polyhedral_bounds.dimensions();
+}
+
 RectangularDomain& LoopNest::getDomain(){
+  assertWithException( this->isRectangular(), "Loop nest does not have a rectangular domain." );
+  return this->bounds;
+}
+
+const RectangularDomain& LoopNest::getDomain() const {
+  assertWithException( this->isRectangular(), "Loop nest does not have a rectangular domain." );
   return this->bounds;
 }
 
-std::list<Dataspace> LoopNest::getDataspaces() const {
-  return std::list<Dataspace>( this->dataspaces );
+PolyhedralDomain& LoopNest::getPolyhedralDomain(){
+  return this->polyhedral_bounds;
+}
+
+const PolyhedralDomain& LoopNest::getPolyhedralDomain() const {
+  return this->polyhedral_bounds;
+}
+
+const std::list<Dataspace>& LoopNest::getDataspaces() const {
+  return this->dataspaces;
 }
 
 void LoopNest::replaceDataspaces( std::list<Dataspace> dataspaces ) {
-  this->dataspaces.clear();
-  this->dataspaces.insert( this->dataspaces.begin(), dataspaces.begin(), dataspaces.end() );
+  this->dataspaces = std::move( dataspaces );
 }
 
-void LoopNest::shiftDataspaces( Tuple extent ){
+void LoopNest::shiftDataspaces( const Tuple& extent ){
   std::list<Dataspace> shifted_dataspaces;
+  for( const Dataspace& dataspace : this->dataspaces ){
+    shifted_dataspaces.push_back( dataspace.shifted( extent ) );
+  }
+
+  this->replaceDataspaces( std::move( shifted_dataspaces ) );
+}
+
+std::vector<DependenceDistance> LoopChainIR::dependenceDistances( const LoopNest& earlier, const LoopNest& later ){
+  for( const LoopNest* nest : { &earlier, &later } ){
+    for( const Dataspace& dataspace : nest->getDataspaces() ){
+      assertWithException( !dataspace.hasAffineAccesses() && !dataspace.isReduction(),
+                           SSTR( "Distances of the accesses to " << dataspace.name << " are unknown" ) );
+    }
+  }
+
+  std::vector<DependenceDistance> distances;
+  for( const Dataspace& earlier_dataspace : earlier.getDataspaces() ){
+    for( const Dataspace& later_dataspace : later.getDataspaces() ){
+      if( earlier_dataspace.name != later_dataspace.name ){
+        continue;
+      }
+
+      // Iteration i of earlier and j of later access the same element when j - i = earlier_access - later_access
+      auto pair = [&]( DependenceDistance::Kind kind, const TupleCollection& from, const TupleCollection& to ){
+        for( const Tuple& earlier_access : from ){
+          for( const Tuple& later_access : to ){
+            std::vector<int> distance( earlier_access.dimensions() );
+            for( Tuple::size_type d = 0; d < earlier_access.dimensions(); d += 1 ){
+              distance[d] = earlier_access[d] - later_access[d];
+            }
+            distances.push_back( DependenceDistance{ earlier_dataspace.name, kind, Tuple( distance ) } );
+          }
+        }
+      };
 
-  for( Dataspace& dataspace : this->dataspaces ){
-    TupleCollection reads = dataspace.reads();
-    TupleCollection writes = dataspace.writes();
-    reads.shiftAll( extent );
-    writes.shiftAll( extent );
-    shifted_dataspaces.push_back( Dataspace( dataspace.name, reads, writes ) );
+      pair( DependenceDistance::Flow, earlier_dataspace.writes(), later_dataspace.reads() );
+      pair( DependenceDistance::Output, earlier_dataspace.writes(), later_dataspace.writes() );
+      pair( DependenceDistance::Anti, earlier_dataspace.reads(), later_dataspace.writes() );
+    }
   }
 
-  this->replaceDataspaces( shifted_dataspaces );
+  return distances;
 }
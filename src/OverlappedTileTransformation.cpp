@@ -0,0 +1,217 @@
+/*! ****************************************************************************
+\file OverlappedTileTransformation.cpp
+\authors Ian J. Bertolacci
+
+\brief
+Tile consecutive producer/consumer nests with overlapping tiles, recomputing
+the producers' halos in every tile.
+
+\copyright
+Copyright 2017 Universiy of Arizona
+*******************************************************************************/
+
+#include <LoopChainIR/OverlappedTileTransformation.hpp>
+#include <LoopChainIR/util.hpp>
+#include <algorithm>
+#include <set>
+#include <sstream>
+
+using namespace std;
+using namespace LoopChainIR;
+
+OverlappedTileTransformation::OverlappedTileTransformation( std::vector<LoopChain::size_type> nests, std::vector<int> tile_sizes, std::vector<Transformation*> over_tiles )
+: nests( std::move( nests ) ), tile_sizes( std::move( tile_sizes ) ), over_tiles( std::move( over_tiles ) )
+{
+  assertWithException( !this->nests.empty(), "Must tile at least one loop" );
+  for( std::vector<LoopChain::size_type>::size_type n = 1; n < this->nests.size(); n += 1 ){
+    assertWithException( this->nests[n] == this->nests[n-1] + 1,
+                         SSTR( "Overlapped loops must be consecutive, but loop " << this->nests[n] << " follows loop " << this->nests[n-1] ) );
+  }
+  assertWithException( !this->tile_sizes.empty(), "Must tile at least one dimension of the loops" );
+  for( int size : this->tile_sizes ){
+    assertWithException( size > 0, SSTR( "Tile size must be positive, not " << size ) );
+  }
+}
+
+const std::vector<LoopChain::size_type>& OverlappedTileTransformation::getNests() const {
+  return this->nests;
+}
+
+const std::vector<int>& OverlappedTileTransformation::getTileSizes() const {
+  return this->tile_sizes;
+}
+
+std::vector< std::vector<OverlappedTileTransformation::Halo> > OverlappedTileTransformation::halos( const LoopChain& chain, const std::vector<LoopChain::size_type>& nests, size_type dimensions ){
+  // Nest of the group writing each dataspace
+  map<string, LoopChain::size_type> writers;
+  set<string> read;
+  for( LoopChain::size_type loop : nests ){
+    assertWithException( loop < chain.length(), SSTR( "Loop " << loop << " is not in the chain" ) );
+    const LoopNest& nest = chain.getNest( loop );
+    assertWithException( nest.dimensions() >= dimensions, SSTR( "Loop " << loop << " has fewer than " << dimensions << " dimensions" ) );
+
+    // Repeated iterations must store the same values
+    for( const DependenceDistance& dependence : dependenceDistances( nest, nest ) ){
+      assertWithException( dependence.kind == DependenceDistance::Output,
+                           SSTR( "Loop " << loop << " overwrites " << dependence.dataspace << ", which it reads" ) );
+    }
+    for( const Dataspace& dataspace : nest.getDataspaces() ){
+      if( dataspace.reads().size() > 0 ){
+        read.insert( dataspace.name );
+      }
+    }
+    for( const Dataspace& dataspace : nest.getDataspaces() ){
+      if( dataspace.writes().size() == 0 ){
+        continue;
+      }
+      // Otherwise disjoint regions could store to the same element, and the
+      // last store to it would depend on the order of the tiles
+      assertWithException( dataspace.writes().size() == 1,
+                           SSTR( "Loop " << loop << " writes " << dataspace.name << " at more than one offset" ) );
+      map<string, LoopChain::size_type>::const_iterator writer = writers.find( dataspace.name );
+      assertWithException( writer == writers.end(),
+                           SSTR( "Loops " << ((writer != writers.end())? writer->second : loop) << " and " << loop << " both write " << dataspace.name ) );
+      assertWithException( read.count( dataspace.name ) == 0,
+                           SSTR( "Loop " << loop << " overwrites " << dataspace.name << ", which is read before it" ) );
+      writers[dataspace.name] = loop;
+    }
+  }
+
+  // From the last nest back, each producer covers the regions of the nests reading it
+  std::vector< std::vector<Halo> > halos( nests.size(), std::vector<Halo>( dimensions, Halo( 0, 0 ) ) );
+  for( std::vector<Halo>::size_type consumer = nests.size(); consumer > 0; consumer -= 1 ){
+    for( std::vector<Halo>::size_type producer = 0; producer < consumer - 1; producer += 1 ){
+      // Iteration j of the consumer reads the element written by iteration j - distance of the producer
+      for( const DependenceDistance& dependence : dependenceDistances( chain.getNest( nests[producer] ), chain.getNest( nests[consumer-1] ) ) ){
+        if( dependence.kind != DependenceDistance::Flow ){
+          continue;
+        }
+        for( size_type d = 0; d < dimensions; d += 1 ){
+          halos[producer][d].first = max( halos[producer][d].first, halos[consumer-1][d].first + dependence.distance[d] );
+          halos[producer][d].second = max( halos[producer][d].second, halos[consumer-1][d].second - dependence.distance[d] );
+        }
+      }
+    }
+  }
+
+  return halos;
+}
+
+double OverlappedTileTransformation::redundancyRatio( const LoopChain& chain, const std::vector<LoopChain::size_type>& nests, const std::vector<int>& tile_sizes ){
+  std::vector< std::vector<Halo> > halos = OverlappedTileTransformation::halos( chain, nests, tile_sizes.size() );
+
+  double executed = 0;
+  double tile = 1;
+  for( int size : tile_sizes ){
+    tile *= size;
+  }
+  for( const std::vector<Halo>& halo : halos ){
+    double region = 1;
+    for( size_type d = 0; d < tile_sizes.size(); d += 1 ){
+      region *= tile_sizes[d] + halo[d].first + halo[d].second;
+    }
+    executed += region;
+  }
+
+  return executed / (tile * halos.size());
+}
+
+double OverlappedTileTransformation::redundancyRatio( const LoopChain& chain ) const {
+  return OverlappedTileTransformation::redundancyRatio( chain, this->nests, this->tile_sizes );
+}
+
+std::vector<int> OverlappedTileTransformation::phaseStrides( const std::vector< std::vector<Halo> >& halos, const std::vector<int>& tile_sizes ){
+  // Regions of tiles T and T + stride of a nest are disjoint when size*stride > size - 1 + halo.first + halo.second
+  std::vector<int> strides( tile_sizes.size(), 1 );
+  for( const std::vector<Halo>& halo : halos ){
+    for( size_type d = 0; d < tile_sizes.size(); d += 1 ){
+      strides[d] = max( strides[d], (tile_sizes[d] - 1 + halo[d].first + halo[d].second) / tile_sizes[d] + 1 );
+    }
+  }
+  return strides;
+}
+
+std::vector<std::string> OverlappedTileTransformation::apply( Schedule& schedule ){
+  return this->apply( schedule, schedule.getSubspaceManager().get_nest() );
+}
+
+std::vector<std::string> OverlappedTileTransformation::apply( Schedule& schedule, Subspace* subspace ){
+  std::vector< std::vector<Halo> > halos = OverlappedTileTransformation::halos( schedule.getChain(), this->nests, this->tile_sizes.size() );
+  std::vector<int> strides = OverlappedTileTransformation::phaseStrides( halos, this->tile_sizes );
+
+  SubspaceManager& manager = schedule.getSubspaceManager();
+  Subspace* loops = manager.get_loops();
+  assertWithException( subspace != loops && subspace->size() >= this->tile_sizes.size(),
+                       "Tiling more dimensions than exist in the subspace." );
+
+  // Subspace of the tiles, with the nest's position in the group as its constant iterator
+  Subspace* tiles = new Subspace( manager.get_safe_prefix( "o" ), this->tile_sizes.size(), *subspace );
+  manager.insert_left( tiles, manager.get_iterator_to_subspace( subspace ) );
+
+  // Subspace of the phases, each executing tiles whose regions do not overlap
+  Subspace* phases = new Subspace( manager.get_safe_prefix( "q" ), this->tile_sizes.size(), *subspace );
+  manager.insert_left( phases, manager.get_iterator_to_subspace( tiles ) );
+
+  loops->set_aliased();
+  phases->set_aliased();
+  tiles->set_aliased();
+  subspace->set_aliased();
+
+  std::string header = SSTR( "[" << manager.get_input_iterators() << "] -> [" << manager.get_output_iterators() << "] : " );
+
+  // identity map subspace
+  std::ostringstream identity;
+  for( Subspace::size_type i = 0; i < subspace->complete_size(); ++i ){
+    identity << " and " << subspace->get( i, true ) << " = " << subspace->get( i, false );
+  }
+
+  // Phase of a tile: its position modulo the strides
+  std::ostringstream phase;
+  phase << " and " << phases->get( phases->const_index, true ) << " = 0";
+  for( size_type d = 0; d < this->tile_sizes.size(); d += 1 ){
+    phase << " and " << phases->get( d, true ) << " = " << tiles->get( d, true ) << " mod " << strides[d];
+  }
+
+  std::ostringstream transformation;
+  transformation << "{";
+  // An iteration belongs to every tile whose region (of its nest) contains it
+  for( std::vector<LoopChain::size_type>::size_type n = 0; n < this->nests.size(); n += 1 ){
+    transformation << "\n\t" << header << "\n\t\t"
+                   << loops->get( loops->const_index, false ) << " = " << this->nests[n] << " and "
+                   << loops->get( loops->const_index, true ) << " = " << this->nests.front() << " and "
+                   << tiles->get( tiles->const_index, true ) << " = " << n << phase.str();
+    for( size_type d = 0; d < this->tile_sizes.size(); d += 1 ){
+      transformation << " and " << this->tile_sizes[d] << "*" << tiles->get( d, true ) << " - " << halos[n][d].first
+                     << " <= " << subspace->get( d, false ) << " <= "
+                     << this->tile_sizes[d] << "*" << tiles->get( d, true ) << " + " << (this->tile_sizes[d] - 1 + halos[n][d].second);
+    }
+    transformation << identity.str() << ";";
+  }
+
+  // Identity map other loops
+  transformation << "\n\t" << header << "\n\t\t"
+                 << "(" << loops->get( loops->const_index, false ) << " < " << this->nests.front() << " or "
+                 << loops->get( loops->const_index, false ) << " > " << this->nests.back() << ") and "
+                 << loops->get( loops->const_index, true ) << " = " << loops->get( loops->const_index, false );
+  for( Subspace::size_type i = 0; i < phases->complete_size(); ++i ){
+    transformation << " and " << phases->get( i, true ) << " = 0";
+  }
+  for( Subspace::size_type i = 0; i < tiles->complete_size(); ++i ){
+    transformation << " and " << tiles->get( i, true ) << " = 0";
+  }
+  transformation << identity.str() << ";\n};";
+
+  std::vector<std::string> transformations;
+  transformations.push_back( transformation.str() );
+
+  manager.next_stage();
+  schedule.incrementDepth();
+  // Apply over tile transformations on the tile subspace, appending (in order) any new transformations created
+  for( Transformation* over_tile : this->over_tiles ){
+    std::vector<std::string> additional_transformations = over_tile->apply( schedule, tiles );
+    transformations.insert( transformations.end(), additional_transformations.begin(), additional_transformations.end() );
+  }
+  schedule.decrementDepth();
+
+  return transformations;
+}
@@ -1,14 +1,200 @@
 #include <LoopChainIR/ParallelAnnotation.hpp>
+#include <LoopChainIR/util.hpp>
+#include <sstream>
+#include <cstdlib>
+#include <cctype>
 
 using namespace LoopChainIR;
 using namespace std;
 
+namespace {
+
+  // A bound as an operand: parenthesized unless it is a number or a symbol
+  string operandText( const string& bound ){
+    bool simple = !bound.empty();
+    for( char c : bound ){
+      simple = simple && ( isalnum( c ) || c == '_' );
+    }
+    return (simple)? bound : "(" + bound + ")";
+  }
+
+  // Smallest (or largest) index of dimension row of access over domain
+  string extremeIndex( const AffineAccess& access, AffineAccess::size_type row, const RectangularDomain& domain, bool largest ){
+    ostringstream index;
+    bool empty = true;
+    for( AffineAccess::size_type column = 0; column < access.iteratorDimensions(); ++column ){
+      int coefficient = access.coefficient( row, column );
+      if( coefficient == 0 ){
+        continue;
+      }
+      const string& bound = ( (coefficient > 0) == largest )? domain.getUpperBound( column ) : domain.getLowerBound( column );
+      index << ( (coefficient < 0)? "-" : (empty? "" : "+") );
+      if( abs( coefficient ) != 1 ){
+        index << abs( coefficient ) << "*";
+      }
+      index << operandText( bound );
+      empty = false;
+    }
+    int offset = access.offset()[row];
+    if( offset != 0 || empty ){
+      index << ( (offset < 0)? "-" : (empty? "" : "+") ) << abs( offset );
+    }
+    return index.str();
+  }
+
+  /*
+  reduction(op:name) clause of a reduction dataspace of nest.
+  A single target s[0] is a scalar accumulator; otherwise the clause reduces
+  the array section covering the targets over the domain, e.g. r[1:N-1+1].
+  */
+  string reductionClause( const Dataspace& dataspace, const LoopNest& nest ){
+    const set<AffineAccess>& targets = dataspace.reductionTargets();
+    const AffineAccess& first = *targets.begin();
+
+    ostringstream clause;
+    clause << "reduction(" << reductionIdentifier( dataspace.reductionOperator() ) << ":" << dataspace.name;
+
+    bool scalar = targets.size() == 1 && first.dimensions() == 1 && first.offset()[0] == 0;
+    for( AffineAccess::size_type column = 0; scalar && column < first.iteratorDimensions(); ++column ){
+      scalar = first.coefficient( 0, column ) == 0;
+    }
+
+    if( !scalar ){
+      assertWithException( nest.isRectangular(),
+                           SSTR( "Cannot give the array section of reduction " << dataspace.name << " over a non-rectangular domain" ) );
+      const RectangularDomain& domain = nest.getDomain();
+      for( const AffineAccess& target : targets ){
+        assertWithException( target.hasSameLinearPart( first ) && target.iteratorDimensions() == domain.dimensions(),
+                             SSTR( "Cannot give an array section of the targets of reduction " << dataspace.name ) );
+      }
+      for( AffineAccess::size_type row = 0; row < first.dimensions(); ++row ){
+        const AffineAccess* lowest = &first;
+        const AffineAccess* highest = &first;
+        for( const AffineAccess& target : targets ){
+          lowest = ( target.offset()[row] < lowest->offset()[row] )? &target : lowest;
+          highest = ( target.offset()[row] > highest->offset()[row] )? &target : highest;
+        }
+        string lower = extremeIndex( *lowest, row, domain, false );
+        string upper = extremeIndex( *highest, row, domain, true );
+        clause << "[" << lower << ":" << upper << "-" << operandText( lower ) << "+1]";
+      }
+    }
+
+    clause << ")";
+    return clause.str();
+  }
+}
+
+OpenMPClauses::OpenMPClauses()
+: schedule_kind( DefaultSchedule ), chunk_size( "" ), collapse_depth( 1 ), thread_count( "" ), proc_bind( DefaultProcBind ), reductions()
+{ }
+
+OpenMPClauses& OpenMPClauses::schedule( ScheduleKind kind, std::string chunk ){
+  assertWithException( chunk.empty() || kind == Static || kind == Dynamic || kind == Guided,
+                       "A chunk size can only be given to static, dynamic or guided schedules." );
+  this->schedule_kind = kind;
+  this->chunk_size = chunk;
+  return *this;
+}
+
+OpenMPClauses& OpenMPClauses::collapse( unsigned int depth ){
+  assertWithException( depth >= 1, "Cannot collapse fewer than one loop." );
+  this->collapse_depth = depth;
+  return *this;
+}
+
+OpenMPClauses& OpenMPClauses::numThreads( std::string threads ){
+  this->thread_count = threads;
+  return *this;
+}
+
+OpenMPClauses& OpenMPClauses::procBind( ProcBind bind ){
+  this->proc_bind = bind;
+  return *this;
+}
+
+OpenMPClauses& OpenMPClauses::reduction( ReductionOperator op, std::string variable ){
+  assertWithException( !variable.empty(), "A reduction needs a variable." );
+  map<string, ReductionOperator>::const_iterator existing = this->reductions.find( variable );
+  if( existing != this->reductions.end() ){
+    assertWithException( existing->second == op,
+                         SSTR( "Cannot reduce " << variable << " with both " << reductionIdentifier( existing->second ) << " and " << reductionIdentifier( op ) ) );
+  }
+  this->reductions[variable] = op;
+  return *this;
+}
+
+OpenMPClauses::ScheduleKind OpenMPClauses::getSchedule() const {
+  return this->schedule_kind;
+}
+
+const std::string& OpenMPClauses::getChunk() const {
+  return this->chunk_size;
+}
+
+unsigned int OpenMPClauses::getCollapse() const {
+  return this->collapse_depth;
+}
+
+const std::string& OpenMPClauses::getNumThreads() const {
+  return this->thread_count;
+}
+
+OpenMPClauses::ProcBind OpenMPClauses::getProcBind() const {
+  return this->proc_bind;
+}
+
+const std::map<std::string, ReductionOperator>& OpenMPClauses::getReductions() const {
+  return this->reductions;
+}
+
+std::string OpenMPClauses::pragma() const {
+  ostringstream pragma;
+  pragma << "omp parallel for";
+
+  if( this->schedule_kind != DefaultSchedule ){
+    const char* kinds[] = { "", "static", "dynamic", "guided", "auto", "runtime" };
+    pragma << " schedule(" << kinds[this->schedule_kind];
+    if( !this->chunk_size.empty() ){
+      pragma << "," << this->chunk_size;
+    }
+    pragma << ")";
+  }
+
+  if( this->collapse_depth > 1 ){
+    pragma << " collapse(" << this->collapse_depth << ")";
+  }
+
+  if( !this->thread_count.empty() ){
+    pragma << " num_threads(" << this->thread_count << ")";
+  }
+
+  if( this->proc_bind != DefaultProcBind ){
+    const char* binds[] = { "", "master", "close", "spread" };
+    pragma << " proc_bind(" << binds[this->proc_bind] << ")";
+  }
+
+  for( const auto& reduction : this->reductions ){
+    pragma << " reduction(" << reductionIdentifier( reduction.second ) << ":" << reduction.first << ")";
+  }
+
+  return pragma.str();
+}
+
 ParallelAnnotation::ParallelAnnotation( )
 : ParallelAnnotation( (Subspace::size_type) 0 )
 { }
 
 ParallelAnnotation::ParallelAnnotation( Subspace::size_type additional_depth )
-: additional_depth( additional_depth )
+: ParallelAnnotation( additional_depth, OpenMPClauses() )
+{ }
+
+ParallelAnnotation::ParallelAnnotation( OpenMPClauses clauses )
+: ParallelAnnotation( (Subspace::size_type) 0, clauses )
+{ }
+
+ParallelAnnotation::ParallelAnnotation( Subspace::size_type additional_depth, OpenMPClauses clauses )
+: additional_depth( additional_depth ), clauses( clauses )
 { }
 
 std::vector<std::string> ParallelAnnotation::apply( Schedule& schedule ){
@@ -25,6 +211,30 @@ list of schedule (modifies schedule) given a particular subspace.
 The ISCC code as a string
 */
 std::vector<std::string> ParallelAnnotation::apply( Schedule& schedule, Subspace* subspace ){
-  schedule.addParallelSubspace( subspace, this->additional_depth );
+  // Indices of the targets are those of the untransformed nests
+  const LoopChain& chain = schedule.getChain();
+  NestReductions reductions;
+  for( LoopChain::size_type nest = 0; nest < chain.length(); ++nest ){
+    for( const Dataspace& dataspace : schedule.getOriginalDataspaces( nest ) ){
+      if( dataspace.isReduction() && this->clauses.getReductions().count( dataspace.name ) == 0 ){
+        reductions[nest][dataspace.name] = reductionClause( dataspace, chain.getNest( nest ) );
+      }
+    }
+  }
+
+  // The annotated loop and the loops it collapses must be in the nest
+  SubspaceManager& manager = schedule.getSubspaceManager();
+  Subspace::size_type loops = 0;
+  for( SubspaceManager::iterator it = manager.get_iterator_to_subspace( subspace ); it != manager.end(); ++it ){
+    loops += (*it)->size();
+  }
+  assertWithException( this->additional_depth + this->clauses.getCollapse() <= loops,
+                       SSTR( "Cannot collapse " << this->clauses.getCollapse() << " loops from loop " << this->additional_depth
+                             << " of the subspace; there are only " << loops << " loops from the subspace inwards" ) );
+
+  schedule.addParallelSubspace( subspace, this->additional_depth, this->clauses.pragma() );
+  if( !reductions.empty() ){
+    schedule.addParallelReductions( subspace, this->additional_depth, reductions );
+  }
   return std::vector<std::string>();
 }
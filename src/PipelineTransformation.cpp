@@ -0,0 +1,140 @@
+/*! ****************************************************************************
+\file PipelineTransformation.cpp
+\authors Ian J. Bertolacci
+
+\brief
+Execute consecutive loop nests as a pipeline over blocks of their outermost
+dimension, with OpenMP doacross (ordered depend) synchronization.
+
+\copyright
+Copyright 2017 Universiy of Arizona
+*******************************************************************************/
+
+#include <LoopChainIR/PipelineTransformation.hpp>
+#include <LoopChainIR/util.hpp>
+#include <algorithm>
+#include <sstream>
+#include <set>
+
+using namespace std;
+using namespace LoopChainIR;
+
+namespace {
+
+  /*
+  Largest outermost lag (iteration of earlier - iteration of later) of the
+  dependences of later on earlier.
+  Returns false if the nests do not depend on each other.
+  */
+  bool largestLag( const LoopNest& earlier, const LoopNest& later, int& lag ){
+    bool dependent = false;
+    for( const DependenceDistance& dependence : dependenceDistances( earlier, later ) ){
+      lag = dependent? max( lag, -dependence.distance[0] ) : -dependence.distance[0];
+      dependent = true;
+    }
+    return dependent;
+  }
+
+}
+
+PipelineTransformation::PipelineTransformation( std::vector<LoopChain::size_type> stages, int block_size, std::string clauses )
+: stages( std::move( stages ) ), block_size( block_size ), clauses( std::move( clauses ) )
+{
+  assertWithException( this->stages.size() >= 2, "A pipeline requires at least two loops" );
+  assertWithException( this->block_size > 0, SSTR( "Pipeline block size must be positive, not " << this->block_size ) );
+  for( std::vector<LoopChain::size_type>::size_type s = 1; s < this->stages.size(); s += 1 ){
+    assertWithException( this->stages[s] == this->stages[s-1] + 1,
+                         SSTR( "Pipelined loops must be consecutive, but loop " << this->stages[s] << " follows loop " << this->stages[s-1] ) );
+  }
+}
+
+const std::vector<LoopChain::size_type>& PipelineTransformation::getStages() const {
+  return this->stages;
+}
+
+int PipelineTransformation::getBlockSize() const {
+  return this->block_size;
+}
+
+std::vector<int> PipelineTransformation::blockOffsets( const LoopChain& chain, const std::vector<LoopChain::size_type>& stages, int block_size ){
+  for( LoopChain::size_type loop : stages ){
+    assertWithException( loop < chain.length(), SSTR( "Loop " << loop << " is not in the chain" ) );
+    assertWithException( chain.getNest( loop ).dimensions() > 0, SSTR( "Loop " << loop << " has no dimension to pipeline" ) );
+  }
+
+  // Blocks of the last stage run concurrently
+  const LoopNest& last = chain.getNest( stages.back() );
+  for( const DependenceDistance& dependence : dependenceDistances( last, last ) ){
+    assertWithException( dependence.distance[0] == 0,
+                         SSTR( "Blocks of the last pipelined loop " << stages.back() << " depend on each other through " << dependence.dataspace ) );
+  }
+
+  std::vector<int> offsets( stages.size(), 0 );
+  for( std::vector<int>::size_type s = 1; s < stages.size(); s += 1 ){
+    for( std::vector<int>::size_type r = 0; r < s; r += 1 ){
+      int lag = 0;
+      if( largestLag( chain.getNest( stages[r] ), chain.getNest( stages[s] ), lag ) ){
+        int blocks = (lag > 0)? (lag + block_size - 1) / block_size : 0;
+        offsets[s] = max( offsets[s], offsets[r] + blocks );
+      }
+    }
+  }
+
+  return offsets;
+}
+
+std::vector<std::string> PipelineTransformation::apply( Schedule& schedule ){
+  return this->apply( schedule, schedule.getSubspaceManager().get_nest() );
+}
+
+std::vector<std::string> PipelineTransformation::apply( Schedule& schedule, Subspace* subspace ){
+  std::vector<int> offsets = PipelineTransformation::blockOffsets( schedule.getChain(), this->stages, this->block_size );
+
+  SubspaceManager& manager = schedule.getSubspaceManager();
+  Subspace* loops = manager.get_loops();
+  assertWithException( subspace != loops && subspace->size() > 0, "Can only pipeline a subspace with variable iterators" );
+
+  // Subspace of the blocks, with the stage as its constant iterator
+  Subspace* blocks = new Subspace( manager.get_safe_prefix( "p" ), 1, *subspace );
+  manager.insert_left( blocks, manager.get_iterator_to_subspace( subspace ) );
+
+  loops->set_aliased();
+  blocks->set_aliased();
+  subspace->set_aliased();
+
+  std::string header = SSTR( "[" << manager.get_input_iterators() << "] -> [" << manager.get_output_iterators() << "] : " );
+
+  // identity map subspace
+  std::ostringstream identity;
+  for( Subspace::size_type i = 0; i < subspace->complete_size(); ++i ){
+    identity << " and " << subspace->get( i, true ) << " = " << subspace->get( i, false );
+  }
+
+  std::ostringstream transformation;
+  transformation << "{";
+  // All stages execute at the position of the first stage
+  for( std::vector<LoopChain::size_type>::size_type s = 0; s < this->stages.size(); s += 1 ){
+    transformation << "\n\t" << header << "\n\t\t"
+                   << loops->get( loops->const_index, false ) << " = " << this->stages[s] << " and "
+                   << loops->get( loops->const_index, true ) << " = " << this->stages.front() << " and "
+                   << blocks->get( 0, true ) << " = floor(" << subspace->get( 0, false ) << "/" << this->block_size << ") + " << offsets[s] << " and "
+                   << blocks->get( blocks->const_index, true ) << " = " << s
+                   << identity.str() << ";";
+  }
+
+  // Identity map non-pipelined loops
+  transformation << "\n\t" << header << "\n\t\t"
+                 << "(" << loops->get( loops->const_index, false ) << " < " << this->stages.front() << " or "
+                 << loops->get( loops->const_index, false ) << " > " << this->stages.back() << ") and "
+                 << loops->get( loops->const_index, true ) << " = " << loops->get( loops->const_index, false ) << " and "
+                 << blocks->get( 0, true ) << " = 0 and "
+                 << blocks->get( blocks->const_index, true ) << " = 0"
+                 << identity.str() << ";\n};";
+
+  // Only the last stage overlaps with later blocks
+  schedule.addDoacrossSubspace( blocks, 0, std::set<LoopChain::size_type>( this->stages.begin(), this->stages.end() ), { this->stages.back() }, this->clauses );
+
+  std::vector<std::string> transformations;
+  transformations.push_back( transformation.str() );
+  return transformations;
+}
@@ -0,0 +1,143 @@
+/*! ****************************************************************************
+\file PolyhedralDomain.cpp
+\authors Ian J. Bertolacci
+
+\brief
+Contains the bounds on a (possibly non-rectangular) loop nest.
+
+\copyright
+Copyright 2017 Universiy of Arizona
+*******************************************************************************/
+
+#include <LoopChainIR/PolyhedralDomain.hpp>
+#include <LoopChainIR/all_isl.hpp>
+#include <LoopChainIR/util.hpp>
+#include <sstream>
+#include <cstdlib>
+#include <utility>
+
+using namespace LoopChainIR;
+
+PolyhedralDomain::PolyhedralDomain( std::vector<std::string> iterators, std::vector<std::string> constraints, std::set<std::string> symbols )
+: iterators( std::move( iterators ) ), constraints( std::move( constraints ) ), symbols( std::move( symbols ) )
+{
+  assertWithException( this->iterators.size() >= 1, "Cannot have domain with fewer than one dimension" );
+
+  // Validate constraints
+  isl_ctx* ctx = isl_ctx_alloc();
+  isl_set* set = isl_set_read_from_str( ctx, this->getSet().c_str() );
+  bool valid = set != NULL;
+  if( valid ){
+    isl_set_free( set );
+  }
+  isl_ctx_free( ctx );
+
+  assertWithException( valid, SSTR( "Constraints do not form a valid domain: " << this->getSet() ) );
+}
+
+PolyhedralDomain::PolyhedralDomain( std::string set_string )
+: iterators(), constraints(), symbols()
+{
+  isl_ctx* ctx = isl_ctx_alloc();
+  isl_set* set = isl_set_read_from_str( ctx, set_string.c_str() );
+
+  if( set == NULL ){
+    isl_ctx_free( ctx );
+  }
+  assertWithException( set != NULL, SSTR( "Failed to read domain set: " << set_string ) );
+
+  // Extract iterator and symbol names.
+  unsigned dimensions = isl_set_dim( set, isl_dim_set );
+  for( unsigned d = 0; d < dimensions; d += 1 ){
+    if( !isl_set_has_dim_name( set, isl_dim_set, d ) ){
+      std::string name = SSTR( "i_" << d );
+      set = isl_set_set_dim_name( set, isl_dim_set, d, name.c_str() );
+    }
+    this->iterators.push_back( std::string( isl_set_get_dim_name( set, isl_dim_set, d ) ) );
+  }
+
+  unsigned parameters = isl_set_dim( set, isl_dim_param );
+  for( unsigned p = 0; p < parameters; p += 1 ){
+    this->symbols.insert( std::string( isl_set_get_dim_name( set, isl_dim_param, p ) ) );
+  }
+
+  // Print the set with the tuple name removed, and keep the text of its
+  // constraints (may contain existentials or disjunctions).
+  set = isl_set_reset_tuple_id( set );
+  isl_printer* p = isl_printer_to_str( ctx );
+  p = isl_printer_print_set( p, set );
+  char* set_text = isl_printer_get_str( p );
+  std::string printed( set_text );
+  free( set_text );
+  isl_printer_free( p );
+
+  isl_set_free( set );
+  isl_ctx_free( ctx );
+
+  assertWithException( dimensions >= 1, "Cannot have domain with fewer than one dimension" );
+
+  // Printed as "[params] -> { [iterators] : constraints }"
+  std::string::size_type tuple_end = printed.find( ']', printed.find( '{' ) );
+  std::string::size_type separator = printed.find( " : ", tuple_end );
+  if( separator != std::string::npos ){
+    std::string::size_type set_end = printed.rfind( '}' );
+    this->constraints.push_back( printed.substr( separator + 3, set_end - (separator + 3) - 1 ) );
+  }
+}
+
+PolyhedralDomain::PolyhedralDomain( const RectangularDomain& domain )
+: iterators(), constraints(), symbols( domain.getSymbols() )
+{
+  for( RectangularDomain::size_type d = 0; d < domain.dimensions(); d += 1 ){
+    std::string iterator = SSTR( "i_" << d );
+    this->iterators.push_back( iterator );
+    this->constraints.push_back( SSTR( domain.getLowerBound( d ) << " <= " << iterator << " <= " << domain.getUpperBound( d ) ) );
+    if( domain.getStride( d ) != "1" ){
+      this->constraints.push_back( SSTR( "(" << iterator << " - (" << domain.getLowerBound( d ) << ")) mod " << domain.getStride( d ) << " = 0" ) );
+    }
+  }
+}
+
+PolyhedralDomain::size_type PolyhedralDomain::dimensions() const {
+  return this->iterators.size();
+}
+
+PolyhedralDomain::size_type PolyhedralDomain::symbolics() const {
+  return this->symbols.size();
+}
+
+const std::vector<std::string>& PolyhedralDomain::getIterators() const {
+  return this->iterators;
+}
+
+const std::vector<std::string>& PolyhedralDomain::getConstraints() const {
+  return this->constraints;
+}
+
+const std::set<std::string>& PolyhedralDomain::getSymbols() const {
+  return this->symbols;
+}
+
+std::string PolyhedralDomain::getSet() const {
+  std::ostringstream set;
+
+  set << "[";
+  bool is_not_first_symbolic = false;
+  for( std::string symbol : this->symbols ){
+    set << (is_not_first_symbolic?",":"") << symbol;
+    is_not_first_symbolic = true;
+  }
+
+  set << "] -> { [";
+  for( size_type d = 0; d < this->iterators.size(); d += 1 ){
+    set << ((d > 0)?",":"") << this->iterators[d];
+  }
+  set << "] : ";
+
+  for( size_type c = 0; c < this->constraints.size(); c += 1 ){
+    set << ((c > 0)?" and ":"") << "(" << this->constraints[c] << ")";
+  }
+  set << " }";
+
+  return set.str();
+}
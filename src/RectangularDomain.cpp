@@ -7,6 +7,7 @@ Contains the bounds on a loop nest.
 Currently, bounds are represented simply as a string, containing only the
 expression that gives that bound. For example the bounds 0 <= x <= N+M would be
 "0" for the lower bound, and "N+M" for the upper bound.
+Each dimension may also have a (constant) stride.
 
 \copyright
 Copyright 2015-2016 Colorado State University
@@ -19,15 +20,28 @@ using namespace LoopChainIR;
 
 
 RectangularDomain::RectangularDomain( std::vector<std::string> lower_bounds, std::vector<std::string> upper_bounds, std::set<std::string> symbols )
-: upper_bounds( upper_bounds ), lower_bounds( lower_bounds ), symbols( symbols )
+: upper_bounds( std::move( upper_bounds ) ), lower_bounds( std::move( lower_bounds ) ), strides( this->lower_bounds.size(), "1" ), symbols( std::move( symbols ) )
 { }
 
+RectangularDomain::RectangularDomain( std::vector<std::string> lower_bounds, std::vector<std::string> upper_bounds, std::vector<std::string> strides, std::set<std::string> symbols )
+: upper_bounds( std::move( upper_bounds ) ), lower_bounds( std::move( lower_bounds ) ), strides( std::move( strides ) ), symbols( std::move( symbols ) )
+{
+  assertWithException( this->lower_bounds.size() == this->upper_bounds.size(), "Must have as many lower bounds as upper bounds" );
+  assertWithException( this->lower_bounds.size() == this->strides.size(), "Must have as many strides as bounds" );
+
+  for( const std::string& stride : this->strides ){
+    assertWithException( !stride.empty() && stride.find_first_not_of("0123456789") == std::string::npos && std::stoi( stride ) > 0,
+                         SSTR( "Stride must be a positive integer constant, but got " << stride ) );
+  }
+}
+
 RectangularDomain::RectangularDomain( std::vector< std::pair<std::string,std::string> > bounds, std::set<std::string> symbols )
-: upper_bounds(), lower_bounds(), symbols( symbols )
+: upper_bounds(), lower_bounds(), symbols( std::move( symbols ) )
 {
-  for( std::pair<std::string, std::string> bound_pair : bounds ){
+  for( const std::pair<std::string, std::string>& bound_pair : bounds ){
     this->lower_bounds.push_back( bound_pair.first );
     this->upper_bounds.push_back( bound_pair.second );
+    this->strides.push_back( "1" );
   }
 }
 
@@ -36,6 +50,7 @@ RectangularDomain::RectangularDomain( std::string input_lower_bounds, std::strin
 
   this->lower_bounds.push_back( input_lower_bounds );
   this->upper_bounds.push_back( input_upper_bounds );
+  this->strides.push_back( "1" );
 
 }
 
@@ -44,6 +59,7 @@ RectangularDomain::RectangularDomain( std::string input_lower_bounds, std::strin
 {
   this->lower_bounds.push_back( input_lower_bounds );
   this->upper_bounds.push_back( input_upper_bounds );
+  this->strides.push_back( "1" );
 }
 
 RectangularDomain::RectangularDomain( std::string input_lower_bounds[], std::string input_upper_bounds[], size_type dimensions ){
@@ -54,6 +70,7 @@ RectangularDomain::RectangularDomain( std::string input_lower_bounds[], std::str
   for( size_type d = 0; d < dimensions; d += 1 ){
     this->lower_bounds.push_back( input_lower_bounds[d] );
     this->upper_bounds.push_back( input_upper_bounds[d] );
+    this->strides.push_back( "1" );
   }
 
 }
@@ -67,6 +84,7 @@ RectangularDomain::RectangularDomain( std::string input_lower_bounds[], std::str
   for( size_type d = 0; d < dimensions; d += 1 ){
     this->lower_bounds.push_back( input_lower_bounds[d] );
     this->upper_bounds.push_back( input_upper_bounds[d] );
+    this->strides.push_back( "1" );
   }
 
   for( size_type d = 0; d < symbolics; d += 1 ){
@@ -85,34 +103,40 @@ RectangularDomain::RectangularDomain( std::string input_lower_bounds[], std::str
   for( size_type d = 0; d < dimensions; d += 1 ){
     this->lower_bounds.push_back( input_lower_bounds[d] );
     this->upper_bounds.push_back( input_upper_bounds[d] );
+    this->strides.push_back( "1" );
   }
 
 }
 
-void RectangularDomain::append( RectangularDomain other){
+void RectangularDomain::append( const RectangularDomain& other ){
   this->symbols.insert( other.symbols.begin(), other.symbols.end() );
   for( size_type d = 0; d < other.dimensions(); d += 1 ){
     this->lower_bounds.push_back( other.getLowerBound(d) );
     this->upper_bounds.push_back( other.getUpperBound(d) );
+    this->strides.push_back( other.getStride(d) );
   }
 }
 
-RectangularDomain::size_type RectangularDomain::dimensions(){
+RectangularDomain::size_type RectangularDomain::dimensions() const {
   return this->lower_bounds.size();
 }
 
-RectangularDomain::size_type RectangularDomain::symbolics(){
+RectangularDomain::size_type RectangularDomain::symbolics() const {
   return this->symbols.size();
 }
 
-std::string RectangularDomain::getUpperBound( RectangularDomain::size_type dimension ){
+const std::string& RectangularDomain::getUpperBound( RectangularDomain::size_type dimension ) const {
   return this->upper_bounds[dimension];
 }
 
-std::string RectangularDomain::getLowerBound( RectangularDomain::size_type dimension ){
+const std::string& RectangularDomain::getLowerBound( RectangularDomain::size_type dimension ) const {
   return this->lower_bounds[dimension];
 }
 
-std::set<std::string> RectangularDomain::getSymbols( ){
+const std::string& RectangularDomain::getStride( RectangularDomain::size_type dimension ) const {
+  return this->strides[dimension];
+}
+
+const std::set<std::string>& RectangularDomain::getSymbols( ) const {
   return this->symbols;
 }
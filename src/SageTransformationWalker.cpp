@@ -9,6 +9,7 @@
 
 #include <LoopChainIR/util.hpp>
 #include <LoopChainIR/SageTransformationWalker.hpp>
+#include <LoopChainIR/Schedule.hpp>
 #include <LoopChainIR/util.hpp>
 
 using namespace std;
@@ -1029,11 +1030,13 @@ SgNode* SageTransformationWalker::visit_node_for(isl_ast_node* node){
         //OmpSupport::addOmpAttribute( pragma, for_stmt );
         //OmpSupport::generatePragmaFromOmpAttribute( for_stmt );
 
-        // Manually create prama with literal "omp parallel for" invocation.
-        SgPragmaDeclaration* prama_decl = buildPragmaDeclaration( string("omp parallel for"), this->top() );
-        SageInterface::insertStatement( for_stmt, prama_decl );
-        if( this->verbose ){
-          cout << string(this->depth*2, ' ') << "pragma declaration @ " << static_cast<void*>( prama_decl ) << endl;
+        // Manually create pramas with the annotation's "omp parallel for ..." invocation.
+        for( const string& line : parallel_annotation_pragma_lines( maybe_annotation ) ){
+          SgPragmaDeclaration* prama_decl = buildPragmaDeclaration( line, this->top() );
+          SageInterface::insertStatement( for_stmt, prama_decl );
+          if( this->verbose ){
+            cout << string(this->depth*2, ' ') << "pragma declaration @ " << static_cast<void*>( prama_decl ) << endl;
+          }
         }
       }
     }
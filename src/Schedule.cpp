@@ -12,21 +12,29 @@ Copyright 2015-2016 Colorado State University
 #include <LoopChainIR/Schedule.hpp>
 #include <LoopChainIR/all_isl.hpp>
 #include <LoopChainIR/util.hpp>
+#include <algorithm>
+#include <cstddef>
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <cstdio>
+#include <cstdlib>
 #include <unistd.h>
+#include <utility>
 
 using namespace LoopChainIR;
 using namespace std;
 
 Schedule::Schedule( LoopChain& chain, std::string statement_prefix, std::string iterator_prefix ) :
-  chain(chain), statement_prefix(statement_prefix),
+  Schedule( LoopChain( chain ), statement_prefix, iterator_prefix )
+  { }
+
+Schedule::Schedule( LoopChain&& chain, std::string statement_prefix, std::string iterator_prefix ) :
+  chain( std::move( chain ) ), statement_prefix(statement_prefix),
   root_statement_symbol( SSTR(statement_prefix << "statement_" ) ),
   iterator_prefix( iterator_prefix ),
-  manager( new Subspace("loop", 0), new Subspace("i", chain.maxDimension() )),
-  depth(0)
+  manager( new Subspace("loop", 0), new Subspace("i", this->chain.maxDimension() )),
+  time_subspace( NULL ), depth(0), persistent_region( false )
   {
 
   // Synthesize the loop statements and the primary maps
@@ -39,33 +47,39 @@ Schedule::Schedule( LoopChain& chain, std::string statement_prefix, std::string
 
   Subspace* nest_ss = this->manager.get_nest();
   Subspace* loop_ss = this->manager.get_loops();
+
+  // The time loop runs every nest, so its subspace is outside the loops subspace
+  Subspace* time_ss = NULL;
+  ostringstream time_constraints;
+  if( this->chain.hasTimeDomain() ){
+    const RectangularDomain& time = this->chain.getTimeDomain();
+    time_ss = new Subspace( this->manager.get_safe_prefix( "time" ), 1 );
+    this->manager.insert_left( time_ss, this->manager.get_iterator_to_loops() );
+    time_ss->set_stage( this->manager.get_current_stage() );
+    this->time_subspace = time_ss;
+    this->symbols.insert( time.getSymbols().begin(), time.getSymbols().end() );
+
+    time_constraints << time.getLowerBound( 0 ) << " <= time <= " << time.getUpperBound( 0 )
+                     << " and " << time.getLowerBound( 0 ) << " <= " << time.getUpperBound( 0 );
+    if( time.getStride( 0 ) != "1" ){
+      time_constraints << " and (time - (" << time.getLowerBound( 0 ) << ")) mod " << time.getStride( 0 ) << " = 0";
+    }
+  }
+
   nest_ss->set_aliased();
   int chain_idx = 0;
-  for( LoopNest nest : this->chain ){
-    RectangularDomain& domain = nest.getDomain();
-
+  for( const LoopNest& nest : this->chain ){
     ostringstream statement_string;
+    RectangularDomain::size_type dimensions = nest.dimensions();
 
-    // synth. the symbolic constants
-    statement_string << "[";
-    bool is_not_first_symbolic = false; // for comma insertion
-    for( auto symbol : domain.getSymbols() ){
-      statement_string << (is_not_first_symbolic?",":"") << symbol;
-      is_not_first_symbolic = true;
-    }
-
-    statement_string << "]->{" << root_statement_symbol << chain_idx << "[";
     // add statement name into map_string;
-    map_string << "\t" << root_statement_symbol << chain_idx << "[";
+    map_string << "\t" << root_statement_symbol << chain_idx << "[" << ((time_ss != NULL)? "time" : "");
 
-    // build the iterators for the statement (and the map)
-    for( RectangularDomain::size_type dimension = 0; dimension < domain.dimensions(); dimension += 1 ){
-      statement_string << ((dimension > 0)?",":"") << "i_" << dimension;
-      map_string << ((dimension > 0)?",":"") << "i_" << dimension;
+    // build the iterators for the map
+    for( RectangularDomain::size_type dimension = 0; dimension < dimensions; dimension += 1 ){
+      map_string << ((dimension > 0 || time_ss != NULL)?",":"") << "i_" << dimension;
     }
 
-    statement_string << "] :";
-
     // Create maping tuple
     map_string << "] -> [" << this->manager.get_output_iterators() << "] : \n\t\t"
     // Map the loop constant iterator to the chain index,
@@ -73,30 +87,123 @@ Schedule::Schedule( LoopChain& chain, std::string statement_prefix, std::string
                << ((*loop_ss)[loop_ss->const_index]) << " = " <<  chain_idx
                << " and " << ((*nest_ss)[nest_ss->const_index]) << " = 0";
 
-    // build the conditions for the statement and map
-    for( RectangularDomain::size_type dimension = 0; dimension < domain.dimensions(); dimension += 1 ){
-      // statement conditions (loop bounds)
-      statement_string << ((dimension > 0)?" and ":"")
-                       << domain.getLowerBound( dimension ) << " <= "
-                       << "i_" << dimension
-                       << " <= " << domain.getUpperBound( dimension )
-                       << " and " << domain.getLowerBound( dimension )
-                       << " <= " << domain.getUpperBound( dimension );
-      // map conditions
+    if( time_ss != NULL ){
+      map_string << " and " << (*time_ss)[0] << " = time and " << (*time_ss)[time_ss->const_index] << " = 0";
+    }
+
+    // map conditions
+    for( RectangularDomain::size_type dimension = 0; dimension < dimensions; dimension += 1 ){
       map_string << " and i_" << dimension << " = " << (*nest_ss)[dimension];
     }
 
     // map higher dimensions to 0
-    for( RectangularDomain::size_type dimension = domain.dimensions(); dimension < nest_ss->size(); dimension += 1 ){
+    for( RectangularDomain::size_type dimension = dimensions; dimension < nest_ss->size(); dimension += 1 ){
       map_string << " and " << (*nest_ss)[dimension] << " = 0";
     }
 
-    // end of statement definition
-    statement_string << "} ;";
-
     // end of this domains map
     map_string << ";\n";
 
+    if( nest.isRectangular() ){
+      const RectangularDomain& domain = nest.getDomain();
+
+      // synth. the symbolic constants
+      statement_string << "[";
+      bool is_not_first_symbolic = false; // for comma insertion
+      for( auto symbol : domain.getSymbols() ){
+        statement_string << (is_not_first_symbolic?",":"") << symbol;
+        is_not_first_symbolic = true;
+        this->symbols.insert( symbol );
+      }
+
+      if( time_ss != NULL ){
+        for( auto symbol : this->chain.getTimeDomain().getSymbols() ){
+          if( domain.getSymbols().count( symbol ) == 0 ){
+            statement_string << (is_not_first_symbolic?",":"") << symbol;
+            is_not_first_symbolic = true;
+          }
+        }
+      }
+
+      statement_string << "]->{" << root_statement_symbol << chain_idx << "[" << ((time_ss != NULL)? "time" : "");
+
+      // build the iterators for the statement
+      for( RectangularDomain::size_type dimension = 0; dimension < domain.dimensions(); dimension += 1 ){
+        statement_string << ((dimension > 0 || time_ss != NULL)?",":"") << "i_" << dimension;
+      }
+
+      statement_string << "] :";
+      if( time_ss != NULL ){
+        statement_string << " " << time_constraints.str() << ((domain.dimensions() > 0)? " and " : "");
+      }
+
+      // build the conditions for the statement (loop bounds)
+      for( RectangularDomain::size_type dimension = 0; dimension < domain.dimensions(); dimension += 1 ){
+        statement_string << ((dimension > 0)?" and ":"")
+                         << domain.getLowerBound( dimension ) << " <= "
+                         << "i_" << dimension
+                         << " <= " << domain.getUpperBound( dimension )
+                         << " and " << domain.getLowerBound( dimension )
+                         << " <= " << domain.getUpperBound( dimension );
+        // only every stride-th iteration from the lower bound
+        if( domain.getStride( dimension ) != "1" ){
+          statement_string << " and (i_" << dimension << " - (" << domain.getLowerBound( dimension ) << ")) mod "
+                           << domain.getStride( dimension ) << " = 0";
+        }
+      }
+
+      // end of statement definition
+      statement_string << "} ;";
+    } else {
+      const PolyhedralDomain& domain = nest.getPolyhedralDomain();
+      const std::set<std::string>& domain_symbols = domain.getSymbols();
+      this->symbols.insert( domain_symbols.begin(), domain_symbols.end() );
+
+      // Name the statement and rename the domain's iterators to i_0 .. i_n
+      isl_ctx* ctx = isl_ctx_alloc();
+      isl_set* set = isl_set_read_from_str( ctx, domain.getSet().c_str() );
+      assertWithException( set != NULL, SSTR( "Failed to read domain of loop nest " << chain_idx ) );
+
+      set = isl_set_set_tuple_name( set, SSTR( root_statement_symbol << chain_idx ).c_str() );
+      for( RectangularDomain::size_type dimension = 0; dimension < dimensions; dimension += 1 ){
+        set = isl_set_set_dim_name( set, isl_dim_set, dimension, SSTR( "i_" << dimension ).c_str() );
+      }
+
+      if( time_ss != NULL ){
+        set = isl_set_insert_dims( set, isl_dim_set, 0, 1 );
+        set = isl_set_set_tuple_name( set, SSTR( root_statement_symbol << chain_idx ).c_str() );
+        set = isl_set_set_dim_name( set, isl_dim_set, 0, "time" );
+
+        ostringstream time_set;
+        time_set << "[";
+        bool is_not_first_symbolic = false;
+        for( const std::string& symbol : this->chain.getTimeDomain().getSymbols() ){
+          time_set << (is_not_first_symbolic?",":"") << symbol;
+          is_not_first_symbolic = true;
+        }
+        time_set << "] -> { " << root_statement_symbol << chain_idx << "[time";
+        for( RectangularDomain::size_type dimension = 0; dimension < dimensions; dimension += 1 ){
+          time_set << ",i_" << dimension;
+        }
+        time_set << "] : " << time_constraints.str() << " }";
+        isl_set* time_bounds = isl_set_read_from_str( ctx, time_set.str().c_str() );
+        time_bounds = isl_set_align_params( time_bounds, isl_set_get_space( set ) );
+        set = isl_set_align_params( set, isl_set_get_space( time_bounds ) );
+        set = isl_set_intersect( set, time_bounds );
+        assertWithException( set != NULL, SSTR( "Failed to add the time loop to the domain of loop nest " << chain_idx ) );
+      }
+
+      isl_printer* p = isl_printer_to_str( ctx );
+      p = isl_printer_print_set( p, set );
+      char* set_text = isl_printer_get_str( p );
+      statement_string << set_text << " ;";
+
+      free( set_text );
+      isl_printer_free( p );
+      isl_set_free( set );
+      isl_ctx_free( ctx );
+    }
+
     this->domains.push_back( statement_string.str() );
     chain_idx += 1;
   }
@@ -164,6 +271,44 @@ Schedule::const_iterator Schedule::end_transformations() const {
 }
 
 
+namespace {
+
+  std::string exprText( __isl_keep isl_ast_expr* expr ){
+    isl_printer* p = isl_printer_to_str( isl_ast_expr_get_ctx( expr ) );
+    p = isl_printer_set_output_format( p, ISL_FORMAT_C );
+    p = isl_printer_print_ast_expr( p, expr );
+    char* text = isl_printer_get_str( p );
+    std::string result( text );
+    free( text );
+    isl_printer_free( p );
+    return result;
+  }
+
+  // The least value of each dimension of the schedule over all of its iterations, by iterator name
+  std::map<std::string, std::string> leastValues( __isl_keep isl_union_map* schedule, __isl_keep isl_ast_build* build, const std::string& iterator_prefix ){
+    std::map<std::string, std::string> values;
+    isl_set* iterations = isl_set_from_union_set( isl_union_map_range( isl_union_map_copy( schedule ) ) );
+    assertWithException( iterations != NULL, "Failed to compute the iterations of the schedule." );
+
+    for( int d = 0; d < (int) isl_set_dim( iterations, isl_dim_set ); d += 1 ){
+      isl_pw_aff* least = isl_set_dim_min( isl_set_copy( iterations ), d );
+      // Unbounded dimensions have no least value
+      if( least == NULL || isl_pw_aff_involves_nan( least ) != isl_bool_false ){
+        isl_pw_aff_free( least );
+        continue;
+      }
+      isl_ast_expr* expr = isl_ast_build_expr_from_pw_aff( build, least );
+      assertWithException( expr != NULL, "Failed to create expression of least value." );
+      values[ iterator_prefix + std::to_string( d ) ] = "(" + exprText( expr ) + ")";
+      isl_ast_expr_free( expr );
+    }
+
+    isl_set_free( iterations );
+    return values;
+  }
+
+}
+
 ISLASTRoot* Schedule::codegenToIslAst(){
   isl_ctx* ctx = isl_ctx_alloc();
 
@@ -192,20 +337,17 @@ ISLASTRoot* Schedule::codegenToIslAst(){
   //isl_union_set* schedule_set = isl_union_map_domain( schedule_map );
   //isl_schedule* schedule = isl_schedule_from_domain( schedule_set );
 
-  // Create separation option map
+  // Create AST build option map
   SubspaceManager& manager = this->getSubspaceManager();
-  Subspace* nest = manager.get_nest();
 
-  isl_union_map* separate_map = isl_union_map_read_from_str(
-    ctx,
-    SSTR( "{ [" << manager.get_input_iterators() << "] -> "
-        << "separate[" << nest->get( nest->size() , false ) << "] };"
-    ).c_str()
-  );
+  isl_union_map* options_map = isl_union_map_read_from_str( ctx, this->getASTBuildOptions().c_str() );
+  assertWithException( options_map != NULL, "Failed to create AST build options." );
 
-  // Create AST
-  isl_ast_build* build = isl_ast_build_alloc(ctx);
-  build = isl_ast_build_set_options( build, separate_map );
+  // Create AST, assuming the context constraints hold
+  isl_set* context = isl_set_read_from_str( ctx, this->getContext().c_str() );
+  assertWithException( context != NULL, "Failed to create schedule context." );
+  isl_ast_build* build = isl_ast_build_from_context( context );
+  build = isl_ast_build_set_options( build, options_map );
 
   // Create hundreds of iterator names
   {
@@ -218,8 +360,9 @@ ISLASTRoot* Schedule::codegenToIslAst(){
     build = isl_ast_build_set_iterators( build, names );
   }
 
-  // Collect depths of parallel loops
-  std::set<Subspace::size_type> parallel_depths;
+  // Collect depths of parallel loops, and their pragmas
+  ParallelDepths parallel_depths;
+  parallel_depths.statement_symbol = this->root_statement_symbol;
   {
     Subspace::size_type depth = 1;
     for(
@@ -228,11 +371,36 @@ ISLASTRoot* Schedule::codegenToIslAst(){
       depth += (*cursor)->size(), ++cursor
      ){
       if( this->parallel_subspaces.count( *cursor ) != 0 ){
-        parallel_depths.insert( depth + this->parallel_subspaces[*cursor] );
+        for( const auto& parallel : this->parallel_subspaces[*cursor] ){
+          parallel_depths.pragmas[ depth + parallel.first ] = parallel.second;
+        }
+      }
+      if( this->reduction_subspaces.count( *cursor ) != 0 ){
+        for( const auto& reductions : this->reduction_subspaces[*cursor] ){
+          parallel_depths.reductions[ depth + reductions.first ] = reductions.second;
+        }
+      }
+      if( this->doacross_subspaces.count( *cursor ) != 0 ){
+        for( const auto& doacross : this->doacross_subspaces[*cursor] ){
+          parallel_depths.doacross[ depth + doacross.first ] = doacross.second;
+          parallel_depths.doacross[ depth + doacross.first ].statement_symbol = this->root_statement_symbol;
+        }
+      }
+      if( this->runtime_subspaces.count( *cursor ) != 0 ){
+        parallel_depths.runtime[ depth ] = this->runtime_subspaces[*cursor];
       }
     }
   }
 
+  // Least values of the loops, for the pragmas that refer to them
+  bool least_values = false;
+  for( const auto& pragma : parallel_depths.pragmas ){
+    least_values = least_values || pragma.second.find( "$min(" ) != std::string::npos;
+  }
+  if( least_values ){
+    parallel_depths.least_values = leastValues( schedule_map, build, this->getIteratorPrefix() );
+  }
+
   // Annotate loops of appropriate depth
   //annotateParallelISLLoops( isl_root, parallel_depths );
   isl_ast_build_set_after_each_for( build, custom_for_builder_callback, (void*) &parallel_depths );
@@ -248,6 +416,67 @@ ISLASTRoot* Schedule::codegenToIslAst(){
   return isl_root;
 }
 
+std::string Schedule::getIterationSpace() const {
+  isl_ctx* ctx = isl_ctx_alloc();
+
+  isl_union_set* space = NULL;
+  for( Schedule::const_iterator it = this->begin_domains(); it != this->end_domains(); ++it ){
+    isl_union_set* domain = isl_union_set_read_from_str( ctx, (*it).c_str() );
+    space = (space)? isl_union_set_union( space, domain ) : domain;
+  }
+
+  for( Schedule::const_iterator it = this->begin_transformations(); it != this->end_transformations(); ++it ){
+    isl_union_map* map = isl_union_map_read_from_str( ctx, (*it).c_str() );
+    space = isl_union_set_apply( space, map );
+  }
+
+  assertWithException( space != NULL, "Failed to compute iteration space of schedule." );
+
+  isl_printer* p = isl_printer_to_str( ctx );
+  p = isl_printer_print_union_set( p, space );
+  char* space_text = isl_printer_get_str( p );
+  string result( space_text );
+
+  free( space_text );
+  isl_printer_free( p );
+  isl_union_set_free( space );
+  isl_ctx_free( ctx );
+
+  return result;
+}
+
+std::string Schedule::getScheduleMap() const {
+  isl_ctx* ctx = isl_ctx_alloc();
+
+  isl_union_set* space = NULL;
+  for( Schedule::const_iterator it = this->begin_domains(); it != this->end_domains(); ++it ){
+    isl_union_set* domain = isl_union_set_read_from_str( ctx, (*it).c_str() );
+    space = (space)? isl_union_set_union( space, domain ) : domain;
+  }
+
+  assertWithException( space != NULL, "Failed to compute schedule map: schedule has no domains." );
+
+  isl_union_map* schedule = isl_union_set_identity( space );
+  for( Schedule::const_iterator it = this->begin_transformations(); it != this->end_transformations(); ++it ){
+    isl_union_map* map = isl_union_map_read_from_str( ctx, (*it).c_str() );
+    schedule = isl_union_map_apply_range( schedule, map );
+  }
+
+  assertWithException( schedule != NULL, "Failed to compute schedule map." );
+
+  isl_printer* p = isl_printer_to_str( ctx );
+  p = isl_printer_print_union_map( p, schedule );
+  char* schedule_text = isl_printer_get_str( p );
+  string result( schedule_text );
+
+  free( schedule_text );
+  isl_printer_free( p );
+  isl_union_map_free( schedule );
+  isl_ctx_free( ctx );
+
+  return result;
+}
+
 std::string Schedule::codegen( ){
   // Get ISL AST Tree
   ISLASTRoot& root = *this->codegenToIslAst();
@@ -260,7 +489,11 @@ std::string Schedule::codegen( ){
   isl_ast_print_options* print_options = isl_ast_print_options_alloc(ctx);
   // Set option to print for nodes with my printer (custom_for_printer_callback)
   print_options = isl_ast_print_options_set_print_for(print_options, custom_for_printer_callback, NULL);
-  isl_ast_node_print(tree, p, print_options);
+  if( this->persistent_region ){
+    p = this->printPersistentRegion( tree, p, print_options );
+  } else {
+    p = isl_ast_node_print(tree, p, print_options);
+  }
 
   // Extract string
   string code_text( isl_printer_get_str( p ) );
@@ -275,6 +508,644 @@ std::string Schedule::codegen( ){
   return code_text;
 }
 
+namespace {
+
+  // Add the nests of the statements executed under node to nests
+  void collectNests( __isl_keep isl_ast_node* node, const std::string& statement_symbol, std::set<LoopChain::size_type>& nests ){
+    std::vector<isl_ast_node*> children;
+    switch( isl_ast_node_get_type( node ) ){
+      case isl_ast_node_for:
+        children.push_back( isl_ast_node_for_get_body( node ) );
+        break;
+      case isl_ast_node_if:
+        children.push_back( isl_ast_node_if_get_then( node ) );
+        if( isl_ast_node_if_has_else( node ) == isl_bool_true ){
+          children.push_back( isl_ast_node_if_get_else( node ) );
+        }
+        break;
+      case isl_ast_node_block: {
+        isl_ast_node_list* list = isl_ast_node_block_get_children( node );
+        for( int i = 0; i < isl_ast_node_list_n_ast_node( list ); i += 1 ){
+          children.push_back( isl_ast_node_list_get_ast_node( list, i ) );
+        }
+        isl_ast_node_list_free( list );
+        break;
+      }
+      case isl_ast_node_mark:
+        children.push_back( isl_ast_node_mark_get_node( node ) );
+        break;
+      case isl_ast_node_user: {
+        // statement_<nest>( iterators... )
+        isl_ast_expr* call = isl_ast_node_user_get_expr( node );
+        isl_ast_expr* function = isl_ast_expr_get_op_arg( call, 0 );
+        isl_id* id = isl_ast_expr_get_id( function );
+        std::string name( isl_id_get_name( id ) );
+        if( name.compare( 0, statement_symbol.size(), statement_symbol ) == 0 ){
+          nests.insert( (LoopChain::size_type) std::stoul( name.substr( statement_symbol.size() ) ) );
+        }
+        isl_id_free( id );
+        isl_ast_expr_free( function );
+        isl_ast_expr_free( call );
+        break;
+      }
+      default:
+        break;
+    }
+
+    for( isl_ast_node* child : children ){
+      collectNests( child, statement_symbol, nests );
+      isl_ast_node_free( child );
+    }
+  }
+
+  // Append the statements of (possibly nested) blocks at node to nodes
+  void flattenBlocks( __isl_keep isl_ast_node* node, std::vector<isl_ast_node*>& nodes ){
+    if( isl_ast_node_get_type( node ) != isl_ast_node_block ){
+      nodes.push_back( isl_ast_node_copy( node ) );
+      return;
+    }
+    isl_ast_node_list* list = isl_ast_node_block_get_children( node );
+    for( int i = 0; i < isl_ast_node_list_n_ast_node( list ); i += 1 ){
+      isl_ast_node* child = isl_ast_node_list_get_ast_node( list, i );
+      flattenBlocks( child, nodes );
+      isl_ast_node_free( child );
+    }
+    isl_ast_node_list_free( list );
+  }
+
+  bool writes( const Dataspace& dataspace ){
+    return dataspace.writes().size() > 0 || !dataspace.affineWrites().empty() || dataspace.isReduction();
+  }
+
+  // Whether the nests share a dataspace that either of them writes
+  bool dependent( const LoopNest& earlier, const LoopNest& later ){
+    for( const Dataspace& earlier_dataspace : earlier.getDataspaces() ){
+      for( const Dataspace& later_dataspace : later.getDataspaces() ){
+        if( earlier_dataspace.name == later_dataspace.name && (writes( earlier_dataspace ) || writes( later_dataspace )) ){
+          return true;
+        }
+      }
+    }
+    return false;
+  }
+
+  // Whether expr refers to the identifier name
+  bool refersTo( __isl_keep isl_ast_expr* expr, const std::string& name ){
+    switch( isl_ast_expr_get_type( expr ) ){
+      case isl_ast_expr_id: {
+        isl_id* id = isl_ast_expr_get_id( expr );
+        bool found = name == isl_id_get_name( id );
+        isl_id_free( id );
+        return found;
+      }
+      case isl_ast_expr_op: {
+        bool found = false;
+        for( int i = 0; !found && i < isl_ast_expr_get_op_n_arg( expr ); i += 1 ){
+          isl_ast_expr* arg = isl_ast_expr_get_op_arg( expr, i );
+          found = refersTo( arg, name );
+          isl_ast_expr_free( arg );
+        }
+        return found;
+      }
+      default:
+        return false;
+    }
+  }
+
+  // Whether the init, condition or increment of loop refer to any of iterators
+  bool boundsReferTo( __isl_keep isl_ast_node* loop, const std::vector<std::string>& iterators ){
+    isl_ast_expr* bounds[] = { isl_ast_node_for_get_init( loop ), isl_ast_node_for_get_cond( loop ), isl_ast_node_for_get_inc( loop ) };
+    bool found = false;
+    for( isl_ast_expr* bound : bounds ){
+      for( const std::string& iterator : iterators ){
+        found = found || refersTo( bound, iterator );
+      }
+      isl_ast_expr_free( bound );
+    }
+    return found;
+  }
+
+  /*
+  Assert that the loops collapsed by the collapse(n) clause of pragma, if any,
+  are n perfectly nested, non-degenerate loops starting at node, and that
+  their bounds do not depend on each other's iterators.
+  */
+  void assertCollapsible( __isl_keep isl_ast_node* node, const std::string& pragma ){
+    const std::string clause = "collapse(";
+    std::string::size_type start = pragma.find( clause );
+    if( start == std::string::npos ){
+      return;
+    }
+    unsigned collapse = (unsigned) std::stoul( pragma.substr( start + clause.size() ) );
+
+    std::vector<std::string> iterators;
+    isl_ast_node* loop = isl_ast_node_copy( node );
+    for( unsigned k = 0; k < collapse; k += 1 ){
+      if( k > 0 ){
+        isl_ast_node* body = isl_ast_node_for_get_body( loop );
+        isl_ast_node_free( loop );
+        loop = body;
+        // A block of a single statement is still perfectly nested
+        while( isl_ast_node_get_type( loop ) == isl_ast_node_block ){
+          isl_ast_node_list* children = isl_ast_node_block_get_children( loop );
+          bool single = isl_ast_node_list_n_ast_node( children ) == 1;
+          if( single ){
+            isl_ast_node_free( loop );
+            loop = isl_ast_node_list_get_ast_node( children, 0 );
+          }
+          isl_ast_node_list_free( children );
+          if( !single ){
+            break;
+          }
+        }
+      }
+
+      bool nested = isl_ast_node_get_type( loop ) == isl_ast_node_for && isl_ast_node_for_is_degenerate( loop ) == isl_bool_false;
+      bool rectangular = nested && !boundsReferTo( loop, iterators );
+      if( !nested || !rectangular ){
+        isl_ast_node_free( loop );
+      }
+      assertWithException( nested, SSTR( "Pragma \"" << pragma << "\" collapses " << collapse << " loops, but loop " << k << " of them is not perfectly nested" ) );
+      assertWithException( rectangular, SSTR( "Pragma \"" << pragma << "\" collapses loop " << k << ", whose bounds depend on an outer collapsed loop" ) );
+
+      isl_ast_expr* iterator = isl_ast_node_for_get_iterator( loop );
+      isl_id* id = isl_ast_expr_get_id( iterator );
+      iterators.push_back( isl_id_get_name( id ) );
+      isl_id_free( id );
+      isl_ast_expr_free( iterator );
+    }
+    isl_ast_node_free( loop );
+  }
+
+  // Remove the clause "name(...)" from pragma
+  std::string withoutClause( std::string pragma, const std::string& name ){
+    std::string::size_type start = pragma.find( " " + name + "(" );
+    if( start != std::string::npos ){
+      std::string::size_type end = pragma.find( ')', start );
+      pragma.erase( start, (end == std::string::npos)? std::string::npos : end + 1 - start );
+    }
+    return pragma;
+  }
+
+  // "omp parallel for <clauses>" as the worksharing loop "omp for <clauses> nowait",
+  // or an empty string if pragma is not a parallel loop.
+  std::string worksharingPragma( const std::string& pragma ){
+    const std::string parallel_for = "omp parallel for";
+    if( pragma.compare( 0, parallel_for.size(), parallel_for ) != 0 || pragma.find( '\n' ) != std::string::npos ){
+      return "";
+    }
+    // Clauses of the region, not of the loop
+    std::string clauses = withoutClause( withoutClause( pragma.substr( parallel_for.size() ), "num_threads" ), "proc_bind" );
+    return "omp for" + clauses + " nowait";
+  }
+
+  __isl_give isl_printer* printPragma( __isl_take isl_printer* p, const std::string& pragma ){
+    p = isl_printer_start_line( p );
+    p = isl_printer_print_str( p, ("#pragma " + pragma).c_str() );
+    return isl_printer_end_line( p );
+  }
+
+  // Print the for node as a doacross loop
+  __isl_give isl_printer* printDoacross( __isl_keep isl_ast_node* node, __isl_take isl_printer* p, __isl_take isl_ast_print_options* options, const DoacrossLoop& loop ){
+    if( isl_ast_node_for_is_degenerate( node ) == isl_bool_true ){
+      return isl_ast_node_for_print( node, p, options );
+    }
+
+    isl_ast_expr* iterator = isl_ast_node_for_get_iterator( node );
+    isl_ast_expr* init = isl_ast_node_for_get_init( node );
+    isl_ast_expr* cond = isl_ast_node_for_get_cond( node );
+    isl_ast_expr* inc = isl_ast_node_for_get_inc( node );
+    isl_ast_node* body = isl_ast_node_for_get_body( node );
+
+    p = printPragma( p, loop.pragma );
+    p = isl_printer_start_line( p );
+    p = isl_printer_print_str( p, "for (" );
+    p = isl_printer_print_str( p, isl_options_get_ast_iterator_type( isl_ast_node_get_ctx( node ) ) );
+    p = isl_printer_print_str( p, " " );
+    p = isl_printer_print_ast_expr( p, iterator );
+    p = isl_printer_print_str( p, " = " );
+    p = isl_printer_print_ast_expr( p, init );
+    p = isl_printer_print_str( p, "; " );
+    p = isl_printer_print_ast_expr( p, cond );
+    p = isl_printer_print_str( p, "; " );
+    p = isl_printer_print_ast_expr( p, iterator );
+    p = isl_printer_print_str( p, " += " );
+    p = isl_printer_print_ast_expr( p, inc );
+    p = isl_printer_print_str( p, ") {" );
+    p = isl_printer_end_line( p );
+    p = isl_printer_indent( p, 2 );
+
+    std::vector<isl_ast_node*> children;
+    flattenBlocks( body, children );
+
+    // The trailing statements of only the overlapped nests run after the source
+    std::vector<isl_ast_node*>::size_type source = children.size();
+    while( source > 0 ){
+      std::set<LoopChain::size_type> nests;
+      collectNests( children[source - 1], loop.statement_symbol, nests );
+      bool overlapped = !nests.empty();
+      for( LoopChain::size_type nest : nests ){
+        overlapped = overlapped && loop.overlapped.count( nest ) != 0;
+      }
+      if( !overlapped ){
+        break;
+      }
+      source -= 1;
+    }
+
+    // Unconditional, as an iteration that never signals would block the next forever
+    p = printPragma( p, "omp ordered depend(sink: " + exprText( iterator ) + " - " + exprText( inc ) + ")" );
+
+    for( std::vector<isl_ast_node*>::size_type child = 0; child < children.size(); child += 1 ){
+      if( child == source ){
+        p = printPragma( p, "omp ordered depend(source)" );
+      }
+      p = isl_ast_node_print( children[child], p, isl_ast_print_options_copy( options ) );
+      isl_ast_node_free( children[child] );
+    }
+    if( source == children.size() ){
+      p = printPragma( p, "omp ordered depend(source)" );
+    }
+
+    p = isl_printer_indent( p, -2 );
+    p = isl_printer_start_line( p );
+    p = isl_printer_print_str( p, "}" );
+    p = isl_printer_end_line( p );
+
+    isl_ast_node_free( body );
+    isl_ast_expr_free( inc );
+    isl_ast_expr_free( cond );
+    isl_ast_expr_free( init );
+    isl_ast_expr_free( iterator );
+    isl_ast_print_options_free( options );
+    return p;
+  }
+
+  __isl_give isl_printer* printLine( __isl_take isl_printer* p, const std::string& line ){
+    p = isl_printer_start_line( p );
+    p = isl_printer_print_str( p, line.c_str() );
+    return isl_printer_end_line( p );
+  }
+
+  // "std::vector<int>( { <elements> } )"
+  std::string coordinateText( const std::vector<std::string>& elements ){
+    std::ostringstream text;
+    text << "std::vector<int>( { ";
+    for( std::vector<std::string>::size_type e = 0; e < elements.size(); e += 1 ){
+      text << ((e > 0)? ", " : "") << elements[e];
+    }
+    text << " } )";
+    return text.str();
+  }
+
+  /*
+  Print node, which is level loops into the runtime tile loops (whose
+  iterators are iterators). When registering, the tiles reached at the
+  innermost tile loop are added to tile_ids. Otherwise, each tile loop is the
+  iteration of the current tile_coordinate, if the loop has it.
+  */
+  __isl_give isl_printer* printTileLoops( __isl_keep isl_ast_node* node, __isl_take isl_printer* p, __isl_keep isl_ast_print_options* options,
+                                          const RuntimeTiles& tiles, Subspace::size_type level, std::vector<std::string>& iterators, bool registering ){
+    if( level == tiles.dimensions ){
+      if( registering ){
+        return printLine( p, "tile_ids.emplace( " + coordinateText( iterators ) + ", tile_ids.size() );" );
+      }
+      return isl_ast_node_print( node, p, isl_ast_print_options_copy( options ) );
+    }
+
+    switch( isl_ast_node_get_type( node ) ){
+      case isl_ast_node_for: {
+        isl_ast_expr* iterator = isl_ast_node_for_get_iterator( node );
+        isl_ast_expr* init = isl_ast_node_for_get_init( node );
+        isl_ast_node* body = isl_ast_node_for_get_body( node );
+        std::string type( isl_options_get_ast_iterator_type( isl_ast_node_get_ctx( node ) ) );
+        std::string name = exprText( iterator );
+        bool degenerate = isl_ast_node_for_is_degenerate( node ) == isl_bool_true;
+
+        if( registering && degenerate ){
+          p = printLine( p, "{" );
+          p = isl_printer_indent( p, 2 );
+          p = printLine( p, "const " + type + " " + name + " = " + exprText( init ) + ";" );
+        } else if( registering ){
+          isl_ast_expr* cond = isl_ast_node_for_get_cond( node );
+          isl_ast_expr* inc = isl_ast_node_for_get_inc( node );
+          p = printLine( p, "for (" + type + " " + name + " = " + exprText( init ) + "; " + exprText( cond ) + "; " + name + " += " + exprText( inc ) + ") {" );
+          p = isl_printer_indent( p, 2 );
+          isl_ast_expr_free( inc );
+          isl_ast_expr_free( cond );
+        } else {
+          std::string condition = SSTR( name << " == " << exprText( init ) );
+          if( !degenerate ){
+            isl_ast_expr* cond = isl_ast_node_for_get_cond( node );
+            isl_ast_expr* inc = isl_ast_node_for_get_inc( node );
+            condition = SSTR( name << " >= " << exprText( init ) << " && " << exprText( cond ) );
+            if( exprText( inc ) != "1" ){
+              condition += SSTR( " && (" << name << " - (" << exprText( init ) << ")) % " << exprText( inc ) << " == 0" );
+            }
+            isl_ast_expr_free( inc );
+            isl_ast_expr_free( cond );
+          }
+          p = printLine( p, "{" );
+          p = isl_printer_indent( p, 2 );
+          p = printLine( p, SSTR( "const " << type << " " << name << " = tile_coordinate[" << level << "];" ) );
+          p = printLine( p, "if (" + condition + ") {" );
+          p = isl_printer_indent( p, 2 );
+        }
+
+        iterators.push_back( name );
+        p = printTileLoops( body, p, options, tiles, level + 1, iterators, registering );
+        iterators.pop_back();
+
+        if( !registering ){
+          p = isl_printer_indent( p, -2 );
+          p = printLine( p, "}" );
+        }
+        p = isl_printer_indent( p, -2 );
+        p = printLine( p, "}" );
+
+        isl_ast_node_free( body );
+        isl_ast_expr_free( init );
+        isl_ast_expr_free( iterator );
+        break;
+      }
+      case isl_ast_node_if: {
+        isl_ast_expr* cond = isl_ast_node_if_get_cond( node );
+        isl_ast_node* then_node = isl_ast_node_if_get_then( node );
+        p = printLine( p, "if (" + exprText( cond ) + ") {" );
+        p = isl_printer_indent( p, 2 );
+        p = printTileLoops( then_node, p, options, tiles, level, iterators, registering );
+        p = isl_printer_indent( p, -2 );
+        if( isl_ast_node_if_has_else( node ) == isl_bool_true ){
+          isl_ast_node* else_node = isl_ast_node_if_get_else( node );
+          p = printLine( p, "} else {" );
+          p = isl_printer_indent( p, 2 );
+          p = printTileLoops( else_node, p, options, tiles, level, iterators, registering );
+          p = isl_printer_indent( p, -2 );
+          isl_ast_node_free( else_node );
+        }
+        p = printLine( p, "}" );
+        isl_ast_node_free( then_node );
+        isl_ast_expr_free( cond );
+        break;
+      }
+      case isl_ast_node_block: {
+        isl_ast_node_list* list = isl_ast_node_block_get_children( node );
+        for( int i = 0; i < isl_ast_node_list_n_ast_node( list ); i += 1 ){
+          isl_ast_node* child = isl_ast_node_list_get_ast_node( list, i );
+          p = printTileLoops( child, p, options, tiles, level, iterators, registering );
+          isl_ast_node_free( child );
+        }
+        isl_ast_node_list_free( list );
+        break;
+      }
+      case isl_ast_node_mark: {
+        isl_ast_node* child = isl_ast_node_mark_get_node( node );
+        p = printTileLoops( child, p, options, tiles, level, iterators, registering );
+        isl_ast_node_free( child );
+        break;
+      }
+      default:
+        assertWithException( false, SSTR( "Statement outside of the innermost of the " << tiles.dimensions << " runtime tile loops" ) );
+    }
+
+    return p;
+  }
+
+  // Print the for node and the tile loops within it as tiles registered in a graph and run by tiles.runtime
+  __isl_give isl_printer* printRuntimeTiles( __isl_keep isl_ast_node* node, __isl_take isl_printer* p, __isl_take isl_ast_print_options* options, const RuntimeTiles& tiles ){
+    const std::string tile_ids = "std::map< std::vector<int>, LoopChainIR::TileGraph::size_type >";
+    std::vector<std::string> iterators;
+
+    p = printLine( p, "{" );
+    p = isl_printer_indent( p, 2 );
+
+    // Register the tiles
+    p = printLine( p, tile_ids + " tile_ids;" );
+    p = printTileLoops( node, p, options, tiles, 0, iterators, true );
+    p = printLine( p, "std::vector< std::vector<int> > tile_coordinates( tile_ids.size() );" );
+    p = printLine( p, "for (const auto& tile : tile_ids) {" );
+    p = isl_printer_indent( p, 2 );
+    p = printLine( p, "tile_coordinates[tile.second] = tile.first;" );
+    p = isl_printer_indent( p, -2 );
+    p = printLine( p, "}" );
+
+    // Edges from the tiles each tile depends on
+    p = printLine( p, "LoopChainIR::TileGraph tile_graph( tile_ids.size() );" );
+    p = printLine( p, "for (const auto& tile : tile_ids) {" );
+    p = isl_printer_indent( p, 2 );
+    for( const std::vector<int>& offset : tiles.offsets ){
+      if( std::count( offset.begin(), offset.end(), 0 ) == (std::ptrdiff_t) offset.size() ){
+        continue;
+      }
+      std::vector<std::string> predecessor;
+      for( Subspace::size_type d = 0; d < tiles.dimensions; d += 1 ){
+        predecessor.push_back( SSTR( "tile.first[" << d << "] - (" << offset[d] << ")" ) );
+      }
+      p = printLine( p, "{" );
+      p = isl_printer_indent( p, 2 );
+      p = printLine( p, tile_ids + "::const_iterator predecessor = tile_ids.find( " + coordinateText( predecessor ) + " );" );
+      p = printLine( p, "if (predecessor != tile_ids.end())" );
+      p = printLine( p, "  tile_graph.addEdge( predecessor->second, tile.second );" );
+      p = isl_printer_indent( p, -2 );
+      p = printLine( p, "}" );
+    }
+    p = isl_printer_indent( p, -2 );
+    p = printLine( p, "}" );
+
+    // Run each tile
+    p = printLine( p, tiles.runtime + ".run( tile_graph, [&]( LoopChainIR::TileGraph::size_type tile ) {" );
+    p = isl_printer_indent( p, 2 );
+    p = printLine( p, "const std::vector<int>& tile_coordinate = tile_coordinates[tile];" );
+    p = printTileLoops( node, p, options, tiles, 0, iterators, false );
+    p = isl_printer_indent( p, -2 );
+    p = printLine( p, "} );" );
+
+    p = isl_printer_indent( p, -2 );
+    p = printLine( p, "}" );
+
+    isl_ast_print_options_free( options );
+    return p;
+  }
+
+
+  // Whether any of the earlier nests and any of the later nests are dependent
+  bool dependent( const LoopChain& chain, const std::set<LoopChain::size_type>& earlier, const std::set<LoopChain::size_type>& later ){
+    for( LoopChain::size_type earlier_nest : earlier ){
+      for( LoopChain::size_type later_nest : later ){
+        if( dependent( chain.getNest( earlier_nest ), chain.getNest( later_nest ) ) ){
+          return true;
+        }
+      }
+    }
+    return false;
+  }
+
+  // The worksharing pragma of node, if it is a loop annotated as a parallel loop
+  std::string worksharingOf( __isl_keep isl_ast_node* node ){
+    std::string worksharing;
+    if( isl_ast_node_get_type( node ) == isl_ast_node_for ){
+      isl_id* annotation = isl_ast_node_get_annotation( node );
+      if( annotation != NULL && std::string( isl_id_get_name( annotation ) ) == std::string( "parallel annotation" ) ){
+        worksharing = worksharingPragma( parallel_annotation_pragma( annotation ) );
+      }
+      isl_id_free( annotation );
+    }
+    return worksharing;
+  }
+
+  // Whether node is a shared loop, or encloses one within unannotated loops and conditions
+  bool sharesWork( __isl_keep isl_ast_node* node ){
+    std::vector<isl_ast_node*> children;
+    switch( isl_ast_node_get_type( node ) ){
+      case isl_ast_node_for: {
+        if( !worksharingOf( node ).empty() ){
+          return true;
+        }
+        isl_id* annotation = isl_ast_node_get_annotation( node );
+        bool annotated = annotation != NULL;
+        isl_id_free( annotation );
+        if( annotated ){
+          return false;
+        }
+        children.push_back( isl_ast_node_for_get_body( node ) );
+        break;
+      }
+      case isl_ast_node_if:
+        children.push_back( isl_ast_node_if_get_then( node ) );
+        if( isl_ast_node_if_has_else( node ) == isl_bool_true ){
+          children.push_back( isl_ast_node_if_get_else( node ) );
+        }
+        break;
+      case isl_ast_node_block:
+        flattenBlocks( node, children );
+        break;
+      default:
+        break;
+    }
+
+    bool shares = false;
+    for( isl_ast_node* child : children ){
+      shares = shares || sharesWork( child );
+      isl_ast_node_free( child );
+    }
+    return shares;
+  }
+
+}
+
+__isl_give isl_printer* Schedule::printPersistentRegion( __isl_keep isl_ast_node* tree, __isl_take isl_printer* p, __isl_take isl_ast_print_options* options ) const {
+  p = printPragma( p, "omp parallel" );
+  p = isl_printer_start_line( p );
+  p = isl_printer_print_str( p, "{" );
+  p = isl_printer_end_line( p );
+  p = isl_printer_indent( p, 2 );
+
+  std::set<LoopChain::size_type> unsynchronized;
+  p = this->printPersistentNodes( tree, p, options, unsynchronized );
+
+  p = isl_printer_indent( p, -2 );
+  p = isl_printer_start_line( p );
+  p = isl_printer_print_str( p, "}" );
+  p = isl_printer_end_line( p );
+
+  isl_ast_print_options_free( options );
+  return p;
+}
+
+__isl_give isl_printer* Schedule::printPersistentNodes( __isl_keep isl_ast_node* node, __isl_take isl_printer* p, __isl_keep isl_ast_print_options* options, std::set<LoopChain::size_type>& unsynchronized ) const {
+  // The nests, in order of execution
+  std::vector<isl_ast_node*> children;
+  flattenBlocks( node, children );
+
+  for( isl_ast_node* child : children ){
+    std::set<LoopChain::size_type> nests;
+    collectNests( child, this->root_statement_symbol, nests );
+    std::string worksharing = worksharingOf( child );
+
+    if( worksharing.empty() && sharesWork( child ) ){
+      // Every thread runs the loop or condition, and shares the loops within it
+      std::set<LoopChain::size_type> entering( unsynchronized );
+      if( isl_ast_node_get_type( child ) == isl_ast_node_for ){
+        isl_ast_expr* iterator = isl_ast_node_for_get_iterator( child );
+        isl_ast_expr* init = isl_ast_node_for_get_init( child );
+        isl_ast_node* body = isl_ast_node_for_get_body( child );
+        std::string type( isl_options_get_ast_iterator_type( isl_ast_node_get_ctx( child ) ) );
+        std::string name = exprText( iterator );
+        bool degenerate = isl_ast_node_for_is_degenerate( child ) == isl_bool_true;
+        if( degenerate ){
+          p = printLine( p, "{" );
+          p = isl_printer_indent( p, 2 );
+          p = printLine( p, "const " + type + " " + name + " = " + exprText( init ) + ";" );
+        } else {
+          isl_ast_expr* cond = isl_ast_node_for_get_cond( child );
+          isl_ast_expr* inc = isl_ast_node_for_get_inc( child );
+          p = printLine( p, "for (" + type + " " + name + " = " + exprText( init ) + "; " + exprText( cond ) + "; " + name + " += " + exprText( inc ) + ") {" );
+          p = isl_printer_indent( p, 2 );
+          isl_ast_expr_free( inc );
+          isl_ast_expr_free( cond );
+        }
+
+        p = this->printPersistentNodes( body, p, options, unsynchronized );
+        // The next iteration's nests wait for this iteration's
+        if( !degenerate && dependent( this->chain, unsynchronized, nests ) ){
+          p = printPragma( p, "omp barrier" );
+          unsynchronized.clear();
+        }
+
+        p = isl_printer_indent( p, -2 );
+        p = printLine( p, "}" );
+        isl_ast_node_free( body );
+        isl_ast_expr_free( init );
+        isl_ast_expr_free( iterator );
+      } else {
+        isl_ast_expr* cond = isl_ast_node_if_get_cond( child );
+        isl_ast_node* then_node = isl_ast_node_if_get_then( child );
+        p = printLine( p, "if (" + exprText( cond ) + ") {" );
+        p = isl_printer_indent( p, 2 );
+        p = this->printPersistentNodes( then_node, p, options, unsynchronized );
+        p = isl_printer_indent( p, -2 );
+        if( isl_ast_node_if_has_else( child ) == isl_bool_true ){
+          isl_ast_node* else_node = isl_ast_node_if_get_else( child );
+          std::set<LoopChain::size_type> otherwise( entering );
+          p = printLine( p, "} else {" );
+          p = isl_printer_indent( p, 2 );
+          p = this->printPersistentNodes( else_node, p, options, otherwise );
+          p = isl_printer_indent( p, -2 );
+          unsynchronized.insert( otherwise.begin(), otherwise.end() );
+          isl_ast_node_free( else_node );
+        }
+        p = printLine( p, "}" );
+        isl_ast_node_free( then_node );
+        isl_ast_expr_free( cond );
+      }
+      // The loop may run no iteration, and the condition may not hold
+      unsynchronized.insert( entering.begin(), entering.end() );
+      isl_ast_node_free( child );
+      continue;
+    }
+
+    if( dependent( this->chain, unsynchronized, nests ) ){
+      p = printPragma( p, "omp barrier" );
+      unsynchronized.clear();
+    }
+    unsynchronized.insert( nests.begin(), nests.end() );
+
+    // Share the loop among the threads, or run the statement on one thread
+    if( !worksharing.empty() ){
+      isl_id* annotation = isl_id_alloc( isl_ast_node_get_ctx( child ), "parallel annotation", new std::string( worksharing ) );
+      annotation = isl_id_set_free_user( annotation, free_parallel_annotation );
+      child = isl_ast_node_set_annotation( child, annotation );
+    } else {
+      p = printPragma( p, "omp single nowait" );
+    }
+
+    p = isl_ast_node_print( child, p, isl_ast_print_options_copy( options ) );
+    isl_ast_node_free( child );
+  }
+
+  return p;
+}
+
 bool Schedule::codegenToFile( std::string file_name ){
   std::string code = this->codegen();
   std::ofstream file_stream( file_name );
@@ -301,6 +1172,12 @@ std::string Schedule::codegenToISCC( ) const {
     os << "M" << map_count++ << " := " <<  (*it) << std::endl;
   }
 
+  bool has_context = !this->context_constraints.empty();
+  if( has_context ){
+    os << std::endl << "# Context:" << std::endl
+       << "C := " << this->getContext() << ";" << std::endl;
+  }
+
   os << "\ncodegen( (";
   for( int i = 1; i < map_count; i += 1 ){
     os << ((i>1)?".":"") << "M" << i;
@@ -309,9 +1186,8 @@ std::string Schedule::codegenToISCC( ) const {
   for( int i = 1; i < stmt_count; i += 1 ){
     os << ((i>1)?"+":"") << "S" << i;
   }
-  const Subspace* nest = manager.get_nest();;
-  os << ") ) using { [" << manager.get_input_iterators() << "] -> "
-      << "separate[" << nest->get( nest->size() , false ) << "] };";
+  // The context is the AST build's context, as in codegenToIslAst, not a restriction of the schedule
+  os << ") )" << (has_context?" given C":"") << " using " << this->getASTBuildOptions();
   return std::string( os.str() );
 }
 
@@ -323,18 +1199,54 @@ LoopChain& Schedule::getChain(){
   return this->chain;
 }
 
-std::string Schedule::getStatementPrefix(){
+const LoopChain& Schedule::getChain() const {
+  return this->chain;
+}
+
+void Schedule::preserveDataspaces( LoopChain::size_type nest ){
+  if( this->original_dataspaces.count( nest ) == 0 ){
+    this->original_dataspaces.insert( std::make_pair( nest, this->chain.getNest( nest ).getDataspaces() ) );
+    this->original_chain.reset();
+  }
+}
+
+const std::list<Dataspace>& Schedule::getOriginalDataspaces( LoopChain::size_type nest ) const {
+  std::map<LoopChain::size_type, std::list<Dataspace> >::const_iterator preserved = this->original_dataspaces.find( nest );
+  if( preserved != this->original_dataspaces.end() ){
+    return preserved->second;
+  }
+  return this->chain.getNest( nest ).getDataspaces();
+}
+
+const LoopChain& Schedule::getOriginalChain() const {
+  if( this->original_dataspaces.empty() ){
+    return this->chain;
+  }
+  if( !this->original_chain ){
+    this->original_chain.reset( new LoopChain( this->chain ) );
+    for( const auto& preserved : this->original_dataspaces ){
+      this->original_chain->getNest( preserved.first ).replaceDataspaces( preserved.second );
+    }
+  }
+  return *this->original_chain;
+}
+
+std::string Schedule::getStatementPrefix() const {
   return std::string(this->statement_prefix);
 }
 
-std::string Schedule::getRootStatementSymbol(){
+std::string Schedule::getRootStatementSymbol() const {
   return std::string(this->root_statement_symbol);
 }
 
-std::string Schedule::getIteratorPrefix(){
+std::string Schedule::getIteratorPrefix() const {
   return std::string( this->iterator_prefix );
 }
 
+Subspace* Schedule::getTimeSubspace(){
+  return this->time_subspace;
+}
+
 SubspaceManager& Schedule::getSubspaceManager(){
   return this->manager;
 }
@@ -353,29 +1265,250 @@ int Schedule::decrementDepth(){
   return this->getDepth();
 }
 
-void Schedule::addParallelSubspace( Subspace* subspace, Subspace::size_type additional_depth ){
-  this->parallel_subspaces[subspace] = additional_depth;
+void Schedule::setPersistentParallelRegion( bool persistent ){
+  this->persistent_region = persistent;
+}
+
+bool Schedule::getPersistentParallelRegion() const {
+  return this->persistent_region;
+}
+
+void Schedule::addParallelSubspace( Subspace* subspace, Subspace::size_type additional_depth, std::string pragma ){
+  this->parallel_subspaces[subspace][additional_depth] = pragma;
+}
+
+void Schedule::addParallelReductions( Subspace* subspace, Subspace::size_type additional_depth, NestReductions reductions ){
+  this->reduction_subspaces[subspace][additional_depth] = std::move( reductions );
+}
+
+void Schedule::addDoacrossSubspace( Subspace* subspace, Subspace::size_type additional_depth, std::set<LoopChain::size_type> nests, std::set<LoopChain::size_type> overlapped, std::string clauses ){
+  DoacrossLoop loop;
+  loop.pragma = "omp parallel for" + (clauses.empty()? std::string() : " " + clauses) + " ordered(1)";
+  loop.nests = nests;
+  loop.overlapped = overlapped;
+  this->doacross_subspaces[subspace][additional_depth] = loop;
+}
+
+void Schedule::addRuntimeSubspace( Subspace* subspace, RuntimeTiles tiles ){
+  assertWithException( tiles.dimensions > 0 && tiles.dimensions <= subspace->size(),
+                       "Runtime tiles must be variable iterators of the subspace." );
+  for( const std::vector<int>& offset : tiles.offsets ){
+    assertWithException( offset.size() == tiles.dimensions, "Runtime tile offsets must have an element per tile dimension." );
+  }
+  this->runtime_subspaces[subspace] = std::move( tiles );
+}
+
+void Schedule::addASTBuildOption( Subspace* subspace, Subspace::size_type dimension, ASTBuildOption option ){
+  assertWithException( dimension < subspace->size(), "AST build option dimension is not a variable iterator of the subspace." );
+  this->ast_build_options[subspace][dimension] = option;
+}
+
+std::string Schedule::getASTBuildOptions() const {
+  const Subspace* nest = this->manager.get_nest();
+  std::string input_iterators = this->manager.get_input_iterators();
+  std::string default_dimension = nest->get( nest->size() , false );
+
+  // Options for annotated loops. The option's dimension is the loop's position in the full iteration space.
+  std::ostringstream annotated;
+  std::vector<Subspace::size_type> annotated_positions;
+  Subspace::size_type position = 0;
+  for( SubspaceManager::const_iterator cursor = this->manager.begin();
+       cursor != this->manager.end();
+       position += (*cursor)->complete_size(), ++cursor ){
+    std::map<Subspace*, std::map<Subspace::size_type, ASTBuildOption> >::const_iterator subspace_options = this->ast_build_options.find( *cursor );
+    if( subspace_options == this->ast_build_options.end() ){
+      continue;
+    }
+
+    for( const auto& dimension_option : subspace_options->second ){
+      std::string option_name;
+      switch( dimension_option.second ){
+        case ASTBuildOption::Separate: { option_name = "separate"; break; }
+        case ASTBuildOption::Atomic: { option_name = "atomic"; break; }
+        case ASTBuildOption::Unroll: { option_name = "unroll"; break; }
+      }
+
+      annotated << "; [" << input_iterators << "] -> "
+                << option_name << "[x] : x = " << (position + dimension_option.first);
+      annotated_positions.push_back( position + dimension_option.first );
+    }
+  }
+
+  std::ostringstream options;
+  // Default: separate on the nest subspace, unless the user annotated that loop with another option
+  options << "{ [" << input_iterators << "] -> "
+          << "separate[" << default_dimension << "]";
+  for( std::vector<Subspace::size_type>::size_type i = 0; i < annotated_positions.size(); i += 1 ){
+    options << ((i == 0)? " : " : " and ") << default_dimension << " != " << annotated_positions[i];
+  }
+  options << annotated.str() << " };";
+  return options.str();
+}
+
+void Schedule::addContextConstraint( std::string constraint ){
+  this->context_constraints.push_back( constraint );
+
+  // Validate the context now, rather than during code generation
+  isl_ctx* ctx = isl_ctx_alloc();
+  isl_set* context = isl_set_read_from_str( ctx, this->getContext().c_str() );
+  bool valid = context != NULL;
+  if( valid ){
+    isl_set_free( context );
+  }
+  isl_ctx_free( ctx );
+
+  if( !valid ){
+    this->context_constraints.pop_back();
+  }
+  assertWithException( valid, SSTR( "Context constraint \"" << constraint << "\" is not a valid constraint on the symbols of the chain." ) );
+}
+
+std::string Schedule::getContext() const {
+  std::ostringstream context;
+
+  context << "[";
+  bool is_not_first_symbolic = false;
+  for( std::string symbol : this->symbols ){
+    context << (is_not_first_symbolic?",":"") << symbol;
+    is_not_first_symbolic = true;
+  }
+  context << "] -> { : ";
+
+  bool is_not_first_constraint = false;
+  for( std::string constraint : this->context_constraints ){
+    context << (is_not_first_constraint?" and ":"") << "(" << constraint << ")";
+    is_not_first_constraint = true;
+  }
+  context << " }";
+
+  return context.str();
 }
 
 std::ostream& LoopChainIR::operator<<( std::ostream& os, const Schedule& schedule){
   return os << schedule.codegenToISCC() ;
 }
 
+void LoopChainIR::free_parallel_annotation( void* pragma ){
+  delete static_cast<std::string*>( pragma );
+}
+
+void LoopChainIR::free_doacross_annotation( void* loop ){
+  delete static_cast<DoacrossLoop*>( loop );
+}
+
+void LoopChainIR::free_runtime_annotation( void* tiles ){
+  delete static_cast<RuntimeTiles*>( tiles );
+}
+
+std::string LoopChainIR::parallel_annotation_pragma( __isl_keep isl_id* annotation ){
+  std::string* pragma = static_cast<std::string*>( isl_id_get_user( annotation ) );
+  return (pragma != NULL)? *pragma : std::string( "omp parallel for" );
+}
+
+std::vector<std::string> LoopChainIR::parallel_annotation_pragma_lines( __isl_keep isl_id* annotation ){
+  std::vector<std::string> lines;
+  std::istringstream pragma( parallel_annotation_pragma( annotation ) );
+  std::string line;
+  while( std::getline( pragma, line ) ){
+    lines.push_back( line );
+  }
+  return lines;
+}
+
 __isl_give isl_ast_node* LoopChainIR::custom_for_builder_callback( __isl_take isl_ast_node *node, __isl_keep isl_ast_build* build, void* user ){
   // Get dimensionality of loop nest at this point.
-  unsigned dimensions = isl_space_dim( isl_ast_build_get_schedule_space( build ), isl_dim_set );
-  // Magic cast void* to std::set<Subspace::size_type>*
-  std::set<Subspace::size_type>* depths = static_cast<std::set<Subspace::size_type>*>( user );
+  isl_space* schedule_space = isl_ast_build_get_schedule_space( build );
+  unsigned dimensions = isl_space_dim( schedule_space, isl_dim_set );
+  // Magic cast void* to ParallelDepths*
+  ParallelDepths* depths = static_cast<ParallelDepths*>( user );
+
+  // Doacross loops print their own ordered directives
+  std::set<LoopChain::size_type> nests;
+  if( depths->doacross.count(dimensions) != 0 ){
+    collectNests( node, depths->doacross[dimensions].statement_symbol, nests );
+  }
+  bool doacross = !nests.empty();
+  for( LoopChain::size_type nest : nests ){
+    doacross = doacross && depths->doacross[dimensions].nests.count( nest ) != 0;
+  }
+  if( doacross ){
+    isl_space_free( schedule_space );
+    isl_id* annotation = isl_id_alloc( isl_ast_build_get_ctx(build), "doacross annotation", new DoacrossLoop( depths->doacross[dimensions] ) );
+    assertWithException( annotation != NULL, "Failed to create annotation in custom_for_builder_callback." );
+    annotation = isl_id_set_free_user( annotation, free_doacross_annotation );
+    return isl_ast_node_set_annotation( node, annotation );
+  }
+
+  // The outermost runtime tile loop prints the tile loops within it
+  if( depths->runtime.count(dimensions) != 0 ){
+    isl_space_free( schedule_space );
+    isl_id* annotation = isl_id_alloc( isl_ast_build_get_ctx(build), "runtime annotation", new RuntimeTiles( depths->runtime[dimensions] ) );
+    assertWithException( annotation != NULL, "Failed to create annotation in custom_for_builder_callback." );
+    annotation = isl_id_set_free_user( annotation, free_runtime_annotation );
+    return isl_ast_node_set_annotation( node, annotation );
+  }
 
   // If no the appropriate depth, return exiting, unmodified node
-  if( depths->count(dimensions) == 0 ){
+  if( depths->pragmas.count(dimensions) == 0 ){
+    isl_space_free( schedule_space );
     return node;
   }
 
-  // Create annotation
+  // Replace $n with the iterator of the loop n loops out from this one, and $min(n) with its least value
+  std::string pragma = depths->pragmas[dimensions];
+  const std::string least = "min(";
+  for( std::string::size_type dollar = pragma.find( '$' ); dollar != std::string::npos; dollar = pragma.find( '$', dollar ) ){
+    bool minimum = pragma.compare( dollar + 1, least.size(), least ) == 0;
+    std::string::size_type begin = dollar + 1 + (minimum? least.size() : 0);
+    std::string::size_type end = pragma.find_first_not_of( "0123456789", begin );
+    end = (end == std::string::npos)? pragma.size() : end;
+    assertWithException( end > begin && (!minimum || (end < pragma.size() && pragma[end] == ')')),
+                         SSTR( "Expected loop number after $ in pragma \"" << pragma << "\"" ) );
+
+    unsigned outward = (unsigned) std::stoul( pragma.substr( begin, end - begin ) );
+    assertWithException( outward < dimensions, SSTR( "Pragma \"" << pragma << "\" refers to a loop outside of the schedule" ) );
+    std::string replacement( isl_space_get_dim_name( schedule_space, isl_dim_set, dimensions - 1 - outward ) );
+    if( minimum ){
+      std::map<std::string, std::string>::const_iterator value = depths->least_values.find( replacement );
+      assertWithException( value != depths->least_values.end(), SSTR( "Loop " << replacement << " has no least value over the schedule" ) );
+      replacement = value->second;
+      end += 1;
+    }
+
+    pragma.replace( dollar, end - dollar, replacement );
+    dollar += replacement.size();
+  }
+  isl_space_free( schedule_space );
+
+  assertCollapsible( node, pragma );
+
+  // Reduce into what the nests executed by this loop reduce into
+  if( depths->reductions.count(dimensions) != 0 ){
+    std::set<LoopChain::size_type> reducing;
+    collectNests( node, depths->statement_symbol, reducing );
+    std::map<std::string, std::string> clauses;
+    for( LoopChain::size_type nest : reducing ){
+      NestReductions::const_iterator found = depths->reductions[dimensions].find( nest );
+      if( found == depths->reductions[dimensions].end() ){
+        continue;
+      }
+      for( const auto& reduction : found->second ){
+        std::map<std::string, std::string>::const_iterator clause = clauses.insert( reduction ).first;
+        assertWithException( clause->second == reduction.second,
+                             SSTR( "Nests under a parallel loop reduce into " << reduction.first << " with both "
+                                   << clause->second << " and " << reduction.second ) );
+      }
+    }
+    for( const auto& clause : clauses ){
+      pragma += " " + clause.second;
+    }
+  }
+
+  // Create annotation, carrying the pragma text (freed with the annotation)
   string annotation_str = "parallel annotation";
-  isl_id* annotation = isl_id_alloc( isl_ast_build_get_ctx(build), annotation_str.c_str(), NULL );
+  isl_id* annotation = isl_id_alloc( isl_ast_build_get_ctx(build), annotation_str.c_str(), new std::string( pragma ) );
   assertWithException( annotation != NULL, "Failed to create annotation in custom_for_builder_callback." );
+  annotation = isl_id_set_free_user( annotation, free_parallel_annotation );
 
   // Add annotation
   isl_ast_node* new_node = isl_ast_node_set_annotation( node, annotation );
@@ -387,12 +1520,25 @@ __isl_give isl_ast_node* LoopChainIR::custom_for_builder_callback( __isl_take is
 __isl_give isl_printer* LoopChainIR::custom_for_printer_callback( __isl_take isl_printer *p, __isl_take isl_ast_print_options *options, __isl_keep isl_ast_node *node, void *user __attribute__((unused)) ){
   // Get annotation
   isl_id* maybe_annotation = isl_ast_node_get_annotation( node );
+  if( maybe_annotation != NULL && string( isl_id_get_name( maybe_annotation ) ) == string("doacross annotation") ){
+    const DoacrossLoop loop = *static_cast<DoacrossLoop*>( isl_id_get_user( maybe_annotation ) );
+    isl_id_free( maybe_annotation );
+    return printDoacross( node, p, options, loop );
+  }
+  if( maybe_annotation != NULL && string( isl_id_get_name( maybe_annotation ) ) == string("runtime annotation") ){
+    const RuntimeTiles tiles = *static_cast<RuntimeTiles*>( isl_id_get_user( maybe_annotation ) );
+    isl_id_free( maybe_annotation );
+    return printRuntimeTiles( node, p, options, tiles );
+  }
   // If annotation is not null, and if string is the parallel annotation string print openmp annotation
   if( maybe_annotation != NULL && string( isl_id_get_name( maybe_annotation ) ) == string("parallel annotation") ){
-    p = isl_printer_start_line(p);
-    p = isl_printer_print_str(p, "#pragma omp parallel for");
-    p = isl_printer_end_line(p);
+    for( const std::string& line : parallel_annotation_pragma_lines( maybe_annotation ) ){
+      p = isl_printer_start_line(p);
+      p = isl_printer_print_str(p, ("#pragma " + line).c_str() );
+      p = isl_printer_end_line(p);
+    }
   }
+  isl_id_free( maybe_annotation );
 
   // print the for node as usual
   p = isl_ast_node_for_print(node, p, options);
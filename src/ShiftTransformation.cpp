@@ -119,6 +119,7 @@ std::vector<std::string> ShiftTransformation::apply( Schedule& schedule, Subspac
   transformations.push_back( transformation.str() );
 
   // Modify shifts
+  schedule.preserveDataspaces( this->loop_id );
   schedule.getChain().getNest( this->loop_id ).shiftDataspaces( this->extent );
 
   // Return list of created transformations.
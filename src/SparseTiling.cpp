@@ -0,0 +1,328 @@
+/*! ****************************************************************************
+\file SparseTiling.cpp
+\authors Ian J. Bertolacci
+
+\brief
+Inspector-executor runtime for full sparse tiling of loop chains whose
+accesses go through index arrays (e.g. unstructured meshes).
+
+\copyright
+Copyright 2017 Universiy of Arizona
+*******************************************************************************/
+
+#include <LoopChainIR/SparseTiling.hpp>
+#include <LoopChainIR/util.hpp>
+#include <algorithm>
+#include <limits>
+#include <sstream>
+
+using namespace std;
+using namespace LoopChainIR;
+
+SparseAccess::SparseAccess( std::string dataspace, bool is_write, std::vector<int> offsets, std::vector<int> items )
+: dataspace( dataspace ), is_write( is_write ), offsets( offsets ), items( items )
+{
+  assertWithException( this->offsets.size() >= 1, "Offsets must have one more entry than there are iterations." );
+  assertWithException( this->offsets.front() == 0 && this->offsets.back() == (int) this->items.size(),
+                       SSTR( "Offsets of " << dataspace << " do not cover the item array." ) );
+  for( size_type i = 1; i < this->offsets.size(); i += 1 ){
+    assertWithException( this->offsets[i-1] <= this->offsets[i], SSTR( "Offsets of " << dataspace << " are not non-decreasing." ) );
+  }
+  for( int item : this->items ){
+    assertWithException( item >= 0, SSTR( "Negative item " << item << " accessed in " << dataspace ) );
+  }
+}
+
+SparseAccess SparseAccess::fromIndexArray( std::string dataspace, bool is_write, const std::vector<int>& index, SparseAccess::size_type arity ){
+  assertWithException( arity > 0 && index.size() % arity == 0, "Index array size must be a multiple of the arity." );
+
+  vector<int> offsets;
+  for( size_type i = 0; i <= index.size(); i += arity ){
+    offsets.push_back( (int) i );
+  }
+
+  return SparseAccess( dataspace, is_write, offsets, index );
+}
+
+SparseAccess SparseAccess::direct( std::string dataspace, bool is_write, SparseAccess::size_type iterations ){
+  vector<int> offsets( iterations + 1, 0 );
+  vector<int> items( iterations, 0 );
+  for( size_type i = 0; i < iterations; i += 1 ){
+    offsets[i+1] = (int) (i + 1);
+    items[i] = (int) i;
+  }
+
+  return SparseAccess( dataspace, is_write, offsets, items );
+}
+
+SparseAccess::size_type SparseAccess::iterations() const {
+  return this->offsets.size() - 1;
+}
+
+int SparseAccess::itemBound() const {
+  return (this->items.size() > 0)? *max_element( this->items.begin(), this->items.end() ) + 1 : 0;
+}
+
+const int* SparseAccess::beginItems( SparseAccess::size_type iteration ) const {
+  return this->items.data() + this->offsets[iteration];
+}
+
+const int* SparseAccess::endItems( SparseAccess::size_type iteration ) const {
+  return this->items.data() + this->offsets[iteration + 1];
+}
+
+SparseTileSchedule::SparseTileSchedule( int num_tiles, std::vector< std::vector<int> > tile_of )
+: num_tiles( num_tiles ), tile_of( tile_of ), tile_pointers(), tile_iterations()
+{
+  // Counting sort iterations of each loop by tile.
+  for( vector<int>& loop_tiles : this->tile_of ){
+    vector<int> pointers( num_tiles + 1, 0 );
+    for( int tile : loop_tiles ){
+      assertWithException( 0 <= tile && tile < num_tiles, SSTR( "Tile " << tile << " out of range." ) );
+      pointers[tile + 1] += 1;
+    }
+    for( int t = 0; t < num_tiles; t += 1 ){
+      pointers[t + 1] += pointers[t];
+    }
+
+    vector<int> iterations( loop_tiles.size(), 0 );
+    vector<int> cursor( pointers.begin(), pointers.end() - 1 );
+    for( size_type i = 0; i < loop_tiles.size(); i += 1 ){
+      iterations[ cursor[ loop_tiles[i] ]++ ] = (int) i;
+    }
+
+    this->tile_pointers.push_back( pointers );
+    this->tile_iterations.push_back( iterations );
+  }
+}
+
+int SparseTileSchedule::numTiles() const {
+  return this->num_tiles;
+}
+
+SparseTileSchedule::size_type SparseTileSchedule::numLoops() const {
+  return this->tile_of.size();
+}
+
+int SparseTileSchedule::tileOf( SparseTileSchedule::size_type loop, SparseTileSchedule::size_type iteration ) const {
+  return this->tile_of[loop][iteration];
+}
+
+const std::vector<int>& SparseTileSchedule::tilePointers( SparseTileSchedule::size_type loop ) const {
+  return this->tile_pointers[loop];
+}
+
+const std::vector<int>& SparseTileSchedule::tileIterations( SparseTileSchedule::size_type loop ) const {
+  return this->tile_iterations[loop];
+}
+
+void SparseTileSchedule::execute( std::function<void(SparseTileSchedule::size_type, int)> kernel ) const {
+  for( int tile = 0; tile < this->num_tiles; tile += 1 ){
+    for( size_type loop = 0; loop < this->numLoops(); loop += 1 ){
+      const vector<int>& pointers = this->tile_pointers[loop];
+      const vector<int>& iterations = this->tile_iterations[loop];
+      for( int p = pointers[tile]; p < pointers[tile + 1]; p += 1 ){
+        kernel( loop, iterations[p] );
+      }
+    }
+  }
+}
+
+std::string SparseTileSchedule::executorCode( std::string prefix, std::string statement_prefix ) const {
+  ostringstream code;
+  string tile = prefix + "tile";
+  string p = prefix + "p";
+
+  code << "for( int " << tile << " = 0; " << tile << " < " << this->num_tiles << "; " << tile << " += 1 ){\n";
+  for( size_type loop = 0; loop < this->numLoops(); loop += 1 ){
+    string pointers = SSTR( prefix << "tile_ptr_" << loop );
+    code << "  for( int " << p << " = " << pointers << "[" << tile << "]; "
+         << p << " < " << pointers << "[" << tile << " + 1]; " << p << " += 1 )\n"
+         << "    " << statement_prefix << "statement_" << loop
+         << "( " << prefix << "tile_iter_" << loop << "[" << p << "] );\n";
+  }
+  code << "}\n";
+
+  return code.str();
+}
+
+SparseTileInspector::SparseTileInspector()
+: loop_iterations(), loop_accesses()
+{ }
+
+SparseTileInspector::size_type SparseTileInspector::addLoop( SparseTileInspector::size_type iterations, std::vector<SparseAccess> accesses ){
+  for( const SparseAccess& access : accesses ){
+    assertWithException( access.iterations() == iterations,
+                         SSTR( "Access to " << access.dataspace << " is defined over " << access.iterations()
+                               << " iterations, but the loop has " << iterations ) );
+  }
+
+  this->loop_iterations.push_back( iterations );
+  this->loop_accesses.push_back( accesses );
+  return this->loop_iterations.size() - 1;
+}
+
+SparseTileInspector::size_type SparseTileInspector::numLoops() const {
+  return this->loop_iterations.size();
+}
+
+SparseTileSchedule SparseTileInspector::inspect( SparseTileInspector::size_type seed_loop, int num_tiles ) const {
+  assertWithException( seed_loop < this->numLoops(), SSTR( "Seed loop " << seed_loop << " does not exist." ) );
+  assertWithException( num_tiles > 0, "Must have one or more tiles." );
+
+  size_type iterations = this->loop_iterations[seed_loop];
+  vector<int> partition( iterations, 0 );
+  for( size_type i = 0; i < iterations; i += 1 ){
+    partition[i] = (int) ( ((long long) i * num_tiles) / iterations );
+  }
+
+  return this->inspect( seed_loop, partition );
+}
+
+namespace {
+  // Tile of an iteration without dependences on other loops.
+  int proportionalTile( SparseTileInspector::size_type iteration, SparseTileInspector::size_type iterations, int num_tiles ){
+    return (int) ( ((long long) iteration * num_tiles) / iterations );
+  }
+}
+
+SparseTileSchedule SparseTileInspector::inspect( SparseTileInspector::size_type seed_loop, std::vector<int> seed_partition ) const {
+  assertWithException( seed_loop < this->numLoops(), SSTR( "Seed loop " << seed_loop << " does not exist." ) );
+  assertWithException( seed_partition.size() == this->loop_iterations[seed_loop],
+                       "Seed partition must have a tile for every iteration of the seed loop." );
+
+  int num_tiles = 0;
+  for( int tile : seed_partition ){
+    assertWithException( tile >= 0, "Seed partition has a negative tile." );
+    num_tiles = max( num_tiles, tile + 1 );
+  }
+
+  // Number of items of each dataspace
+  map<string, int> item_bounds;
+  for( const vector<SparseAccess>& accesses : this->loop_accesses ){
+    for( const SparseAccess& access : accesses ){
+      item_bounds[access.dataspace] = max( item_bounds[access.dataspace], access.itemBound() );
+    }
+  }
+
+  vector< vector<int> > tile_of( this->numLoops() );
+  tile_of[seed_loop] = seed_partition;
+
+  // Per item, the extreme tile of the writes and of all accesses of the loops visited so far.
+  map<string, vector<int> > write_tile;
+  map<string, vector<int> > access_tile;
+
+  auto reset = [&]( int value ){
+    for( pair<const string, int>& bound : item_bounds ){
+      write_tile[bound.first].assign( bound.second, value );
+      access_tile[bound.first].assign( bound.second, value );
+    }
+  };
+
+  auto record = [&]( size_type loop, const int& (*pick)( const int&, const int& ) ){
+    for( const SparseAccess& access : this->loop_accesses[loop] ){
+      vector<int>& writes = write_tile[access.dataspace];
+      vector<int>& all = access_tile[access.dataspace];
+      for( size_type i = 0; i < this->loop_iterations[loop]; i += 1 ){
+        int tile = tile_of[loop][i];
+        for( const int* item = access.beginItems( i ); item != access.endItems( i ); ++item ){
+          all[*item] = pick( all[*item], tile );
+          if( access.is_write ){
+            writes[*item] = pick( writes[*item], tile );
+          }
+        }
+      }
+    }
+  };
+
+  // Grow a loop's tiles from the dependences recorded so far.
+  // A write conflicts with any access, a read only conflicts with writes.
+  auto grow = [&]( size_type loop, int none, const int& (*pick)( const int&, const int& ) ){
+    size_type iterations = this->loop_iterations[loop];
+    vector<int> bounds( iterations, none );
+
+    for( const SparseAccess& access : this->loop_accesses[loop] ){
+      const vector<int>& conflicts = (access.is_write)? access_tile[access.dataspace] : write_tile[access.dataspace];
+      for( size_type i = 0; i < iterations; i += 1 ){
+        for( const int* item = access.beginItems( i ); item != access.endItems( i ); ++item ){
+          bounds[i] = pick( bounds[i], conflicts[*item] );
+        }
+      }
+    }
+
+    tile_of[loop].assign( iterations, 0 );
+    for( size_type i = 0; i < iterations; i += 1 ){
+      int proportional = proportionalTile( i, iterations, num_tiles );
+      tile_of[loop][i] = (bounds[i] == none)? proportional : pick( bounds[i], proportional );
+    }
+  };
+
+  // Backward: each iteration must be in a tile no later than the later iterations depending on it.
+  reset( numeric_limits<int>::max() );
+  record( seed_loop, std::min<int> );
+  for( size_type loop = seed_loop; loop-- > 0; ){
+    grow( loop, numeric_limits<int>::max(), std::min<int> );
+    record( loop, std::min<int> );
+  }
+
+  // Forward: each iteration must be in a tile no earlier than the earlier iterations it depends on.
+  reset( numeric_limits<int>::min() );
+  for( size_type loop = 0; loop <= seed_loop; loop += 1 ){
+    record( loop, std::max<int> );
+  }
+  for( size_type loop = seed_loop + 1; loop < this->numLoops(); loop += 1 ){
+    grow( loop, numeric_limits<int>::min(), std::max<int> );
+    record( loop, std::max<int> );
+  }
+
+  return SparseTileSchedule( num_tiles, tile_of );
+}
+
+bool SparseTileInspector::isLegal( const SparseTileSchedule& schedule ) const {
+  if( schedule.numLoops() != this->numLoops() ){
+    return false;
+  }
+
+  // Latest tile of the writes and of all accesses to each item by previous loops
+  map<string, vector<int> > write_tile;
+  map<string, vector<int> > access_tile;
+  for( const vector<SparseAccess>& accesses : this->loop_accesses ){
+    for( const SparseAccess& access : accesses ){
+      vector<int>& writes = write_tile[access.dataspace];
+      vector<int>& all = access_tile[access.dataspace];
+      if( (int) writes.size() < access.itemBound() ){
+        writes.resize( access.itemBound(), numeric_limits<int>::min() );
+        all.resize( access.itemBound(), numeric_limits<int>::min() );
+      }
+    }
+  }
+
+  for( size_type loop = 0; loop < this->numLoops(); loop += 1 ){
+    for( const SparseAccess& access : this->loop_accesses[loop] ){
+      const vector<int>& conflicts = (access.is_write)? access_tile[access.dataspace] : write_tile[access.dataspace];
+      for( size_type i = 0; i < this->loop_iterations[loop]; i += 1 ){
+        for( const int* item = access.beginItems( i ); item != access.endItems( i ); ++item ){
+          if( conflicts[*item] > schedule.tileOf( loop, i ) ){
+            return false;
+          }
+        }
+      }
+    }
+
+    for( const SparseAccess& access : this->loop_accesses[loop] ){
+      vector<int>& writes = write_tile[access.dataspace];
+      vector<int>& all = access_tile[access.dataspace];
+      for( size_type i = 0; i < this->loop_iterations[loop]; i += 1 ){
+        int tile = schedule.tileOf( loop, i );
+        for( const int* item = access.beginItems( i ); item != access.endItems( i ); ++item ){
+          all[*item] = max( all[*item], tile );
+          if( access.is_write ){
+            writes[*item] = max( writes[*item], tile );
+          }
+        }
+      }
+    }
+  }
+
+  return true;
+}
@@ -0,0 +1,246 @@
+/*! ****************************************************************************
+\file StorageMapping.cpp
+\authors Ian J. Bertolacci
+
+\brief
+Modulo storage mapping (circular buffers) of a dataspace.
+
+\copyright
+Copyright 2017 Universiy of Arizona
+*******************************************************************************/
+
+#include <LoopChainIR/StorageMapping.hpp>
+#include <LoopChainIR/all_isl.hpp>
+#include <LoopChainIR/util.hpp>
+#include <algorithm>
+#include <sstream>
+
+using namespace std;
+using namespace LoopChainIR;
+
+namespace {
+
+  // Every access of the dataspace in the nest, translations included.
+  vector<AffineAccess> accessesOf( const Dataspace& dataspace, bool writes ){
+    vector<AffineAccess> accesses;
+    for( Tuple tuple : (writes? dataspace.writes() : dataspace.reads()) ){
+      accesses.push_back( AffineAccess( tuple ) );
+    }
+    const set<AffineAccess>& affine = (writes? dataspace.affineWrites() : dataspace.affineReads());
+    accesses.insert( accesses.end(), affine.begin(), affine.end() );
+    // A reduction reads and writes its targets
+    accesses.insert( accesses.end(), dataspace.reductionTargets().begin(), dataspace.reductionTargets().end() );
+    return accesses;
+  }
+
+  // "{ statement_k[i_0,i_1] -> A[i_0 + 1,i_1] }"
+  string accessMap( const string& statement, RectangularDomain::size_type dimensions, const string& name, const AffineAccess& access ){
+    assertWithException( access.iteratorDimensions() == dimensions,
+                         SSTR( "Access " << access << " of " << name << " does not match the dimensionality of " << statement ) );
+    ostringstream map;
+    map << "{ " << statement << "[";
+    for( RectangularDomain::size_type d = 0; d < dimensions; d += 1 ){
+      map << ((d > 0)?",":"") << "i_" << d;
+    }
+    map << "] -> " << name << "[";
+    for( AffineAccess::size_type row = 0; row < access.dimensions(); row += 1 ){
+      map << ((row > 0)?",":"");
+      for( AffineAccess::size_type column = 0; column < access.iteratorDimensions(); column += 1 ){
+        if( access.coefficient( row, column ) != 0 ){
+          map << access.coefficient( row, column ) << "*i_" << column << " + ";
+        }
+      }
+      map << access.offset()[row];
+    }
+    map << "] }";
+    return map.str();
+  }
+
+  // Exact dataflow of the reads from the writes under the schedule.
+  // Takes ownership of reads, writes and schedule.
+  void dataflow( isl_union_map* reads, isl_union_map* writes, isl_union_map* schedule,
+                 isl_union_map** dependences, isl_union_map** no_source ){
+    isl_union_access_info* info = isl_union_access_info_from_sink( reads );
+    info = isl_union_access_info_set_must_source( info, writes );
+    info = isl_union_access_info_set_schedule_map( info, schedule );
+    isl_union_flow* flow = isl_union_access_info_compute_flow( info );
+    assertWithException( flow != NULL, "Failed to compute dataflow of schedule." );
+    *dependences = isl_union_flow_get_must_dependence( flow );
+    *no_source = isl_union_flow_get_must_no_source( flow );
+    isl_union_flow_free( flow );
+  }
+
+}
+
+StorageMapping::StorageMapping( const LoopChain& chain, std::string dataspace, Tuple::size_type dimension )
+: StorageMapping( chain, dataspace, dimension, StorageMapping::reuseDistance( chain, dataspace, dimension ) )
+{ }
+
+StorageMapping::StorageMapping( const Schedule& schedule, std::string dataspace, Tuple::size_type dimension )
+: StorageMapping( schedule.getOriginalChain(), dataspace, dimension )
+{ }
+
+StorageMapping::StorageMapping( const LoopChain& chain, std::string dataspace, Tuple::size_type dimension, int modulus )
+: dataspace( dataspace ), dataspace_dimensions( 0 ), fold_dimension( dimension ), modulus( modulus )
+{
+  bool found = false;
+  for( const LoopNest& nest : chain ){
+    for( const Dataspace& candidate : nest.getDataspaces() ){
+      if( candidate.name == dataspace ){
+        found = true;
+        this->dataspace_dimensions = candidate.dimensions();
+      }
+    }
+  }
+
+  assertWithException( found, SSTR( "Dataspace " << dataspace << " is not accessed in the chain" ) );
+  assertWithException( dimension < this->dataspace_dimensions,
+                       SSTR( "Cannot fold dimension " << dimension << " of " << this->dataspace_dimensions << " dimensional dataspace " << dataspace ) );
+  assertWithException( modulus >= 1, SSTR( "Modulus must be positive, but got " << modulus ) );
+}
+
+int StorageMapping::reuseDistance( const LoopChain& chain, const std::string& dataspace, Tuple::size_type dimension ){
+  vector<Tuple> reads;
+  vector<Tuple> writes;
+  for( const LoopNest& nest : chain ){
+    for( const Dataspace& candidate : nest.getDataspaces() ){
+      if( candidate.name != dataspace ){
+        continue;
+      }
+      assertWithException( !candidate.isReduction(),
+                           SSTR( "Cannot derive the reuse distance of the reduction " << dataspace ) );
+      assertWithException( !candidate.hasAffineAccesses(),
+                           SSTR( "Cannot derive the reuse distance of " << dataspace << " from non-translation accesses; give the modulus explicitly" ) );
+      reads.insert( reads.end(), candidate.reads().begin(), candidate.reads().end() );
+      writes.insert( writes.end(), candidate.writes().begin(), candidate.writes().end() );
+    }
+  }
+
+  // A value written at iteration i through offset w is read at iteration
+  // i + w - r through offset r.
+  int distance = 0;
+  for( const Tuple& write : writes ){
+    for( const Tuple& read : reads ){
+      assertWithException( dimension < write.dimensions() && dimension < read.dimensions(),
+                           SSTR( "Cannot fold dimension " << dimension << " of dataspace " << dataspace ) );
+      distance = max( distance, write[dimension] - read[dimension] );
+    }
+  }
+
+  return distance + 1;
+}
+
+int StorageMapping::reuseDistance( const Schedule& schedule, const std::string& dataspace, Tuple::size_type dimension ){
+  return StorageMapping::reuseDistance( schedule.getOriginalChain(), dataspace, dimension );
+}
+
+const std::string& StorageMapping::getDataspace() const {
+  return this->dataspace;
+}
+
+Tuple::size_type StorageMapping::getDimension() const {
+  return this->fold_dimension;
+}
+
+int StorageMapping::getModulus() const {
+  return this->modulus;
+}
+
+std::string StorageMapping::getMap() const {
+  ostringstream map;
+  map << "{ " << this->dataspace << "[";
+  for( Tuple::size_type d = 0; d < this->dataspace_dimensions; d += 1 ){
+    map << ((d > 0)?",":"") << "a_" << d;
+  }
+  map << "] -> " << this->dataspace << "[";
+  for( Tuple::size_type d = 0; d < this->dataspace_dimensions; d += 1 ){
+    map << ((d > 0)?",":"") << "a_" << d;
+    if( d == this->fold_dimension ){
+      map << " mod " << this->modulus;
+    }
+  }
+  map << "] }";
+  return map.str();
+}
+
+std::string StorageMapping::indexExpression( const std::vector<std::string>& indices ) const {
+  assertWithException( indices.size() == this->dataspace_dimensions,
+                       SSTR( "Dataspace " << this->dataspace << " has " << this->dataspace_dimensions << " dimensions, but " << indices.size() << " indices were given" ) );
+
+  ostringstream subscript;
+  for( Tuple::size_type d = 0; d < indices.size(); d += 1 ){
+    if( d == this->fold_dimension ){
+      // Non-negative modulo, since indices may be negative
+      subscript << "[((" << indices[d] << ")%" << this->modulus << "+" << this->modulus << ")%" << this->modulus << "]";
+    } else {
+      subscript << "[" << indices[d] << "]";
+    }
+  }
+  return subscript.str();
+}
+
+bool StorageMapping::verify( const Schedule& schedule ) const {
+  // The schedule map applies to the statements as given, not to the accesses transformations rewrote
+  const LoopChain& chain = schedule.getChain();
+  string root_statement = schedule.getRootStatementSymbol();
+
+  isl_ctx* ctx = isl_ctx_alloc();
+
+  isl_union_set* domains = isl_union_set_empty( isl_space_params_alloc( ctx, 0 ) );
+  for( Schedule::const_iterator it = schedule.begin_domains(); it != schedule.end_domains(); ++it ){
+    domains = isl_union_set_union( domains, isl_union_set_read_from_str( ctx, (*it).c_str() ) );
+  }
+
+  isl_union_map* reads = isl_union_map_empty( isl_space_params_alloc( ctx, 0 ) );
+  isl_union_map* writes = isl_union_map_empty( isl_space_params_alloc( ctx, 0 ) );
+  for( LoopChain::size_type nest = 0; nest < chain.length(); nest += 1 ){
+    string statement = SSTR( root_statement << nest );
+    RectangularDomain::size_type dimensions = chain.getNest( nest ).dimensions();
+    for( const Dataspace& candidate : schedule.getOriginalDataspaces( nest ) ){
+      if( candidate.name != this->dataspace ){
+        continue;
+      }
+      for( const AffineAccess& access : accessesOf( candidate, false ) ){
+        reads = isl_union_map_union( reads, isl_union_map_read_from_str( ctx, accessMap( statement, dimensions, this->dataspace, access ).c_str() ) );
+      }
+      for( const AffineAccess& access : accessesOf( candidate, true ) ){
+        writes = isl_union_map_union( writes, isl_union_map_read_from_str( ctx, accessMap( statement, dimensions, this->dataspace, access ).c_str() ) );
+      }
+    }
+  }
+
+  reads = isl_union_map_intersect_domain( reads, isl_union_set_copy( domains ) );
+  writes = isl_union_map_intersect_domain( writes, domains );
+
+  isl_union_map* schedule_map = isl_union_map_read_from_str( ctx, schedule.getScheduleMap().c_str() );
+  isl_union_map* folding = isl_union_map_read_from_str( ctx, this->getMap().c_str() );
+
+  isl_union_map* dependences = NULL;
+  isl_union_map* no_source = NULL;
+  dataflow( isl_union_map_copy( reads ), isl_union_map_copy( writes ), isl_union_map_copy( schedule_map ),
+            &dependences, &no_source );
+
+  isl_union_map* folded_dependences = NULL;
+  isl_union_map* folded_no_source = NULL;
+  isl_union_map* folded_reads = isl_union_map_apply_range( reads, isl_union_map_copy( folding ) );
+  isl_union_map* folded_writes = isl_union_map_apply_range( writes, folding );
+  dataflow( folded_reads, folded_writes, schedule_map, &folded_dependences, &folded_no_source );
+
+  // Folded no-source reads are of the folded location, so compare only the
+  // statement instances.
+  no_source = isl_union_map_apply_range( no_source, isl_union_map_read_from_str( ctx, this->getMap().c_str() ) );
+
+  isl_bool same_dependences = isl_union_map_is_equal( dependences, folded_dependences );
+  isl_bool same_no_source = isl_union_map_is_equal( no_source, folded_no_source );
+
+  isl_union_map_free( dependences );
+  isl_union_map_free( no_source );
+  isl_union_map_free( folded_dependences );
+  isl_union_map_free( folded_no_source );
+  isl_ctx_free( ctx );
+
+  assertWithException( same_dependences != isl_bool_error && same_no_source != isl_bool_error,
+                       "Failed to compare dataflow of folded and unfolded storage." );
+
+  return same_dependences == isl_bool_true && same_no_source == isl_bool_true;
+}
@@ -22,37 +22,39 @@ using namespace std;
 const std::string Subspace::alias_prefix = "alias_";
 const std::string Subspace::const_suffix = "_c";
 
+namespace {
+  // Stores the iterator and its alias.
+  void add_iterator( const std::string& iterator, Subspace::Container& iterators, Subspace::Container& aliases ){
+    iterators.push_back( iterator );
+    aliases.push_back( Subspace::alias_prefix + iterator );
+  }
+}
+
 Subspace::Subspace( std::string var_iter_prefix, count_type var_iter_count )
-: const_index( var_iter_count ), variable_iterators(),
-  constant_iterator( SSTR( var_iter_prefix << Subspace::const_suffix ) ), all_iterators(),
+: const_index( var_iter_count ), all_iterators(), alias_iterators(),
   stage( timestamp_flags::Unstaged ),
   is_currently_aliased( false )
 {
   for( count_type i = 0; i < var_iter_count; ++i ){
-    this->variable_iterators.push_back( SSTR( var_iter_prefix << "_" << i) );
+    add_iterator( SSTR( var_iter_prefix << "_" << i ), this->all_iterators, this->alias_iterators );
   }
 
-  for( auto symbol : this->variable_iterators ){
-    this->all_iterators.push_back( symbol );
-  }
-  this->all_iterators.push_back( this->constant_iterator);
+  add_iterator( var_iter_prefix + Subspace::const_suffix, this->all_iterators, this->alias_iterators );
 }
 
 Subspace::Subspace( std::string prefix, count_type count, Subspace& that )
-: const_index( count ), variable_iterators(),
-  constant_iterator( SSTR( prefix << "_" << that.constant_iterator ) ),
-  all_iterators(), stage( timestamp_flags::Unstaged ),
+: const_index( count ), all_iterators(), alias_iterators(),
+  stage( timestamp_flags::Unstaged ),
   is_currently_aliased( false )
 {
-  assertWithException( that.variable_iterators.size() >= count, "There are fewer iterators in that subspace than needed by count." );
+  this->all_iterators.reserve( count + 1 );
+  this->alias_iterators.reserve( count + 1 );
+  assertWithException( that.size() >= count, "There are fewer iterators in that subspace than needed by count." );
   for( count_type i = 0; i < count; ++i ){
-    this->variable_iterators.push_back( SSTR( prefix << "_" << that.variable_iterators[i] ) );
+    add_iterator( SSTR( prefix << "_" << that.get( i, false ) ), this->all_iterators, this->alias_iterators );
   }
 
-  for( auto symbol : this->variable_iterators ){
-    this->all_iterators.push_back( symbol );
-  }
-  this->all_iterators.push_back( this->constant_iterator);
+  add_iterator( SSTR( prefix << "_" << that.get( that.const_index, false ) ), this->all_iterators, this->alias_iterators );
 }
 
 void Subspace::set_aliased(){
@@ -92,7 +94,7 @@ Subspace::const_iterator Subspace::end() const {
 }
 
 Subspace::size_type Subspace::size() const {
-  return this->variable_iterators.size();
+  return this->all_iterators.size() - 1;
 }
 
 Subspace::size_type Subspace::complete_size() const {
@@ -104,49 +106,45 @@ timestamp_t Subspace::get_stage() const {
 }
 
 std::string Subspace::get_iterators( timestamp_t stage, bool use_aliases ) const {
-  ostringstream stream;
+  std::string iterators;
+  this->append_iterators( stage, use_aliases, iterators );
+  return iterators;
+}
 
+void Subspace::append_iterators( timestamp_t stage, bool use_aliases, std::string& iterators ) const {
   if( this->get_stage() <= stage ){
-    bool not_first = false;
-    for( Subspace::const_iterator iter = this->begin( use_aliases ); iter != this->end(); ++iter ){
-      stream << (not_first?",":"") << *iter ;
-      not_first = true;
+    const Container& names = (this->is_aliased() && use_aliases)? this->alias_iterators : this->all_iterators;
+    for( const std::string& name : names ){
+      if( !iterators.empty() ){
+        iterators += ",";
+      }
+      iterators += name;
     }
   }
-
-  return stream.str();
 }
 
-std::string Subspace::get( Subspace::size_type index, bool use_aliases ) const {
+const std::string& Subspace::get( Subspace::size_type index, bool use_aliases ) const {
   if( this->is_aliased() && use_aliases ){
-    return SSTR( alias_prefix << this->all_iterators[index] );
+    return this->alias_iterators[index];
   } else {
     return this->all_iterators[index];
   }
 }
 
 
-std::string Subspace::operator[]( size_type index ) const {
+const std::string& Subspace::operator[]( size_type index ) const {
   return this->get( index, this->is_aliased() );
 }
 
-bool Subspace::operator==( const Subspace that ) const {
+bool Subspace::operator==( const Subspace& that ) const {
   if( this->complete_size() != that.complete_size() ){
     return false;
   }
 
-  for( Subspace::const_iterator iter_this = this->begin(false), iter_that = that.begin(false);
-       iter_this != this->end() && iter_that != that.end();
-       ++iter_this, ++iter_that ){
-    if( *iter_this != *iter_that ){
-      return false;
-    }
-  }
-
-  return true;
+  return this->all_iterators == that.all_iterators;
 }
 
-bool Subspace::operator!=( const Subspace that ) const {
+bool Subspace::operator!=( const Subspace& that ) const {
   return !( *this == that );
 }
 
@@ -158,20 +156,17 @@ SubspaceIterator::SubspaceIterator( const Subspace* subspace, base_iterator iter
 : subspace( subspace ), internal_iter( iter ), use_aliases( use_aliases )
 { }
 
-bool SubspaceIterator::operator==( const SubspaceIterator that ) const {
+bool SubspaceIterator::operator==( const SubspaceIterator& that ) const {
   return this->internal_iter == that.internal_iter;
 }
 
-bool SubspaceIterator::operator!=( const SubspaceIterator that ) const {
+bool SubspaceIterator::operator!=( const SubspaceIterator& that ) const {
   return !( *this == that );
 }
 
-SubspaceIterator::value_type SubspaceIterator::operator*(){
-  if( this->use_aliases && this->subspace->is_aliased() ){
-    return SSTR( this->subspace->alias_prefix << *(this->internal_iter) );
-  } else {
-    return *(this->internal_iter);
-  }
+const SubspaceIterator::value_type& SubspaceIterator::operator*(){
+  Subspace::size_type index = this->internal_iter - this->subspace->all_iterators.begin();
+  return this->subspace->get( index, this->use_aliases );
 }
 
 SubspaceIterator& SubspaceIterator::operator++(){
@@ -193,20 +188,17 @@ ConstSubspaceIterator::ConstSubspaceIterator( const Subspace* subspace, base_ite
 : subspace( subspace ), internal_iter( iter ), use_aliases( use_aliases )
 { }
 
-bool ConstSubspaceIterator::operator==( const ConstSubspaceIterator that ) const {
+bool ConstSubspaceIterator::operator==( const ConstSubspaceIterator& that ) const {
   return this->internal_iter == that.internal_iter;
 }
 
-bool ConstSubspaceIterator::operator!=( const ConstSubspaceIterator that ) const {
+bool ConstSubspaceIterator::operator!=( const ConstSubspaceIterator& that ) const {
   return !( *this == that );
 }
 
-ConstSubspaceIterator::value_type ConstSubspaceIterator::operator*(){
-  if( this->use_aliases && this->subspace->is_aliased() ){
-    return SSTR( this->subspace->alias_prefix << *(this->internal_iter) );
-  } else {
-    return *(this->internal_iter);
-  }
+const ConstSubspaceIterator::value_type& ConstSubspaceIterator::operator*(){
+  Subspace::size_type index = this->internal_iter - this->subspace->all_iterators.begin();
+  return this->subspace->get( index, this->use_aliases );
 }
 
 ConstSubspaceIterator& ConstSubspaceIterator::operator++(){
@@ -356,21 +348,23 @@ timestamp_t SubspaceManager::next_stage(){
 }
 
 std::string SubspaceManager::get_iterators( timestamp_t stage, bool use_aliases ) const {
-  ostringstream stream;
-
-  bool not_first = false;
+  // Size the buffer once, then append each Subspace in place.
+  std::string::size_type length = 0;
   for( SubspaceManager::const_iterator it = this->begin(); it != this->end(); ++it ){
     const Subspace* subspace = *it;
-    std::string subspace_str = subspace->get_iterators( stage, use_aliases );
-
-    if( subspace_str != "" ){
-      stream << (not_first? "," : "") << subspace_str;
+    for( Subspace::const_iterator name = subspace->begin( use_aliases ); name != subspace->end(); ++name ){
+      length += (*name).size() + 1;
     }
+  }
 
-    not_first = not_first || (subspace_str != "");
+  std::string iterators;
+  iterators.reserve( length );
+
+  for( SubspaceManager::const_iterator it = this->begin(); it != this->end(); ++it ){
+    (*it)->append_iterators( stage, use_aliases, iterators );
   }
 
-  return stream.str();
+  return iterators;
 }
 
 std::string SubspaceManager::get_iterators( ) const {
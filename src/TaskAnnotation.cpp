@@ -0,0 +1,194 @@
+/*! ****************************************************************************
+\file TaskAnnotation.cpp
+\authors Ian J. Bertolacci
+
+\brief
+Execute each tile of a tiling as an OpenMP task, ordered by depend clauses
+instead of the barriers of a wavefront.
+
+\copyright
+Copyright 2017 Universiy of Arizona
+*******************************************************************************/
+
+#include <LoopChainIR/TaskAnnotation.hpp>
+#include <LoopChainIR/util.hpp>
+#include <sstream>
+#include <map>
+#include <cstdlib>
+
+using namespace std;
+using namespace LoopChainIR;
+
+namespace {
+
+  bool lexicographicallyPositive( const vector<int>& vector ){
+    for( int value : vector ){
+      if( value != 0 ){
+        return value > 0;
+      }
+    }
+    return false;
+  }
+
+  int sign( int value ){
+    return (value > 0) - (value < 0);
+  }
+
+  // Add every lexicographically positive offset with offset[d] in {0, signs[d]}
+  void addOffsets( const vector<int>& signs, set<TaskAnnotation::TileOffset>& offsets ){
+    vector<int> offset( signs.size(), 0 );
+    while( true ){
+      if( lexicographicallyPositive( offset ) ){
+        offsets.insert( offset );
+      }
+
+      // Next combination
+      Subspace::size_type d = 0;
+      while( d < signs.size() && (signs[d] == 0 || offset[d] == signs[d]) ){
+        offset[d] = 0;
+        d += 1;
+      }
+      if( d == signs.size() ){
+        break;
+      }
+      offset[d] = signs[d];
+    }
+  }
+
+}
+
+TaskAnnotation::TaskAnnotation( LoopChain::size_type loop, std::string dependence_array )
+: TaskAnnotation( vector<LoopChain::size_type>( { loop } ), dependence_array )
+{ }
+
+TaskAnnotation::TaskAnnotation( std::vector<LoopChain::size_type> loops, std::string dependence_array )
+: loops( std::move( loops ) ), dependence_array( std::move( dependence_array ) )
+{
+  assertWithException( !this->loops.empty(), "TaskAnnotation requires at least one loop" );
+  assertWithException( !this->dependence_array.empty(), "TaskAnnotation requires a dependence array name" );
+}
+
+const std::string& TaskAnnotation::getDependenceArray() const {
+  return this->dependence_array;
+}
+
+std::set<TaskAnnotation::TileOffset> TaskAnnotation::tileDependences( const LoopChain& chain, const std::vector<LoopChain::size_type>& loops, Subspace::size_type tile_dimensions ){
+  // Reads and writes of each dataspace, over all the loops
+  map< string, vector<AffineAccess> > reads;
+  map< string, vector<AffineAccess> > writes;
+  set<TileOffset> offsets;
+
+  for( LoopChain::size_type loop : loops ){
+    assertWithException( loop < chain.length(), SSTR( "Loop " << loop << " is not in the chain" ) );
+    assertWithException( tile_dimensions <= chain.getNest( loop ).dimensions(),
+                         SSTR( "Cannot tile " << tile_dimensions << " dimensions of loop " << loop ) );
+
+    for( const Dataspace& dataspace : chain.getNest( loop ).getDataspaces() ){
+      assertWithException( !dataspace.isReduction(),
+                           SSTR( "Tasks of loop " << loop << " would race on the reduction into " << dataspace.name ) );
+      for( const Tuple& read : dataspace.reads() ){
+        reads[dataspace.name].push_back( AffineAccess( read ) );
+      }
+      for( const Tuple& write : dataspace.writes() ){
+        writes[dataspace.name].push_back( AffineAccess( write ) );
+      }
+      reads[dataspace.name].insert( reads[dataspace.name].end(), dataspace.affineReads().begin(), dataspace.affineReads().end() );
+      writes[dataspace.name].insert( writes[dataspace.name].end(), dataspace.affineWrites().begin(), dataspace.affineWrites().end() );
+    }
+  }
+
+  // Distance between two accesses of the same element, made lexicographically positive
+  auto addDistance = [&]( const string& name, const AffineAccess& from, const AffineAccess& to ){
+    assertWithException( to.isComparable( from ),
+                         SSTR( "Cannot derive the tile dependences between the accesses " << from << " and " << to << " of " << name ) );
+    Tuple to_from = Tuple::createMagicEmptyTuple();
+    vector<bool> constant;
+    if( !to.dependenceDistance( from, to_from, constant ) ){
+      return;
+    }
+    for( Subspace::size_type d = 0; d < tile_dimensions; d += 1 ){
+      assertWithException( constant[d],
+                           SSTR( "The accesses " << from << " and " << to << " of " << name << " touch the same element from every tile of dimension " << d ) );
+    }
+
+    vector<int> distance;
+    for( Tuple::size_type d = 0; d < to_from.dimensions(); d += 1 ){
+      distance.push_back( to_from[d] );
+    }
+    if( !lexicographicallyPositive( distance ) ){
+      for( int& value : distance ){
+        value = -value;
+      }
+    }
+
+    vector<int> signs;
+    for( Subspace::size_type d = 0; d < tile_dimensions; d += 1 ){
+      signs.push_back( sign( distance[d] ) );
+    }
+    addOffsets( signs, offsets );
+  };
+
+  for( const auto& dataspace : writes ){
+    for( const AffineAccess& write : dataspace.second ){
+      // Flow and anti dependences
+      for( const AffineAccess& read : reads[dataspace.first] ){
+        addDistance( dataspace.first, read, write );
+      }
+      // Output dependences
+      for( const AffineAccess& other : dataspace.second ){
+        addDistance( dataspace.first, other, write );
+      }
+    }
+  }
+
+  return offsets;
+}
+
+std::string TaskAnnotation::taskPragma( const std::set<TileOffset>& offsets, Subspace::size_type tile_dimensions ) const {
+  // Element of the dependence array of the tile at offset from this one
+  auto element = [&]( const TileOffset& offset ){
+    ostringstream element;
+    element << this->dependence_array;
+    for( Subspace::size_type d = 0; d < tile_dimensions; d += 1 ){
+      int index = 1 - offset[d];
+      element << "[$" << (tile_dimensions - d) << "-$min(" << (tile_dimensions - d) << ")";
+      if( index != 0 ){
+        element << ((index > 0)?"+":"-") << abs( index );
+      }
+      element << "]";
+    }
+    return element.str();
+  };
+
+  ostringstream pragma;
+  pragma << "omp task depend(out: " << element( TileOffset( tile_dimensions, 0 ) ) << ")";
+
+  if( !offsets.empty() ){
+    pragma << " depend(in: ";
+    bool first = true;
+    for( const TileOffset& offset : offsets ){
+      pragma << (first?"":", ") << element( offset );
+      first = false;
+    }
+    pragma << ")";
+  }
+
+  return pragma.str();
+}
+
+std::vector<std::string> TaskAnnotation::apply( Schedule& schedule __attribute__((unused)) ){
+  assertWithException( false, "TaskAnnotation must be applied over the tiles of a TileTransformation" );
+  return std::vector<std::string>();
+}
+
+std::vector<std::string> TaskAnnotation::apply( Schedule& schedule, Subspace* subspace ){
+  Subspace::size_type tile_dimensions = subspace->size();
+  set<TileOffset> offsets = TaskAnnotation::tileDependences( schedule.getChain(), this->loops, tile_dimensions );
+
+  // One thread creates the tasks, in the order of the tile loops
+  schedule.addParallelSubspace( subspace, 0, "omp parallel\nomp single" );
+  // The point loops of each tile are a task
+  schedule.addParallelSubspace( subspace, tile_dimensions, this->taskPragma( offsets, tile_dimensions ) );
+
+  return std::vector<std::string>();
+}
@@ -0,0 +1,346 @@
+/*! ****************************************************************************
+\file TileRuntime.cpp
+\authors Ian J. Bertolacci
+
+\brief
+A small dependence-driven runtime for executing the tiles of tiled (and fused)
+loop chains without the OpenMP runtime.
+
+\copyright
+Copyright 2017 Universiy of Arizona
+*******************************************************************************/
+
+#include <LoopChainIR/TileRuntime.hpp>
+#include <LoopChainIR/util.hpp>
+#include <algorithm>
+
+using namespace std;
+using namespace LoopChainIR;
+
+WorkStealingDeque::WorkStealingDeque( size_type capacity )
+: buffer( 0 ), mask( 0 ), top( 0 ), bottom( 0 )
+{
+  size_type size = 1;
+  while( size < capacity ){
+    size *= 2;
+  }
+  this->buffer = vector< atomic<size_type> >( size );
+  this->mask = size - 1;
+}
+
+WorkStealingDeque::size_type WorkStealingDeque::capacity() const {
+  return this->buffer.size();
+}
+
+void WorkStealingDeque::clear(){
+  this->top.store( 0, memory_order_relaxed );
+  this->bottom.store( 0, memory_order_relaxed );
+}
+
+void WorkStealingDeque::push( size_type tile ){
+  long b = this->bottom.load( memory_order_relaxed );
+  long t = this->top.load( memory_order_acquire );
+  assertWithException( (size_type)(b - t) < this->buffer.size(), "Work-stealing deque is full" );
+
+  this->buffer[ b & this->mask ].store( tile, memory_order_relaxed );
+  atomic_thread_fence( memory_order_release );
+  this->bottom.store( b + 1, memory_order_relaxed );
+}
+
+bool WorkStealingDeque::pop( size_type& tile ){
+  long b = this->bottom.load( memory_order_relaxed ) - 1;
+  this->bottom.store( b, memory_order_relaxed );
+  atomic_thread_fence( memory_order_seq_cst );
+  long t = this->top.load( memory_order_relaxed );
+
+  if( t > b ){
+    // Empty
+    this->bottom.store( b + 1, memory_order_relaxed );
+    return false;
+  }
+
+  tile = this->buffer[ b & this->mask ].load( memory_order_relaxed );
+  if( t == b ){
+    // Last tile: race the thieves for it
+    bool won = this->top.compare_exchange_strong( t, t + 1, memory_order_seq_cst, memory_order_relaxed );
+    this->bottom.store( b + 1, memory_order_relaxed );
+    return won;
+  }
+  return true;
+}
+
+bool WorkStealingDeque::steal( size_type& tile ){
+  long t = this->top.load( memory_order_acquire );
+  atomic_thread_fence( memory_order_seq_cst );
+  long b = this->bottom.load( memory_order_acquire );
+
+  if( t >= b ){
+    return false;
+  }
+
+  tile = this->buffer[ t & this->mask ].load( memory_order_relaxed );
+  return this->top.compare_exchange_strong( t, t + 1, memory_order_seq_cst, memory_order_relaxed );
+}
+
+TileGraph::TileGraph()
+: TileGraph( 0 )
+{ }
+
+TileGraph::TileGraph( size_type tiles )
+: successor_lists( tiles ), predecessor_counts( tiles, 0 ), extents()
+{ }
+
+TileGraph::size_type TileGraph::addTile(){
+  this->successor_lists.push_back( vector<size_type>() );
+  this->predecessor_counts.push_back( 0 );
+  this->extents.clear();
+  return this->successor_lists.size() - 1;
+}
+
+void TileGraph::addEdge( size_type from, size_type to ){
+  assertWithException( from < this->size() && to < this->size(),
+                       SSTR( "Edge " << from << " -> " << to << " is not between tiles of a graph of " << this->size() << " tiles" ) );
+  this->successor_lists[from].push_back( to );
+  this->predecessor_counts[to] += 1;
+}
+
+TileGraph::size_type TileGraph::size() const {
+  return this->successor_lists.size();
+}
+
+const std::vector<TileGraph::size_type>& TileGraph::successors( size_type tile ) const {
+  assertWithException( tile < this->size(), SSTR( "Tile " << tile << " is not in the graph" ) );
+  return this->successor_lists[tile];
+}
+
+TileGraph::size_type TileGraph::predecessors( size_type tile ) const {
+  assertWithException( tile < this->size(), SSTR( "Tile " << tile << " is not in the graph" ) );
+  return this->predecessor_counts[tile];
+}
+
+bool TileGraph::acyclic() const {
+  vector<size_type> pending( this->predecessor_counts );
+  vector<size_type> ready;
+  for( size_type tile = 0; tile < this->size(); tile += 1 ){
+    if( pending[tile] == 0 ){
+      ready.push_back( tile );
+    }
+  }
+
+  size_type visited = 0;
+  while( !ready.empty() ){
+    size_type tile = ready.back();
+    ready.pop_back();
+    visited += 1;
+    for( size_type successor : this->successor_lists[tile] ){
+      if( (pending[successor] -= 1) == 0 ){
+        ready.push_back( successor );
+      }
+    }
+  }
+
+  return visited == this->size();
+}
+
+TileGraph TileGraph::grid( const std::vector<size_type>& tiles, const std::set<TileOffset>& offsets ){
+  assertWithException( !tiles.empty(), "A grid of tiles needs at least one dimension" );
+  size_type count = 1;
+  for( size_type extent : tiles ){
+    count *= extent;
+  }
+  for( const TileOffset& offset : offsets ){
+    assertWithException( offset.size() == tiles.size(),
+                         SSTR( "Offset of " << offset.size() << " dimensions in a grid of " << tiles.size() ) );
+  }
+
+  TileGraph graph( count );
+  graph.extents = tiles;
+  for( size_type tile = 0; tile < count; tile += 1 ){
+    vector<size_type> coordinate = graph.coordinate( tile );
+    for( const TileOffset& offset : offsets ){
+      // Row-major id of coordinate - offset, if it is in the grid
+      bool inside = true;
+      size_type predecessor = 0;
+      for( size_type d = 0; d < tiles.size() && inside; d += 1 ){
+        long position = (long) coordinate[d] - offset[d];
+        inside = 0 <= position && position < (long) tiles[d];
+        predecessor = predecessor * tiles[d] + (size_type) position;
+      }
+      if( inside && predecessor != tile ){
+        graph.addEdge( predecessor, tile );
+      }
+    }
+  }
+
+  return graph;
+}
+
+std::vector<TileGraph::size_type> TileGraph::coordinate( size_type tile ) const {
+  assertWithException( !this->extents.empty(), "Tile coordinates are only known for graphs made by grid()" );
+  assertWithException( tile < this->size(), SSTR( "Tile " << tile << " is not in the graph" ) );
+
+  vector<size_type> coordinate( this->extents.size() );
+  for( size_type d = this->extents.size(); d > 0; d -= 1 ){
+    coordinate[d-1] = tile % this->extents[d-1];
+    tile /= this->extents[d-1];
+  }
+  return coordinate;
+}
+
+TileRuntime::TileRuntime( size_type workers )
+: deques(), threads(), mutex(), start_condition(), done_condition(),
+  generation( 0 ), finished_workers( 0 ), stopping( false ),
+  graph( NULL ), body( NULL ), pending_predecessors(), remaining( 0 ), aborted( false ),
+  failure(), steal_count( 0 )
+{
+  workers = max<size_type>( workers, 1 );
+  for( size_type worker = 0; worker < workers; worker += 1 ){
+    this->deques.push_back( unique_ptr<WorkStealingDeque>( new WorkStealingDeque( 1 ) ) );
+  }
+  // The thread calling run() is worker 0
+  for( size_type worker = 1; worker < workers; worker += 1 ){
+    this->threads.push_back( thread( &TileRuntime::serve, this, worker ) );
+  }
+}
+
+TileRuntime::~TileRuntime(){
+  {
+    lock_guard<std::mutex> lock( this->mutex );
+    this->stopping = true;
+  }
+  this->start_condition.notify_all();
+  for( thread& worker : this->threads ){
+    worker.join();
+  }
+}
+
+TileRuntime::size_type TileRuntime::workers() const {
+  return this->deques.size();
+}
+
+TileRuntime::size_type TileRuntime::steals() const {
+  return this->steal_count.load();
+}
+
+void TileRuntime::serve( size_type worker ){
+  size_type seen = 0;
+  while( true ){
+    {
+      unique_lock<std::mutex> lock( this->mutex );
+      this->start_condition.wait( lock, [&](){ return this->stopping || this->generation != seen; } );
+      if( this->stopping ){
+        return;
+      }
+      seen = this->generation;
+    }
+
+    this->work( worker );
+
+    {
+      lock_guard<std::mutex> lock( this->mutex );
+      this->finished_workers += 1;
+    }
+    this->done_condition.notify_one();
+  }
+}
+
+void TileRuntime::work( size_type worker ){
+  WorkStealingDeque& own = *this->deques[worker];
+  size_type workers = this->deques.size();
+
+  while( this->remaining.load( memory_order_acquire ) > 0 && !this->aborted.load( memory_order_relaxed ) ){
+    size_type tile;
+    bool found = own.pop( tile );
+    // Steal from the nearest workers first
+    for( size_type distance = 1; !found && distance < workers; distance += 1 ){
+      found = this->deques[ (worker + distance) % workers ]->steal( tile );
+      if( found ){
+        this->steal_count.fetch_add( 1, memory_order_relaxed );
+      }
+    }
+
+    if( !found ){
+      this_thread::yield();
+      continue;
+    }
+
+    try {
+      (*this->body)( tile );
+    } catch( ... ){
+      lock_guard<std::mutex> lock( this->mutex );
+      if( !this->aborted.exchange( true ) ){
+        this->failure = current_exception();
+      }
+      return;
+    }
+
+    // Successors made ready by this tile stay with this worker
+    for( size_type successor : this->graph->successors( tile ) ){
+      if( this->pending_predecessors[successor].fetch_sub( 1, memory_order_acq_rel ) == 1 ){
+        own.push( successor );
+      }
+    }
+    this->remaining.fetch_sub( 1, memory_order_acq_rel );
+  }
+}
+
+void TileRuntime::run( const TileGraph& graph, const TileBody& body ){
+  assertWithException( graph.acyclic(), "Tile graph has a cycle" );
+  if( graph.size() == 0 ){
+    return;
+  }
+
+  size_type workers = this->deques.size();
+  this->graph = &graph;
+  this->body = &body;
+  this->pending_predecessors.reset( new atomic<size_type>[ graph.size() ] );
+  this->remaining.store( graph.size() );
+  this->aborted.store( false );
+  this->failure = exception_ptr();
+  this->steal_count.store( 0 );
+
+  vector<size_type> ready;
+  for( size_type tile = 0; tile < graph.size(); tile += 1 ){
+    this->pending_predecessors[tile].store( graph.predecessors( tile ), memory_order_relaxed );
+    if( graph.predecessors( tile ) == 0 ){
+      ready.push_back( tile );
+    }
+  }
+
+  // Each tile is pushed once, so a deque never holds more than the graph
+  for( size_type worker = 0; worker < workers; worker += 1 ){
+    if( this->deques[worker]->capacity() < graph.size() ){
+      this->deques[worker].reset( new WorkStealingDeque( graph.size() ) );
+    }
+    this->deques[worker]->clear();
+  }
+
+  // Neighbouring ready tiles go to the same worker, first tile popped first
+  for( size_type worker = 0; worker < workers; worker += 1 ){
+    size_type first = (ready.size() * worker) / workers;
+    size_type last = (ready.size() * (worker + 1)) / workers;
+    for( size_type index = last; index > first; index -= 1 ){
+      this->deques[worker]->push( ready[index - 1] );
+    }
+  }
+
+  {
+    lock_guard<std::mutex> lock( this->mutex );
+    this->finished_workers = 0;
+    this->generation += 1;
+  }
+  this->start_condition.notify_all();
+
+  this->work( 0 );
+
+  {
+    unique_lock<std::mutex> lock( this->mutex );
+    this->done_condition.wait( lock, [&](){ return this->finished_workers == this->threads.size(); } );
+  }
+
+  this->graph = NULL;
+  this->body = NULL;
+  if( this->failure ){
+    rethrow_exception( this->failure );
+  }
+}
@@ -0,0 +1,48 @@
+/*! ****************************************************************************
+\file TileRuntimeAnnotation.cpp
+\authors Ian J. Bertolacci
+
+\brief
+Execute the tiles of a tiling with a TileRuntime instead of OpenMP.
+
+\copyright
+Copyright 2017 Universiy of Arizona
+*******************************************************************************/
+
+#include <LoopChainIR/TileRuntimeAnnotation.hpp>
+#include <LoopChainIR/TaskAnnotation.hpp>
+#include <LoopChainIR/util.hpp>
+
+using namespace std;
+using namespace LoopChainIR;
+
+TileRuntimeAnnotation::TileRuntimeAnnotation( LoopChain::size_type loop, std::string runtime )
+: TileRuntimeAnnotation( vector<LoopChain::size_type>( { loop } ), runtime )
+{ }
+
+TileRuntimeAnnotation::TileRuntimeAnnotation( std::vector<LoopChain::size_type> loops, std::string runtime )
+: loops( std::move( loops ) ), runtime( std::move( runtime ) )
+{
+  assertWithException( !this->loops.empty(), "TileRuntimeAnnotation requires at least one loop" );
+  assertWithException( !this->runtime.empty(), "TileRuntimeAnnotation requires a runtime name" );
+}
+
+const std::string& TileRuntimeAnnotation::getRuntime() const {
+  return this->runtime;
+}
+
+std::vector<std::string> TileRuntimeAnnotation::apply( Schedule& schedule __attribute__((unused)) ){
+  assertWithException( false, "TileRuntimeAnnotation must be applied over the tiles of a TileTransformation" );
+  return std::vector<std::string>();
+}
+
+std::vector<std::string> TileRuntimeAnnotation::apply( Schedule& schedule, Subspace* subspace ){
+  RuntimeTiles tiles;
+  tiles.runtime = this->runtime;
+  tiles.dimensions = subspace->size();
+  tiles.offsets = TaskAnnotation::tileDependences( schedule.getChain(), this->loops, tiles.dimensions );
+
+  schedule.addRuntimeSubspace( subspace, tiles );
+
+  return std::vector<std::string>();
+}
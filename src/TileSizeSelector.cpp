@@ -0,0 +1,122 @@
+/*! ****************************************************************************
+\file TileSizeSelector.cpp
+\authors Ian J. Bertolacci
+
+\brief
+Analytical cache model for picking the tile sizes of a loop nest.
+
+\copyright
+Copyright 2017 Universiy of Arizona
+*******************************************************************************/
+
+#include <LoopChainIR/TileSizeSelector.hpp>
+#include <LoopChainIR/util.hpp>
+#include <algorithm>
+#include <cstdlib>
+
+using namespace std;
+using namespace LoopChainIR;
+
+namespace {
+
+  // Parse a constant bound, returning false if it is symbolic.
+  bool constantBound( const string& bound, long& value ){
+    char* end = NULL;
+    value = strtol( bound.c_str(), &end, 10 );
+    return !bound.empty() && *end == '\0';
+  }
+
+}
+
+TileSizeSelector::TileSizeSelector( const LoopChain& chain, LoopChain::size_type loop, size_type element_size, size_type simd_width )
+: estimator( chain, map<string, size_type>(), element_size ), loop( loop ), dimensions( 0 ), simd_width( simd_width ), extents()
+{
+  assertWithException( loop < chain.length(), SSTR( "Loop " << loop << " is not in the chain" ) );
+  assertWithException( simd_width >= 1, "SIMD width must be at least one element" );
+
+  const LoopNest& nest = chain.getNest( loop );
+  this->dimensions = nest.dimensions();
+
+  for( size_type d = 0; d < this->dimensions; d += 1 ){
+    long lower = 0;
+    long upper = 0;
+    if( nest.isRectangular()
+        && constantBound( nest.getDomain().getLowerBound( d ), lower )
+        && constantBound( nest.getDomain().getUpperBound( d ), upper ) ){
+      this->extents.push_back( (upper >= lower)? (size_type)(upper - lower + 1) : 1 );
+    } else {
+      this->extents.push_back( 0 );
+    }
+  }
+}
+
+TileSizeSelector::size_type TileSizeSelector::footprint( const TileSizes& tile ) const {
+  return this->estimator.tileBytes( vector<LoopChain::size_type>( { this->loop } ), tile );
+}
+
+TileSizeSelector::TileSizes TileSizeSelector::grow( TileSizes tile, size_type cache_bytes ) const {
+  bool grew = true;
+  while( grew ){
+    grew = false;
+
+    // Try the smallest dimensions first (innermost on ties), keeping the tile square
+    vector<size_type> order;
+    for( size_type d = this->dimensions; d-- > 0; ){
+      order.push_back( d );
+    }
+    stable_sort( order.begin(), order.end(),
+                 [&tile]( size_type left, size_type right ){ return tile[left] < tile[right]; } );
+
+    for( size_type d : order ){
+      TileSizes candidate = tile;
+      candidate[d] *= 2;
+
+      // Do not grow beyond the loop (rounded up to a vector in the innermost dimension)
+      if( this->extents[d] != 0 ){
+        size_type limit = this->extents[d];
+        if( d == this->dimensions - 1 ){
+          limit = ((limit + this->simd_width - 1) / this->simd_width) * this->simd_width;
+        }
+        candidate[d] = min( candidate[d], max( limit, tile[d] ) );
+      }
+
+      if( candidate[d] != tile[d] && this->footprint( candidate ) <= cache_bytes ){
+        tile = candidate;
+        grew = true;
+        break;
+      }
+    }
+  }
+  return tile;
+}
+
+TileSizeSelector::TileSizes TileSizeSelector::select( size_type cache_bytes ) const {
+  return this->select( vector<size_type>( { cache_bytes } ) ).front();
+}
+
+std::vector<TileSizeSelector::TileSizes> TileSizeSelector::select( const std::vector<size_type>& cache_bytes ) const {
+  assertWithException( !cache_bytes.empty(), "No cache sizes given" );
+
+  TileSizes tile( this->dimensions, 1 );
+  tile.back() = this->simd_width;
+
+  vector<TileSizes> levels;
+  size_type previous = 0;
+  for( size_type cache : cache_bytes ){
+    assertWithException( cache >= previous, "Cache sizes must be given from the innermost level out" );
+    previous = cache;
+
+    tile = this->grow( tile, cache );
+    levels.push_back( tile );
+  }
+
+  return levels;
+}
+
+TileTransformation::TileMap TileSizeSelector::tileMap( const TileSizes& tile ){
+  TileTransformation::TileMap map;
+  for( size_type d = 0; d < tile.size(); d += 1 ){
+    map[d] = SSTR( tile[d] );
+  }
+  return map;
+}
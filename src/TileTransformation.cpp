@@ -13,31 +13,34 @@ Copyright 2017 Universiy of Arizona
 #include <LoopChainIR/TileTransformation.hpp>
 #include <LoopChainIR/DefaultSequentialTransformation.hpp>
 #include <LoopChainIR/util.hpp>
+#include <LoopChainIR/all_isl.hpp>
 #include <iostream>
 #include <sstream>
 #include <iostream>
 #include <algorithm>
+#include <cstdlib>
+#include <utility>
 
 using namespace LoopChainIR;
 
 int TileTransformation::num_prefixes_used = 0;
 
-TileTransformation::TileTransformation( LoopChain::size_type loop, TileMap tile_sizes, Transformation* over_tiles, Transformation* within_tiles )
-: TileTransformation( loop, tile_sizes, {over_tiles}, {within_tiles} )
+TileTransformation::TileTransformation( LoopChain::size_type loop, TileMap tile_sizes, Transformation* over_tiles, Transformation* within_tiles, bool separate_full_tiles )
+: TileTransformation( loop, tile_sizes, {over_tiles}, {within_tiles}, separate_full_tiles )
 { }
 
-TileTransformation::TileTransformation( LoopChain::size_type loop, TileMap tile_sizes, std::vector<Transformation*> over_tiles, std::vector<Transformation*> within_tiles )
-: loop(loop), tile_sizes( tile_sizes ), uniform( false ), over_tiles( over_tiles ), within_tiles( within_tiles )
+TileTransformation::TileTransformation( LoopChain::size_type loop, TileMap tile_sizes, std::vector<Transformation*> over_tiles, std::vector<Transformation*> within_tiles, bool separate_full_tiles )
+: loop(loop), tile_sizes( tile_sizes ), uniform( false ), over_tiles( over_tiles ), within_tiles( within_tiles ), separate_full_tiles( separate_full_tiles )
 {
   assertWithException( tile_sizes.size() > 0, "Must tile along one or more dimensions." );
 }
 
-TileTransformation::TileTransformation( LoopChain::size_type loop, TileMap tile_sizes, std::initializer_list<Transformation*> over_tiles, std::initializer_list<Transformation*> within_tiles )
-: TileTransformation( loop, tile_sizes, std::vector<Transformation*>( over_tiles ), std::vector<Transformation*>( within_tiles) )
+TileTransformation::TileTransformation( LoopChain::size_type loop, TileMap tile_sizes, std::initializer_list<Transformation*> over_tiles, std::initializer_list<Transformation*> within_tiles, bool separate_full_tiles )
+: TileTransformation( loop, tile_sizes, std::vector<Transformation*>( over_tiles ), std::vector<Transformation*>( within_tiles), separate_full_tiles )
 { }
 
-TileTransformation::TileTransformation( LoopChain::size_type loop, TileTransformation::TileMap tile_sizes )
-: TileTransformation( loop, tile_sizes, new DefaultSequentialTransformation(), new DefaultSequentialTransformation() )
+TileTransformation::TileTransformation( LoopChain::size_type loop, TileTransformation::TileMap tile_sizes, bool separate_full_tiles )
+: TileTransformation( loop, tile_sizes, new DefaultSequentialTransformation(), new DefaultSequentialTransformation(), separate_full_tiles )
 { }
 
 
@@ -57,6 +60,10 @@ LoopChain::size_type TileTransformation::getLoopId(){
   return this->loop;
 }
 
+bool TileTransformation::separatesFullTiles(){
+  return this->separate_full_tiles;
+}
+
 
 std::vector<std::string> TileTransformation::apply( Schedule& schedule){
   return this->apply( schedule, schedule.getSubspaceManager().get_nest() );
@@ -112,56 +119,129 @@ std::vector<std::string> TileTransformation::apply( Schedule& schedule, Subspace
 
   subspace->set_aliased();
 
+  std::string input_iterators = manager.get_input_iterators();
+
   // Create map header
-  transformation  << "{\n\t [" << manager.get_input_iterators() << "] -> ["
-                  << manager.get_output_iterators() << "] : \n\t\t"
-                  << loops->get( loops->const_index, false ) << " = "
+  std::ostringstream tile_header;
+  tile_header << "[" << input_iterators << "] -> ["
+              << manager.get_output_iterators() << "] : \n\t\t"
+              << loops->get( loops->const_index, false ) << " = "
   // Create condition to only map target loop
-                  << this->loop << " and "
+              << this->loop << " and "
   // Identity map tiled subspace const iterator
-                  << subspace->get( subspace->const_index, true ) << " = "
-                  << subspace->get( subspace->const_index, false ) << " and "
-  // map tiling subspace const iterator to 0
-                  << tile_subspace->get( tile_subspace->const_index, true )
-                  << " = 0";
+              << subspace->get( subspace->const_index, true ) << " = "
+              << subspace->get( subspace->const_index, false ) << " and "
+  // map tiling subspace const iterator (to 0, or to 1 for partial tiles)
+              << tile_subspace->get( tile_subspace->const_index, true )
+              << " = ";
 
   // Create tile conditions for each dimension of the tile
+  std::ostringstream tile_conditions;
+  // Relation between iterations in the same tile, used to find full tiles
+  std::ostringstream same_tile_conditions;
+  std::vector<std::string> tiled_iterators;
   for( Subspace::size_type i = 0; i < subspace->size(); ++i ){
     // Create tile condition for dimensions of the tile
     if( i < tile_subspace->size() ){
       auto tile_size = this->getSize((key_type) i);
-      transformation << " and\n\t\t" << tile_subspace->get(i,true) << " * "
-                     << tile_size << " <= " << subspace->get( i, false )
-                     << " < (" << tile_subspace->get(i,true) << " + 1 ) * "
-                     << tile_size;
+      tile_conditions << " and\n\t\t" << tile_subspace->get(i,true) << " * "
+                      << tile_size << " <= " << subspace->get( i, false )
+                      << " < (" << tile_subspace->get(i,true) << " + 1 ) * "
+                      << tile_size;
+      tiled_iterators.push_back( subspace->get( i, false ) );
+      same_tile_conditions << " and floor(" << subspace->get( i, false ) << "/" << tile_size << ") = "
+                           << "floor(same_" << subspace->get( i, false ) << "/" << tile_size << ")";
     }
     // alias map tiled subspace ( alias_i_0 = i_0 )
-    transformation << " and " << subspace->get( i, true ) << " = "
-                   << subspace->get( i, false );
+    tile_conditions << " and " << subspace->get( i, true ) << " = "
+                    << subspace->get( i, false );
   }
 
-  // End tile component of mapping.
-  transformation << ";\n\t";
-
   // Start identity mapping of non-target loops
   subspace->unset_aliased();
   tile_subspace->unset_aliased();
+  std::ostringstream identity;
   // Create map header
-  transformation  << "[" << manager.get_input_iterators() << "] -> ["
-                  << manager.get_output_iterators() << "] : \n\t\t"
+  identity << "[" << manager.get_input_iterators() << "] -> ["
+           << manager.get_output_iterators() << "] : \n\t\t"
   // Create condition to map non-target loops
-                  << loops->get( loops->const_index, false ) << " != "
-                  << this->loop;
+           << loops->get( loops->const_index, false ) << " != "
+           << this->loop;
 
   // If a previous susbpace was not found, then the tile iterators need to be mapped to 0
   if( !found_previous_tile_subspace ){
     for( Subspace::size_type i = 0; i < tile_subspace->complete_size(); ++i ){
-      transformation << " and\n\t\t" << tile_subspace->get( i, true ) << " = 0";
+      identity << " and\n\t\t" << tile_subspace->get( i, true ) << " = 0";
     }
   }
 
-  // End mapping
-  transformation << ";\n};";
+  if( !this->separate_full_tiles ){
+    transformation << "{\n\t " << tile_header.str() << "0" << tile_conditions.str() << ";\n\t"
+                   << identity.str() << ";\n};";
+  } else {
+    // The iteration space is only known for transformations already appended to
+    // the schedule, which excludes those created by an enclosing transformation.
+    assertWithException( schedule.getDepth() == 0, "Full tile separation is only supported on tiling applied directly to the schedule." );
+    for( std::pair<key_type, mapped_type> tile_size : this->tile_sizes ){
+      assertWithException( tile_size.second.find_first_not_of("0123456789") == std::string::npos,
+                           SSTR( "Full tile separation requires constant tile sizes, but dimension " << tile_size.first << " has size " << tile_size.second ) );
+    }
+
+    // Relate each iteration to the iterations in the same tile
+    std::ostringstream same_tile;
+    same_tile << "{ [" << input_iterators << "] -> [";
+    std::ostringstream same_identity;
+    {
+      std::istringstream iterators( input_iterators );
+      std::string iterator;
+      bool first = true;
+      while( std::getline( iterators, iterator, ',' ) ){
+        iterator.erase( std::remove( iterator.begin(), iterator.end(), ' ' ), iterator.end() );
+        same_tile << (first?"":",") << "same_" << iterator;
+        if( std::find( tiled_iterators.begin(), tiled_iterators.end(), iterator ) == tiled_iterators.end() ){
+          same_identity << " and same_" << iterator << " = " << iterator;
+        }
+        first = false;
+      }
+    }
+    // Drop the leading " and " from the conditions
+    same_tile << "] : " << SSTR( same_identity.str() << same_tile_conditions.str() ).substr( 5 ) << " }";
+
+    isl_ctx* ctx = isl_ctx_alloc();
+
+    isl_union_set* iterations = isl_union_set_read_from_str( ctx, schedule.getIterationSpace().c_str() );
+    isl_union_map* same_tile_map = isl_union_map_read_from_str( ctx, same_tile.str().c_str() );
+    assertWithException( iterations != NULL && same_tile_map != NULL, "Failed to build tile relation during full tile separation." );
+
+    // Partial tiles are those containing an iteration outside the iteration space.
+    isl_union_set* outside = isl_union_set_subtract( isl_union_set_universe( isl_union_set_copy( iterations ) ), isl_union_set_copy( iterations ) );
+    same_tile_map = isl_union_map_intersect_domain( same_tile_map, isl_union_set_copy( iterations ) );
+    same_tile_map = isl_union_map_intersect_range( same_tile_map, outside );
+    isl_union_set* partial = isl_union_map_domain( same_tile_map );
+    isl_union_set* full = isl_union_set_subtract( isl_union_set_copy( iterations ), isl_union_set_copy( partial ) );
+    partial = isl_union_set_intersect( partial, iterations );
+
+    std::string full_map_text = SSTR( "{ " << tile_header.str() << "0" << tile_conditions.str() << " }" );
+    std::string partial_map_text = SSTR( "{ " << tile_header.str() << "1" << tile_conditions.str() << " }" );
+    std::string identity_map_text = SSTR( "{ " << identity.str() << " }" );
+
+    isl_union_map* full_map = isl_union_map_intersect_domain( isl_union_map_read_from_str( ctx, full_map_text.c_str() ), full );
+    isl_union_map* partial_map = isl_union_map_intersect_domain( isl_union_map_read_from_str( ctx, partial_map_text.c_str() ), partial );
+    isl_union_map* identity_map = isl_union_map_read_from_str( ctx, identity_map_text.c_str() );
+
+    isl_union_map* tile_map = isl_union_map_union( isl_union_map_union( full_map, partial_map ), identity_map );
+    assertWithException( tile_map != NULL, "Failed to create full tile separation map." );
+
+    isl_printer* printer = isl_printer_to_str( ctx );
+    printer = isl_printer_print_union_map( printer, tile_map );
+    char* tile_map_text = isl_printer_get_str( printer );
+    transformation << tile_map_text;
+
+    free( tile_map_text );
+    isl_printer_free( printer );
+    isl_union_map_free( tile_map );
+    isl_ctx_free( ctx );
+  }
 
   // Add transformation to our list
   transformations.push_back( transformation.str() );
@@ -194,7 +274,7 @@ std::vector<std::string> TileTransformation::apply( Schedule& schedule, Subspace
     else /* value < 0 */ return -1;
   };
 
-  for( Dataspace dataspace : schedule.getChain().getNest( this->getLoopId() ).getDataspaces() ){
+  for( const Dataspace& dataspace : schedule.getChain().getNest( this->getLoopId() ).getDataspaces() ){
 
     std::set<Tuple> read_set;
     std::set<Tuple> write_set;
@@ -218,13 +298,46 @@ std::vector<std::string> TileTransformation::apply( Schedule& schedule, Subspace
       write_set.insert( Tuple( values ) );
     }
 
+    // Affine accesses keep their coefficients. The offset c = a*q + r of a row with
+    // coefficient a (0 <= r < |a|) is q iterations away, so it becomes a*func(q) + r.
+    // Constant rows (broadcasts) keep their index.
+    auto affine_func = [&func, &dataspace]( const std::set<AffineAccess>& accesses ){
+      std::set<AffineAccess> result;
+      for( const AffineAccess& access : accesses ){
+        assertWithException( access.isSeparable(),
+                             SSTR( "Cannot tile access " << access.str() << " to " << dataspace.name << ", whose indices depend on several iterators" ) );
+        Tuple offset = access.offset();
+        std::vector<int> values( offset.begin(), offset.end() );
+        for( AffineAccess::size_type row = 0; row < access.dimensions(); row += 1 ){
+          for( AffineAccess::size_type column = 0; column < access.iteratorDimensions(); column += 1 ){
+            int coefficient = access.coefficient( row, column );
+            if( coefficient != 0 ){
+              int remainder = ( (values[row] % std::abs( coefficient )) + std::abs( coefficient ) ) % std::abs( coefficient );
+              values[row] = coefficient * func( (values[row] - remainder) / coefficient ) + remainder;
+            }
+          }
+        }
+        result.insert( access.withOffset( Tuple( values ) ) );
+      }
+      return result;
+    };
+
+    if( dataspace.isReduction() ){
+      new_dataspaces.push_back( Dataspace( dataspace.name, dataspace.reductionOperator(), affine_func( dataspace.reductionTargets() ) ) );
+      continue;
+    }
+
+    std::set<AffineAccess> affine_read_set = affine_func( dataspace.affineReads() );
+    std::set<AffineAccess> affine_write_set = affine_func( dataspace.affineWrites() );
+
     TupleCollection reads( read_set, dataspace.reads().dimensions() );
     TupleCollection writes( write_set, dataspace.writes().dimensions() );
 
-    new_dataspaces.push_back( Dataspace( dataspace.name, reads, writes ) );
+    new_dataspaces.push_back( Dataspace( dataspace.name, reads, writes, affine_read_set, affine_write_set ) );
   }
 
-  schedule.getChain().getNest( this->getLoopId() ).replaceDataspaces( new_dataspaces );
+  schedule.preserveDataspaces( this->getLoopId() );
+  schedule.getChain().getNest( this->getLoopId() ).replaceDataspaces( std::move( new_dataspaces ) );
 
   // Return all transformations
   return transformations;
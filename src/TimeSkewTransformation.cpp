@@ -0,0 +1,190 @@
+/*! ****************************************************************************
+\file TimeSkewTransformation.cpp
+\authors Ian J. Bertolacci
+
+\brief
+Temporal blocking of a loop chain with a time domain: skew the nests by the
+time step, and tile time together with the nests' outermost dimensions.
+
+\copyright
+Copyright 2017 Universiy of Arizona
+*******************************************************************************/
+
+#include <LoopChainIR/TimeSkewTransformation.hpp>
+#include <LoopChainIR/util.hpp>
+#include <algorithm>
+#include <sstream>
+
+using namespace std;
+using namespace LoopChainIR;
+
+namespace {
+
+  /*
+  Smallest distance in each of the first dimensions of the dependences of
+  later on earlier.
+  Returns false if the nests do not depend on each other.
+  */
+  bool smallestDistances( const LoopNest& earlier, const LoopNest& later, TimeSkewTransformation::size_type dimensions, vector<int>& distances ){
+    bool dependent = false;
+    distances.assign( dimensions, 0 );
+    for( const DependenceDistance& dependence : dependenceDistances( earlier, later ) ){
+      for( TimeSkewTransformation::size_type d = 0; d < dimensions; d += 1 ){
+        distances[d] = dependent? min( distances[d], dependence.distance[d] ) : dependence.distance[d];
+      }
+      dependent = true;
+    }
+    return dependent;
+  }
+
+}
+
+TimeSkewTransformation::TimeSkewTransformation( int time_tile, std::vector<int> space_tiles, bool fuse )
+: time_tile( time_tile ), space_tiles( std::move( space_tiles ) ), fuse( fuse )
+{
+  assertWithException( this->time_tile > 0, SSTR( "Time tile size must be positive, not " << this->time_tile ) );
+  assertWithException( !this->space_tiles.empty(), "Must tile at least one dimension of the nests" );
+  for( int size : this->space_tiles ){
+    assertWithException( size > 0, SSTR( "Tile size must be positive, not " << size ) );
+  }
+}
+
+int TimeSkewTransformation::getTimeTile() const {
+  return this->time_tile;
+}
+
+const std::vector<int>& TimeSkewTransformation::getSpaceTiles() const {
+  return this->space_tiles;
+}
+
+bool TimeSkewTransformation::fusesNests() const {
+  return this->fuse;
+}
+
+std::vector< std::vector<int> > TimeSkewTransformation::nestShifts( const LoopChain& chain, size_type dimensions ){
+  for( LoopChain::size_type loop = 0; loop < chain.length(); loop += 1 ){
+    const LoopNest& nest = chain.getNest( loop );
+    assertWithException( nest.dimensions() >= dimensions, SSTR( "Loop " << loop << " has fewer than " << dimensions << " dimensions" ) );
+
+    // Dependences between iterations of the nest in the same time step must not point backward
+    for( const DependenceDistance& dependence : dependenceDistances( nest, nest ) ){
+      bool positive = false;
+      for( Tuple::size_type d = 0; d < dependence.distance.dimensions(); d += 1 ){
+        if( dependence.distance[d] != 0 ){
+          positive = dependence.distance[d] > 0;
+          break;
+        }
+      }
+      for( size_type d = 0; d < dimensions; d += 1 ){
+        assertWithException( (positive? dependence.distance[d] : -dependence.distance[d]) >= 0,
+                             SSTR( "Iterations of loop " << loop << " depend backward in dimension " << d << " through " << dependence.dataspace ) );
+      }
+    }
+  }
+
+  // Each nest is shifted past the (shifted) iterations of earlier nests it depends on
+  std::vector< std::vector<int> > shifts( chain.length(), std::vector<int>( dimensions, 0 ) );
+  for( LoopChain::size_type later = 0; later < chain.length(); later += 1 ){
+    for( LoopChain::size_type earlier = 0; earlier < later; earlier += 1 ){
+      vector<int> distances;
+      if( smallestDistances( chain.getNest( earlier ), chain.getNest( later ), dimensions, distances ) ){
+        for( size_type d = 0; d < dimensions; d += 1 ){
+          shifts[later][d] = max( shifts[later][d], shifts[earlier][d] - distances[d] );
+        }
+      }
+    }
+  }
+
+  return shifts;
+}
+
+std::vector<int> TimeSkewTransformation::skewFactors( const LoopChain& chain, const std::vector< std::vector<int> >& shifts ){
+  assertWithException( shifts.size() == chain.length(), "Must have a shift for every loop in the chain" );
+  size_type dimensions = shifts.empty()? 0 : shifts.front().size();
+
+  // Any nest of a time step may depend on any nest of the previous one
+  std::vector<int> factors( dimensions, 0 );
+  for( LoopChain::size_type earlier = 0; earlier < chain.length(); earlier += 1 ){
+    for( LoopChain::size_type later = 0; later < chain.length(); later += 1 ){
+      vector<int> distances;
+      if( smallestDistances( chain.getNest( earlier ), chain.getNest( later ), dimensions, distances ) ){
+        for( size_type d = 0; d < dimensions; d += 1 ){
+          factors[d] = max( factors[d], shifts[earlier][d] - shifts[later][d] - distances[d] );
+        }
+      }
+    }
+  }
+
+  return factors;
+}
+
+std::vector<std::string> TimeSkewTransformation::apply( Schedule& schedule ){
+  return this->apply( schedule, schedule.getSubspaceManager().get_nest() );
+}
+
+std::vector<std::string> TimeSkewTransformation::apply( Schedule& schedule, Subspace* subspace ){
+  SubspaceManager& manager = schedule.getSubspaceManager();
+  Subspace* time = schedule.getTimeSubspace();
+  Subspace* loops = manager.get_loops();
+  const LoopChain& chain = schedule.getChain();
+  assertWithException( time != NULL, "Time skewing requires a chain with a time domain" );
+  assertWithException( subspace == manager.get_nest(), "Can only time skew the nest subspace" );
+
+  // Fusing needs every dimension of the shifted nests to be in order
+  size_type dimensions = this->space_tiles.size();
+  if( this->fuse ){
+    for( LoopChain::size_type loop = 0; loop < chain.length(); loop += 1 ){
+      assertWithException( chain.getNest( loop ).dimensions() == chain.getNest( 0 ).dimensions(),
+                           "Fused loops must have the same number of dimensions" );
+    }
+    dimensions = max( dimensions, (chain.length() > 0)? chain.getNest( 0 ).dimensions() : 0 );
+  }
+
+  std::vector< std::vector<int> > shifts = TimeSkewTransformation::nestShifts( chain, dimensions );
+  std::vector<int> factors = TimeSkewTransformation::skewFactors( chain, shifts );
+
+  // Subspace of the tiles, outside the time loop
+  Subspace* tiles = new Subspace( manager.get_safe_prefix( "ts" ), 1 + this->space_tiles.size() );
+  manager.insert_left( tiles, manager.get_iterator_to_subspace( time ) );
+
+  tiles->set_aliased();
+  if( this->fuse ){
+    loops->set_aliased();
+    subspace->set_aliased();
+  }
+
+  std::string header = SSTR( "[" << manager.get_input_iterators() << "] -> [" << manager.get_output_iterators() << "] : " );
+  std::string time_iterator = time->get( 0, false );
+
+  std::ostringstream transformation;
+  transformation << "{";
+  for( LoopChain::size_type loop = 0; loop < chain.length(); loop += 1 ){
+    transformation << "\n\t" << header << "\n\t\t"
+                   << loops->get( loops->const_index, false ) << " = " << loop << " and "
+                   << tiles->get( 0, true ) << " = floor(" << time_iterator << "/" << this->time_tile << ") and "
+                   << tiles->get( tiles->const_index, true ) << " = 0";
+
+    for( size_type d = 0; d < this->space_tiles.size(); d += 1 ){
+      transformation << " and " << tiles->get( d + 1, true ) << " = floor(("
+                     << subspace->get( d, false ) << " + " << shifts[loop][d] << " + " << factors[d] << "*" << time_iterator
+                     << ")/" << this->space_tiles[d] << ")";
+    }
+
+    // Shifted nests fused within each time step, ordered by nest in the nest subspace's constant iterator
+    if( this->fuse ){
+      transformation << " and " << loops->get( loops->const_index, true ) << " = 0";
+      for( Subspace::size_type d = 0; d < subspace->size(); d += 1 ){
+        transformation << " and " << subspace->get( d, true ) << " = " << subspace->get( d, false )
+                       << ((d < dimensions)? SSTR( " + " << shifts[loop][d] ) : std::string( "" ));
+      }
+      transformation << " and " << subspace->get( subspace->const_index, true ) << " = " << loop;
+    }
+
+    transformation << ";";
+  }
+  transformation << "\n};";
+
+  std::vector<std::string> transformations;
+  transformations.push_back( transformation.str() );
+  return transformations;
+}
@@ -0,0 +1,137 @@
+/*! ****************************************************************************
+\file IRCopy_benchmark.cpp
+\authors Ian J. Bertolacci
+
+\brief
+Counts heap allocations (and time) spent building a long loop chain,
+walking its accesses, and scheduling and shifting it, with the chain either
+copied into or moved into the Schedule.
+
+Usage: IRCopy_benchmark [nests (default 500)]
+
+\copyright
+Copyright 2017 Universiy of Arizona
+*******************************************************************************/
+
+#include <LoopChainIR/Schedule.hpp>
+#include <LoopChainIR/ShiftTransformation.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <utility>
+
+using namespace std;
+using namespace LoopChainIR;
+
+namespace {
+  size_t allocations = 0;
+}
+
+void* operator new( size_t size ){
+  allocations += 1;
+  void* pointer = malloc( (size > 0)? size : 1 );
+  if( pointer == NULL ){
+    throw bad_alloc();
+  }
+  return pointer;
+}
+
+void operator delete( void* pointer ) noexcept {
+  free( pointer );
+}
+
+namespace {
+
+  struct Measurement {
+    size_t allocations;
+    double milliseconds;
+  };
+
+  template<typename Function>
+  Measurement measure( Function function ){
+    size_t start_allocations = allocations;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    function();
+    chrono::steady_clock::time_point end = chrono::steady_clock::now();
+    return { allocations - start_allocations,
+             chrono::duration<double, milli>( end - start ).count() };
+  }
+
+  void report( string name, Measurement measurement ){
+    cout << left << setw( 32 ) << name
+         << right << setw( 12 ) << measurement.allocations << " allocations"
+         << setw( 12 ) << fixed << setprecision( 3 ) << measurement.milliseconds << " ms"
+         << endl;
+  }
+
+  // 2D five point stencil nests, alternating between two dataspaces.
+  LoopChain makeChain( LoopChain::size_type nests ){
+    LoopChain chain;
+    for( LoopChain::size_type n = 0; n < nests; n += 1 ){
+      string lower[2] = { "1", "1" };
+      string upper[2] = { "N", "M" };
+      set<string> symbols = { "N", "M" };
+      string from = (n % 2 == 0)? "A" : "B";
+      string to = (n % 2 == 0)? "B" : "A";
+
+      list<Dataspace> dataspaces;
+      dataspaces.push_back( Dataspace( from,
+                                       TupleCollection( { Tuple( { 0, 0 } ), Tuple( { -1, 0 } ), Tuple( { 1, 0 } ), Tuple( { 0, -1 } ), Tuple( { 0, 1 } ) } ),
+                                       TupleCollection( 2 ) ) );
+      dataspaces.push_back( Dataspace( to, TupleCollection( 2 ), TupleCollection( { Tuple( { 0, 0 } ) } ) ) );
+
+      chain.append( LoopNest( RectangularDomain( lower, upper, 2, symbols ), std::move( dataspaces ) ) );
+    }
+    return chain;
+  }
+
+  void shiftSome( Schedule& schedule, LoopChain::size_type nests ){
+    vector<ShiftTransformation> shifts;
+    for( LoopChain::size_type n = 1; n < nests && shifts.size() < 4; n += nests / 4 ){
+      shifts.push_back( ShiftTransformation( n, Tuple( { 1, 1 } ) ) );
+    }
+    vector<Transformation*> schedulers;
+    for( ShiftTransformation& shift : shifts ){
+      schedulers.push_back( &shift );
+    }
+    schedule.apply( schedulers );
+  }
+
+}
+
+int main( int argc, char** argv ){
+  LoopChain::size_type nests = (argc > 1)? strtoul( argv[1], NULL, 10 ) : 500;
+  cout << nests << " nests" << endl;
+
+  LoopChain chain;
+  report( "build chain", measure( [&](){ chain = makeChain( nests ); } ) );
+
+  long sum = 0;
+  report( "walk accesses", measure( [&](){
+    for( const LoopNest& nest : chain ){
+      for( const Dataspace& dataspace : nest.getDataspaces() ){
+        for( Tuple tuple : dataspace.reads() ){
+          sum += tuple[0];
+        }
+        sum += dataspace.reads().maxOnDims()[0] + dataspace.writes().size();
+      }
+    }
+  } ) );
+
+  report( "copy chain", measure( [&](){ LoopChain copy( chain ); } ) );
+
+  report( "schedule (copying chain)", measure( [&](){
+    Schedule schedule( chain );
+    shiftSome( schedule, nests );
+  } ) );
+
+  report( "schedule (moving chain)", measure( [&](){
+    Schedule schedule( std::move( chain ) );
+    shiftSome( schedule, nests );
+  } ) );
+
+  // Keep the walk from being optimized away.
+  return (sum == 42)? 1 : 0;
+}
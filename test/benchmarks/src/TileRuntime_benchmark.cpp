@@ -0,0 +1,154 @@
+/*! ****************************************************************************
+\file TileRuntime_benchmark.cpp
+\authors Ian J. Bertolacci
+
+\brief
+Times an in-place, tiled 2D Gauss-Seidel sweep executed by the TileRuntime
+against the same tiles executed as wavefronts of "omp parallel for" loops
+(with a barrier after every wavefront), and checks both against the
+sequential sweep.
+
+Usage: TileRuntime_benchmark [N (default 2048)] [tile size (default 64)] [sweeps (default 10)]
+
+\copyright
+Copyright 2017 Universiy of Arizona
+*******************************************************************************/
+
+#include <LoopChainIR/TileRuntime.hpp>
+#include <LoopChainIR/TaskAnnotation.hpp>
+#include <LoopChainIR/LoopChain.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include <omp.h>
+
+using namespace std;
+using namespace LoopChainIR;
+
+namespace {
+
+  typedef TileGraph::size_type size_type;
+
+  struct Grid {
+    size_type N;
+    vector<double> values;
+
+    Grid( size_type N )
+    : N( N ), values( (N + 2) * (N + 2) )
+    {
+      for( size_type i = 0; i < values.size(); i += 1 ){
+        values[i] = (double)( (i * 7919) % 1000 ) / 1000.0;
+      }
+    }
+
+    double& operator()( size_type i, size_type j ){
+      return values[ i * (N + 2) + j ];
+    }
+  };
+
+  // Points [1, N] x [1, N] of tile (ti, tj)
+  void sweepTile( Grid& A, size_type tile_size, size_type ti, size_type tj ){
+    size_type i_end = min( (ti + 1) * tile_size, A.N );
+    size_type j_end = min( (tj + 1) * tile_size, A.N );
+    for( size_type i = ti * tile_size + 1; i <= i_end; i += 1 ){
+      for( size_type j = tj * tile_size + 1; j <= j_end; j += 1 ){
+        A( i, j ) = 0.2 * ( A( i, j ) + A( i - 1, j ) + A( i + 1, j ) + A( i, j - 1 ) + A( i, j + 1 ) );
+      }
+    }
+  }
+
+  LoopChain seidel(){
+    LoopChain chain;
+    chain.append( LoopNest( RectangularDomain( { make_pair( "1", "N" ), make_pair( "1", "N" ) }, { "N" } ),
+                            { Dataspace( "A",
+                                         TupleCollection( { Tuple( { 0, 0 } ), Tuple( { -1, 0 } ), Tuple( { 1, 0 } ), Tuple( { 0, -1 } ), Tuple( { 0, 1 } ) } ),
+                                         TupleCollection( { Tuple( { 0, 0 } ) } ) ) } ) );
+    return chain;
+  }
+
+  template<typename Function>
+  double milliseconds( Function function ){
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    function();
+    chrono::steady_clock::time_point end = chrono::steady_clock::now();
+    return chrono::duration<double, milli>( end - start ).count();
+  }
+
+  void report( string name, double time, double baseline ){
+    cout << left << setw( 24 ) << name
+         << right << setw( 12 ) << fixed << setprecision( 3 ) << time << " ms"
+         << setw( 10 ) << setprecision( 2 ) << baseline / time << "x"
+         << endl;
+  }
+
+  bool same( Grid& a, Grid& b ){
+    return a.values == b.values;
+  }
+
+}
+
+int main( int argc, char** argv ){
+  size_type N = (argc > 1)? strtoul( argv[1], NULL, 10 ) : 2048;
+  size_type tile_size = (argc > 2)? strtoul( argv[2], NULL, 10 ) : 64;
+  size_type sweeps = (argc > 3)? strtoul( argv[3], NULL, 10 ) : 10;
+  size_type tiles = (N + tile_size - 1) / tile_size;
+  size_type threads = (size_type) omp_get_max_threads();
+
+  cout << N << "x" << N << " points, " << tiles << "x" << tiles << " tiles, "
+       << sweeps << " sweeps, " << threads << " threads" << endl;
+
+  // Register the tiles and the edges the chain's dependences give them
+  set<TaskAnnotation::TileOffset> offsets = TaskAnnotation::tileDependences( seidel(), { 0 }, 2 );
+  TileGraph graph = TileGraph::grid( { tiles, tiles }, offsets );
+  TileRuntime runtime( threads );
+
+  Grid sequential( N );
+  double sequential_time = milliseconds( [&](){
+    for( size_type sweep = 0; sweep < sweeps; sweep += 1 ){
+      for( size_type ti = 0; ti < tiles; ti += 1 ){
+        for( size_type tj = 0; tj < tiles; tj += 1 ){
+          sweepTile( sequential, tile_size, ti, tj );
+        }
+      }
+    }
+  } );
+  report( "sequential", sequential_time, sequential_time );
+
+  Grid wavefront( N );
+  double wavefront_time = milliseconds( [&](){
+    for( size_type sweep = 0; sweep < sweeps; sweep += 1 ){
+      for( size_type front = 0; front < 2 * tiles - 1; front += 1 ){
+        size_type first = (front < tiles)? 0 : front - tiles + 1;
+        size_type last = min( front, tiles - 1 );
+        #pragma omp parallel for schedule(static)
+        for( size_type ti = first; ti <= last; ti += 1 ){
+          sweepTile( wavefront, tile_size, ti, front - ti );
+        }
+      }
+    }
+  } );
+  report( "omp for wavefronts", wavefront_time, sequential_time );
+
+  Grid stolen( N );
+  size_type steals = 0;
+  double runtime_time = milliseconds( [&](){
+    for( size_type sweep = 0; sweep < sweeps; sweep += 1 ){
+      runtime.run( graph, [&]( size_type tile ){
+        vector<size_type> coordinate = graph.coordinate( tile );
+        sweepTile( stolen, tile_size, coordinate[0], coordinate[1] );
+      } );
+      steals += runtime.steals();
+    }
+  } );
+  report( "tile runtime", runtime_time, sequential_time );
+  cout << steals << " tiles stolen" << endl;
+
+  if( !same( sequential, wavefront ) || !same( sequential, stolen ) ){
+    cerr << "Results differ from the sequential sweep" << endl;
+    return 1;
+  }
+  return 0;
+}
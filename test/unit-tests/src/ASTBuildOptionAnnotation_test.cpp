@@ -0,0 +1,153 @@
+/*! ****************************************************************************
+\file ASTBuildOptionAnnotation_test.cpp
+\authors Ian J. Bertolacci
+
+\brief
+To perform unit testing on the ASTBuildOptionAnnotation.
+
+\copyright
+Copyright 2017 Universiy of Arizona
+*******************************************************************************/
+
+#include "gtest/gtest.h"
+#include <LoopChainIR/ASTBuildOptionAnnotation.hpp>
+#include <LoopChainIR/Schedule.hpp>
+#include <LoopChainIR/TileTransformation.hpp>
+#include <LoopChainIR/DefaultSequentialTransformation.hpp>
+#include <LoopChainIR/util.hpp>
+#include <iostream>
+#include <utility>
+
+using namespace std;
+using namespace LoopChainIR;
+
+// Count the number of for loops in generated code
+static int count_fors( string code ){
+  int count = 0;
+  for( string::size_type pos = code.find("for ("); pos != string::npos; pos = code.find("for (", pos + 1) ){
+    count += 1;
+  }
+  return count;
+}
+
+TEST( ASTBuildOptionAnnotation_test, default_options ){
+  LoopChain chain;
+
+  chain.append(
+    LoopNest(
+      RectangularDomain(
+        { make_pair("0", "N") },
+        {"N"}
+      )
+    )
+  );
+
+  Schedule sched( chain );
+
+  ASSERT_EQ( sched.getASTBuildOptions(), string("{ [loop_c,i_0,i_c] -> separate[i_c] };") );
+  ASSERT_NE( SSTR( sched ).find( sched.getASTBuildOptions() ), string::npos );
+}
+
+TEST( ASTBuildOptionAnnotation_test, 1N_2D_atomic ){
+  LoopChain chain;
+
+  chain.append(
+    LoopNest(
+      RectangularDomain(
+        { make_pair("0", "N"), make_pair("0", "M") },
+        {"N", "M"}
+      )
+    )
+  );
+
+  vector<Transformation*> schedulers = { new ASTBuildOptionAnnotation( ASTBuildOption::Atomic, {1} ) };
+
+  Schedule sched( chain );
+  sched.apply( schedulers );
+
+  // Second loop of the nest subspace is at position 2 (after loop_c and i_0)
+  ASSERT_NE( sched.getASTBuildOptions().find("atomic[x] : x = 2"), string::npos );
+  // The default separation does not conflict with the annotated loop
+  ASSERT_NE( sched.getASTBuildOptions().find("separate[i_c] : i_c != 2;"), string::npos );
+  ASSERT_NE( sched.codegen(), string("{\n}\n") );
+}
+
+TEST( ASTBuildOptionAnnotation_test, 1N_1D_tile_unroll_within ){
+  LoopChain chain;
+
+  chain.append(
+    LoopNest(
+      RectangularDomain(
+        { make_pair("0", "N") },
+        {"N"}
+      )
+    )
+  );
+
+  vector<Transformation*> schedulers = {
+    new TileTransformation(
+      0,
+      { make_pair( 0, "4" ) },
+      new DefaultSequentialTransformation(),
+      new ASTBuildOptionAnnotation( ASTBuildOption::Unroll )
+    )
+  };
+
+  Schedule sched( chain );
+  sched.apply( schedulers );
+
+  string code = sched.codegen();
+
+  // Only the tile loop remains, the point loop was unrolled
+  ASSERT_EQ( count_fors( code ), 1 );
+}
+
+TEST( ASTBuildOptionAnnotation_test, 1N_2D_tile_separate_over ){
+  LoopChain chain;
+
+  chain.append(
+    LoopNest(
+      RectangularDomain(
+        { make_pair("0", "N"), make_pair("0", "M") },
+        {"N", "M"}
+      )
+    )
+  );
+
+  vector<Transformation*> schedulers = {
+    new TileTransformation(
+      0,
+      { make_pair( 0, "8" ), make_pair( 1, "8" ) },
+      new ASTBuildOptionAnnotation( ASTBuildOption::Separate ),
+      new ASTBuildOptionAnnotation( ASTBuildOption::Atomic )
+    )
+  };
+
+  Schedule sched( chain );
+  ASSERT_NO_THROW({ sched.apply( schedulers ); });
+
+  string options = sched.getASTBuildOptions();
+  ASSERT_NE( options.find("separate[x] : x = 1"), string::npos );
+  ASSERT_NE( options.find("separate[x] : x = 2"), string::npos );
+  ASSERT_NE( options.find("atomic[x] : x = 4"), string::npos );
+  ASSERT_NE( options.find("atomic[x] : x = 5"), string::npos );
+  ASSERT_NE( sched.codegen(), string("{\n}\n") );
+}
+
+TEST( ASTBuildOptionAnnotation_test, bad_dimension ){
+  LoopChain chain;
+
+  chain.append(
+    LoopNest(
+      RectangularDomain(
+        { make_pair("0", "N") },
+        {"N"}
+      )
+    )
+  );
+
+  Schedule sched( chain );
+  ASTBuildOptionAnnotation annotation( ASTBuildOption::Unroll, {1} );
+
+  ASSERT_THROW( sched.apply( annotation ), assert_exception );
+}
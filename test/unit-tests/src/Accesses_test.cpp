@@ -15,6 +15,7 @@ Copyright 2016 University of Arizona
 #include <iostream>
 #include <utility>
 #include <limits>
+#include <algorithm>
 
 using namespace std;
 using namespace LoopChainIR;
@@ -158,6 +159,26 @@ TEST( Tuple_test, str ){
   EXPECT_EQ( (a - b).str(), neg_b.str() );
 }
 
+TEST( Tuple_test, large ){
+  // More dimensions than are stored inline
+  vector<int> values = { 1, -2, 3, -4, 5, -6, 7, -8, 9, -10 };
+  Tuple tuple( values );
+  ASSERT_EQ( tuple.dimensions(), values.size() );
+  EXPECT_TRUE( equal( tuple.begin(), tuple.end(), values.begin() ) );
+
+  Tuple copy( tuple );
+  EXPECT_EQ( copy, tuple );
+  EXPECT_TRUE( ( -tuple + tuple ).isZeroTuple() );
+  EXPECT_EQ( copy[9], -10 );
+
+  Tuple small( { 1, 2 } );
+  small = copy;
+  EXPECT_EQ( small, tuple );
+  copy = Tuple( { 3, 4 } );
+  EXPECT_EQ( copy, Tuple( { 3, 4 } ) );
+  EXPECT_LT( copy, tuple );
+}
+
 TEST( TupleCollection_test, construct ){
   set<Tuple> init_set = { Tuple( { 0, 0 } ), Tuple( { 0, 1 } ), Tuple( { 1, 0 } ), Tuple( { 1, 0 } ) };
   ASSERT_NO_THROW({ TupleCollection maythrow( init_set ); });
@@ -219,6 +240,34 @@ TEST( TupleCollection_test, str ){
   EXPECT_NE( collection.str(), "{  }" );
 }
 
+TEST( TupleCollection_test, sorted ){
+  TupleCollection collection( {  Tuple( {  1, -1 } ),
+                                 Tuple( { -1,  1 } ),
+                                 Tuple( {  0,  0 } ),
+                                 Tuple( { -1,  0 } )
+                              } );
+  EXPECT_EQ( collection.size(), 4 );
+  EXPECT_EQ( collection.str(), "{ (-1, 0), (-1, 1), (0, 0), (1, -1) }" );
+
+  Tuple extent( { 2, -3 } );
+  collection.shiftAll( extent );
+  EXPECT_EQ( collection.str(), "{ (1, -3), (1, -2), (2, -3), (3, -4) }" );
+}
+
+TEST( TupleCollection_test, union ){
+  TupleCollection left( { Tuple( { 0, 1 } ), Tuple( { 2, 0 } ) } );
+  TupleCollection right( { Tuple( { -1, 5 } ), Tuple( { 0, 1 } ), Tuple( { 3, 3 } ) } );
+  TupleCollection empty( 2 );
+
+  TupleCollection both( left, right );
+  EXPECT_EQ( both.size(), 4 );
+  EXPECT_EQ( both.str(), "{ (-1, 5), (0, 1), (2, 0), (3, 3) }" );
+
+  TupleCollection with_empty( empty, left );
+  EXPECT_EQ( with_empty.dimensions(), 2 );
+  EXPECT_EQ( with_empty.str(), left.str() );
+}
+
 TEST( TupleCollection_test, empty ){
   TupleCollection collection( 3 );
   EXPECT_EQ( collection.minOnDims(), Tuple::createMagicEmptyTuple() );
@@ -262,3 +311,126 @@ TEST( Dataspace_test, construct ){
                         );
   });
 }
+
+TEST( AffineAccess_test, construct ){
+  // A[j][i] with iterators (i,j)
+  AffineAccess transpose( {{0, 1}, {1, 0}}, Tuple({0, 0}) );
+  EXPECT_EQ( transpose.dimensions(), 2 );
+  EXPECT_EQ( transpose.iteratorDimensions(), 2 );
+  EXPECT_EQ( transpose.coefficient( 0, 1 ), 1 );
+  EXPECT_FALSE( transpose.isTranslation() );
+  EXPECT_TRUE( transpose.isSeparable() );
+
+  // A[i+1][j-1]
+  AffineAccess translation( Tuple({1, -1}) );
+  EXPECT_TRUE( translation.isTranslation() );
+  EXPECT_EQ( translation.offset(), Tuple({1, -1}) );
+
+  // A[i+j]
+  AffineAccess sum( {{1, 1}}, Tuple({0}) );
+  EXPECT_FALSE( sum.isSeparable() );
+
+  // s[0], and A[i][0] with iterators (i,j)
+  EXPECT_TRUE( AffineAccess( {{0}}, Tuple({0}) ).isSeparable() );
+  EXPECT_TRUE( AffineAccess( {{1, 0}, {0, 0}}, Tuple({0, 0}) ).isSeparable() );
+  // A[i][i]
+  EXPECT_FALSE( AffineAccess( {{1}, {1}}, Tuple({0, 0}) ).isSeparable() );
+
+  EXPECT_THROW( AffineAccess( {{1, 0}, {0}}, Tuple({0, 0}) ), assert_exception );
+  EXPECT_THROW( AffineAccess( {{1, 0}}, Tuple({0, 0}) ), assert_exception );
+}
+
+TEST( AffineAccess_test, evaluate_shift ){
+  // A[2i+1][0] with iterators (i,j)
+  AffineAccess access( {{2, 0}, {0, 0}}, Tuple({1, 0}) );
+
+  EXPECT_EQ( access.evaluate( Tuple({3, 5}) ), Tuple({7, 0}) );
+  EXPECT_EQ( access.shifted( Tuple({1, 2}) ), AffineAccess( {{2, 0}, {0, 0}}, Tuple({3, 0}) ) );
+  EXPECT_EQ( access.str(), "[2*i_0+1, 0]" );
+}
+
+TEST( AffineAccess_test, dependenceDistance ){
+  Tuple distance = Tuple::createMagicEmptyTuple();
+
+  // Translation accesses: the difference of offsets
+  ASSERT_TRUE( AffineAccess( Tuple({1, 0}) ).dependenceDistance( AffineAccess( Tuple({0, -1}) ), distance ) );
+  EXPECT_EQ( distance, Tuple({1, 1}) );
+
+  // Transpose: A[j+1][i] vs A[j][i]
+  ASSERT_TRUE( AffineAccess( {{0, 1}, {1, 0}}, Tuple({1, 0}) ).dependenceDistance( AffineAccess( {{0, 1}, {1, 0}}, Tuple({0, 0}) ), distance ) );
+  EXPECT_EQ( distance, Tuple({0, 1}) );
+
+  // Restriction: A[2i+2] vs A[2i]
+  ASSERT_TRUE( AffineAccess( {{2}}, Tuple({2}) ).dependenceDistance( AffineAccess( {{2}}, Tuple({0}) ), distance ) );
+  EXPECT_EQ( distance, Tuple({1}) );
+
+  // A[2i+1] and A[2i] never touch the same element
+  EXPECT_FALSE( AffineAccess( {{2}}, Tuple({1}) ).dependenceDistance( AffineAccess( {{2}}, Tuple({0}) ), distance ) );
+
+  // Broadcast A[i][0] vs A[i][1] never touch the same element
+  EXPECT_FALSE( AffineAccess( {{1}, {0}}, Tuple({0, 0}) ).dependenceDistance( AffineAccess( {{1}, {0}}, Tuple({0, 1}) ), distance ) );
+
+  // Different linear parts are not analyzable
+  EXPECT_THROW( AffineAccess( {{2}}, Tuple({0}) ).dependenceDistance( AffineAccess( Tuple({0}) ), distance ), assert_exception );
+
+  // Iterator j does not appear in A[i][0]
+  EXPECT_THROW( AffineAccess( {{1, 0}, {0, 0}}, Tuple({0, 0}) ).dependenceDistance( AffineAccess( {{1, 0}, {0, 0}}, Tuple({0, 0}) ), distance ), assert_exception );
+
+  // ... but at any distance in j, which the constant mask tells
+  vector<bool> constant;
+  ASSERT_TRUE( AffineAccess( {{1, 0}, {0, 0}}, Tuple({1, 0}) ).dependenceDistance( AffineAccess( {{1, 0}, {0, 0}}, Tuple({0, 0}) ), distance, constant ) );
+  EXPECT_EQ( distance, Tuple({1, 0}) );
+  EXPECT_EQ( constant, vector<bool>( { true, false } ) );
+
+  // Every iteration touches the scalar s[0]
+  ASSERT_TRUE( AffineAccess( {{0}}, Tuple({0}) ).dependenceDistance( AffineAccess( {{0}}, Tuple({0}) ), distance, constant ) );
+  EXPECT_EQ( constant, vector<bool>( { false } ) );
+  EXPECT_FALSE( AffineAccess( {{0}}, Tuple({0}) ).dependenceDistance( AffineAccess( {{0}}, Tuple({1}) ), distance, constant ) );
+
+  // A transpose and a translation cannot be compared
+  EXPECT_FALSE( AffineAccess( {{0, 1}, {1, 0}}, Tuple({0, 0}) ).isComparable( AffineAccess( Tuple({0, 0}) ) ) );
+  EXPECT_TRUE( AffineAccess( {{1, 0}, {0, 0}}, Tuple({0, 0}) ).isComparable( AffineAccess( {{1, 0}, {0, 0}}, Tuple({0, 3}) ) ) );
+}
+
+TEST( Dataspace_test, affine ){
+  Dataspace dataspace( "A",
+                       set<Tuple>(), set<Tuple>(),
+                       { AffineAccess( {{0, 1}, {1, 0}}, Tuple({0, 0}) ), AffineAccess( Tuple({0, 1}) ) },
+                       { AffineAccess( Tuple({0, 0}) ) }
+                     );
+
+  // Translations are stored as tuples
+  EXPECT_EQ( dataspace.dimensions(), 2 );
+  EXPECT_EQ( dataspace.reads().str(), "{ (0, 1) }" );
+  EXPECT_EQ( dataspace.writes().str(), "{ (0, 0) }" );
+  EXPECT_EQ( dataspace.affineReads().size(), 1 );
+  EXPECT_EQ( dataspace.affineWrites().size(), 0 );
+  EXPECT_TRUE( dataspace.hasAffineAccesses() );
+
+  EXPECT_THROW( Dataspace( "B", set<Tuple>(), set<Tuple>(), { AffineAccess( {{1, 0}}, Tuple({0}) ) }, { AffineAccess( Tuple({0, 0}) ) } ), assert_exception );
+}
+
+TEST( Dataspace_test, reduction ){
+  // r[i] = max( r[i], ... ) over iterators (i,j)
+  Dataspace dataspace( "r", ReduceMax, { AffineAccess( {{1, 0}}, Tuple({0}) ) } );
+
+  EXPECT_TRUE( dataspace.isReduction() );
+  EXPECT_EQ( dataspace.reductionOperator(), ReduceMax );
+  EXPECT_EQ( dataspace.dimensions(), 1 );
+  EXPECT_EQ( dataspace.reads().size(), 0 );
+  EXPECT_EQ( dataspace.writes().size(), 0 );
+  EXPECT_FALSE( dataspace.hasAffineAccesses() );
+
+  Dataspace shifted = dataspace.shifted( Tuple({2, 3}) );
+  EXPECT_TRUE( shifted.isReduction() );
+  EXPECT_EQ( *shifted.reductionTargets().begin(), AffineAccess( {{1, 0}}, Tuple({2}) ) );
+
+  EXPECT_FALSE( Dataspace( "A", TupleCollection( { Tuple({0}) } ), TupleCollection( 1 ) ).isReduction() );
+  EXPECT_THROW( Dataspace( "A", TupleCollection( { Tuple({0}) } ), TupleCollection( 1 ) ).reductionOperator(), assert_exception );
+  EXPECT_THROW( Dataspace( "s", ReduceAdd, set<AffineAccess>() ), assert_exception );
+  EXPECT_THROW( Dataspace( "s", ReduceAdd, { AffineAccess( {{0, 0}}, Tuple({0}) ), AffineAccess( Tuple({0, 0}) ) } ), assert_exception );
+
+  EXPECT_EQ( reductionIdentifier( ReduceAdd ), "+" );
+  EXPECT_EQ( reductionIdentifier( ReduceMin ), "min" );
+  EXPECT_EQ( reductionIdentifier( ReduceLogicalOr ), "||" );
+}
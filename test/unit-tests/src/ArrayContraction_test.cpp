@@ -0,0 +1,140 @@
+/*! ****************************************************************************
+\file ArrayContraction_test.cpp
+\authors Ian J. Bertolacci
+
+\brief
+To perform unit testsing on the ArrayContraction analysis.
+
+\copyright
+Copyright 2017 Universiy of Arizona
+*******************************************************************************/
+
+#include "gtest/gtest.h"
+#include <LoopChainIR/ArrayContraction.hpp>
+#include <LoopChainIR/util.hpp>
+#include <iostream>
+#include <utility>
+
+using namespace std;
+using namespace LoopChainIR;
+
+namespace {
+  // 1D nest over 1..N with the given dataspaces
+  LoopNest nest1D( list<Dataspace> dataspaces ){
+    return LoopNest( RectangularDomain( { make_pair( "1", "N" ) }, { "N" } ), dataspaces );
+  }
+
+  LoopNest nest2D( list<Dataspace> dataspaces ){
+    return LoopNest( RectangularDomain( { make_pair( "1", "N" ), make_pair( "1", "M" ) }, { "N", "M" } ), dataspaces );
+  }
+
+  // 1D nest over 2..N-1, so that reads one element away stay inside 1..N
+  LoopNest interior1D( list<Dataspace> dataspaces ){
+    return LoopNest( RectangularDomain( { make_pair( "2", "N-1" ) }, { "N" } ), dataspaces );
+  }
+
+  LoopNest interior2D( list<Dataspace> dataspaces ){
+    return LoopNest( RectangularDomain( { make_pair( "2", "N-1" ), make_pair( "2", "M-1" ) }, { "N", "M" } ), dataspaces );
+  }
+}
+
+/*
+B[i] = A[i]; C[i] = B[i];
+*/
+TEST( ArrayContraction_test, scalar ){
+  LoopChain chain;
+  chain.append( nest1D( { Dataspace( "A", TupleCollection( { Tuple( { 0 } ) } ), TupleCollection( 1 ) ),
+                          Dataspace( "B", TupleCollection( 1 ), TupleCollection( { Tuple( { 0 } ) } ) ) } ) );
+  chain.append( nest1D( { Dataspace( "B", TupleCollection( { Tuple( { 0 } ) } ), TupleCollection( 1 ) ),
+                          Dataspace( "C", TupleCollection( 1 ), TupleCollection( { Tuple( { 0 } ) } ) ) } ) );
+
+  ArrayContraction contraction( chain, map<LoopChain::size_type, Tuple>(), { "C" } );
+
+  EXPECT_EQ( contraction.contractibleDataspaces(), set<string>( { "B" } ) );
+  EXPECT_TRUE( contraction.isScalar( "B" ) );
+  EXPECT_EQ( contraction.getWindow( "B" ), vector<int>( { 1 } ) );
+  EXPECT_EQ( contraction.contractedSubscript( "B", { "c1" } ), "" );
+
+  EXPECT_EQ( contraction.getReason( "A" ), "Never written" );
+  EXPECT_EQ( contraction.getReason( "C" ), "Live out of the chain" );
+  EXPECT_THROW( contraction.getWindow( "C" ), assert_exception );
+}
+
+/*
+B[i] = A[i]; C[i] = B[i-1] + B[i] + B[i+1]; (C over 2..N-1)
+*/
+TEST( ArrayContraction_test, rolling_1D ){
+  LoopChain chain;
+  chain.append( nest1D( { Dataspace( "A", TupleCollection( { Tuple( { 0 } ) } ), TupleCollection( 1 ) ),
+                          Dataspace( "B", TupleCollection( 1 ), TupleCollection( { Tuple( { 0 } ) } ) ) } ) );
+  chain.append( interior1D( { Dataspace( "B", TupleCollection( { Tuple( { -1 } ), Tuple( { 0 } ), Tuple( { 1 } ) } ), TupleCollection( 1 ) ),
+                              Dataspace( "C", TupleCollection( 1 ), TupleCollection( { Tuple( { 0 } ) } ) ) } ) );
+
+  // Without a shift, B[i+1] is read before it is written
+  ArrayContraction unshifted( chain, map<LoopChain::size_type, Tuple>(), { "C" } );
+  EXPECT_FALSE( unshifted.isContractible( "B" ) );
+  EXPECT_NE( unshifted.getReason( "B" ), "" );
+
+  // Shifted by one, B[i-1], B[i], B[i+1] are live at once
+  map<LoopChain::size_type, Tuple> shifts = { { 1, Tuple( { 1 } ) } };
+  ArrayContraction shifted( chain, shifts, { "C" } );
+  ASSERT_TRUE( shifted.isContractible( "B" ) );
+  EXPECT_FALSE( shifted.isScalar( "B" ) );
+  EXPECT_EQ( shifted.getWindow( "B" ), vector<int>( { 3 } ) );
+  EXPECT_EQ( shifted.contractedSubscript( "B", { "i" } ), "[((i)%3+3)%3]" );
+}
+
+/*
+B[i][j] = A[i][j]; C[i][j] = B[i-1][j] + B[i+1][j] + B[i][j-1] + B[i][j+1]; (C over the interior)
+*/
+TEST( ArrayContraction_test, rolling_rows_2D ){
+  LoopChain chain;
+  chain.append( nest2D( { Dataspace( "A", TupleCollection( { Tuple( { 0, 0 } ) } ), TupleCollection( 2 ) ),
+                          Dataspace( "B", TupleCollection( 2 ), TupleCollection( { Tuple( { 0, 0 } ) } ) ) } ) );
+  chain.append( interior2D( { Dataspace( "B", TupleCollection( { Tuple( { -1, 0 } ), Tuple( { 1, 0 } ), Tuple( { 0, -1 } ), Tuple( { 0, 1 } ) } ), TupleCollection( 2 ) ),
+                              Dataspace( "C", TupleCollection( 2 ), TupleCollection( { Tuple( { 0, 0 } ) } ) ) } ) );
+
+  map<LoopChain::size_type, Tuple> shifts = { { 0, Tuple( { 0, 0 } ) }, { 1, Tuple( { 1, 1 } ) } };
+  ArrayContraction contraction( chain, shifts, { "C" } );
+
+  ASSERT_TRUE( contraction.isContractible( "B" ) );
+  EXPECT_EQ( contraction.getWindow( "B" ), vector<int>( { 3, ArrayContraction::FullDimension } ) );
+  EXPECT_EQ( contraction.contractedSubscript( "B", { "i", "j" } ), "[((i)%3+3)%3][j]" );
+
+  // B used in an unfused nest cannot be contracted
+  ArrayContraction partial( chain, { 1 }, shifts, { "C" } );
+  EXPECT_FALSE( partial.isContractible( "B" ) );
+}
+
+/*
+B[i][j] = A[i][j]; C[i][j] = B[i][j-1] + B[i][j]; (C over the interior)
+*/
+TEST( ArrayContraction_test, rolling_inner_2D ){
+  LoopChain chain;
+  chain.append( nest2D( { Dataspace( "A", TupleCollection( { Tuple( { 0, 0 } ) } ), TupleCollection( 2 ) ),
+                          Dataspace( "B", TupleCollection( 2 ), TupleCollection( { Tuple( { 0, 0 } ) } ) ) } ) );
+  chain.append( interior2D( { Dataspace( "B", TupleCollection( { Tuple( { 0, -1 } ), Tuple( { 0, 0 } ) } ), TupleCollection( 2 ) ),
+                              Dataspace( "C", TupleCollection( 2 ), TupleCollection( { Tuple( { 0, 0 } ) } ) ) } ) );
+
+  ArrayContraction contraction( chain, map<LoopChain::size_type, Tuple>(), { "C" } );
+  ASSERT_TRUE( contraction.isContractible( "B" ) );
+  EXPECT_EQ( contraction.getWindow( "B" ), vector<int>( { 1, 2 } ) );
+  EXPECT_EQ( contraction.contractedSubscript( "B", { "i", "j" } ), "[((j)%2+2)%2]" );
+}
+
+/*
+B[i] = A[i]; C[i] = B[i-1] + B[i] + B[i+1]; (both over 1..N)
+B[0] and B[N+1] are read but never written in the fused loop.
+*/
+TEST( ArrayContraction_test, live_in_edges ){
+  LoopChain chain;
+  chain.append( nest1D( { Dataspace( "A", TupleCollection( { Tuple( { 0 } ) } ), TupleCollection( 1 ) ),
+                          Dataspace( "B", TupleCollection( 1 ), TupleCollection( { Tuple( { 0 } ) } ) ) } ) );
+  chain.append( nest1D( { Dataspace( "B", TupleCollection( { Tuple( { -1 } ), Tuple( { 0 } ), Tuple( { 1 } ) } ), TupleCollection( 1 ) ),
+                          Dataspace( "C", TupleCollection( 1 ), TupleCollection( { Tuple( { 0 } ) } ) ) } ) );
+
+  map<LoopChain::size_type, Tuple> shifts = { { 1, Tuple( { 1 } ) } };
+  ArrayContraction contraction( chain, shifts, { "C" } );
+  EXPECT_FALSE( contraction.isContractible( "B" ) );
+  EXPECT_EQ( contraction.getReason( "B" ), "Reads elements that are not written earlier in the fused loop" );
+}
@@ -4,6 +4,8 @@
 #include <utility>
 #include <vector>
 #include <set>
+#include <list>
+#include <map>
 
 using namespace std;
 using namespace LoopChainIR;
@@ -723,3 +725,117 @@ TEST( AutomaticShiftTransformation_test, MFD_TripleCache ){
     EXPECT_EQ( *a_it, *s_it );
   }
 }
+
+TEST( AutomaticShiftTransformation_test, transpose){
+  LoopChain chain;
+
+  string lower[2] = {"0", "0"};
+  string upper[2] = {"10", "10"};
+
+  // B[j][i] = ...
+  chain.append(
+    LoopNest(
+      RectangularDomain( lower, upper, 2 ),
+      {
+        Dataspace(
+          "B",
+          // Reads
+          {},
+          // writes
+          {},
+          // Affine reads
+          {},
+          // Affine writes
+          { AffineAccess( {{0, 1}, {1, 0}}, Tuple({0, 0}) ) }
+        )
+      }
+    )
+  );
+
+  // ... = B[j+1][i]
+  chain.append(
+    LoopNest(
+      RectangularDomain( lower, upper, 2 ),
+      {
+        Dataspace(
+          "B",
+          // Reads
+          {},
+          // writes
+          {},
+          // Affine reads
+          { AffineAccess( {{0, 1}, {1, 0}}, Tuple({1, 0}) ) },
+          // Affine writes
+          {}
+        )
+      }
+    )
+  );
+
+  std::map<LoopChain::size_type, Tuple> actual = {
+                                                    make_pair<LoopChain::size_type, Tuple>( 0, Tuple({0, 0}) ),
+                                                    make_pair<LoopChain::size_type, Tuple>( 1, Tuple({0, 1}) ),
+                                                  };
+  std::map<LoopChain::size_type, Tuple> shift_tuples = AutomaticShiftTransformation::computeShiftTuplesForFusion( 2, chain, true );
+
+  ASSERT_EQ( actual.size(), shift_tuples.size() );
+  for(  std::map<LoopChain::size_type, Tuple>::iterator a_it = actual.begin(), s_it = shift_tuples.begin();
+        a_it != actual.end() && s_it != shift_tuples.end();
+        ++a_it, ++s_it ){
+    EXPECT_EQ( *a_it, *s_it );
+  }
+}
+
+TEST( AutomaticShiftTransformation_test, non_constant_distances ){
+  string lower[2] = {"0", "0"};
+  string upper[2] = {"10", "10"};
+
+  // A[i][j] = ...; B[j][i] = ...
+  // ... = A[i+1][j] + B[i][j]
+  auto chain_with = [&]( bool transpose ){
+    LoopChain chain;
+    list<Dataspace> writer = { Dataspace( "A", TupleCollection( 2 ), TupleCollection( { Tuple({0, 0}) } ) ) };
+    list<Dataspace> reader = { Dataspace( "A", TupleCollection( { Tuple({1, 0}) } ), TupleCollection( 2 ) ) };
+    if( transpose ){
+      writer.push_back( Dataspace( "B", {}, {}, {}, { AffineAccess( {{0, 1}, {1, 0}}, Tuple({0, 0}) ) } ) );
+      reader.push_back( Dataspace( "B", { Tuple({0, 0}) }, {} ) );
+    }
+    chain.append( LoopNest( RectangularDomain( lower, upper, 2 ), writer ) );
+    chain.append( LoopNest( RectangularDomain( lower, upper, 2 ), reader ) );
+    return chain;
+  };
+
+  // The transpose has no constant distance, and leaves the shifts to A
+  std::map<LoopChain::size_type, Tuple> shift_tuples;
+  ASSERT_NO_THROW( shift_tuples = AutomaticShiftTransformation::computeShiftTuplesForFusion( 2, chain_with( true ), true ) );
+  EXPECT_EQ( shift_tuples, AutomaticShiftTransformation::computeShiftTuplesForFusion( 2, chain_with( false ), true ) );
+}
+
+TEST( AutomaticShiftTransformation_test, scalar_reduction_reader ){
+  string lower[1] = {"0"};
+  string upper[1] = {"10"};
+
+  // sum[0] += A[i]
+  // B[i] = A[i] / sum[0]
+  LoopChain chain;
+  chain.append(
+    LoopNest(
+      RectangularDomain( lower, upper, 1 ),
+      { Dataspace( "A", TupleCollection( { Tuple({0}) } ), TupleCollection( 1 ) ),
+        Dataspace( "sum", ReduceAdd, { AffineAccess( {{0}}, Tuple({0}) ) } ) }
+    )
+  );
+  chain.append(
+    LoopNest(
+      RectangularDomain( lower, upper, 1 ),
+      { Dataspace( "A", TupleCollection( { Tuple({0}) } ), TupleCollection( 1 ) ),
+        Dataspace( "sum", {}, {}, { AffineAccess( {{0}}, Tuple({0}) ) }, {} ),
+        Dataspace( "B", TupleCollection( 1 ), TupleCollection( { Tuple({0}) } ) ) }
+    )
+  );
+
+  // Every iteration touches sum[0], which no shift can order
+  std::map<LoopChain::size_type, Tuple> shift_tuples;
+  ASSERT_NO_THROW( shift_tuples = AutomaticShiftTransformation::computeShiftTuplesForFusion( 1, chain ) );
+  EXPECT_TRUE( shift_tuples.empty() );
+}
@@ -0,0 +1,98 @@
+/*! ****************************************************************************
+\file DiamondTileTransformation_test.cpp
+\authors Ian J. Bertolacci
+
+\brief
+To perform unit testing on the DiamondTileTransformation.
+
+\copyright
+Copyright 2017 Universiy of Arizona
+*******************************************************************************/
+
+#include "gtest/gtest.h"
+#include <LoopChainIR/DiamondTileTransformation.hpp>
+#include <LoopChainIR/ParallelAnnotation.hpp>
+#include <LoopChainIR/Schedule.hpp>
+#include <LoopChainIR/util.hpp>
+#include <iostream>
+#include <utility>
+
+using namespace std;
+using namespace LoopChainIR;
+
+namespace {
+  /*
+  for t in 1..T:
+    B[i] = A[i-reach] + A[i] + A[i+1]
+    A[i] = B[i]
+  */
+  LoopChain jacobi( int reach ){
+    LoopChain chain;
+    chain.append( LoopNest( RectangularDomain( { make_pair( "1", "N" ) }, { "N" } ),
+                            { Dataspace( "A", TupleCollection( { Tuple( { -reach } ), Tuple( { 0 } ), Tuple( { 1 } ) } ), TupleCollection( 1 ) ),
+                              Dataspace( "B", TupleCollection( 1 ), TupleCollection( { Tuple( { 0 } ) } ) ) } ) );
+    chain.append( LoopNest( RectangularDomain( { make_pair( "1", "N" ) }, { "N" } ),
+                            { Dataspace( "B", TupleCollection( { Tuple( { 0 } ) } ), TupleCollection( 1 ) ),
+                              Dataspace( "A", TupleCollection( 1 ), TupleCollection( { Tuple( { 0 } ) } ) ) } ) );
+    chain.setTimeDomain( RectangularDomain( "1", "T", { "T" } ) );
+    return chain;
+  }
+}
+
+TEST( DiamondTileTransformation_test, slope ){
+  EXPECT_EQ( DiamondTileTransformation::slope( jacobi( 1 ) ), 1 );
+  // The second loop's write of A is one virtual step before the next time step's read
+  EXPECT_EQ( DiamondTileTransformation::slope( jacobi( 3 ) ), 3 );
+
+  // Without dependences between nests, the slope only has to be positive
+  LoopChain independent;
+  independent.append( LoopNest( RectangularDomain( { make_pair( "1", "N" ) }, { "N" } ),
+                                { Dataspace( "A", TupleCollection( { Tuple( { 2 } ) } ), TupleCollection( 1 ) ),
+                                  Dataspace( "B", TupleCollection( 1 ), TupleCollection( { Tuple( { 0 } ) } ) ) } ) );
+  independent.setTimeDomain( RectangularDomain( "1", "T", { "T" } ) );
+  EXPECT_EQ( DiamondTileTransformation::slope( independent ), 1 );
+}
+
+TEST( DiamondTileTransformation_test, codegen ){
+  Schedule schedule( jacobi( 1 ) );
+  ParallelAnnotation parallel( 1 );
+  DiamondTileTransformation diamond( 8, { &parallel } );
+  EXPECT_EQ( diamond.getTileSize(), 8 );
+  ASSERT_NO_THROW( schedule.apply( diamond ) );
+
+  string code;
+  ASSERT_NO_THROW( code = schedule.codegen() );
+
+  // The tiles of each row run in parallel, and execute their time steps in order
+  string::size_type row = code.find( "for (int c0 = " );
+  string::size_type pragma = code.find( "#pragma omp parallel for" );
+  string::size_type column = code.find( "for (int c1 = " );
+  string::size_type steps = code.find( "for (int c3 = " );
+  ASSERT_NE( row, string::npos ) << code;
+  ASSERT_NE( pragma, string::npos ) << code;
+  EXPECT_LT( row, pragma ) << code;
+  EXPECT_LT( pragma, column ) << code;
+  EXPECT_LT( column, steps ) << code;
+  EXPECT_EQ( code.find( "#pragma omp parallel for", pragma + 1 ), string::npos ) << code;
+  EXPECT_LT( steps, code.find( "statement_0(c3, " ) ) << code;
+  EXPECT_LT( code.find( "statement_0(c3, " ), code.find( "statement_1(c3, " ) ) << code;
+}
+
+TEST( DiamondTileTransformation_test, illegal ){
+  EXPECT_THROW( DiamondTileTransformation( 0 ), assert_exception );
+
+  // No time domain
+  LoopChain timeless;
+  timeless.append( jacobi( 1 ).getNest( 0 ) );
+  EXPECT_THROW( DiamondTileTransformation::slope( timeless ), assert_exception );
+  Schedule schedule( timeless );
+  DiamondTileTransformation diamond( 8 );
+  EXPECT_THROW( schedule.apply( diamond ), assert_exception );
+
+  // Gauss-Seidel: iterations of a time step depend on each other
+  LoopChain in_place;
+  in_place.append( LoopNest( RectangularDomain( { make_pair( "1", "N" ) }, { "N" } ),
+                             { Dataspace( "A", TupleCollection( { Tuple( { -1 } ), Tuple( { 1 } ) } ), TupleCollection( { Tuple( { 0 } ) } ) ) } ) );
+  in_place.setTimeDomain( RectangularDomain( "1", "T", { "T" } ) );
+  EXPECT_THROW( DiamondTileTransformation::slope( in_place ), assert_exception );
+}
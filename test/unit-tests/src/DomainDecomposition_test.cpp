@@ -0,0 +1,131 @@
+/*! ****************************************************************************
+\file DomainDecomposition_test.cpp
+\authors Ian J. Bertolacci
+
+\brief
+To perform unit testing on the DomainDecomposition.
+
+\copyright
+Copyright 2017 Universiy of Arizona
+*******************************************************************************/
+
+#include "gtest/gtest.h"
+#include <LoopChainIR/DomainDecomposition.hpp>
+#include <LoopChainIR/util.hpp>
+#include <iostream>
+#include <utility>
+
+using namespace std;
+using namespace LoopChainIR;
+
+namespace {
+  /*
+  B[i][j] = A[i][j] + A[i-1][j] + A[i+1][j] + A[i][j-1] + A[i][j+1]
+  A[i][j] = B[i][j]
+  */
+  LoopChain jacobi(){
+    LoopChain chain;
+    chain.append( LoopNest( RectangularDomain( { make_pair( "1", "N" ), make_pair( "1", "N" ) }, { "N" } ),
+                            { Dataspace( "A", TupleCollection( { Tuple( { 0, 0 } ), Tuple( { -1, 0 } ), Tuple( { 1, 0 } ), Tuple( { 0, -1 } ), Tuple( { 0, 1 } ) } ), TupleCollection( 2 ) ),
+                              Dataspace( "B", TupleCollection( 2 ), TupleCollection( { Tuple( { 0, 0 } ) } ) ) } ) );
+    chain.append( LoopNest( RectangularDomain( { make_pair( "1", "N" ), make_pair( "1", "N" ) }, { "N" } ),
+                            { Dataspace( "B", TupleCollection( { Tuple( { 0, 0 } ) } ), TupleCollection( 2 ) ),
+                              Dataspace( "A", TupleCollection( 2 ), TupleCollection( { Tuple( { 0, 0 } ) } ) ) } ) );
+    return chain;
+  }
+}
+
+TEST( DomainDecomposition_test, halo_widths ){
+  DomainDecomposition decomposition( jacobi(), { 2, 2 } );
+  EXPECT_EQ( decomposition.ranks(), 4 );
+
+  vector<DomainDecomposition::HaloWidth> none( 2, make_pair( 0, 0 ) );
+  EXPECT_EQ( decomposition.haloWidths( "A" ), vector<DomainDecomposition::HaloWidth>( 2, make_pair( 1, 1 ) ) );
+  EXPECT_EQ( decomposition.haloWidths( "B" ), none );
+  EXPECT_EQ( decomposition.haloWidths( "C" ), none );
+
+  // Only the decomposed dimension has a halo
+  DomainDecomposition rows( jacobi(), { 4 } );
+  EXPECT_EQ( rows.haloWidths( "A" ), vector<DomainDecomposition::HaloWidth>( 1, make_pair( 1, 1 ) ) );
+}
+
+TEST( DomainDecomposition_test, exchanges ){
+  LoopChain chain = jacobi();
+  // Reads A's halo again after the second loop wrote it, then reads it further while it is still current
+  chain.append( chain.getNest( 0 ) );
+  chain.append( LoopNest( RectangularDomain( { make_pair( "1", "N" ), make_pair( "1", "N" ) }, { "N" } ),
+                          { Dataspace( "A", TupleCollection( { Tuple( { 2, 0 } ) } ), TupleCollection( 2 ) ),
+                            Dataspace( "C", TupleCollection( 2 ), TupleCollection( { Tuple( { 0, 0 } ) } ) ) } ) );
+
+  vector< set<string> > exchanges = DomainDecomposition( chain, { 2 } ).exchanges();
+  ASSERT_EQ( exchanges.size(), 4 );
+  EXPECT_EQ( exchanges[0], set<string>( { "A" } ) );
+  EXPECT_EQ( exchanges[1], set<string>() );
+  EXPECT_EQ( exchanges[2], set<string>( { "A" } ) );
+  EXPECT_EQ( exchanges[3], set<string>() );
+}
+
+TEST( DomainDecomposition_test, codegen ){
+  DomainDecomposition decomposition( jacobi(), { 2, 2 } );
+  string code;
+  ASSERT_NO_THROW( code = decomposition.codegen() );
+
+  // The interior of the first loop overlaps the exchange, its boundary follows it
+  string::size_type pack = code.find( "halo_A.pack();" );
+  string::size_type exchange = code.find( "halo_A.exchange( transport );" );
+  string::size_type interior = code.find( "statement_0(" );
+  string::size_type wait = code.find( "transport.wait();" );
+  string::size_type unpack = code.find( "halo_A.unpack();" );
+  string::size_type boundary = code.find( "statement_0(", wait );
+  ASSERT_NE( pack, string::npos ) << code;
+  ASSERT_NE( boundary, string::npos ) << code;
+  EXPECT_LT( pack, exchange ) << code;
+  EXPECT_LT( exchange, interior ) << code;
+  EXPECT_LT( interior, wait ) << code;
+  EXPECT_LT( wait, unpack ) << code;
+  EXPECT_LT( unpack, boundary ) << code;
+
+  // The second loop reads no halo
+  EXPECT_EQ( code.find( "transport.wait();", wait + 1 ), string::npos ) << code;
+  EXPECT_LT( boundary, code.find( "statement_1(" ) ) << code;
+
+  // Every loop stays within the owned iterations
+  EXPECT_NE( code.find( "owned_lower_0" ), string::npos ) << code;
+  EXPECT_NE( code.find( "owned_upper_1" ), string::npos ) << code;
+
+  EXPECT_NE( decomposition.codegen( "mpi", "exchange_" ).find( "exchange_A.exchange( mpi );" ), string::npos );
+}
+
+TEST( DomainDecomposition_test, regions ){
+  DomainDecomposition decomposition( jacobi(), { 2 } );
+
+  // The second loop is empty in the first loop's local chain
+  LoopChain interior = decomposition.localChain( 0, DomainDecomposition::Interior );
+  ASSERT_EQ( interior.length(), 2 );
+  EXPECT_EQ( interior.getNest( 1 ).getPolyhedralDomain().getConstraints(), vector<string>( { "1 = 0" } ) );
+
+  // Without halos, the boundary is empty
+  LoopChain boundary = decomposition.localChain( 1, DomainDecomposition::Boundary );
+  const vector<string>& constraints = boundary.getNest( 1 ).getPolyhedralDomain().getConstraints();
+  EXPECT_EQ( constraints.back(), "1 = 0" );
+
+  EXPECT_THROW( decomposition.localChain( 2, DomainDecomposition::Owned ), assert_exception );
+}
+
+TEST( DomainDecomposition_test, illegal ){
+  EXPECT_THROW( DomainDecomposition( jacobi(), {} ), assert_exception );
+  EXPECT_THROW( DomainDecomposition( jacobi(), { 2, 0 } ), assert_exception );
+  EXPECT_THROW( DomainDecomposition( jacobi(), { 2, 2, 2 } ), assert_exception );
+
+  // Writes a neighbour's element
+  LoopChain chain;
+  chain.append( LoopNest( RectangularDomain( { make_pair( "1", "N" ) }, { "N" } ),
+                          { Dataspace( "A", TupleCollection( 1 ), TupleCollection( { Tuple( { 1 } ) } ) ) } ) );
+  EXPECT_THROW( DomainDecomposition( chain, { 2 } ), assert_exception );
+
+  // Reads the halo of what it writes
+  LoopChain in_place;
+  in_place.append( LoopNest( RectangularDomain( { make_pair( "1", "N" ) }, { "N" } ),
+                             { Dataspace( "A", TupleCollection( { Tuple( { -1 } ) } ), TupleCollection( { Tuple( { 0 } ) } ) ) } ) );
+  EXPECT_THROW( DomainDecomposition( in_place, { 2 } ), assert_exception );
+}
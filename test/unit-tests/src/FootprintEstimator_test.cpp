@@ -0,0 +1,115 @@
+/*! ****************************************************************************
+\file FootprintEstimator_test.cpp
+\authors Ian J. Bertolacci
+
+\brief
+To perform unit testsing on the FootprintEstimator class.
+
+\copyright
+Copyright 2017 Universiy of Arizona
+*******************************************************************************/
+
+#include "gtest/gtest.h"
+#include <LoopChainIR/FootprintEstimator.hpp>
+#include <LoopChainIR/FusionTransformation.hpp>
+#include <LoopChainIR/ShiftTransformation.hpp>
+#include <LoopChainIR/util.hpp>
+#include <iostream>
+#include <utility>
+
+using namespace std;
+using namespace LoopChainIR;
+
+namespace {
+  /*
+  B[i][j] = A[i-1][j] + A[i+1][j] + A[i][j-1] + A[i][j+1] + A[i][j]
+  */
+  LoopNest stencil(){
+    return LoopNest( RectangularDomain( { make_pair( "1", "N" ), make_pair( "1", "N" ) }, { "N" } ),
+                     { Dataspace( "A",
+                                  TupleCollection( { Tuple( { -1, 0 } ), Tuple( { 1, 0 } ), Tuple( { 0, -1 } ), Tuple( { 0, 1 } ), Tuple( { 0, 0 } ) } ),
+                                  TupleCollection( 2 ) ),
+                       Dataspace( "B", TupleCollection( 2 ), TupleCollection( { Tuple( { 0, 0 } ) } ) ) } );
+  }
+}
+
+TEST( FootprintEstimator_test, stencil ){
+  LoopChain chain;
+  chain.append( stencil() );
+
+  FootprintEstimator estimator( chain, { { "B", sizeof(float) } } );
+  EXPECT_EQ( estimator.elementSize( "A" ), sizeof(double) );
+  EXPECT_EQ( estimator.elementSize( "B" ), sizeof(float) );
+
+  FootprintEstimator::FootprintMap footprints = estimator.estimate( 0, { { 0, "4" }, { 1, "4" } } );
+  ASSERT_EQ( footprints.size(), 2 );
+
+  // 6x6 box without its corners
+  EXPECT_EQ( footprints["A"].tile_bytes, 32 * sizeof(double) );
+  // Columns j-1 and j of the previous tile
+  EXPECT_EQ( footprints["A"].reused_bytes, 8 * sizeof(double) );
+  EXPECT_EQ( footprints["A"].iteration_bytes, 5 * sizeof(double) );
+
+  EXPECT_EQ( footprints["B"].tile_bytes, 16 * sizeof(float) );
+  EXPECT_EQ( footprints["B"].reused_bytes, 0 );
+  EXPECT_EQ( footprints["B"].iteration_bytes, sizeof(float) );
+
+  FootprintEstimator::Footprint total = FootprintEstimator::total( footprints );
+  EXPECT_EQ( total.tile_bytes, 32 * sizeof(double) + 16 * sizeof(float) );
+  EXPECT_EQ( total.reused_bytes, 8 * sizeof(double) );
+  EXPECT_EQ( estimator.tileBytes( { 0 }, { 4, 4 } ), total.tile_bytes );
+
+  EXPECT_THROW( estimator.estimate( 0, { { 0, "4" } } ), assert_exception );
+  EXPECT_THROW( estimator.estimate( 0, { { 0, "4" }, { 1, "T" } } ), assert_exception );
+  EXPECT_THROW( estimator.estimate( 1, { { 0, "4" }, { 1, "4" } } ), assert_exception );
+}
+
+TEST( FootprintEstimator_test, affine ){
+  // B[i][j] = A[j][i] + A[j][i+1] + C[2*i]
+  LoopChain chain;
+  chain.append( LoopNest( RectangularDomain( { make_pair( "1", "N" ), make_pair( "1", "N" ) }, { "N" } ),
+                          { Dataspace( "A", { }, { },
+                                       { AffineAccess( { { 0, 1 }, { 1, 0 } }, Tuple( { 0, 0 } ) ),
+                                         AffineAccess( { { 0, 1 }, { 1, 0 } }, Tuple( { 0, 1 } ) ) },
+                                       { } ),
+                            Dataspace( "B", TupleCollection( 2 ), TupleCollection( { Tuple( { 0, 0 } ) } ) ) } ) );
+
+  FootprintEstimator estimator( chain, { }, 1 );
+  FootprintEstimator::FootprintMap footprints = estimator.estimate( { 0 }, FootprintEstimator::TileSizes( { 2, 8 } ) );
+  // 8 x (2+1) transposed
+  EXPECT_EQ( footprints["A"].tile_bytes, 24 );
+  EXPECT_EQ( footprints["A"].iteration_bytes, 2 );
+  // The previous tile (along j) touches rows j-8..j-1 of A
+  EXPECT_EQ( footprints["A"].reused_bytes, 0 );
+}
+
+/*
+B[i] = A[i-1] + A[i+1]; C[i] = B[i-1] + B[i]
+*/
+TEST( FootprintEstimator_test, fused_schedule ){
+  LoopChain chain;
+  chain.append( LoopNest( RectangularDomain( { make_pair( "1", "N" ) }, { "N" } ),
+                          { Dataspace( "A", TupleCollection( { Tuple( { -1 } ), Tuple( { 1 } ) } ), TupleCollection( 1 ) ),
+                            Dataspace( "B", TupleCollection( 1 ), TupleCollection( { Tuple( { 0 } ) } ) ) } ) );
+  chain.append( LoopNest( RectangularDomain( { make_pair( "1", "N" ) }, { "N" } ),
+                          { Dataspace( "B", TupleCollection( { Tuple( { -1 } ), Tuple( { 0 } ) } ), TupleCollection( 1 ) ),
+                            Dataspace( "C", TupleCollection( 1 ), TupleCollection( { Tuple( { 0 } ) } ) ) } ) );
+
+  FootprintEstimator unfused( chain );
+  FootprintEstimator::FootprintMap footprints = unfused.estimate( { 0, 1 }, { { 0, "16" } } );
+  EXPECT_EQ( footprints["A"].tile_bytes, 18 * sizeof(double) );
+  EXPECT_EQ( footprints["A"].reused_bytes, 2 * sizeof(double) );
+  // B is written and read in the same tile
+  EXPECT_EQ( footprints["B"].tile_bytes, 17 * sizeof(double) );
+  EXPECT_EQ( footprints["B"].reused_bytes, 1 * sizeof(double) );
+  EXPECT_EQ( footprints["B"].iteration_bytes, 2 * sizeof(double) );
+  EXPECT_EQ( footprints["C"].tile_bytes, 16 * sizeof(double) );
+
+  // Estimate from a schedule, where the accesses of the second loop are shifted
+  Schedule schedule( chain );
+  ShiftTransformation shift( 1, Tuple( { -1 } ) );
+  schedule.apply( shift );
+
+  FootprintEstimator shifted( schedule );
+  EXPECT_EQ( shifted.estimate( { 0, 1 }, { { 0, "16" } } )["B"].tile_bytes, 18 * sizeof(double) );
+}
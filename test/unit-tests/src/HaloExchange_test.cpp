@@ -0,0 +1,174 @@
+/*! ****************************************************************************
+\file HaloExchange_test.cpp
+\authors Ian J. Bertolacci
+
+\brief
+To perform unit testing on the HaloExchange and LocalTransport.
+
+\copyright
+Copyright 2017 Universiy of Arizona
+*******************************************************************************/
+
+#include "gtest/gtest.h"
+#include <LoopChainIR/HaloExchange.hpp>
+#include <LoopChainIR/util.hpp>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace std;
+using namespace LoopChainIR;
+
+TEST( HaloExchange_test, partition_range ){
+  EXPECT_EQ( partitionRange( 1, 10, 2, 0 ), make_pair( 1L, 5L ) );
+  EXPECT_EQ( partitionRange( 1, 10, 2, 1 ), make_pair( 6L, 10L ) );
+
+  // Parts differ in size by at most one, and cover the range
+  long next = 0;
+  for( int part = 0; part < 3; part += 1 ){
+    pair<long, long> range = partitionRange( 0, 9, 3, part );
+    EXPECT_EQ( range.first, next );
+    EXPECT_GE( range.second - range.first + 1, 3 );
+    EXPECT_LE( range.second - range.first + 1, 4 );
+    next = range.second + 1;
+  }
+  EXPECT_EQ( next, 10 );
+
+  EXPECT_THROW( partitionRange( 0, 9, 3, 3 ), assert_exception );
+}
+
+TEST( HaloExchange_test, local_transport ){
+  LocalNetwork network( 2 );
+  LocalTransport first( network, 0 );
+  LocalTransport second( network, 1 );
+  EXPECT_EQ( first.ranks(), 2 );
+  EXPECT_EQ( second.rank(), 1 );
+
+  int sent[2] = { 1, 2 };
+  int other = 3;
+  first.send( 1, 7, sent, sizeof( sent ) );
+  first.send( 1, 8, &other, sizeof( other ) );
+
+  // Messages are matched by tag, not by order
+  int received[2] = { 0, 0 };
+  int received_other = 0;
+  second.receive( 0, 8, &received_other, sizeof( received_other ) );
+  second.receive( 0, 7, received, sizeof( received ) );
+  second.wait();
+  EXPECT_EQ( received[0], 1 );
+  EXPECT_EQ( received[1], 2 );
+  EXPECT_EQ( received_other, 3 );
+
+  first.send( 1, 7, sent, sizeof( sent ) );
+  second.receive( 0, 7, &received_other, sizeof( received_other ) );
+  EXPECT_THROW( second.wait(), assert_exception );
+
+  EXPECT_THROW( LocalTransport( network, 2 ), assert_exception );
+  EXPECT_THROW( first.send( 2, 0, sent, sizeof( sent ) ), assert_exception );
+}
+
+TEST( HaloExchange_test, exchange_2d ){
+  // 2x2 ranks, each owning a 5x4 block of a 10x8 array, with halos 1 below and 2 above
+  const vector<int> grid = { 2, 2 };
+  const vector<HaloExchange::size_type> owned = { 5, 4 };
+  const vector<HaloExchange::HaloWidth> halo = { make_pair( 1, 2 ), make_pair( 1, 2 ) };
+  const long rows = 1 + 5 + 2;
+  const long columns = 1 + 4 + 2;
+  auto value = []( long i, long j ){ return (double)( 100 * i + j ); };
+
+  LocalNetwork network( 4 );
+  vector< vector<double> > arrays( 4, vector<double>( rows * columns, -1 ) );
+  vector<HaloExchange::size_type> neighbours( 4 );
+  vector<thread> ranks;
+  for( int rank = 0; rank < 4; rank += 1 ){
+    ranks.push_back( thread( [&, rank](){
+      vector<double>& array = arrays[rank];
+      long first_i = 5 * (rank / 2);
+      long first_j = 4 * (rank % 2);
+      for( long i = 0; i < 5; i += 1 ){
+        for( long j = 0; j < 4; j += 1 ){
+          array[ (i + 1) * columns + (j + 1) ] = value( first_i + i, first_j + j );
+        }
+      }
+
+      LocalTransport transport( network, rank );
+      HaloExchange exchange( array.data(), sizeof( double ), owned, halo, grid, rank );
+      neighbours[rank] = exchange.neighbours();
+      exchange.pack();
+      exchange.exchange( transport );
+      transport.wait();
+      exchange.unpack();
+    } ) );
+  }
+  for( thread& rank : ranks ){
+    rank.join();
+  }
+
+  for( int rank = 0; rank < 4; rank += 1 ){
+    EXPECT_EQ( neighbours[rank], 3 );
+    long first_i = 5 * (rank / 2);
+    long first_j = 4 * (rank % 2);
+    for( long i = -1; i < 5 + 2; i += 1 ){
+      for( long j = -1; j < 4 + 2; j += 1 ){
+        long global_i = first_i + i;
+        long global_j = first_j + j;
+        double element = arrays[rank][ (i + 1) * columns + (j + 1) ];
+        // Halo elements outside the whole array are untouched; the rest (corners included) are the owners'
+        if( 0 <= global_i && global_i < 10 && 0 <= global_j && global_j < 8 ){
+          EXPECT_EQ( element, value( global_i, global_j ) ) << "rank " << rank << " (" << i << ", " << j << ")";
+        } else {
+          EXPECT_EQ( element, -1 ) << "rank " << rank << " (" << i << ", " << j << ")";
+        }
+      }
+    }
+  }
+}
+
+TEST( HaloExchange_test, undecomposed_dimension ){
+  // Two ranks split the rows; the columns' halos are exchanged along with the rows
+  const vector<int> grid = { 2, 1 };
+  const vector<HaloExchange::size_type> owned = { 3, 3 };
+  const vector<HaloExchange::HaloWidth> halo = { make_pair( 1, 1 ), make_pair( 1, 1 ) };
+  const long columns = 5;
+
+  LocalNetwork network( 2 );
+  vector< vector<int> > arrays( 2, vector<int>( 5 * columns ) );
+  for( int rank = 0; rank < 2; rank += 1 ){
+    for( long i = 0; i < 5; i += 1 ){
+      for( long j = 0; j < columns; j += 1 ){
+        arrays[rank][ i * columns + j ] = (1 <= i && i <= 3)? 10 * (3 * rank + i - 1) + j : -1;
+      }
+    }
+  }
+
+  vector<thread> ranks;
+  for( int rank = 0; rank < 2; rank += 1 ){
+    ranks.push_back( thread( [&, rank](){
+      LocalTransport transport( network, rank );
+      HaloExchange exchange( arrays[rank].data(), sizeof( int ), owned, halo, grid, rank );
+      exchange.pack();
+      exchange.exchange( transport );
+      transport.wait();
+      exchange.unpack();
+    } ) );
+  }
+  for( thread& rank : ranks ){
+    rank.join();
+  }
+
+  for( long j = 0; j < columns; j += 1 ){
+    EXPECT_EQ( arrays[0][ 4 * columns + j ], 10 * 3 + j );
+    EXPECT_EQ( arrays[1][ 0 * columns + j ], 10 * 2 + j );
+    EXPECT_EQ( arrays[0][ 0 * columns + j ], -1 );
+    EXPECT_EQ( arrays[1][ 4 * columns + j ], -1 );
+  }
+}
+
+TEST( HaloExchange_test, illegal ){
+  vector<double> array( 100 );
+  EXPECT_THROW( HaloExchange( array.data(), sizeof( double ), { 4, 4 }, { make_pair( 1, 1 ) }, { 2, 2 }, 0 ), assert_exception );
+  EXPECT_THROW( HaloExchange( array.data(), sizeof( double ), { 4 }, { make_pair( 1, 1 ) }, { 2 }, 2 ), assert_exception );
+  // Wider than a neighbour's owned elements
+  EXPECT_THROW( HaloExchange( array.data(), sizeof( double ), { 4 }, { make_pair( 5, 1 ) }, { 2 }, 0 ), assert_exception );
+  EXPECT_THROW( LocalNetwork( 0 ), assert_exception );
+}
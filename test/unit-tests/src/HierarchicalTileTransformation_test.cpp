@@ -0,0 +1,202 @@
+/*! ****************************************************************************
+\file HierarchicalTileTransformation_test.cpp
+\authors Ian J. Bertolacci
+
+\brief
+To perform unit testsing on the CacheHierarchy and
+HierarchicalTileTransformation classes.
+
+\copyright
+Copyright 2017 Universiy of Arizona
+*******************************************************************************/
+
+#include "gtest/gtest.h"
+#include <LoopChainIR/HierarchicalTileTransformation.hpp>
+#include <LoopChainIR/CacheHierarchy.hpp>
+#include <LoopChainIR/Schedule.hpp>
+#include <LoopChainIR/util.hpp>
+#include <fstream>
+#include <iostream>
+#include <utility>
+#include <cstdlib>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+using namespace LoopChainIR;
+
+namespace {
+  LoopChain stencil(){
+    LoopChain chain;
+    chain.append( LoopNest( RectangularDomain( { make_pair( "1", "N" ), make_pair( "1", "N" ) }, { "N" } ),
+                            { Dataspace( "A",
+                                         TupleCollection( { Tuple( { -1, 0 } ), Tuple( { 1, 0 } ), Tuple( { 0, -1 } ), Tuple( { 0, 1 } ), Tuple( { 0, 0 } ) } ),
+                                         TupleCollection( 2 ) ),
+                              Dataspace( "B", TupleCollection( 2 ), TupleCollection( { Tuple( { 0, 0 } ) } ) ) } ) );
+    return chain;
+  }
+
+  string temporaryPath( string name ){
+    return SSTR( "/tmp/LoopChainIR_" << getpid() << "_" << name );
+  }
+
+  void writeFile( string path, string contents ){
+    ofstream file( path.c_str() );
+    file << contents;
+  }
+}
+
+TEST( CacheHierarchy_test, parse_size ){
+  EXPECT_EQ( CacheHierarchy::parseSize( "32768" ), 32768 );
+  EXPECT_EQ( CacheHierarchy::parseSize( "32K" ), 32*1024 );
+  EXPECT_EQ( CacheHierarchy::parseSize( "1M" ), 1024*1024 );
+  EXPECT_THROW( CacheHierarchy::parseSize( "big" ), assert_exception );
+  EXPECT_THROW( CacheHierarchy::parseSize( "32Q" ), assert_exception );
+}
+
+TEST( CacheHierarchy_test, from_file ){
+  string path = temporaryPath( "caches" );
+  writeFile( path, "# level size line shared\n3 32M 64 16\n\n1 32K\n2 1M 64 1\n" );
+
+  CacheHierarchy caches = CacheHierarchy::fromFile( path );
+  ASSERT_EQ( caches.size(), 3 );
+  EXPECT_EQ( caches[0].level, 1 );
+  EXPECT_EQ( caches[0].size, 32*1024 );
+  EXPECT_EQ( caches[1].level, 2 );
+  EXPECT_EQ( caches[2].level, 3 );
+  EXPECT_EQ( caches[2].shared_cores, 16 );
+  EXPECT_EQ( caches[2].sizePerCore(), 2*1024*1024 );
+
+  // Override of host()
+  setenv( CacheHierarchy::OverrideVariable, path.c_str(), 1 );
+  EXPECT_EQ( CacheHierarchy::host().size(), 3 );
+  unsetenv( CacheHierarchy::OverrideVariable );
+
+  writeFile( path, "1 32K\nL2 1M\n" );
+  EXPECT_THROW( CacheHierarchy::fromFile( path ), assert_exception );
+  unlink( path.c_str() );
+
+  EXPECT_THROW( CacheHierarchy::fromFile( path ), assert_exception );
+}
+
+TEST( CacheHierarchy_test, from_sysfs ){
+  string root = temporaryPath( "cpu" );
+  mkdir( root.c_str(), 0700 );
+  mkdir( (root + "/cpu0").c_str(), 0700 );
+  mkdir( (root + "/cpu0/cache").c_str(), 0700 );
+
+  struct { const char* level; const char* type; const char* size; const char* shared; } indices[] = {
+    { "1", "Data", "48K", "0,8" },
+    { "1", "Instruction", "32K", "0,8" },
+    { "2", "Unified", "1280K", "0,8" },
+    { "3", "Unified", "24576K", "0-15" }
+  };
+  for( int i = 0; i < 4; i += 1 ){
+    string directory = SSTR( root << "/cpu0/cache/index" << i );
+    mkdir( directory.c_str(), 0700 );
+    writeFile( directory + "/level", SSTR( indices[i].level << "\n" ) );
+    writeFile( directory + "/type", SSTR( indices[i].type << "\n" ) );
+    writeFile( directory + "/size", SSTR( indices[i].size << "\n" ) );
+    writeFile( directory + "/shared_cpu_list", SSTR( indices[i].shared << "\n" ) );
+    writeFile( directory + "/coherency_line_size", "64\n" );
+  }
+
+  CacheHierarchy caches = CacheHierarchy::fromSysfs( root );
+
+  ASSERT_EQ( caches.size(), 3 );
+  EXPECT_EQ( caches[0].size, 48*1024 );
+  EXPECT_EQ( caches[0].shared_cores, 2 );
+  EXPECT_EQ( caches[1].size, 1280*1024 );
+  EXPECT_EQ( caches[2].shared_cores, 16 );
+  EXPECT_EQ( caches[2].line_size, 64 );
+
+  EXPECT_THROW( CacheHierarchy::fromSysfs( root + "/missing" ), assert_exception );
+
+  for( int i = 0; i < 4; i += 1 ){
+    string directory = SSTR( root << "/cpu0/cache/index" << i );
+    for( string file : { "/level", "/type", "/size", "/shared_cpu_list", "/coherency_line_size" } ){
+      unlink( (directory + file).c_str() );
+    }
+    rmdir( directory.c_str() );
+  }
+  rmdir( (root + "/cpu0/cache").c_str() );
+  rmdir( (root + "/cpu0").c_str() );
+  rmdir( root.c_str() );
+}
+
+TEST( HierarchicalTileTransformation_test, levels ){
+  LoopChain chain = stencil();
+  CacheHierarchy caches( { CacheLevel( 1, 32*1024 ), CacheLevel( 2, 1024*1024 ), CacheLevel( 3, 32*1024*1024, 64, 16 ) } );
+
+  HierarchicalTileTransformation tiling( chain, 0, caches );
+  ASSERT_EQ( tiling.depth(), 3 );
+  EXPECT_TRUE( tiling.isParallel() );
+
+  TileSizeSelector selector( chain, 0 );
+  vector<TileSizeSelector::size_type> per_core = { 32*1024, 1024*1024, 2*1024*1024 };
+  for( HierarchicalTileTransformation::size_type level = 0; level < tiling.depth(); level += 1 ){
+    EXPECT_LE( selector.footprint( tiling.getLevels()[level] ), per_core[level] );
+    if( level > 0 ){
+      for( TileSizeSelector::size_type d = 0; d < 2; d += 1 ){
+        EXPECT_EQ( tiling.getLevels()[level][d] % tiling.getLevels()[level-1][d], 0 );
+      }
+    }
+  }
+
+  // A shared cache smaller per core than the private one does not add a level
+  CacheHierarchy crowded( { CacheLevel( 1, 32*1024 ), CacheLevel( 2, 1024*1024 ), CacheLevel( 3, 8*1024*1024, 64, 16 ) } );
+  EXPECT_EQ( HierarchicalTileTransformation( chain, 0, crowded ).depth(), 2 );
+
+  // The whole of a bounded domain fits the outer level, which is still made of whole inner tiles
+  LoopChain bounded;
+  bounded.append( LoopNest( RectangularDomain( { make_pair( "1", "100" ), make_pair( "1", "100" ) }, { } ),
+                            stencil().getNest( 0 ).getDataspaces() ) );
+  CacheHierarchy two( { CacheLevel( 1, 32*1024 ), CacheLevel( 2, 1024*1024 ) } );
+  HierarchicalTileTransformation bounded_tiling( bounded, 0, two );
+  ASSERT_EQ( bounded_tiling.depth(), 2 );
+  EXPECT_EQ( bounded_tiling.getLevels()[0], TileSizeSelector::TileSizes( { 32, 32 } ) );
+  EXPECT_EQ( bounded_tiling.getLevels()[1], TileSizeSelector::TileSizes( { 96, 96 } ) );
+  EXPECT_NO_THROW( HierarchicalTileTransformation( 0, bounded_tiling.getLevels() ) );
+}
+
+TEST( HierarchicalTileTransformation_test, explicit_levels ){
+  EXPECT_THROW( HierarchicalTileTransformation( 0, { } ), assert_exception );
+  EXPECT_THROW( HierarchicalTileTransformation( 0, { { 8, 8 }, { 12, 16 } } ), assert_exception );
+  EXPECT_THROW( HierarchicalTileTransformation( 0, { { 8, 8 }, { 16 } } ), assert_exception );
+  EXPECT_NO_THROW( HierarchicalTileTransformation( 0, { { 8, 8 }, { 16, 64 } } ) );
+}
+
+TEST( HierarchicalTileTransformation_test, codegen ){
+  LoopChain chain = stencil();
+
+  HierarchicalTileTransformation tiling( 0, { { 4, 8 }, { 16, 32 }, { 64, 64 } } );
+  vector<Transformation*> schedulers = { &tiling };
+
+  Schedule sched( chain );
+  sched.apply( schedulers );
+
+  string code = sched.codegen();
+  ASSERT_NE( code, string("{\n}\n") );
+  // The outermost tiles run in parallel
+  EXPECT_EQ( code.find( "#pragma omp parallel for\nfor (int c1 = 0; c1 <= floord(N, 64); c1 += 1)" ), 0 ) << code;
+  // Two loops per tiling level, outermost (64x64) first, each level's tiles
+  // spanning its share of the enclosing level's tile, then the point loops
+  vector<string> loops = {
+    "for (int c1 = 0; c1 <= floord(N, 64); c1 += 1)",
+    "for (int c2 = 0; c2 <= N / 64; c2 += 1)",
+    "for (int c4 = 4 * c1; c4 <= min(4 * c1 + 3, N / 16); c4 += 1)",
+    "for (int c5 = 2 * c2; c5 <= min(2 * c2 + 1, N / 32); c5 += 1)",
+    "for (int c7 = 4 * c4; c7 <= min(4 * c4 + 3, N / 4); c7 += 1)",
+    "for (int c8 = 4 * c5; c8 <= min(4 * c5 + 3, N / 8); c8 += 1)",
+    "for (int c10 = max(1, 4 * c7); c10 <= min(N, 4 * c7 + 3); c10 += 1)",
+    "for (int c11 = max(1, 8 * c8); c11 <= min(N, 8 * c8 + 7); c11 += 1)",
+    "statement_0(c10, c11);"
+  };
+  string::size_type previous = 0;
+  for( const string& loop : loops ){
+    string::size_type position = code.find( loop );
+    ASSERT_NE( position, string::npos ) << loop << " not in:\n" << code;
+    EXPECT_LE( previous, position ) << loop << " out of order in:\n" << code;
+    previous = position;
+  }
+}
@@ -11,6 +11,7 @@ Copyright 2015-2016 Colorado State University
 
 #include "gtest/gtest.h"
 #include <LoopChainIR/LoopChain.hpp>
+#include <LoopChainIR/util.hpp>
 #include <iostream>
 #include <utility>
 
@@ -305,3 +306,53 @@ TEST(LoopChainTest, Test_Getters_3N_1D_2D_3D) {
     EXPECT_EQ( got_domain.getSymbols(), form_symbols );
   }
 }
+
+/*
+Moving a chain keeps its nests and dataspaces.
+*/
+TEST(LoopChainTest, Test_Move) {
+  LoopChain chain;
+  {
+    string lower[1] = { "0" };
+    string upper[1] = { "N" };
+    string symbol[1] = { "N" };
+    chain.append( LoopNest( RectangularDomain( lower, upper, 1, symbol, 1 ),
+                            { Dataspace( "A", TupleCollection( { Tuple( { -1 } ), Tuple( { 1 } ) } ), TupleCollection( { Tuple( { 0 } ) } ) ) } ) );
+  }
+
+  const LoopNest* first_nest = &chain.getNest( 0 );
+  const Dataspace* first_dataspace = &chain.getNest( 0 ).getDataspaces().front();
+
+  LoopChain moved( std::move( chain ) );
+  ASSERT_EQ( moved.length(), 1 );
+
+  // No nest or dataspace was copied.
+  const LoopChain& const_moved = moved;
+  EXPECT_EQ( &const_moved.getNest( 0 ), first_nest );
+  EXPECT_EQ( &const_moved.getNest( 0 ).getDataspaces().front(), first_dataspace );
+  EXPECT_EQ( const_moved.getNest( 0 ).getDataspaces().front().reads().str(), "{ (-1), (1) }" );
+  EXPECT_EQ( const_moved.getNest( 0 ).getDomain().getUpperBound( 0 ), "N" );
+}
+
+/*
+A time domain is kept by copies and moves, and must be one dimensional.
+*/
+TEST(LoopChainTest, Test_Time_Domain) {
+  LoopChain chain;
+  chain.append( LoopNest( RectangularDomain( { make_pair( "1", "N" ) }, { "N" } ) ) );
+  EXPECT_FALSE( chain.hasTimeDomain() );
+  EXPECT_THROW( chain.getTimeDomain(), assert_exception );
+
+  EXPECT_THROW( chain.setTimeDomain( RectangularDomain( { make_pair( "1", "T" ), make_pair( "1", "T" ) }, { "T" } ) ), assert_exception );
+  chain.setTimeDomain( RectangularDomain( "1", "T", { "T" } ) );
+  ASSERT_TRUE( chain.hasTimeDomain() );
+  EXPECT_EQ( chain.getTimeDomain().getUpperBound( 0 ), "T" );
+
+  LoopChain copied( chain );
+  ASSERT_TRUE( copied.hasTimeDomain() );
+  EXPECT_EQ( copied.getTimeDomain().getLowerBound( 0 ), "1" );
+
+  LoopChain moved( std::move( chain ) );
+  EXPECT_TRUE( moved.hasTimeDomain() );
+  EXPECT_EQ( moved.length(), 1 );
+}
@@ -11,8 +11,10 @@ Copyright 2015-2016 Colorado State University
 
 #include "gtest/gtest.h"
 #include <LoopChainIR/LoopNest.hpp>
+#include <LoopChainIR/util.hpp>
 #include <iostream>
 #include <utility>
+#include <algorithm>
 
 using namespace std;
 using namespace LoopChainIR;
@@ -135,8 +137,44 @@ TEST( LoopNestTest, shift_dataspaces ){
   nest.shiftDataspaces( Tuple( {1,1} ) );
 
   /*
-  for( Dataspace& dataspace : nest.getDataspaces() ){
+  for( const Dataspace& dataspace : nest.getDataspaces() ){
     cout << dataspace << endl;
   }
   */
 }
+
+TEST(LoopNestTest, dependenceDistances) {
+  RectangularDomain domain( { make_pair( "1", "N" ) }, { "N" } );
+
+  // B[i] = A[i-1] + A[i+1]
+  LoopNest producer( domain,
+                     { Dataspace( "A", TupleCollection( { Tuple( { -1 } ), Tuple( { 1 } ) } ), TupleCollection( 1 ) ),
+                       Dataspace( "B", TupleCollection( 1 ), TupleCollection( { Tuple( { 0 } ) } ) ) } );
+  // A[i] = B[i-2]
+  LoopNest consumer( domain,
+                     { Dataspace( "B", TupleCollection( { Tuple( { -2 } ) } ), TupleCollection( 1 ) ),
+                       Dataspace( "A", TupleCollection( 1 ), TupleCollection( { Tuple( { 0 } ) } ) ) } );
+
+  // Iteration i+2 of the consumer reads B[i]; iterations i-1 and i+1 overwrite the A[i] read by the producer
+  vector<DependenceDistance> dependences = dependenceDistances( producer, consumer );
+  ASSERT_EQ( dependences.size(), 3 );
+  vector< pair<DependenceDistance::Kind, int> > found;
+  for( const DependenceDistance& dependence : dependences ){
+    EXPECT_EQ( dependence.dataspace, (dependence.kind == DependenceDistance::Flow)? "B" : "A" );
+    found.push_back( make_pair( dependence.kind, dependence.distance[0] ) );
+  }
+  sort( found.begin(), found.end() );
+  EXPECT_EQ( found[0], make_pair( DependenceDistance::Flow, 2 ) );
+  EXPECT_EQ( found[1], make_pair( DependenceDistance::Anti, -1 ) );
+  EXPECT_EQ( found[2], make_pair( DependenceDistance::Anti, 1 ) );
+
+  // The producer only writes B once per iteration
+  dependences = dependenceDistances( producer, producer );
+  ASSERT_EQ( dependences.size(), 1 );
+  EXPECT_EQ( dependences[0].kind, DependenceDistance::Output );
+  EXPECT_EQ( dependences[0].distance, Tuple( { 0 } ) );
+
+  // Reductions have no constant distance
+  LoopNest reducer( domain, { Dataspace( "A", ReduceAdd, { AffineAccess( {{0}}, Tuple( { 0 } ) ) } ) } );
+  EXPECT_THROW( dependenceDistances( producer, reducer ), assert_exception );
+}
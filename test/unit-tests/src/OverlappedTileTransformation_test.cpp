@@ -0,0 +1,154 @@
+/*! ****************************************************************************
+\file OverlappedTileTransformation_test.cpp
+\authors Ian J. Bertolacci
+
+\brief
+To perform unit testing on the OverlappedTileTransformation.
+
+\copyright
+Copyright 2017 Universiy of Arizona
+*******************************************************************************/
+
+#include "gtest/gtest.h"
+#include <LoopChainIR/OverlappedTileTransformation.hpp>
+#include <LoopChainIR/ParallelAnnotation.hpp>
+#include <LoopChainIR/Schedule.hpp>
+#include <LoopChainIR/util.hpp>
+#include <iostream>
+#include <utility>
+
+using namespace std;
+using namespace LoopChainIR;
+
+namespace {
+  RectangularDomain domain(){
+    return RectangularDomain( { make_pair( "1", "N" ), make_pair( "1", "M" ) }, { "N", "M" } );
+  }
+
+  /*
+  B[i,j] = A[i-1,j] + A[i,j] + A[i+1,j]
+  C[i,j] = B[i-1,j] + B[i+1,j] + B[i,j+1]
+  D[i,j] = C[i,j-1] + C[i+2,j]
+  */
+  LoopChain pipeline(){
+    LoopChain chain;
+    chain.append( LoopNest( domain(),
+                            { Dataspace( "A", TupleCollection( { Tuple( { -1, 0 } ), Tuple( { 0, 0 } ), Tuple( { 1, 0 } ) } ), TupleCollection( 2 ) ),
+                              Dataspace( "B", TupleCollection( 2 ), TupleCollection( { Tuple( { 0, 0 } ) } ) ) } ) );
+    chain.append( LoopNest( domain(),
+                            { Dataspace( "B", TupleCollection( { Tuple( { -1, 0 } ), Tuple( { 1, 0 } ), Tuple( { 0, 1 } ) } ), TupleCollection( 2 ) ),
+                              Dataspace( "C", TupleCollection( 2 ), TupleCollection( { Tuple( { 0, 0 } ) } ) ) } ) );
+    chain.append( LoopNest( domain(),
+                            { Dataspace( "C", TupleCollection( { Tuple( { 0, -1 } ), Tuple( { 2, 0 } ) } ), TupleCollection( 2 ) ),
+                              Dataspace( "D", TupleCollection( 2 ), TupleCollection( { Tuple( { 0, 0 } ) } ) ) } ) );
+    return chain;
+  }
+}
+
+TEST( OverlappedTileTransformation_test, halos ){
+  vector< vector<OverlappedTileTransformation::Halo> > halos = OverlappedTileTransformation::halos( pipeline(), { 0, 1, 2 }, 2 );
+  ASSERT_EQ( halos.size(), 3 );
+
+  // The last nest runs over the tile itself
+  EXPECT_EQ( halos[2][0], make_pair( 0, 0 ) );
+  EXPECT_EQ( halos[2][1], make_pair( 0, 0 ) );
+  // C is read at (0,-1) and (2,0)
+  EXPECT_EQ( halos[1][0], make_pair( 0, 2 ) );
+  EXPECT_EQ( halos[1][1], make_pair( 1, 0 ) );
+  // B is read at (-1,0), (1,0) and (0,1) over the region of the second nest
+  EXPECT_EQ( halos[0][0], make_pair( 1, 3 ) );
+  EXPECT_EQ( halos[0][1], make_pair( 1, 1 ) );
+
+  // Only the first two nests
+  halos = OverlappedTileTransformation::halos( pipeline(), { 0, 1 }, 1 );
+  ASSERT_EQ( halos.size(), 2 );
+  EXPECT_EQ( halos[0][0], make_pair( 1, 1 ) );
+  EXPECT_EQ( halos[1][0], make_pair( 0, 0 ) );
+}
+
+TEST( OverlappedTileTransformation_test, redundancyRatio ){
+  // (12*8 + 10*7 + 8*6) / (8*6*3)
+  OverlappedTileTransformation overlapped( { 0, 1, 2 }, { 8, 6 } );
+  EXPECT_DOUBLE_EQ( overlapped.redundancyRatio( pipeline() ), 214.0 / 144.0 );
+
+  // Larger tiles recompute less
+  EXPECT_LT( OverlappedTileTransformation::redundancyRatio( pipeline(), { 0, 1, 2 }, { 32, 32 } ),
+             OverlappedTileTransformation::redundancyRatio( pipeline(), { 0, 1, 2 }, { 8, 6 } ) );
+
+  // A single nest has no halo
+  EXPECT_DOUBLE_EQ( OverlappedTileTransformation::redundancyRatio( pipeline(), { 2 }, { 4, 4 } ), 1.0 );
+}
+
+TEST( OverlappedTileTransformation_test, codegen ){
+  Schedule schedule( pipeline() );
+  ParallelAnnotation parallel( 0 );
+  OverlappedTileTransformation overlapped( { 0, 1, 2 }, { 8, 6 }, { &parallel } );
+  ASSERT_EQ( overlapped.getNests().size(), 3 );
+  EXPECT_EQ( overlapped.getTileSizes()[0], 8 );
+  ASSERT_NO_THROW( schedule.apply( overlapped ) );
+
+  string code;
+  ASSERT_NO_THROW( code = schedule.codegen() );
+
+  // The phases run in order, each with its tiles in parallel
+  string::size_type phase = code.find( "for (int c1 = 0; c1 <= 1; c1 += 1)" );
+  string::size_type pragma = code.find( "#pragma omp parallel for" );
+  string::size_type tile = code.find( "for (int c4 = -c1; " );
+  ASSERT_NE( phase, string::npos ) << code;
+  ASSERT_NE( pragma, string::npos ) << code;
+  ASSERT_NE( tile, string::npos ) << code;
+  EXPECT_EQ( code.find( "#pragma omp parallel for", pragma + 1 ), string::npos ) << code;
+  EXPECT_LT( phase, pragma ) << code;
+  EXPECT_LT( pragma, tile ) << code;
+  EXPECT_NE( code.find( "c4 += 2)" ), string::npos ) << code;
+  EXPECT_NE( code.find( "c5 += 2)" ), string::npos ) << code;
+
+  // Every tile runs all three nests, producers over their halos
+  EXPECT_LT( tile, code.find( "statement_0(" ) ) << code;
+  EXPECT_LT( code.find( "statement_0(" ), code.find( "statement_1(" ) ) << code;
+  EXPECT_LT( code.find( "statement_1(" ), code.find( "statement_2(" ) ) << code;
+  EXPECT_NE( code.find( "8 * c4 - 1" ), string::npos ) << code;
+  EXPECT_NE( code.find( "8 * c4 + 10" ), string::npos ) << code;
+}
+
+TEST( OverlappedTileTransformation_test, phaseStrides ){
+  vector< vector<OverlappedTileTransformation::Halo> > halos = OverlappedTileTransformation::halos( pipeline(), { 0, 1, 2 }, 2 );
+
+  // Regions of neighbouring tiles overlap by the halos
+  EXPECT_EQ( OverlappedTileTransformation::phaseStrides( halos, { 8, 6 } ), vector<int>( { 2, 2 } ) );
+  // Tiles narrower than the halos overlap more than their neighbours
+  EXPECT_EQ( OverlappedTileTransformation::phaseStrides( halos, { 2, 1 } ), vector<int>( { 3, 3 } ) );
+  // Without halos, every tile is independent
+  halos = OverlappedTileTransformation::halos( pipeline(), { 2 }, 2 );
+  EXPECT_EQ( OverlappedTileTransformation::phaseStrides( halos, { 8, 6 } ), vector<int>( { 1, 1 } ) );
+}
+
+TEST( OverlappedTileTransformation_test, illegal ){
+  EXPECT_THROW( OverlappedTileTransformation( {}, { 8 } ), assert_exception );
+  EXPECT_THROW( OverlappedTileTransformation( { 0, 2 }, { 8 } ), assert_exception );
+  EXPECT_THROW( OverlappedTileTransformation( { 0, 1 }, {} ), assert_exception );
+  EXPECT_THROW( OverlappedTileTransformation( { 0, 1 }, { 8, 0 } ), assert_exception );
+
+  EXPECT_THROW( OverlappedTileTransformation::halos( pipeline(), { 0, 1, 2, 3 }, 2 ), assert_exception );
+  EXPECT_THROW( OverlappedTileTransformation::halos( pipeline(), { 0, 1 }, 3 ), assert_exception );
+
+  // Two nests write B
+  LoopChain twice;
+  twice.append( pipeline().getNest( 0 ) );
+  twice.append( pipeline().getNest( 0 ) );
+  EXPECT_THROW( OverlappedTileTransformation::halos( twice, { 0, 1 }, 2 ), assert_exception );
+
+  // Writes A in place, which it reads
+  LoopChain in_place;
+  in_place.append( LoopNest( domain(),
+                             { Dataspace( "A", TupleCollection( { Tuple( { -1, 0 } ) } ), TupleCollection( { Tuple( { 0, 0 } ) } ) ) } ) );
+  EXPECT_THROW( OverlappedTileTransformation::halos( in_place, { 0 }, 2 ), assert_exception );
+
+  // Writes B[i,j] and B[i+1,j], so disjoint regions store to the same elements
+  LoopChain spread;
+  spread.append( LoopNest( domain(),
+                           { Dataspace( "A", TupleCollection( { Tuple( { 0, 0 } ) } ), TupleCollection( 2 ) ),
+                             Dataspace( "B", TupleCollection( 2 ), TupleCollection( { Tuple( { 0, 0 } ), Tuple( { 1, 0 } ) } ) ) } ) );
+  spread.append( pipeline().getNest( 1 ) );
+  EXPECT_THROW( OverlappedTileTransformation::halos( spread, { 0, 1 }, 2 ), assert_exception );
+}
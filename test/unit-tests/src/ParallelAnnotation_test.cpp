@@ -14,6 +14,7 @@ Copyright 2015-2016 Colorado State University
 #include <LoopChainIR/Schedule.hpp>
 #include <LoopChainIR/TileTransformation.hpp>
 #include <LoopChainIR/DefaultSequentialTransformation.hpp>
+#include <LoopChainIR/FusionTransformation.hpp>
 #include <iostream>
 #include <utility>
 
@@ -269,3 +270,247 @@ TEST( ParallelAnnotation_test, 2N_2D_tile_parallel_within ){
   // Because this is an empty loop, the code will be an empty statement body
   ASSERT_NE( sched.codegen(), string("{\n}\n") );
 }
+
+TEST( ParallelAnnotation_test, clauses ){
+  EXPECT_EQ( OpenMPClauses().pragma(), "omp parallel for" );
+  EXPECT_EQ( OpenMPClauses().schedule( OpenMPClauses::Dynamic, "4" ).pragma(), "omp parallel for schedule(dynamic,4)" );
+  EXPECT_EQ( OpenMPClauses().schedule( OpenMPClauses::Guided ).collapse( 2 ).pragma(), "omp parallel for schedule(guided) collapse(2)" );
+  EXPECT_EQ( OpenMPClauses().numThreads( "T" ).procBind( OpenMPClauses::Spread ).pragma(), "omp parallel for num_threads(T) proc_bind(spread)" );
+
+  EXPECT_THROW( OpenMPClauses().schedule( OpenMPClauses::Runtime, "4" ), assert_exception );
+  EXPECT_THROW( OpenMPClauses().collapse( 0 ), assert_exception );
+
+  EXPECT_EQ( OpenMPClauses().reduction( ReduceAdd, "sum" ).reduction( ReduceMax, "m" ).reduction( ReduceAdd, "sum" ).pragma(),
+             "omp parallel for reduction(max:m) reduction(+:sum)" );
+  EXPECT_THROW( OpenMPClauses().reduction( ReduceAdd, "sum" ).reduction( ReduceMultiply, "sum" ), assert_exception );
+}
+
+TEST( ParallelAnnotation_test, 1N_2D_tile_parallel_over_clauses ){
+  LoopChain chain;
+
+  chain.append(
+    LoopNest(
+      RectangularDomain(
+        { make_pair("0", "N"), make_pair("0", "M") },
+        {"N", "M"}
+      )
+    )
+  );
+
+  vector<Transformation*> schedulers = {
+    new TileTransformation(
+      0,
+      { make_pair( 0, "8" ), make_pair( 1, "8" ) },
+      new ParallelAnnotation( OpenMPClauses().schedule( OpenMPClauses::Dynamic, "1" ).collapse( 2 ) ),
+      new ParallelAnnotation( 1, OpenMPClauses().schedule( OpenMPClauses::Static ).numThreads( "4" ) )
+    )
+  };
+
+  Schedule sched( chain );
+  sched.apply( schedulers );
+
+  string code = sched.codegen();
+  EXPECT_NE( code.find( "#pragma omp parallel for schedule(dynamic,1) collapse(2)\n" ), string::npos ) << code;
+  EXPECT_NE( code.find( "#pragma omp parallel for schedule(static) num_threads(4)\n" ), string::npos ) << code;
+}
+
+TEST( ParallelAnnotation_test, 1N_2D_tile_reduction ){
+  LoopChain chain;
+
+  // sum[0] += A[i][j]
+  chain.append(
+    LoopNest(
+      RectangularDomain(
+        { make_pair("0", "N"), make_pair("0", "M") },
+        {"N", "M"}
+      ),
+      { Dataspace( "A", TupleCollection( { Tuple( { 0, 0 } ) } ), TupleCollection( 2 ) ),
+        Dataspace( "sum", ReduceAdd, { AffineAccess( {{0, 0}}, Tuple( { 0 } ) ) } ) }
+    )
+  );
+
+  vector<Transformation*> schedulers = {
+    new TileTransformation(
+      0,
+      { make_pair( 0, "8" ), make_pair( 1, "8" ) },
+      new ParallelAnnotation( OpenMPClauses().collapse( 2 ) ),
+      new DefaultSequentialTransformation()
+    )
+  };
+
+  Schedule sched( chain );
+  sched.apply( schedulers );
+
+  string code = sched.codegen();
+  EXPECT_NE( code.find( "#pragma omp parallel for collapse(2) reduction(+:sum)\n" ), string::npos ) << code;
+
+  // The reduction survives the rewriting of the accesses by tiling
+  const Dataspace& sum = sched.getChain().getNest( 0 ).getDataspaces().back();
+  EXPECT_TRUE( sum.isReduction() );
+  EXPECT_EQ( sum.reductionOperator(), ReduceAdd );
+}
+
+TEST( ParallelAnnotation_test, 2N_1D_reduction_reader ){
+  LoopChain chain;
+  RectangularDomain domain( { make_pair("1", "N") }, {"N"} );
+
+  // sum[0] += A[i]
+  chain.append(
+    LoopNest( domain,
+      { Dataspace( "A", TupleCollection( { Tuple( { 0 } ) } ), TupleCollection( 1 ) ),
+        Dataspace( "sum", ReduceAdd, { AffineAccess( {{0}}, Tuple( { 0 } ) ) } ) }
+    )
+  );
+
+  // B[i] = A[i] / sum[0]
+  chain.append(
+    LoopNest( domain,
+      { Dataspace( "A", TupleCollection( { Tuple( { 0 } ) } ), TupleCollection( 1 ) ),
+        Dataspace( "sum", set<Tuple>(), set<Tuple>(), { AffineAccess( {{0}}, Tuple( { 0 } ) ) }, set<AffineAccess>() ),
+        Dataspace( "B", TupleCollection( 1 ), TupleCollection( { Tuple( { 0 } ) } ) ) }
+    )
+  );
+
+  Schedule sched( chain );
+  ParallelAnnotation parallel;
+  sched.apply( parallel );
+
+  string code = sched.codegen();
+  string::size_type reducer = code.find( "#pragma omp parallel for reduction(+:sum)\n" );
+  string::size_type reader = code.find( "#pragma omp parallel for\n" );
+  ASSERT_NE( reducer, string::npos ) << code;
+  ASSERT_NE( reader, string::npos ) << code;
+
+  // Only the loop of the first nest reduces into sum
+  EXPECT_EQ( code.find( "reduction", code.find( "\n", reducer ) ), string::npos ) << code;
+  EXPECT_LT( reducer, code.find( "statement_0(" ) ) << code;
+  EXPECT_LT( code.find( "statement_0(" ), reader ) << code;
+  EXPECT_LT( reader, code.find( "statement_1(" ) ) << code;
+}
+
+TEST( ParallelAnnotation_test, 1N_2D_array_reduction ){
+  LoopChain chain;
+
+  // r[i] = max( r[i], A[i][j] )
+  chain.append(
+    LoopNest(
+      RectangularDomain(
+        { make_pair("1", "N"), make_pair("0", "M") },
+        {"N", "M"}
+      ),
+      { Dataspace( "A", TupleCollection( { Tuple( { 0, 0 } ) } ), TupleCollection( 2 ) ),
+        Dataspace( "r", ReduceMax, { AffineAccess( {{1, 0}}, Tuple( { 0 } ) ), AffineAccess( {{1, 0}}, Tuple( { 2 } ) ) } ) }
+    )
+  );
+
+  Schedule sched( chain );
+  ParallelAnnotation parallel;
+  sched.apply( parallel );
+
+  // The array section reduced into, r[1] through r[N+2]
+  string code = sched.codegen();
+  EXPECT_NE( code.find( "#pragma omp parallel for reduction(max:r[1:N+2-1+1])\n" ), string::npos ) << code;
+
+  // A reduction the clauses already give is left to them
+  Schedule given( chain );
+  ParallelAnnotation parallel_given( OpenMPClauses().reduction( ReduceMax, "r" ) );
+  given.apply( parallel_given );
+  code = given.codegen();
+  EXPECT_NE( code.find( "#pragma omp parallel for reduction(max:r)\n" ), string::npos ) << code;
+}
+
+TEST( ParallelAnnotation_test, 1N_2D_triangular_reduction ){
+  PolyhedralDomain triangle( { "i", "j" }, { "0 <= j <= i <= N" }, { "N" } );
+
+  // sum[0] += A[i][j] over the triangle
+  LoopChain chain;
+  chain.append(
+    LoopNest( triangle,
+      { Dataspace( "A", TupleCollection( { Tuple( { 0, 0 } ) } ), TupleCollection( 2 ) ),
+        Dataspace( "sum", ReduceAdd, { AffineAccess( {{0, 0}}, Tuple( { 0 } ) ) } ) }
+    )
+  );
+
+  Schedule sched( chain );
+  ParallelAnnotation parallel;
+  ASSERT_NO_THROW( sched.apply( parallel ) );
+  string code = sched.codegen();
+  EXPECT_NE( code.find( "#pragma omp parallel for reduction(+:sum)\n" ), string::npos ) << code;
+
+  // The array section of r[i] needs the bounds of a rectangular domain
+  LoopChain rows;
+  rows.append(
+    LoopNest( triangle,
+      { Dataspace( "r", ReduceMax, { AffineAccess( {{1, 0}}, Tuple( { 0 } ) ) } ) }
+    )
+  );
+  Schedule rows_sched( rows );
+  EXPECT_THROW( rows_sched.apply( parallel ), assert_exception );
+}
+
+TEST( ParallelAnnotation_test, collapse_past_nest ){
+  LoopChain chain;
+
+  chain.append(
+    LoopNest(
+      RectangularDomain(
+        { make_pair("0", "N"), make_pair("0", "M") },
+        {"N", "M"}
+      )
+    )
+  );
+
+  // Loop 1 is the innermost, so there is no loop to collapse it with
+  vector<Transformation*> schedulers = {
+    new ParallelAnnotation( 1, OpenMPClauses().collapse( 2 ) )
+  };
+
+  Schedule sched( chain );
+  EXPECT_THROW( sched.apply( schedulers ), assert_exception );
+}
+
+TEST( ParallelAnnotation_test, collapse_imperfect_nest ){
+  LoopChain chain;
+
+  chain.append(
+    LoopNest(
+      RectangularDomain(
+        { make_pair("0", "N"), make_pair("0", "M") },
+        {"N", "M"}
+      )
+    )
+  );
+
+  chain.append(
+    LoopNest(
+      RectangularDomain(
+        { make_pair("0", "N"), make_pair("0", "K") },
+        {"N", "K"}
+      )
+    )
+  );
+
+  // The fused j loops have different extents, so they do not form a single inner loop
+  vector<Transformation*> schedulers = {
+    new FusionTransformation( vector<LoopChain::size_type>( { 0, 1 } ) ),
+    new ParallelAnnotation( OpenMPClauses().collapse( 2 ) )
+  };
+
+  Schedule sched( chain );
+  sched.apply( schedulers );
+  EXPECT_THROW( sched.codegen(), assert_exception );
+}
+
+TEST( ParallelAnnotation_test, collapse_triangular_nest ){
+  LoopChain chain;
+
+  chain.append( LoopNest( PolyhedralDomain( "[N] -> { [i,j] : 0 <= j <= i <= N }" ) ) );
+
+  vector<Transformation*> schedulers = {
+    new ParallelAnnotation( OpenMPClauses().collapse( 2 ) )
+  };
+
+  Schedule sched( chain );
+  sched.apply( schedulers );
+  EXPECT_THROW( sched.codegen(), assert_exception );
+}
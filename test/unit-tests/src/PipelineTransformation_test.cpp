@@ -0,0 +1,125 @@
+/*! ****************************************************************************
+\file PipelineTransformation_test.cpp
+\authors Ian J. Bertolacci
+
+\brief
+To perform unit testing on the PipelineTransformation.
+
+\copyright
+Copyright 2017 Universiy of Arizona
+*******************************************************************************/
+
+#include "gtest/gtest.h"
+#include <LoopChainIR/PipelineTransformation.hpp>
+#include <LoopChainIR/Schedule.hpp>
+#include <LoopChainIR/util.hpp>
+#include <iostream>
+#include <utility>
+
+using namespace std;
+using namespace LoopChainIR;
+
+namespace {
+  /*
+  A[i][j] = B[i][j]
+  C[i][j] = A[i-1][j] + A[i][j] + A[i+1][j]
+  D[i][j] = C[i+5][j]
+  */
+  LoopChain producerConsumer(){
+    LoopChain chain;
+    chain.append( LoopNest( RectangularDomain( { make_pair( "1", "N" ), make_pair( "1", "M" ) }, { "N", "M" } ),
+                            { Dataspace( "A", TupleCollection( 2 ), TupleCollection( { Tuple( { 0, 0 } ) } ) ),
+                              Dataspace( "B", TupleCollection( { Tuple( { 0, 0 } ) } ), TupleCollection( 2 ) ) } ) );
+    chain.append( LoopNest( RectangularDomain( { make_pair( "1", "N" ), make_pair( "1", "M" ) }, { "N", "M" } ),
+                            { Dataspace( "A", TupleCollection( { Tuple( { -1, 0 } ), Tuple( { 0, 0 } ), Tuple( { 1, 0 } ) } ), TupleCollection( 2 ) ),
+                              Dataspace( "C", TupleCollection( 2 ), TupleCollection( { Tuple( { 0, 0 } ) } ) ) } ) );
+    chain.append( LoopNest( RectangularDomain( { make_pair( "1", "N" ), make_pair( "1", "M" ) }, { "N", "M" } ),
+                            { Dataspace( "C", TupleCollection( { Tuple( { 5, 0 } ) } ), TupleCollection( 2 ) ),
+                              Dataspace( "D", TupleCollection( 2 ), TupleCollection( { Tuple( { 0, 0 } ) } ) ) } ) );
+    return chain;
+  }
+}
+
+TEST( PipelineTransformation_test, block_offsets ){
+  LoopChain chain = producerConsumer();
+
+  // Block k of the consumer needs the producer's element k*B + B
+  EXPECT_EQ( PipelineTransformation::blockOffsets( chain, { 0, 1 }, 4 ), vector<int>( { 0, 1 } ) );
+  // Reaching 5 ahead takes two blocks of 4, and one of 8
+  EXPECT_EQ( PipelineTransformation::blockOffsets( chain, { 0, 1, 2 }, 4 ), vector<int>( { 0, 1, 3 } ) );
+  EXPECT_EQ( PipelineTransformation::blockOffsets( chain, { 0, 1, 2 }, 8 ), vector<int>( { 0, 1, 2 } ) );
+  // Blocks of one iteration lag by the distances themselves
+  EXPECT_EQ( PipelineTransformation::blockOffsets( chain, { 0, 1, 2 }, 1 ), vector<int>( { 0, 1, 6 } ) );
+}
+
+TEST( PipelineTransformation_test, independent_and_backward ){
+  LoopChain chain;
+  // Writes A, then reads B (independent of A), then reads A behind itself
+  chain.append( LoopNest( RectangularDomain( { make_pair( "1", "N" ) }, { "N" } ),
+                          { Dataspace( "A", TupleCollection( 1 ), TupleCollection( { Tuple( { 0 } ) } ) ) } ) );
+  chain.append( LoopNest( RectangularDomain( { make_pair( "1", "N" ) }, { "N" } ),
+                          { Dataspace( "B", TupleCollection( 1 ), TupleCollection( { Tuple( { 0 } ) } ) ) } ) );
+  chain.append( LoopNest( RectangularDomain( { make_pair( "1", "N" ) }, { "N" } ),
+                          { Dataspace( "A", TupleCollection( { Tuple( { -3 } ) } ), TupleCollection( 1 ) ),
+                            Dataspace( "C", TupleCollection( 1 ), TupleCollection( { Tuple( { 0 } ) } ) ) } ) );
+
+  EXPECT_EQ( PipelineTransformation::blockOffsets( chain, { 0, 1, 2 }, 2 ), vector<int>( { 0, 0, 0 } ) );
+}
+
+TEST( PipelineTransformation_test, codegen ){
+  Schedule schedule( producerConsumer() );
+  PipelineTransformation pipeline( { 0, 1, 2 }, 4 );
+  EXPECT_EQ( pipeline.getBlockSize(), 4 );
+  ASSERT_NO_THROW( schedule.apply( pipeline ) );
+
+  string code;
+  ASSERT_NO_THROW( code = schedule.codegen() );
+
+  EXPECT_NE( code.find( "#pragma omp parallel for schedule(static, 1) ordered(1)" ), string::npos ) << code;
+
+  // Waits on the previous block before the producers, and signals before the last consumer
+  string::size_type sink = code.find( "#pragma omp ordered depend(sink: " );
+  string::size_type source = code.find( "#pragma omp ordered depend(source)" );
+  ASSERT_NE( sink, string::npos ) << code;
+  ASSERT_NE( source, string::npos ) << code;
+  EXPECT_EQ( code.find( "#pragma omp ordered depend(sink: ", sink + 1 ), string::npos ) << code;
+  EXPECT_EQ( code.find( "#pragma omp ordered depend(source)", source + 1 ), string::npos ) << code;
+
+  EXPECT_LT( sink, code.find( "statement_0(" ) ) << code;
+  EXPECT_LT( code.find( "statement_1(" ), source ) << code;
+  EXPECT_LT( source, code.find( "statement_2(" ) ) << code;
+
+  // The stages run in the block loop
+  string::size_type block_loop = code.find( "for (", code.find( "ordered(1)" ) );
+  EXPECT_LT( block_loop, sink ) << code;
+}
+
+TEST( PipelineTransformation_test, other_loops_unchanged ){
+  LoopChain chain = producerConsumer();
+  Schedule schedule( chain );
+  PipelineTransformation pipeline( { 1, 2 }, 16, "" );
+  ASSERT_NO_THROW( schedule.apply( pipeline ) );
+
+  string code;
+  ASSERT_NO_THROW( code = schedule.codegen() );
+
+  EXPECT_NE( code.find( "#pragma omp parallel for ordered(1)" ), string::npos ) << code;
+  EXPECT_EQ( code.find( "ordered(1)" ), code.rfind( "ordered(1)" ) ) << code;
+  // The first loop runs, whole, before the pipeline
+  EXPECT_LT( code.find( "statement_0(" ), code.find( "ordered(1)" ) ) << code;
+  EXPECT_LT( code.find( "ordered(1)" ), code.find( "statement_1(" ) ) << code;
+}
+
+TEST( PipelineTransformation_test, illegal ){
+  LoopChain chain = producerConsumer();
+
+  EXPECT_THROW( PipelineTransformation( { 0 }, 4 ), assert_exception );
+  EXPECT_THROW( PipelineTransformation( { 0, 1 }, 0 ), assert_exception );
+  EXPECT_THROW( PipelineTransformation( { 0, 2 }, 4 ), assert_exception );
+  EXPECT_THROW( PipelineTransformation::blockOffsets( chain, { 2, 3 }, 4 ), assert_exception );
+
+  // The last stage's blocks would race on A
+  chain.append( LoopNest( RectangularDomain( { make_pair( "1", "N" ), make_pair( "1", "M" ) }, { "N", "M" } ),
+                          { Dataspace( "A", TupleCollection( { Tuple( { -1, 0 } ) } ), TupleCollection( { Tuple( { 0, 0 } ) } ) ) } ) );
+  EXPECT_THROW( PipelineTransformation::blockOffsets( chain, { 2, 3 }, 4 ), assert_exception );
+}
@@ -0,0 +1,112 @@
+/*! ****************************************************************************
+\file PolyhedralDomain_test.cpp
+\authors Ian J. Bertolacci
+
+\brief
+To perform unit testsing on the PolyhedralDomain data structure, and on
+non-rectangular loop nests in schedules.
+
+\copyright
+Copyright 2017 Universiy of Arizona
+*******************************************************************************/
+
+#include "gtest/gtest.h"
+#include <LoopChainIR/PolyhedralDomain.hpp>
+#include <LoopChainIR/Schedule.hpp>
+#include <LoopChainIR/FusionTransformation.hpp>
+#include <LoopChainIR/TileTransformation.hpp>
+#include <LoopChainIR/ShiftTransformation.hpp>
+#include <LoopChainIR/util.hpp>
+#include <iostream>
+#include <utility>
+#include <set>
+
+using namespace std;
+using namespace LoopChainIR;
+
+TEST( PolyhedralDomainTest, Test_Getters_constraints ){
+  PolyhedralDomain domain( {"i", "j"}, {"0 <= i <= N", "0 <= j <= i"}, {"N"} );
+
+  EXPECT_EQ( domain.dimensions(), 2 );
+  EXPECT_EQ( domain.symbolics(), 1 );
+  EXPECT_EQ( domain.getIterators(), vector<string>({"i", "j"}) );
+  EXPECT_EQ( domain.getConstraints(), vector<string>({"0 <= i <= N", "0 <= j <= i"}) );
+  EXPECT_EQ( domain.getSet(), string("[N] -> { [i,j] : (0 <= i <= N) and (0 <= j <= i) }") );
+}
+
+TEST( PolyhedralDomainTest, Test_Getters_set_string ){
+  PolyhedralDomain domain( "[N, M] -> { [i, j] : 0 <= i <= N and i <= j <= i + M }" );
+
+  EXPECT_EQ( domain.dimensions(), 2 );
+  EXPECT_EQ( domain.symbolics(), 2 );
+  EXPECT_EQ( domain.getIterators(), vector<string>({"i", "j"}) );
+  EXPECT_EQ( domain.getSymbols(), set<string>({"N", "M"}) );
+}
+
+TEST( PolyhedralDomainTest, Test_Unnamed_dimensions ){
+  PolyhedralDomain unnamed( "{ [5, 7] }" );
+
+  EXPECT_EQ( unnamed.dimensions(), 2 );
+  EXPECT_EQ( unnamed.symbolics(), 0 );
+  EXPECT_EQ( unnamed.getIterators(), vector<string>({"i_0", "i_1"}) );
+}
+
+TEST( PolyhedralDomainTest, Test_Invalid ){
+  EXPECT_THROW( PolyhedralDomain( {"i"}, {"0 <= i <= N"}, {} ), assert_exception );
+  EXPECT_THROW( PolyhedralDomain( "[N] -> { [i] : 0 <= i <= }" ), assert_exception );
+}
+
+TEST( PolyhedralDomainTest, Test_From_Rectangular ){
+  RectangularDomain rectangle( { make_pair("0", "N"), make_pair("1", "M") }, {"N", "M"} );
+  PolyhedralDomain domain( rectangle );
+
+  EXPECT_EQ( domain.dimensions(), 2 );
+  EXPECT_EQ( domain.symbolics(), 2 );
+  EXPECT_EQ( domain.getIterators(), vector<string>({"i_0", "i_1"}) );
+  EXPECT_EQ( domain.getConstraints(), vector<string>({"0 <= i_0 <= N", "1 <= i_1 <= M"}) );
+}
+
+TEST( PolyhedralDomainTest, Test_LoopNest ){
+  LoopNest nest( PolyhedralDomain( {"i", "j"}, {"0 <= j <= i <= N"}, {"N"} ) );
+
+  EXPECT_FALSE( nest.isRectangular() );
+  EXPECT_EQ( nest.dimensions(), 2 );
+  EXPECT_THROW( nest.getDomain(), assert_exception );
+
+  LoopNest rectangular( RectangularDomain( { make_pair("0", "N") }, {"N"} ) );
+  EXPECT_TRUE( rectangular.isRectangular() );
+  EXPECT_EQ( rectangular.getPolyhedralDomain().dimensions(), 1 );
+}
+
+TEST( PolyhedralDomainTest, GEN_1N_2D_triangle ){
+  LoopChain chain;
+  chain.append( LoopNest( PolyhedralDomain( {"i", "j"}, {"0 <= j <= i <= N"}, {"N"} ) ) );
+
+  Schedule sched( chain );
+
+  string code = sched.codegen();
+  ASSERT_NE( code.find( "c2 <= c1;" ), string::npos );
+}
+
+TEST( PolyhedralDomainTest, GEN_2N_2D_triangle_fuse_tile ){
+  LoopChain chain;
+  chain.append( LoopNest( RectangularDomain( { make_pair("0", "N"), make_pair("0", "N") }, {"N"} ) ) );
+  chain.append( LoopNest( PolyhedralDomain( "[N] -> { [i, j] : 0 <= i <= N and i - 2 <= j <= i + 2 and 0 <= j <= N }" ) ) );
+
+  vector<Transformation*> schedulers = {
+    new ShiftTransformation( 1, vector<string>{"1", "0"} ),
+    new FusionTransformation( vector<LoopChain::size_type>{0, 1} ),
+    new TileTransformation( 0, { make_pair( 0, "8" ), make_pair( 1, "8" ) } )
+  };
+
+  Schedule sched( chain );
+  ASSERT_NO_THROW({ sched.apply( schedulers ); });
+  ASSERT_NE( sched.codegen(), string("{\n}\n") );
+}
+
+TEST( PolyhedralDomainTest, Test_From_Strided_Rectangular ){
+  RectangularDomain rectangle( {"1"}, {"N"}, {"2"}, {"N"} );
+  PolyhedralDomain domain( rectangle );
+
+  EXPECT_EQ( domain.getConstraints(), vector<string>({"1 <= i_0 <= N", "(i_0 - (1)) mod 2 = 0"}) );
+}
@@ -11,6 +11,7 @@ Copyright 2015-2016 Colorado State University
 
 #include "gtest/gtest.h"
 #include <LoopChainIR/RectangularDomain.hpp>
+#include <LoopChainIR/util.hpp>
 #include <iostream>
 #include <utility>
 #include <set>
@@ -287,3 +288,23 @@ TEST(RectangularDomainTest, Test_Getters_2D_Expressions_Symbols_Set) {
   EXPECT_EQ( domain.getUpperBound(1), "N * N" );
   EXPECT_EQ( domain.getSymbols(), symbols );
 }
+
+TEST(RectangularDomainTest, Test_Strides ) {
+  RectangularDomain domain( {"0", "1"}, {"N", "M"}, {"1", "2"}, {"N", "M"} );
+
+  EXPECT_EQ( domain.dimensions(), 2 );
+  EXPECT_EQ( domain.getStride(0), "1" );
+  EXPECT_EQ( domain.getStride(1), "2" );
+
+  // Default stride is 1
+  RectangularDomain unit( { make_pair("0", "N") }, {"N"} );
+  EXPECT_EQ( unit.getStride(0), "1" );
+
+  // Appending keeps strides
+  unit.append( domain );
+  EXPECT_EQ( unit.getStride(2), "2" );
+
+  EXPECT_THROW( RectangularDomain( {"0"}, {"N"}, {"S"}, {"N", "S"} ), assert_exception );
+  EXPECT_THROW( RectangularDomain( {"0"}, {"N"}, {"0"}, {"N"} ), assert_exception );
+  EXPECT_THROW( RectangularDomain( {"0"}, {"N"}, {"1", "2"}, {"N"} ), assert_exception );
+}
@@ -11,6 +11,8 @@ Copyright 2015-2016 Colorado State University
 
 #include "gtest/gtest.h"
 #include <LoopChainIR/Schedule.hpp>
+#include <LoopChainIR/TileTransformation.hpp>
+#include <LoopChainIR/ParallelAnnotation.hpp>
 #include <LoopChainIR/util.hpp>
 #include <iostream>
 #include <utility>
@@ -87,3 +89,196 @@ TEST(ScheduleTest, Custom_statement_prefix) {
   ASSERT_EQ( sched.getRootStatementSymbol(), SSTR(prefix << "statement_") );
   ASSERT_NE( sched.codegen().find(prefix), std::string::npos );
 }
+
+TEST( ScheduleTest, context_constraints ){
+  LoopChain chain;
+
+  chain.append(
+    LoopNest(
+      RectangularDomain(
+        { make_pair("0", "N-1") },
+        {"N"}
+      )
+    )
+  );
+
+  vector<Transformation*> schedulers = {
+    new TileTransformation( 0, { make_pair( 0, "32" ) } )
+  };
+
+  Schedule unconstrained( chain );
+  unconstrained.apply( schedulers );
+
+  Schedule constrained( chain );
+  constrained.apply( schedulers );
+  constrained.addContextConstraint( "N >= 1024 and N % 32 = 0" );
+
+  ASSERT_EQ( constrained.getContext(), string("[N] -> { : (N >= 1024 and N % 32 = 0) }") );
+
+  string unconstrained_code = unconstrained.codegen();
+  string constrained_code = constrained.codegen();
+
+  // The bounds of the remainder tile are gone.
+  ASSERT_NE( unconstrained_code.find( "min(" ), string::npos );
+  ASSERT_EQ( constrained_code.find( "min(" ), string::npos );
+  ASSERT_EQ( constrained_code.find( "if (" ), string::npos );
+
+  ASSERT_NE( SSTR( constrained ).find( "C := [N] -> { : (N >= 1024 and N % 32 = 0) };" ), string::npos );
+  ASSERT_NE( SSTR( constrained ).find( ") ) given C using " ), string::npos );
+  ASSERT_EQ( SSTR( unconstrained ).find( " given " ), string::npos );
+}
+
+TEST( ScheduleTest, bad_context_constraint ){
+  LoopChain chain;
+
+  chain.append(
+    LoopNest(
+      RectangularDomain(
+        { make_pair("0", "N") },
+        {"N"}
+      )
+    )
+  );
+
+  Schedule sched( chain );
+  ASSERT_THROW( sched.addContextConstraint( "M >= 10" ), assert_exception );
+  ASSERT_EQ( sched.getContext(), string("[N] -> { :  }") );
+}
+
+TEST( ScheduleTest, strided_domain ){
+  LoopChain chain;
+
+  chain.append(
+    LoopNest(
+      RectangularDomain( {"1", "0"}, {"N", "M"}, {"2", "1"}, {"N", "M"} )
+    )
+  );
+
+  Schedule sched( chain );
+  string code = sched.codegen();
+
+  // Loop steps directly over every other iteration, without a guard.
+  ASSERT_NE( code.find( "c1 += 2)" ), string::npos );
+  ASSERT_EQ( code.find( "if (" ), string::npos );
+  ASSERT_EQ( code.find( "%" ), string::npos );
+}
+
+TEST( ScheduleTest, strided_domain_tile ){
+  LoopChain chain;
+
+  chain.append(
+    LoopNest(
+      RectangularDomain( {"0"}, {"N"}, {"2"}, {"N"} )
+    )
+  );
+
+  vector<Transformation*> schedulers = {
+    new TileTransformation( 0, { make_pair( 0, "16" ) } )
+  };
+
+  Schedule sched( chain );
+  sched.apply( schedulers );
+
+  ASSERT_NE( sched.codegen().find( "c3 += 2)" ), string::npos );
+}
+
+TEST( ScheduleTest, persistent_parallel_region ){
+  LoopChain chain;
+  RectangularDomain domain( { make_pair( "1", "N" ) }, { "N" } );
+
+  // B = f(A), C = g(A), D = h(B), E = k(C) sequentially, as nothing parallelizes it
+  chain.append( LoopNest( domain, { Dataspace( "A", TupleCollection( { Tuple( { 0 } ) } ), TupleCollection( 1 ) ),
+                                    Dataspace( "B", TupleCollection( 1 ), TupleCollection( { Tuple( { 0 } ) } ) ) } ) );
+  chain.append( LoopNest( domain, { Dataspace( "A", TupleCollection( { Tuple( { 0 } ) } ), TupleCollection( 1 ) ),
+                                    Dataspace( "C", TupleCollection( 1 ), TupleCollection( { Tuple( { 0 } ) } ) ) } ) );
+  chain.append( LoopNest( domain, { Dataspace( "B", TupleCollection( { Tuple( { -1 } ), Tuple( { 1 } ) } ), TupleCollection( 1 ) ),
+                                    Dataspace( "D", TupleCollection( 1 ), TupleCollection( { Tuple( { 0 } ) } ) ) } ) );
+  chain.append( LoopNest( domain, { Dataspace( "C", TupleCollection( { Tuple( { 0 } ) } ), TupleCollection( 1 ) ),
+                                    Dataspace( "E", TupleCollection( 1 ), TupleCollection( { Tuple( { 0 } ) } ) ) } ) );
+
+  Schedule sched( chain );
+  ParallelAnnotation annotation( OpenMPClauses().schedule( OpenMPClauses::Static ).numThreads( "T" ) );
+  sched.apply( annotation );
+
+  EXPECT_FALSE( sched.getPersistentParallelRegion() );
+  string separate = sched.codegen();
+  EXPECT_NE( separate.find( "#pragma omp parallel for schedule(static) num_threads(T)\n" ), string::npos ) << separate;
+
+  sched.setPersistentParallelRegion( true );
+  EXPECT_TRUE( sched.getPersistentParallelRegion() );
+  string code = sched.codegen();
+
+  EXPECT_EQ( code.find( "#pragma omp parallel\n{\n" ), 0 ) << code;
+  EXPECT_EQ( code.find( "omp parallel for" ), string::npos ) << code;
+
+  // Every nest shares its loop, without its implicit barrier
+  string::size_type loops = 0;
+  for( string::size_type at = code.find( "#pragma omp for schedule(static) nowait\n" ); at != string::npos; at = code.find( "#pragma omp for schedule(static) nowait\n", at + 1 ) ){
+    loops += 1;
+  }
+  EXPECT_EQ( loops, 4 ) << code;
+
+  // Only nest 2 (reading B) waits, and nest 3 (reading C) is then ordered by that barrier
+  string::size_type barrier = code.find( "#pragma omp barrier\n" );
+  ASSERT_NE( barrier, string::npos ) << code;
+  EXPECT_EQ( code.find( "#pragma omp barrier\n", barrier + 1 ), string::npos ) << code;
+  EXPECT_LT( code.find( "statement_1(" ), barrier ) << code;
+  EXPECT_GT( code.find( "statement_2(" ), barrier ) << code;
+}
+
+TEST( ScheduleTest, persistent_parallel_region_time_loop ){
+  LoopChain chain;
+  RectangularDomain domain( { make_pair( "1", "N" ) }, { "N" } );
+
+  // for t: B = f(A); A = B
+  chain.append( LoopNest( domain, { Dataspace( "A", TupleCollection( { Tuple( { -1 } ), Tuple( { 0 } ), Tuple( { 1 } ) } ), TupleCollection( 1 ) ),
+                                    Dataspace( "B", TupleCollection( 1 ), TupleCollection( { Tuple( { 0 } ) } ) ) } ) );
+  chain.append( LoopNest( domain, { Dataspace( "B", TupleCollection( { Tuple( { 0 } ) } ), TupleCollection( 1 ) ),
+                                    Dataspace( "A", TupleCollection( 1 ), TupleCollection( { Tuple( { 0 } ) } ) ) } ) );
+  chain.setTimeDomain( RectangularDomain( "1", "T", { "T" } ) );
+
+  Schedule sched( chain );
+  ParallelAnnotation annotation( OpenMPClauses().schedule( OpenMPClauses::Static ) );
+  sched.apply( annotation );
+  sched.setPersistentParallelRegion( true );
+  string code = sched.codegen();
+
+  // Every thread runs the time loop, and shares the loops of each time step
+  EXPECT_EQ( code.find( "#pragma omp parallel\n{\n" ), 0 ) << code;
+  EXPECT_EQ( code.find( "omp single" ), string::npos ) << code;
+  string::size_type time_loop = code.find( "c0 <= T" );
+  ASSERT_NE( time_loop, string::npos ) << code;
+  string::size_type first = code.find( "#pragma omp for schedule(static) nowait\n" );
+  ASSERT_NE( first, string::npos ) << code;
+  string::size_type second = code.find( "#pragma omp for schedule(static) nowait\n", first + 1 );
+  ASSERT_NE( second, string::npos ) << code;
+  EXPECT_LT( time_loop, first ) << code;
+
+  // B is read after it is written, and the next time step reads A after it is written
+  string::size_type barrier = code.find( "#pragma omp barrier\n" );
+  ASSERT_NE( barrier, string::npos ) << code;
+  EXPECT_LT( first, barrier ) << code;
+  EXPECT_LT( barrier, second ) << code;
+  string::size_type step_barrier = code.find( "#pragma omp barrier\n", barrier + 1 );
+  ASSERT_NE( step_barrier, string::npos ) << code;
+  EXPECT_LT( code.find( "statement_1(" ), step_barrier ) << code;
+  EXPECT_EQ( code.find( "#pragma omp barrier\n", step_barrier + 1 ), string::npos ) << code;
+}
+
+TEST( ScheduleTest, persistent_parallel_region_sequential ){
+  LoopChain chain;
+  RectangularDomain domain( { make_pair( "1", "N" ) }, { "N" } );
+
+  // A written by a nest that is not parallel, then read
+  chain.append( LoopNest( domain, { Dataspace( "A", TupleCollection( { Tuple( { -1 } ) } ), TupleCollection( { Tuple( { 0 } ) } ) ) } ) );
+  chain.append( LoopNest( domain, { Dataspace( "A", TupleCollection( { Tuple( { 0 } ) } ), TupleCollection( 1 ) ) } ) );
+
+  Schedule sched( chain );
+  sched.setPersistentParallelRegion( true );
+  string code = sched.codegen();
+
+  string::size_type single = code.find( "#pragma omp single nowait\n" );
+  ASSERT_NE( single, string::npos ) << code;
+  EXPECT_NE( code.find( "#pragma omp single nowait\n", single + 1 ), string::npos ) << code;
+  EXPECT_NE( code.find( "#pragma omp barrier\n" ), string::npos ) << code;
+}
@@ -0,0 +1,138 @@
+/*! ****************************************************************************
+\file SparseTiling_test.cpp
+\authors Ian J. Bertolacci
+
+\brief
+To perform unit testing on the sparse tiling inspector and executor.
+
+\copyright
+Copyright 2017 Universiy of Arizona
+*******************************************************************************/
+
+#include "gtest/gtest.h"
+#include <LoopChainIR/SparseTiling.hpp>
+#include <LoopChainIR/util.hpp>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+using namespace LoopChainIR;
+
+/*
+Chain over a ring mesh with shuffled edges:
+  loop 0 (nodes): x[n] = n
+  loop 1 (edges): y[e] = x[a(e)] + x[b(e)]
+  loop 2 (nodes): z[n] = sum of y[e] over edges incident to n
+*/
+class SparseTilingRing : public ::testing::Test {
+  protected:
+    int nodes;
+    vector<int> edge_nodes;
+    vector<int> node_edge_offsets;
+    vector<int> node_edges;
+    SparseTileInspector inspector;
+
+    void SetUp(){
+      nodes = 64;
+      // Edge e connects nodes (7e) % nodes and (7e + 1) % nodes
+      for( int e = 0; e < nodes; e += 1 ){
+        edge_nodes.push_back( (7 * e) % nodes );
+        edge_nodes.push_back( (7 * e + 1) % nodes );
+      }
+
+      node_edge_offsets.push_back( 0 );
+      for( int n = 0; n < nodes; n += 1 ){
+        for( int e = 0; e < nodes; e += 1 ){
+          if( edge_nodes[2*e] == n || edge_nodes[2*e + 1] == n ){
+            node_edges.push_back( e );
+          }
+        }
+        node_edge_offsets.push_back( (int) node_edges.size() );
+      }
+
+      inspector.addLoop( nodes, { SparseAccess::direct( "x", true, nodes ) } );
+      inspector.addLoop( nodes, { SparseAccess::fromIndexArray( "x", false, edge_nodes, 2 ),
+                                  SparseAccess::direct( "y", true, nodes ) } );
+      inspector.addLoop( nodes, { SparseAccess( "y", false, node_edge_offsets, node_edges ),
+                                  SparseAccess::direct( "z", true, nodes ) } );
+    }
+
+    vector<int> run( const SparseTileSchedule& schedule ){
+      vector<int> x( nodes, -1 ), y( nodes, -1 ), z( nodes, -1 );
+      schedule.execute( [&]( SparseTileSchedule::size_type loop, int i ){
+        if( loop == 0 ){
+          x[i] = i;
+        } else if( loop == 1 ){
+          y[i] = x[ edge_nodes[2*i] ] + x[ edge_nodes[2*i + 1] ];
+        } else {
+          z[i] = 0;
+          for( int p = node_edge_offsets[i]; p < node_edge_offsets[i + 1]; p += 1 ){
+            z[i] += y[ node_edges[p] ];
+          }
+        }
+      } );
+      return z;
+    }
+};
+
+TEST_F( SparseTilingRing, legal_seed_middle ){
+  SparseTileSchedule schedule = inspector.inspect( 1, 8 );
+
+  EXPECT_EQ( schedule.numTiles(), 8 );
+  EXPECT_EQ( schedule.numLoops(), 3 );
+  EXPECT_TRUE( inspector.isLegal( schedule ) );
+
+  // Same result as executing the chain in a single tile
+  EXPECT_EQ( run( schedule ), run( inspector.inspect( 1, 1 ) ) );
+}
+
+TEST_F( SparseTilingRing, legal_seed_first_and_last ){
+  for( SparseTileInspector::size_type seed : { 0, 2 } ){
+    SparseTileSchedule schedule = inspector.inspect( seed, 4 );
+    EXPECT_TRUE( inspector.isLegal( schedule ) );
+    EXPECT_EQ( run( schedule ), run( inspector.inspect( 1, 1 ) ) );
+  }
+}
+
+TEST_F( SparseTilingRing, every_iteration_once ){
+  SparseTileSchedule schedule = inspector.inspect( 1, 8 );
+
+  vector< vector<int> > counts( 3, vector<int>( nodes, 0 ) );
+  schedule.execute( [&]( SparseTileSchedule::size_type loop, int i ){ counts[loop][i] += 1; } );
+
+  for( vector<int> loop_counts : counts ){
+    EXPECT_EQ( loop_counts, vector<int>( nodes, 1 ) );
+  }
+}
+
+TEST_F( SparseTilingRing, illegal_schedule ){
+  // Everything of loop 2 before everything of loop 1
+  vector< vector<int> > tiles = { vector<int>( nodes, 0 ), vector<int>( nodes, 1 ), vector<int>( nodes, 0 ) };
+  EXPECT_FALSE( inspector.isLegal( SparseTileSchedule( 2, tiles ) ) );
+}
+
+TEST( SparseTiling_test, executor_code ){
+  SparseTileInspector inspector;
+  inspector.addLoop( 4, { SparseAccess::direct( "A", true, 4 ) } );
+  inspector.addLoop( 4, { SparseAccess::direct( "A", false, 4 ) } );
+
+  SparseTileSchedule schedule = inspector.inspect( 0, 2 );
+
+  EXPECT_EQ( schedule.tilePointers( 1 ), vector<int>({ 0, 2, 4 }) );
+  EXPECT_EQ( schedule.tileIterations( 1 ), vector<int>({ 0, 1, 2, 3 }) );
+  EXPECT_EQ( schedule.executorCode( "s_" ),
+             string( "for( int s_tile = 0; s_tile < 2; s_tile += 1 ){\n"
+                     "  for( int s_p = s_tile_ptr_0[s_tile]; s_p < s_tile_ptr_0[s_tile + 1]; s_p += 1 )\n"
+                     "    statement_0( s_tile_iter_0[s_p] );\n"
+                     "  for( int s_p = s_tile_ptr_1[s_tile]; s_p < s_tile_ptr_1[s_tile + 1]; s_p += 1 )\n"
+                     "    statement_1( s_tile_iter_1[s_p] );\n"
+                     "}\n" ) );
+}
+
+TEST( SparseTiling_test, bad_access ){
+  EXPECT_THROW( SparseAccess( "A", false, { 0, 2 }, { 1 } ), assert_exception );
+  EXPECT_THROW( SparseAccess::fromIndexArray( "A", false, { 0, 1, 2 }, 2 ), assert_exception );
+
+  SparseTileInspector inspector;
+  EXPECT_THROW( inspector.addLoop( 3, { SparseAccess::direct( "A", false, 4 ) } ), assert_exception );
+}
@@ -0,0 +1,126 @@
+/*! ****************************************************************************
+\file StorageMapping_test.cpp
+\authors Ian J. Bertolacci
+
+\brief
+To perform unit testsing on the StorageMapping class.
+
+\copyright
+Copyright 2017 Universiy of Arizona
+*******************************************************************************/
+
+#include "gtest/gtest.h"
+#include <LoopChainIR/StorageMapping.hpp>
+#include <LoopChainIR/Schedule.hpp>
+#include <LoopChainIR/FusionTransformation.hpp>
+#include <LoopChainIR/ShiftTransformation.hpp>
+#include <LoopChainIR/TileTransformation.hpp>
+#include <LoopChainIR/util.hpp>
+#include <iostream>
+#include <utility>
+
+using namespace std;
+using namespace LoopChainIR;
+
+namespace {
+  /*
+  for t in 1..T:
+    for i in 1..N:
+      A[t][i] = f( A[t-1][i-1], A[t-1][i], A[t-1][i+1] )
+  */
+  LoopChain jacobi(){
+    LoopChain chain;
+    chain.append( LoopNest( RectangularDomain( { make_pair( "1", "T" ), make_pair( "1", "N" ) }, { "T", "N" } ),
+                            { Dataspace( "A",
+                                         TupleCollection( { Tuple( { -1, -1 } ), Tuple( { -1, 0 } ), Tuple( { -1, 1 } ) } ),
+                                         TupleCollection( { Tuple( { 0, 0 } ) } ) ) } ) );
+    return chain;
+  }
+}
+
+TEST( StorageMapping_test, reuse_distance ){
+  LoopChain chain = jacobi();
+  EXPECT_EQ( StorageMapping::reuseDistance( chain, "A", 0 ), 2 );
+  EXPECT_EQ( StorageMapping::reuseDistance( chain, "A", 1 ), 2 );
+
+  StorageMapping mapping( chain, "A", 0 );
+  EXPECT_EQ( mapping.getDataspace(), "A" );
+  EXPECT_EQ( mapping.getDimension(), 0 );
+  EXPECT_EQ( mapping.getModulus(), 2 );
+  EXPECT_EQ( mapping.getMap(), "{ A[a_0,a_1] -> A[a_0 mod 2,a_1] }" );
+  EXPECT_EQ( mapping.indexExpression( { "t", "i" } ), "[((t)%2+2)%2][i]" );
+  EXPECT_THROW( mapping.indexExpression( { "t" } ), assert_exception );
+}
+
+TEST( StorageMapping_test, invalid ){
+  LoopChain chain = jacobi();
+  EXPECT_THROW( StorageMapping( chain, "B", 0 ), assert_exception );
+  EXPECT_THROW( StorageMapping( chain, "A", 2 ), assert_exception );
+  EXPECT_THROW( StorageMapping( chain, "A", 0, 0 ), assert_exception );
+}
+
+TEST( StorageMapping_test, verify ){
+  LoopChain chain = jacobi();
+  Schedule schedule( chain );
+
+  // Two time planes are live at once
+  EXPECT_TRUE( StorageMapping( chain, "A", 0 ).verify( schedule ) );
+  EXPECT_TRUE( StorageMapping( chain, "A", 0, 3 ).verify( schedule ) );
+  // A single plane overwrites A[t-1][i-1] before it is read
+  EXPECT_FALSE( StorageMapping( chain, "A", 0, 1 ).verify( schedule ) );
+}
+
+/*
+for i in 1..N: B[i] = A[i]
+for i in 1..N: C[i] = B[i-1] + B[i]
+Folding B modulo 2 is only legal once the two loops are fused (shifted).
+*/
+TEST( StorageMapping_test, verify_transformed ){
+  LoopChain chain;
+  chain.append( LoopNest( RectangularDomain( { make_pair( "1", "N" ) }, { "N" } ),
+                          { Dataspace( "A", TupleCollection( { Tuple( { 0 } ) } ), TupleCollection( 1 ) ),
+                            Dataspace( "B", TupleCollection( 1 ), TupleCollection( { Tuple( { 0 } ) } ) ) } ) );
+  chain.append( LoopNest( RectangularDomain( { make_pair( "1", "N" ) }, { "N" } ),
+                          { Dataspace( "B", TupleCollection( { Tuple( { -1 } ), Tuple( { 0 } ) } ), TupleCollection( 1 ) ),
+                            Dataspace( "C", TupleCollection( 1 ), TupleCollection( { Tuple( { 0 } ) } ) ) } ) );
+
+  StorageMapping mapping( chain, "B", 0 );
+  EXPECT_EQ( mapping.getModulus(), 2 );
+
+  Schedule unfused( chain );
+  EXPECT_FALSE( mapping.verify( unfused ) );
+
+  Schedule fused( chain );
+  FusionTransformation fusion( vector<LoopChain::size_type>( { 0, 1 } ) );
+  fused.apply( fusion );
+  EXPECT_TRUE( mapping.verify( fused ) );
+}
+
+/*
+for t in 1..T: A[t] = A[t-1] + A[t-3]
+Tiling rewrites the accesses of the schedule's chain, which must not change
+whether the folding is legal.
+*/
+TEST( StorageMapping_test, verify_after_tiling ){
+  LoopChain chain;
+  chain.append( LoopNest( RectangularDomain( { make_pair( "1", "T" ) }, { "T" } ),
+                          { Dataspace( "A", TupleCollection( { Tuple( { -1 } ), Tuple( { -3 } ) } ), TupleCollection( { Tuple( { 0 } ) } ) ) } ) );
+
+  Schedule untiled( chain );
+  EXPECT_FALSE( StorageMapping( chain, "A", 0, 2 ).verify( untiled ) );
+  EXPECT_TRUE( StorageMapping( chain, "A", 0 ).verify( untiled ) );
+
+  Schedule tiled( chain );
+  TileTransformation tile( 0, { make_pair( 0, "4" ) } );
+  tiled.apply( tile );
+  EXPECT_FALSE( StorageMapping( chain, "A", 0, 2 ).verify( tiled ) );
+  EXPECT_TRUE( StorageMapping( chain, "A", 0 ).verify( tiled ) );
+  EXPECT_EQ( StorageMapping::reuseDistance( tiled, "A", 0 ), 4 );
+  EXPECT_EQ( StorageMapping( tiled, "A", 0 ).getModulus(), 4 );
+
+  Schedule shifted( chain );
+  ShiftTransformation shift( 0, Tuple( { 2 } ) );
+  shifted.apply( shift );
+  EXPECT_FALSE( StorageMapping( chain, "A", 0, 2 ).verify( shifted ) );
+  EXPECT_EQ( StorageMapping::reuseDistance( shifted, "A", 0 ), 4 );
+}
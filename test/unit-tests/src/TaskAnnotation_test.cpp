@@ -0,0 +1,129 @@
+/*! ****************************************************************************
+\file TaskAnnotation_test.cpp
+\authors Ian J. Bertolacci
+
+\brief
+To perform unit testing on the TaskAnnotation code generator.
+
+\copyright
+Copyright 2017 Universiy of Arizona
+*******************************************************************************/
+
+#include "gtest/gtest.h"
+#include <LoopChainIR/TaskAnnotation.hpp>
+#include <LoopChainIR/TileTransformation.hpp>
+#include <LoopChainIR/DefaultSequentialTransformation.hpp>
+#include <LoopChainIR/Schedule.hpp>
+#include <LoopChainIR/util.hpp>
+#include <iostream>
+#include <utility>
+
+using namespace std;
+using namespace LoopChainIR;
+
+namespace {
+  /*
+  Gauss-Seidel style update, A[i][j] = A[i-1][j] + A[i][j-1] + A[i+1][j] + A[i][j+1]
+  */
+  LoopChain seidel(){
+    LoopChain chain;
+    chain.append( LoopNest( RectangularDomain( { make_pair( "1", "N" ), make_pair( "1", "N" ) }, { "N" } ),
+                            { Dataspace( "A",
+                                         TupleCollection( { Tuple( { -1, 0 } ), Tuple( { 0, -1 } ), Tuple( { 1, 0 } ), Tuple( { 0, 1 } ) } ),
+                                         TupleCollection( { Tuple( { 0, 0 } ) } ) ) } ) );
+    return chain;
+  }
+}
+
+TEST( TaskAnnotation_test, tile_dependences ){
+  LoopChain chain = seidel();
+
+  set<TaskAnnotation::TileOffset> offsets = TaskAnnotation::tileDependences( chain, { 0 }, 2 );
+  EXPECT_EQ( offsets, set<TaskAnnotation::TileOffset>( { { 0, 1 }, { 1, 0 } } ) );
+
+  // Tiling only the outer dimension
+  EXPECT_EQ( TaskAnnotation::tileDependences( chain, { 0 }, 1 ), set<TaskAnnotation::TileOffset>( { { 1 } } ) );
+
+  // Diagonal reads reach the tile up and to the right
+  LoopChain diagonal;
+  diagonal.append( LoopNest( RectangularDomain( { make_pair( "1", "N" ), make_pair( "1", "N" ) }, { "N" } ),
+                             { Dataspace( "A", TupleCollection( { Tuple( { -1, 1 } ) } ), TupleCollection( { Tuple( { 0, 0 } ) } ) ) } ) );
+  EXPECT_EQ( TaskAnnotation::tileDependences( diagonal, { 0 }, 2 ),
+             set<TaskAnnotation::TileOffset>( { { 1, 0 }, { 1, -1 } } ) );
+
+  // Affine accesses at constant distances
+  LoopChain strided;
+  strided.append( LoopNest( RectangularDomain( { make_pair( "1", "N" ), make_pair( "1", "N" ) }, { "N" } ),
+                            { Dataspace( "A", TupleCollection( 2 ), TupleCollection( 2 ),
+                                         { AffineAccess( {{2, 0}, {0, 1}}, Tuple( { -2, 0 } ) ), AffineAccess( {{2, 0}, {0, 1}}, Tuple( { 1, 0 } ) ) },
+                                         { AffineAccess( {{2, 0}, {0, 1}}, Tuple( { 0, 0 } ) ) } ) } ) );
+  // A[2i-2][j] was written one iteration of i before, and A[2i+1][j] is never written
+  EXPECT_EQ( TaskAnnotation::tileDependences( strided, { 0 }, 2 ), set<TaskAnnotation::TileOffset>( { { 1, 0 } } ) );
+
+  // Accesses at distances that are not constant
+  LoopChain reversed;
+  reversed.append( LoopNest( RectangularDomain( { make_pair( "1", "N" ) }, { "N" } ),
+                             { Dataspace( "A", TupleCollection( 1 ), TupleCollection( { Tuple( { 0 } ) } ),
+                                          { AffineAccess( {{-1}}, Tuple( { 0 } ) ) }, { } ) } ) );
+  EXPECT_THROW( TaskAnnotation::tileDependences( reversed, { 0 }, 1 ), assert_exception );
+  LoopChain mixed;
+  mixed.append( LoopNest( RectangularDomain( { make_pair( "1", "N" ), make_pair( "1", "N" ) }, { "N" } ),
+                          { Dataspace( "A", TupleCollection( 2 ), TupleCollection( { Tuple( { 0, 0 } ) } ),
+                                       { AffineAccess( {{2, 0}, {0, 1}}, Tuple( { 0, 0 } ) ) }, { } ) } ) );
+  EXPECT_THROW( TaskAnnotation::tileDependences( mixed, { 0 }, 2 ), assert_exception );
+  LoopChain broadcast;
+  broadcast.append( LoopNest( RectangularDomain( { make_pair( "1", "N" ), make_pair( "1", "N" ) }, { "N" } ),
+                              { Dataspace( "B", TupleCollection( 1 ), TupleCollection( 1 ),
+                                           { }, { AffineAccess( {{1, 0}}, Tuple( { 0 } ) ) } ) } ) );
+  EXPECT_THROW( TaskAnnotation::tileDependences( broadcast, { 0 }, 2 ), assert_exception );
+  EXPECT_EQ( TaskAnnotation::tileDependences( broadcast, { 0 }, 1 ), set<TaskAnnotation::TileOffset>( ) );
+
+  EXPECT_THROW( TaskAnnotation::tileDependences( chain, { 1 }, 2 ), assert_exception );
+  EXPECT_THROW( TaskAnnotation::tileDependences( chain, { 0 }, 3 ), assert_exception );
+
+  // Tasks cannot share a reduction target
+  LoopChain reduction;
+  reduction.append( LoopNest( RectangularDomain( { make_pair( "1", "N" ), make_pair( "1", "N" ) }, { "N" } ),
+                              { Dataspace( "sum", ReduceAdd, { AffineAccess( {{0, 0}}, Tuple( { 0 } ) ) } ) } ) );
+  EXPECT_THROW( TaskAnnotation::tileDependences( reduction, { 0 }, 2 ), assert_exception );
+}
+
+TEST( TaskAnnotation_test, pragma ){
+  TaskAnnotation annotation( 0, "deps" );
+  EXPECT_EQ( annotation.getDependenceArray(), "deps" );
+  EXPECT_EQ( annotation.taskPragma( { { 0, 1 }, { 1, 0 }, { 1, -1 } }, 2 ),
+             "omp task depend(out: deps[$2-$min(2)+1][$1-$min(1)+1]) depend(in: deps[$2-$min(2)+1][$1-$min(1)], "
+             "deps[$2-$min(2)][$1-$min(1)+2], deps[$2-$min(2)][$1-$min(1)+1])" );
+  EXPECT_EQ( annotation.taskPragma( { }, 1 ), "omp task depend(out: deps[$1-$min(1)+1])" );
+}
+
+TEST( TaskAnnotation_test, codegen ){
+  LoopChain chain = seidel();
+
+  vector<Transformation*> schedulers = {
+    new TileTransformation(
+      0,
+      { make_pair( 0, "16" ), make_pair( 1, "16" ) },
+      new TaskAnnotation( 0 ),
+      new DefaultSequentialTransformation()
+    )
+  };
+
+  Schedule sched( chain );
+  sched.apply( schedulers );
+
+  string code = sched.codegen();
+  string expected_region = "#pragma omp parallel\n#pragma omp single\nfor (int c1 = ";
+  EXPECT_NE( code.find( expected_region ), string::npos ) << code;
+  EXPECT_NE( code.find( "#pragma omp task depend(out: tile_deps[c1-(0)+1][c2-(0)+1]) depend(in: tile_deps[c1-(0)+1][c2-(0)], tile_deps[c1-(0)][c2-(0)+1])\n" ), string::npos ) << code;
+
+  // Tiles that do not start at 0 are indexed from their first tile
+  LoopChain shifted;
+  shifted.append( LoopNest( RectangularDomain( { make_pair( "100", "N" ), make_pair( "-N", "N" ) }, { "N" } ), seidel().getNest( 0 ).getDataspaces() ) );
+  Schedule shifted_sched( shifted );
+  shifted_sched.apply( schedulers );
+  code = shifted_sched.codegen();
+  EXPECT_NE( code.find( "depend(out: tile_deps[c1-(6)+1][c2-(-((N + 15) / 16))+1])" ), string::npos ) << code;
+
+  EXPECT_THROW( TaskAnnotation( 0 ).apply( sched ), assert_exception );
+}
@@ -0,0 +1,91 @@
+/*! ****************************************************************************
+\file TileRuntimeAnnotation_test.cpp
+\authors Ian J. Bertolacci
+
+\brief
+To perform unit testing on the TileRuntimeAnnotation code generator.
+
+\copyright
+Copyright 2017 Universiy of Arizona
+*******************************************************************************/
+
+#include "gtest/gtest.h"
+#include <LoopChainIR/TileRuntimeAnnotation.hpp>
+#include <LoopChainIR/TileTransformation.hpp>
+#include <LoopChainIR/DefaultSequentialTransformation.hpp>
+#include <LoopChainIR/Schedule.hpp>
+#include <LoopChainIR/util.hpp>
+#include <iostream>
+#include <utility>
+
+using namespace std;
+using namespace LoopChainIR;
+
+namespace {
+  /*
+  Gauss-Seidel style update, A[i][j] = A[i-1][j] + A[i][j-1] + A[i+1][j] + A[i][j+1]
+  */
+  LoopChain seidel(){
+    LoopChain chain;
+    chain.append( LoopNest( RectangularDomain( { make_pair( "1", "N" ), make_pair( "1", "M" ) }, { "N", "M" } ),
+                            { Dataspace( "A",
+                                         TupleCollection( { Tuple( { -1, 0 } ), Tuple( { 0, -1 } ), Tuple( { 1, 0 } ), Tuple( { 0, 1 } ) } ),
+                                         TupleCollection( { Tuple( { 0, 0 } ) } ) ) } ) );
+    return chain;
+  }
+}
+
+TEST( TileRuntimeAnnotation_test, registration ){
+  Schedule schedule( seidel() );
+  TileTransformation tile( 0, { make_pair( 0, "8" ), make_pair( 1, "8" ) },
+                           new TileRuntimeAnnotation( 0, "runtime" ), new DefaultSequentialTransformation() );
+  ASSERT_NO_THROW( schedule.apply( tile ) );
+
+  string code;
+  ASSERT_NO_THROW( code = schedule.codegen() );
+
+  // The tile loops register every tile
+  string::size_type registration = code.find( "tile_ids.emplace( std::vector<int>( { c1, c2 } ), tile_ids.size() );" );
+  string::size_type outer = code.find( "for (int c1 = 0; c1 <= floord(N, 8); c1 += 1) {" );
+  string::size_type inner = code.find( "for (int c2 = 0; c2 <= floord(M, 8); c2 += 1) {" );
+  ASSERT_NE( registration, string::npos ) << code;
+  EXPECT_LT( outer, inner ) << code;
+  EXPECT_LT( inner, registration ) << code;
+
+  // Edges from the tiles above and to the left
+  string::size_type graph = code.find( "LoopChainIR::TileGraph tile_graph( tile_ids.size() );" );
+  EXPECT_LT( registration, graph ) << code;
+  EXPECT_NE( code.find( "tile_ids.find( std::vector<int>( { tile.first[0] - (0), tile.first[1] - (1) } ) );" ), string::npos ) << code;
+  EXPECT_NE( code.find( "tile_ids.find( std::vector<int>( { tile.first[0] - (1), tile.first[1] - (0) } ) );" ), string::npos ) << code;
+  EXPECT_NE( code.find( "tile_graph.addEdge( predecessor->second, tile.second );" ), string::npos ) << code;
+
+  // The tile body runs the point loops of the tile it is called with
+  string::size_type run = code.find( "runtime.run( tile_graph, [&]( LoopChainIR::TileGraph::size_type tile ) {" );
+  ASSERT_NE( run, string::npos ) << code;
+  EXPECT_LT( graph, run ) << code;
+  EXPECT_LT( run, code.find( "const int c1 = tile_coordinate[0];" ) ) << code;
+  EXPECT_LT( code.find( "const int c1 = tile_coordinate[0];" ), code.find( "const int c2 = tile_coordinate[1];" ) ) << code;
+  EXPECT_LT( code.find( "const int c2 = tile_coordinate[1];" ), code.find( "statement_0(c4, c5);" ) ) << code;
+  EXPECT_EQ( code.find( "#pragma" ), string::npos ) << code;
+}
+
+TEST( TileRuntimeAnnotation_test, illegal ){
+  EXPECT_THROW( TileRuntimeAnnotation( vector<LoopChain::size_type>() ), assert_exception );
+  EXPECT_THROW( TileRuntimeAnnotation( 0, "" ), assert_exception );
+
+  // Only over the tiles of a tiling
+  Schedule schedule( seidel() );
+  TileRuntimeAnnotation annotation( 0 );
+  EXPECT_EQ( annotation.getRuntime(), "tile_runtime" );
+  EXPECT_THROW( schedule.apply( annotation ), assert_exception );
+
+  // A[i][j] = A[-i][j] reaches tiles at no fixed offset, so the graph would miss edges
+  LoopChain reversed;
+  reversed.append( LoopNest( RectangularDomain( { make_pair( "-N", "N" ), make_pair( "1", "M" ) }, { "N", "M" } ),
+                             { Dataspace( "A", TupleCollection( 2 ), TupleCollection( { Tuple( { 0, 0 } ) } ),
+                                          { AffineAccess( {{-1, 0}, {0, 1}}, Tuple( { 0, 0 } ) ) }, { } ) } ) );
+  Schedule reversed_schedule( reversed );
+  TileTransformation tile( 0, { make_pair( 0, "8" ), make_pair( 1, "8" ) },
+                           new TileRuntimeAnnotation( 0, "runtime" ), new DefaultSequentialTransformation() );
+  EXPECT_THROW( reversed_schedule.apply( tile ), assert_exception );
+}
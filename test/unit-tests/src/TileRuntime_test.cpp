@@ -0,0 +1,189 @@
+/*! ****************************************************************************
+\file TileRuntime_test.cpp
+\authors Ian J. Bertolacci
+
+\brief
+To perform unit testsing on the WorkStealingDeque, TileGraph and TileRuntime
+classes.
+
+\copyright
+Copyright 2017 Universiy of Arizona
+*******************************************************************************/
+
+#include "gtest/gtest.h"
+#include <LoopChainIR/TileRuntime.hpp>
+#include <LoopChainIR/util.hpp>
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace LoopChainIR;
+
+TEST( WorkStealingDeque_test, owner_and_thief_ends ){
+  WorkStealingDeque deque( 3 );
+  EXPECT_EQ( deque.capacity(), 4 );
+
+  WorkStealingDeque::size_type tile;
+  EXPECT_FALSE( deque.pop( tile ) );
+  EXPECT_FALSE( deque.steal( tile ) );
+
+  deque.push( 1 );
+  deque.push( 2 );
+  deque.push( 3 );
+
+  ASSERT_TRUE( deque.steal( tile ) );
+  EXPECT_EQ( tile, 1 );
+  ASSERT_TRUE( deque.pop( tile ) );
+  EXPECT_EQ( tile, 3 );
+  ASSERT_TRUE( deque.pop( tile ) );
+  EXPECT_EQ( tile, 2 );
+  EXPECT_FALSE( deque.pop( tile ) );
+
+  // Wraps around the buffer
+  for( WorkStealingDeque::size_type round = 0; round < 10; round += 1 ){
+    deque.push( round );
+    ASSERT_TRUE( deque.steal( tile ) );
+    EXPECT_EQ( tile, round );
+  }
+
+  deque.push( 1 );
+  deque.push( 2 );
+  deque.push( 3 );
+  deque.push( 4 );
+  EXPECT_THROW( deque.push( 5 ), assert_exception );
+}
+
+TEST( WorkStealingDeque_test, concurrent_steals ){
+  const WorkStealingDeque::size_type tiles = 20000;
+  WorkStealingDeque deque( tiles );
+  vector< atomic<int> > taken( tiles );
+  for( atomic<int>& count : taken ){
+    count.store( 0 );
+  }
+
+  atomic<bool> done( false );
+  vector<thread> thieves;
+  for( int thief = 0; thief < 3; thief += 1 ){
+    thieves.push_back( thread( [&](){
+      WorkStealingDeque::size_type tile;
+      while( !done.load() ){
+        if( deque.steal( tile ) ){
+          taken[tile] += 1;
+        }
+      }
+    } ) );
+  }
+
+  // The owner pushes everything and pops half as often
+  WorkStealingDeque::size_type tile;
+  for( WorkStealingDeque::size_type pushed = 0; pushed < tiles; pushed += 1 ){
+    deque.push( pushed );
+    if( pushed % 2 == 1 && deque.pop( tile ) ){
+      taken[tile] += 1;
+    }
+  }
+  while( deque.pop( tile ) ){
+    taken[tile] += 1;
+  }
+  done.store( true );
+  for( thread& thief : thieves ){
+    thief.join();
+  }
+
+  for( WorkStealingDeque::size_type tile = 0; tile < tiles; tile += 1 ){
+    ASSERT_EQ( taken[tile].load(), 1 ) << "tile " << tile;
+  }
+}
+
+TEST( TileGraph_test, grid ){
+  TileGraph graph = TileGraph::grid( { 3, 4 }, { { 1, 0 }, { 0, 1 } } );
+  ASSERT_EQ( graph.size(), 12 );
+
+  EXPECT_EQ( graph.coordinate( 0 ), vector<TileGraph::size_type>( { 0, 0 } ) );
+  EXPECT_EQ( graph.coordinate( 6 ), vector<TileGraph::size_type>( { 1, 2 } ) );
+
+  EXPECT_EQ( graph.predecessors( 0 ), 0 );
+  EXPECT_EQ( graph.predecessors( 1 ), 1 );
+  EXPECT_EQ( graph.predecessors( 4 ), 1 );
+  EXPECT_EQ( graph.predecessors( 5 ), 2 );
+  EXPECT_EQ( graph.successors( 5 ), vector<TileGraph::size_type>( { 6, 9 } ) );
+  EXPECT_TRUE( graph.successors( 11 ).empty() );
+  EXPECT_TRUE( graph.acyclic() );
+
+  // Offsets with negative components
+  TileGraph skewed = TileGraph::grid( { 2, 3 }, { { 1, -1 } } );
+  EXPECT_EQ( skewed.successors( 1 ), vector<TileGraph::size_type>( { 3 } ) );
+  EXPECT_EQ( skewed.predecessors( 5 ), 0 );
+
+  EXPECT_THROW( TileGraph::grid( { 2, 2 }, { { 1 } } ), assert_exception );
+}
+
+TEST( TileGraph_test, edges ){
+  TileGraph graph;
+  TileGraph::size_type a = graph.addTile();
+  TileGraph::size_type b = graph.addTile();
+  graph.addEdge( a, b );
+  EXPECT_TRUE( graph.acyclic() );
+  EXPECT_THROW( graph.addEdge( a, 2 ), assert_exception );
+  EXPECT_THROW( graph.coordinate( a ), assert_exception );
+
+  graph.addEdge( b, a );
+  EXPECT_FALSE( graph.acyclic() );
+
+  TileRuntime runtime( 2 );
+  EXPECT_THROW( runtime.run( graph, []( TileGraph::size_type ){} ), assert_exception );
+}
+
+TEST( TileRuntime_test, respects_dependences ){
+  TileGraph graph = TileGraph::grid( { 16, 16 }, { { 1, 0 }, { 0, 1 }, { 1, -1 } } );
+
+  for( TileRuntime::size_type workers : { 1, 2, 4 } ){
+    TileRuntime runtime( workers );
+    ASSERT_EQ( runtime.workers(), workers );
+
+    // Run twice on the same pool
+    for( int repeat = 0; repeat < 2; repeat += 1 ){
+      atomic<int> clock( 0 );
+      vector< atomic<int> > started( graph.size() );
+      vector< atomic<int> > finished( graph.size() );
+      for( TileGraph::size_type tile = 0; tile < graph.size(); tile += 1 ){
+        started[tile].store( -1 );
+        finished[tile].store( -1 );
+      }
+
+      runtime.run( graph, [&]( TileGraph::size_type tile ){
+        EXPECT_EQ( started[tile].exchange( clock++ ), -1 );
+        finished[tile].store( clock++ );
+      } );
+
+      for( TileGraph::size_type tile = 0; tile < graph.size(); tile += 1 ){
+        ASSERT_NE( finished[tile].load(), -1 ) << "tile " << tile;
+        for( TileGraph::size_type successor : graph.successors( tile ) ){
+          EXPECT_LT( finished[tile].load(), started[successor].load() ) << tile << " -> " << successor;
+        }
+      }
+    }
+  }
+}
+
+TEST( TileRuntime_test, exceptions ){
+  TileRuntime runtime( 3 );
+  TileGraph graph = TileGraph::grid( { 64 }, { } );
+
+  atomic<int> ran( 0 );
+  EXPECT_THROW( runtime.run( graph, [&]( TileGraph::size_type tile ){
+    ran += 1;
+    if( tile == 10 ){
+      throw runtime_error( "tile failed" );
+    }
+  } ), runtime_error );
+
+  // The pool is still usable
+  ran.store( 0 );
+  runtime.run( graph, [&]( TileGraph::size_type ){ ran += 1; } );
+  EXPECT_EQ( ran.load(), 64 );
+
+  runtime.run( TileGraph(), []( TileGraph::size_type ){} );
+}
@@ -0,0 +1,107 @@
+/*! ****************************************************************************
+\file TileSizeSelector_test.cpp
+\authors Ian J. Bertolacci
+
+\brief
+To perform unit testsing on the TileSizeSelector class.
+
+\copyright
+Copyright 2017 Universiy of Arizona
+*******************************************************************************/
+
+#include "gtest/gtest.h"
+#include <LoopChainIR/TileSizeSelector.hpp>
+#include <LoopChainIR/util.hpp>
+#include <iostream>
+#include <utility>
+
+using namespace std;
+using namespace LoopChainIR;
+
+namespace {
+  /*
+  for i in 1..upper:
+    for j in 1..upper:
+      B[i][j] = A[i-1][j] + A[i+1][j] + A[i][j-1] + A[i][j+1] + A[i][j]
+  */
+  LoopChain stencil( string upper ){
+    LoopChain chain;
+    chain.append( LoopNest( RectangularDomain( { make_pair( "1", upper ), make_pair( "1", upper ) }, { } ),
+                            { Dataspace( "A",
+                                         TupleCollection( { Tuple( { -1, 0 } ), Tuple( { 1, 0 } ), Tuple( { 0, -1 } ), Tuple( { 0, 1 } ), Tuple( { 0, 0 } ) } ),
+                                         TupleCollection( 2 ) ),
+                              Dataspace( "B", TupleCollection( 2 ), TupleCollection( { Tuple( { 0, 0 } ) } ) ) } ) );
+    return chain;
+  }
+}
+
+TEST( TileSizeSelector_test, footprint ){
+  TileSizeSelector selector( stencil( "N" ), 0 );
+
+  // A: (4+2) x (4+2) halo'd box without its corners, B: 4 x 4
+  EXPECT_EQ( selector.footprint( { 4, 4 } ), (32 + 16) * sizeof(double) );
+  EXPECT_EQ( selector.footprint( { 1, 8 } ), (8 + 10 + 8 + 8) * sizeof(double) );
+  EXPECT_THROW( selector.footprint( { 4 } ), assert_exception );
+
+  TileSizeSelector floats( stencil( "N" ), 0, sizeof(float) );
+  EXPECT_EQ( floats.footprint( { 4, 4 } ), (32 + 16) * sizeof(float) );
+}
+
+TEST( TileSizeSelector_test, affine_footprint ){
+  // B[i][j] = A[j][i] + A[j][i+1]
+  LoopChain chain;
+  chain.append( LoopNest( RectangularDomain( { make_pair( "1", "N" ), make_pair( "1", "N" ) }, { "N" } ),
+                          { Dataspace( "A", { }, { },
+                                       { AffineAccess( { { 0, 1 }, { 1, 0 } }, Tuple( { 0, 0 } ) ),
+                                         AffineAccess( { { 0, 1 }, { 1, 0 } }, Tuple( { 0, 1 } ) ) },
+                                       { } ),
+                            Dataspace( "B", TupleCollection( 2 ), TupleCollection( { Tuple( { 0, 0 } ) } ) ) } ) );
+
+  TileSizeSelector selector( chain, 0, 1, 1 );
+  // A: 8 x (2+1), B: 2 x 8
+  EXPECT_EQ( selector.footprint( { 2, 8 } ), 8*3 + 2*8 );
+}
+
+TEST( TileSizeSelector_test, select ){
+  TileSizeSelector selector( stencil( "N" ), 0, sizeof(double), 4 );
+
+  TileSizeSelector::TileSizes tile = selector.select( 32*1024 );
+  ASSERT_EQ( tile.size(), 2 );
+  EXPECT_EQ( tile[1] % 4, 0 );
+  EXPECT_LE( selector.footprint( tile ), 32*1024 );
+
+  // Doubling any dimension would overflow the cache
+  EXPECT_GT( selector.footprint( { tile[0]*2, tile[1] } ), 32*1024 );
+  EXPECT_GT( selector.footprint( { tile[0], tile[1]*2 } ), 32*1024 );
+
+  // Roughly square
+  EXPECT_LE( max( tile[0], tile[1] ), 2*min( tile[0], tile[1] ) );
+
+  // Nothing fits: a single vector of iterations
+  EXPECT_EQ( selector.select( 1 ), TileSizeSelector::TileSizes( { 1, 4 } ) );
+
+  EXPECT_EQ( TileSizeSelector::tileMap( tile ),
+             TileTransformation::TileMap( { { 0, SSTR( tile[0] ) }, { 1, SSTR( tile[1] ) } } ) );
+}
+
+TEST( TileSizeSelector_test, levels ){
+  TileSizeSelector selector( stencil( "N" ), 0, sizeof(double), 8 );
+
+  vector<TileSizeSelector::TileSizes> levels = selector.select( vector<TileSizeSelector::size_type>( { 32*1024, 256*1024 } ) );
+  ASSERT_EQ( levels.size(), 2 );
+  EXPECT_LE( selector.footprint( levels[0] ), 32*1024 );
+  EXPECT_LE( selector.footprint( levels[1] ), 256*1024 );
+  for( TileSizeSelector::size_type d = 0; d < 2; d += 1 ){
+    EXPECT_EQ( levels[1][d] % levels[0][d], 0 );
+    EXPECT_GE( levels[1][d], levels[0][d] );
+  }
+  EXPECT_EQ( levels[0][1] % 8, 0 );
+
+  EXPECT_THROW( selector.select( vector<TileSizeSelector::size_type>( { 256*1024, 32*1024 } ) ), assert_exception );
+}
+
+TEST( TileSizeSelector_test, bounded ){
+  // The whole 6x6 domain fits, but the innermost dimension stays a vector multiple
+  TileSizeSelector selector( stencil( "6" ), 0, sizeof(double), 4 );
+  EXPECT_EQ( selector.select( 1024*1024 ), TileSizeSelector::TileSizes( { 6, 8 } ) );
+}
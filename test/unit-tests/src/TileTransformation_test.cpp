@@ -15,6 +15,7 @@ Copyright 2015-2016 Colorado State University
 #include <LoopChainIR/DefaultSequentialTransformation.hpp>
 #include <iostream>
 #include <utility>
+#include <map>
 
 using namespace std;
 using namespace LoopChainIR;
@@ -610,3 +611,111 @@ TEST(TileTransformationTest, tile_dataspaces) {
   }
   */
 }
+
+TEST( TileTransformation_test, 1N_1D_separate_full_tiles ){
+  LoopChain chain;
+
+  chain.append(
+    LoopNest(
+      RectangularDomain(
+        { make_pair("1", "N") },
+        {"N"}
+      )
+    )
+  );
+
+  TileTransformation tile( 0, { make_pair( 0, "16" ) }, true );
+  ASSERT_TRUE( tile.separatesFullTiles() );
+
+  Schedule sched( chain );
+  sched.apply( tile );
+
+  string code = sched.codegen();
+
+  // Full tiles have a constant trip count, without min/max bounds
+  ASSERT_NE( code.find( "<= 16 * c1 + 15; c3 += 1)" ), string::npos );
+  // Partial tiles are still bounded by the domain
+  ASSERT_NE( code.find( "<= N; c3 += 1)" ), string::npos );
+}
+
+TEST( TileTransformation_test, 2N_2D_separate_full_tiles_after_shift ){
+  LoopChain chain;
+
+  for( int i = 0; i < 2; ++i ){
+    chain.append(
+      LoopNest(
+        RectangularDomain(
+          { make_pair("0", "N"), make_pair("0", "M") },
+          {"N", "M"}
+        )
+      )
+    );
+  }
+
+  vector<Transformation*> schedulers = {
+    new ShiftTransformation( 1, vector<string>{"1", "0"} ),
+    new TileTransformation( 1, { make_pair( 0, "8" ), make_pair( 1, "8" ) }, true )
+  };
+
+  Schedule sched( chain );
+  ASSERT_NO_THROW({ sched.apply( schedulers ); });
+  ASSERT_NE( sched.codegen(), string("{\n}\n") );
+}
+
+TEST( TileTransformation_test, separate_full_tiles_symbolic_size ){
+  LoopChain chain;
+
+  chain.append(
+    LoopNest(
+      RectangularDomain(
+        { make_pair("0", "N") },
+        {"N"}
+      )
+    )
+  );
+
+  TileTransformation tile( 0, { make_pair( 0, "T" ) }, true );
+  Schedule sched( chain );
+
+  ASSERT_THROW( sched.apply( tile ), assert_exception );
+}
+
+TEST( TileTransformation_test, affine_accesses ){
+  LoopChain chain;
+
+  // B[2i+5] = A[2i-3] + A[i][5]
+  chain.append(
+    LoopNest(
+      RectangularDomain( { make_pair("0", "N") }, {"N"} ),
+      { Dataspace( "A", set<Tuple>(), set<Tuple>(), { AffineAccess( {{2}}, Tuple( { -3 } ) ) }, set<AffineAccess>() ),
+        Dataspace( "C", set<Tuple>(), set<Tuple>(), { AffineAccess( {{1}, {0}}, Tuple( { 2, 5 } ) ) }, set<AffineAccess>() ),
+        Dataspace( "B", set<Tuple>(), set<Tuple>(), set<AffineAccess>(), { AffineAccess( {{2}}, Tuple( { 5 } ) ) } ) }
+    )
+  );
+
+  Schedule sched( chain );
+  TileTransformation tile( 0, { make_pair( 0, "16" ) } );
+  ASSERT_NO_THROW( sched.apply( tile ) );
+
+  // Offsets become the direction of the iterations they are away, keeping the element parity
+  map<string, Dataspace> dataspaces;
+  for( const Dataspace& dataspace : sched.getChain().getNest( 0 ).getDataspaces() ){
+    dataspaces.emplace( dataspace.name, dataspace );
+  }
+  EXPECT_EQ( *dataspaces.at( "A" ).affineReads().begin(), AffineAccess( {{2}}, Tuple( { -1 } ) ) );
+  EXPECT_EQ( *dataspaces.at( "B" ).affineWrites().begin(), AffineAccess( {{2}}, Tuple( { 3 } ) ) );
+  // The constant index of a broadcast is kept
+  EXPECT_EQ( *dataspaces.at( "C" ).affineReads().begin(), AffineAccess( {{1}, {0}}, Tuple( { 1, 5 } ) ) );
+
+  // A[i+j] does not give a direction per iterator
+  LoopChain skewed;
+  skewed.append(
+    LoopNest(
+      RectangularDomain( { make_pair("0", "N"), make_pair("0", "N") }, {"N"} ),
+      { Dataspace( "A", set<Tuple>(), set<Tuple>(), { AffineAccess( {{1, 1}}, Tuple( { 1 } ) ) }, set<AffineAccess>() ) }
+    )
+  );
+  Schedule skewed_sched( skewed );
+  TileTransformation skewed_tile( 0, { make_pair( 0, "16" ), make_pair( 1, "16" ) } );
+  EXPECT_THROW( skewed_sched.apply( skewed_tile ), assert_exception );
+}
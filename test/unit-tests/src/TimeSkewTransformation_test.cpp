@@ -0,0 +1,135 @@
+/*! ****************************************************************************
+\file TimeSkewTransformation_test.cpp
+\authors Ian J. Bertolacci
+
+\brief
+To perform unit testing on the TimeSkewTransformation.
+
+\copyright
+Copyright 2017 Universiy of Arizona
+*******************************************************************************/
+
+#include "gtest/gtest.h"
+#include <LoopChainIR/TimeSkewTransformation.hpp>
+#include <LoopChainIR/Schedule.hpp>
+#include <LoopChainIR/util.hpp>
+#include <iostream>
+#include <utility>
+
+using namespace std;
+using namespace LoopChainIR;
+
+namespace {
+  /*
+  for t in 1..T:
+    B[i] = A[i-1] + A[i] + A[i+1]
+    A[i] = B[i]
+  */
+  LoopChain jacobi(){
+    LoopChain chain;
+    chain.append( LoopNest( RectangularDomain( { make_pair( "1", "N" ) }, { "N" } ),
+                            { Dataspace( "A", TupleCollection( { Tuple( { -1 } ), Tuple( { 0 } ), Tuple( { 1 } ) } ), TupleCollection( 1 ) ),
+                              Dataspace( "B", TupleCollection( 1 ), TupleCollection( { Tuple( { 0 } ) } ) ) } ) );
+    chain.append( LoopNest( RectangularDomain( { make_pair( "1", "N" ) }, { "N" } ),
+                            { Dataspace( "B", TupleCollection( { Tuple( { 0 } ) } ), TupleCollection( 1 ) ),
+                              Dataspace( "A", TupleCollection( 1 ), TupleCollection( { Tuple( { 0 } ) } ) ) } ) );
+    chain.setTimeDomain( RectangularDomain( "1", "T", { "T" } ) );
+    return chain;
+  }
+}
+
+TEST( TimeSkewTransformation_test, time_domain_codegen ){
+  Schedule schedule( jacobi() );
+  ASSERT_NE( schedule.getTimeSubspace(), (Subspace*) NULL );
+
+  string code;
+  ASSERT_NO_THROW( code = schedule.codegen() );
+
+  // Every time step runs both loops, and the time iterator is the statements' first argument
+  string::size_type time_loop = code.find( "c0 <= T" );
+  ASSERT_NE( time_loop, string::npos ) << code;
+  EXPECT_LT( time_loop, code.find( "statement_0(c0, " ) ) << code;
+  EXPECT_LT( code.find( "statement_0(c0, " ), code.find( "statement_1(c0, " ) ) << code;
+
+  LoopChain timeless;
+  timeless.append( jacobi().getNest( 0 ) );
+  EXPECT_EQ( Schedule( timeless ).getTimeSubspace(), (Subspace*) NULL );
+}
+
+TEST( TimeSkewTransformation_test, shifts_and_factors ){
+  LoopChain chain = jacobi();
+
+  // The second loop reads B where the first wrote it, but overwrites the A the first loop reads one ahead
+  vector< vector<int> > shifts = TimeSkewTransformation::nestShifts( chain, 1 );
+  EXPECT_EQ( shifts, vector< vector<int> >( { { 0 }, { 1 } } ) );
+
+  // The next time step's first loop reads A one behind where the (shifted) second loop wrote it
+  EXPECT_EQ( TimeSkewTransformation::skewFactors( chain, shifts ), vector<int>( { 2 } ) );
+
+  // Independent time steps need no skew
+  LoopChain independent;
+  independent.append( LoopNest( RectangularDomain( { make_pair( "1", "N" ) }, { "N" } ),
+                                { Dataspace( "A", TupleCollection( 1 ), TupleCollection( { Tuple( { 0 } ) } ) ) } ) );
+  vector< vector<int> > none = TimeSkewTransformation::nestShifts( independent, 1 );
+  EXPECT_EQ( none, vector< vector<int> >( { { 0 } } ) );
+  EXPECT_EQ( TimeSkewTransformation::skewFactors( independent, none ), vector<int>( { 0 } ) );
+}
+
+TEST( TimeSkewTransformation_test, codegen ){
+  Schedule schedule( jacobi() );
+  TimeSkewTransformation skew( 4, { 8 } );
+  EXPECT_EQ( skew.getTimeTile(), 4 );
+  EXPECT_FALSE( skew.fusesNests() );
+  ASSERT_NO_THROW( schedule.apply( skew ) );
+
+  string code;
+  ASSERT_NO_THROW( code = schedule.codegen() );
+
+  // Tiles of time steps, then tiles of skewed iterations, then the time steps of the tile
+  string::size_type time_tiles = code.find( "floord(T, 4)" );
+  string::size_type skewed = code.find( "2 * c3" );
+  ASSERT_NE( time_tiles, string::npos ) << code;
+  ASSERT_NE( skewed, string::npos ) << code;
+  EXPECT_LT( time_tiles, code.find( "c3 <= min(T, 4 * c0 + 3)" ) ) << code;
+  EXPECT_LT( code.find( "statement_0(c3, " ), code.find( "statement_1(c3, " ) ) << code;
+}
+
+TEST( TimeSkewTransformation_test, fused_codegen ){
+  Schedule schedule( jacobi() );
+  TimeSkewTransformation skew( 4, { 8 }, true );
+  ASSERT_NO_THROW( schedule.apply( skew ) );
+
+  string code;
+  ASSERT_NO_THROW( code = schedule.codegen() );
+
+  // The second loop runs one iteration behind the first, in the same loop
+  string::size_type first = code.find( "statement_0(c3, c6);" );
+  string::size_type second = code.find( "statement_1(c3, c6 - 1);" );
+  ASSERT_NE( first, string::npos ) << code;
+  ASSERT_NE( second, string::npos ) << code;
+  EXPECT_LT( first, second ) << code;
+  EXPECT_EQ( code.substr( first, second - first ).find( "for (" ), string::npos ) << code;
+}
+
+TEST( TimeSkewTransformation_test, illegal ){
+  EXPECT_THROW( TimeSkewTransformation( 0, { 8 } ), assert_exception );
+  EXPECT_THROW( TimeSkewTransformation( 4, { } ), assert_exception );
+  EXPECT_THROW( TimeSkewTransformation( 4, { 8, -1 } ), assert_exception );
+
+  // No time domain
+  LoopChain timeless;
+  timeless.append( jacobi().getNest( 0 ) );
+  Schedule schedule( timeless );
+  TimeSkewTransformation skew( 4, { 8 } );
+  EXPECT_THROW( schedule.apply( skew ), assert_exception );
+
+  // Tiling more dimensions than the loops have
+  EXPECT_THROW( TimeSkewTransformation::nestShifts( jacobi(), 2 ), assert_exception );
+
+  // Gauss-Seidel in the second dimension depends backward in the first
+  LoopChain backward;
+  backward.append( LoopNest( RectangularDomain( { make_pair( "1", "N" ), make_pair( "1", "N" ) }, { "N" } ),
+                             { Dataspace( "A", TupleCollection( { Tuple( { -1, 1 } ) } ), TupleCollection( { Tuple( { 0, 0 } ) } ) ) } ) );
+  EXPECT_NO_THROW( TimeSkewTransformation::nestShifts( backward, 1 ) );
+  EXPECT_THROW( TimeSkewTransformation::nestShifts( backward, 2 ), assert_exception );
+}